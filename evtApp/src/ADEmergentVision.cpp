@@ -17,6 +17,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
+#include <map>
+#include <mutex>
 
 // EPICS includes
 #include <epicsTime.h>
@@ -63,6 +66,10 @@ const char* driverName = "ADEmergentVision";
 // Constants
 static const double ONE_BILLION = 1.E9;
 
+// Drivers by port name, used by code in the IOC to find the driver it registers frame consumers with
+static map<string, ADEmergentVision*> evtDrivers;
+static mutex evtDriversMutex;
+
 
 // -----------------------------------------------------------------------
 // ADEmergentVision Utility Functions (Reporting/Logging/ExternalC)
@@ -315,6 +322,7 @@ asynStatus ADEmergentVision::disconnectFromDeviceEVT(){
     int acquiring;
     getIntegerParam(ADAcquire, &acquiring);
     if(acquiring) acquireStop();
+    stopCameraLutTransfer();
     if(this->pdeviceInfo == NULL || this->pcamera == NULL){
         ERR("Never connected to device");
         return asynError;
@@ -516,6 +524,10 @@ asynStatus ADEmergentVision::acquireStart(){
         ERR("Error: No camera connected");
         status = asynError;
     }
+    else if(this->cameraLutBusy){
+        ERR("Camera LUT transfer in progress");
+        status = asynError;
+    }
     else{
         unsigned int evtPixelFormat;
         getFrameFormatEVT(&evtPixelFormat);
@@ -528,6 +540,24 @@ asynStatus ADEmergentVision::acquireStart(){
             ERR_ARGS("Invalid camera settings! Supported formats: %s", this->supportedModes);
         }
         else{
+            this->cameraTimeStampAnchored = 0;
+            readCameraTickFrequency();
+            this->framesSincePublish = 0;
+            this->udpLatencyMax = 0;
+            this->framesSinceFullFrame = 0;
+            this->changeDetector.reset();
+            this->framesSinceBackgroundUpdate = 0;
+            this->triggerEngine.reset();
+            this->triggerState = EVT_TRIGGER_IDLE;
+            releasePreTriggerFrames();
+            setIntegerParam(ADEVT_ChangeSuppressed, 0);
+            getIntegerParam(ADEVT_FfcOutput, &this->flatFieldOutput);
+            this->flatFieldMismatchReported = 0;
+            prewarmArrays();
+            if(this->frameSync != NULL) this->frameSync->reset(this->syncMember);
+            int shmEnable;
+            getIntegerParam(ADEVT_ShmEnable, &shmEnable);
+            if(shmEnable && !this->sharedRing.isOpen()) configureSharedRing(0);
             this->evt_status = EVT_CameraOpenStream(pcamera);
             startImageAcquisitionThread();
             if(this->evt_status != EVT_SUCCESS){
@@ -574,8 +604,12 @@ asynStatus ADEmergentVision::acquireStop(){
     else{
         stopImageAcquisitionThread();
         // Make sure camera acquisition is completed before we close the stream.
-        while(this->imageThreadOpen == 1)
+        // The image thread takes the driver lock while processing a frame, so release it while waiting
+        while(this->imageThreadOpen == 1){
+            this->unlock();
             epicsThreadSleep(0.1);
+            this->lock();
+        }
         this->evt_status = EVT_CameraExecuteCommand(&camera, "AcquisitionStop");
         if(this->evt_status != EVT_SUCCESS){
             reportEVTError(this->evt_status, functionName);
@@ -634,7 +668,10 @@ asynStatus ADEmergentVision::getFrameFormatEVT(unsigned int* evtPixelType){
                     return asynError;
             }
             break;
+        // planar modes are split from interleaved frames by the driver
         case NDColorModeRGB1:
+        case NDColorModeRGB2:
+        case NDColorModeRGB3:
             switch(pixelFormat){
                 case 0:
                     *evtPixelType = GVSP_PIX_RGB8;
@@ -770,6 +807,219 @@ unsigned int ADEmergentVision::getConvertBitDepth(PIXEL_FORMAT evtPixelFormat) {
 }
 
 
+/**
+ * Method that gets the number of significant bits per value of a pixel format
+ * 
+ * @params[in]: evtPixelFormat  -> pixel format of the camera frames
+ * @return:     bit depth, 8 for unknown formats
+ */
+int ADEmergentVision::getPixelBitDepth(PIXEL_FORMAT evtPixelFormat){
+    switch(evtPixelFormat){
+        case GVSP_PIX_MONO10:
+        case GVSP_PIX_MONO10_PACKED:
+        case GVSP_PIX_RGB10:
+        case GVSP_PIX_BAYRG10:
+        case GVSP_PIX_BAYRG10_PACKED:
+            return 10;
+        case GVSP_PIX_MONO12:
+        case GVSP_PIX_MONO12_PACKED:
+        case GVSP_PIX_RGB12:
+        case GVSP_PIX_BAYRG12:
+        case GVSP_PIX_BAYRG12_PACKED:
+            return 12;
+        default:
+            return 8;
+    }
+}
+
+
+/**
+ * Function that reads the frequency of the camera timestamp clock, used to convert camera timestamps
+ * to time. Cameras that do not report it are assumed to count nanoseconds.
+ * 
+ * @return: void
+ */
+void ADEmergentVision::readCameraTickFrequency(){
+    const char* functionName = "readCameraTickFrequency";
+    unsigned int tickFrequency = 0;
+    EVT_ERROR err = EVT_CameraGetUInt32Param(this->pcamera, "GevTimestampTickFrequency", &tickFrequency);
+    if(err != EVT_SUCCESS || tickFrequency == 0){
+        ERR("Camera timestamp frequency not available, assuming nanosecond ticks");
+        tickFrequency = (unsigned int) ONE_BILLION;
+    }
+    this->cameraTickFrequency = tickFrequency;
+}
+
+
+/**
+ * Function that converts the camera timestamp of a frame to nanoseconds of the camera clock
+ * 
+ * @params[in]: frame   -> frame recieved from Emergent Vision Camera
+ * @return:     camera timestamp in nanoseconds
+ */
+uint64_t ADEmergentVision::getCameraTimeNs(CEmergentFrame* frame){
+    uint64_t ticks = frame->timestamp;
+    uint64_t frequency = this->cameraTickFrequency;
+    if(frequency == (uint64_t) ONE_BILLION) return ticks;
+    // whole seconds and the remainder are scaled separately, so large tick counts do not overflow
+    return (ticks / frequency) * (uint64_t) ONE_BILLION + (ticks % frequency) * (uint64_t) ONE_BILLION / frequency;
+}
+
+
+/**
+ * Function that converts the camera timestamp of a frame into an epics timestamp, used when the camera
+ * timestamp source is selected. The first frame of an acquisition is anchored to the host clock, and every
+ * following frame is offset from that anchor using the camera clock, so frame to frame timing is that of the
+ * camera. The offset from the host clock is not corrected during an acquisition, so long acquisitions drift
+ * by the difference between the two clocks.
+ * 
+ * @params[in]:     frame       -> frame recieved from Emergent Vision Camera
+ * @params[out]:    pTimeStamp  -> epics timestamp for the frame
+ * @return:         void
+ */
+void ADEmergentVision::getCameraTimeStamp(CEmergentFrame* frame, epicsTimeStamp* pTimeStamp){
+    if(this->cameraTimeStampAnchored == 0){
+        epicsTimeGetCurrent(&this->cameraTimeStampAnchor);
+        this->cameraTimeStampAnchorTicks = frame->timestamp;
+        this->cameraTimeStampAnchored = 1;
+    }
+    long long elapsedTicks = (long long) (frame->timestamp - this->cameraTimeStampAnchorTicks);
+    *pTimeStamp = this->cameraTimeStampAnchor;
+    epicsTimeAddSeconds(pTimeStamp, elapsedTicks / (double) this->cameraTickFrequency);
+}
+
+
+/**
+ * Function that checks whether the current frame should be passed on to plugins.
+ * Per frame scalars are computed for every frame, but only every Nth NDArray is published,
+ * where N is the value of the decimation PV.
+ * 
+ * @return: true if the NDArray for the current frame should be published, false otherwise
+ */
+bool ADEmergentVision::isFramePublished(){
+    int decimation;
+    getIntegerParam(ADEVT_Decimation, &decimation);
+    this->framesSincePublish++;
+    if(decimation <= 1 || this->framesSincePublish >= decimation){
+        this->framesSincePublish = 0;
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * Function that checks whether the current frame differs enough from the last published frame to be published.
+ * Both are reduced to a grid of block means, and the frame is published if any block mean moved by more than
+ * the threshold, or if no frame was published for the keep alive period. Frames other than mono 8/16 bit
+ * frames are always published.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @return: true if the frame should be published, false if it is suppressed
+ */
+bool ADEmergentVision::isFrameChanged(NDArray* pArray){
+    int enable, blockSize;
+    double threshold, keepAlive, change;
+    this->changePending = false;
+    getIntegerParam(ADEVT_ChangeEnable, &enable);
+    if(!enable || pArray->ndims != 2) return true;
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+
+    getIntegerParam(ADEVT_ChangeBlockSize, &blockSize);
+    if(pArray->dataType == NDUInt8 || pArray->dataType == NDInt8)
+        change = this->changeDetector.measure((const uint8_t*) pArray->pData, sizeX, sizeY, blockSize);
+    else if(pArray->dataType == NDUInt16 || pArray->dataType == NDInt16)
+        change = this->changeDetector.measure((const uint16_t*) pArray->pData, sizeX, sizeY, blockSize);
+    else return true;
+
+    getDoubleParam(ADEVT_ChangeThreshold, &threshold);
+    getDoubleParam(ADEVT_ChangeKeepAlive, &keepAlive);
+    chrono::duration<double> sincePublish = this->frameReceiveTime - this->lastChangePublishTime;
+    // a negative change means there is no comparable frame to compare against yet
+    if(change >= 0) setDoubleParam(ADEVT_ChangeValue, change);
+    if(change < 0 || change > threshold || (keepAlive > 0 && sincePublish.count() >= keepAlive)){
+        this->changePending = true;
+        return true;
+    }
+    int numSuppressed;
+    getIntegerParam(ADEVT_ChangeSuppressed, &numSuppressed);
+    setIntegerParam(ADEVT_ChangeSuppressed, numSuppressed + 1);
+    return false;
+}
+
+
+/**
+ * Function that makes the current frame the change detector reference, called once the frame passed every
+ * publishing check, so later frames are only compared against frames that were published.
+ * 
+ * @return: void
+ */
+void ADEmergentVision::acceptChangedFrame(){
+    if(!this->changePending) return;
+    this->changeDetector.accept();
+    this->lastChangePublishTime = this->frameReceiveTime;
+    this->changePending = false;
+}
+
+
+/**
+ * Function that computes the dimensions of the NDArrays produced from frames of a given size. Software
+ * binning or bayer superpixels, and then the software crop and rotation, set the array size.
+ * Raw bayer frames are left as is to keep the pattern.
+ * 
+ * @params[in]:     colorMode       -> color mode of the frames
+ * @params[in]:     sizeX           -> width of the frames
+ * @params[in]:     sizeY           -> height of the frames
+ * @params[out]:    pNdims          -> number of array dimensions
+ * @params[out]:    dims            -> array dimensions
+ * @params[out]:    pOutColorMode   -> color mode of the arrays
+ * @return:         status          -> error if the software crop is outside of the frame
+ */
+asynStatus ADEmergentVision::getArrayDims(int colorMode, size_t sizeX, size_t sizeY, int* pNdims, size_t dims[3], int* pOutColorMode){
+    const char* functionName = "getArrayDims";
+    int outColorMode = colorMode;
+    size_t binSizeX = sizeX, binSizeY = sizeY;
+    if(isFrameBinned(colorMode)){
+        int numComponents;
+        this->frameBinning.getOutputSize(sizeX, sizeY, colorMode == NDColorModeBayer, &binSizeX, &binSizeY, &numComponents);
+        if(colorMode == NDColorModeBayer) outColorMode = (numComponents == 3) ? NDColorModeRGB1 : NDColorModeMono;
+    }
+    size_t outSizeX = binSizeX, outSizeY = binSizeY;
+    if(outColorMode != NDColorModeBayer) this->frameTransform.getOutputSize(binSizeX, binSizeY, &outSizeX, &outSizeY);
+    if(outSizeX == 0 || outSizeY == 0){
+        ERR("Software crop is outside of the frame");
+        return asynError;
+    }
+
+    if(outColorMode == NDColorModeMono || outColorMode == NDColorModeBayer){
+        *pNdims = 2;
+        dims[0] = outSizeX;
+        dims[1] = outSizeY;
+    }
+    else if(outColorMode == NDColorModeRGB2){
+        *pNdims = 3;
+        dims[0] = outSizeX;
+        dims[1] = 3;
+        dims[2] = outSizeY;
+    }
+    else if(outColorMode == NDColorModeRGB3){
+        *pNdims = 3;
+        dims[0] = outSizeX;
+        dims[1] = outSizeY;
+        dims[2] = 3;
+    }
+    else{
+        *pNdims = 3;
+        dims[0] = 3;
+        dims[1] = outSizeX;
+        dims[2] = outSizeY;
+    }
+    *pOutColorMode = outColorMode;
+    return asynSuccess;
+}
+
+
 /**
  * Function that allocates space for a new NDArray and copies the data from the captured EVT frame
  * 
@@ -805,18 +1055,9 @@ asynStatus ADEmergentVision::evtFrame2NDArray(CEmergentFrame* evtFrame, CEmergen
     else{
         xsize = evtFrame->size_x;
         ysize = evtFrame->size_y;
-        if(colorMode == NDColorModeMono) ndims = 2;
-        else ndims = 3;
 
-        if(ndims == 2){
-            dims[0] = xsize;
-            dims[1] = ysize;
-        }
-        else{
-            dims[0] = 3;
-            dims[1] = xsize;
-            dims[2] = ysize;
-        }
+        int outColorMode;
+        if(getArrayDims(colorMode, xsize, ysize, &ndims, dims, &outColorMode) != asynSuccess) return asynError;
 
         this->pArrays[0] = pNDArrayPool->alloc(ndims, dims, (NDDataType_t) dataType, 0, NULL);
         if(this->pArrays[0]!=NULL) (*pArray) = this->pArrays[0];
@@ -833,8 +1074,8 @@ asynStatus ADEmergentVision::evtFrame2NDArray(CEmergentFrame* evtFrame, CEmergen
 
         (*pArray)->getInfo(&arrayInfo);
         size_t total_size = arrayInfo.totalBytes;
-        memcpy((unsigned char*)(*pArray)->pData, targetFrame->imagePtr, total_size);
-        (*pArray)->pAttributeList->add("ColorMode", "Color Mode", NDAttrInt32, &colorMode);
+        copyFrameData(targetFrame->imagePtr, xsize, ysize, colorMode, *pArray, total_size);
+        (*pArray)->pAttributeList->add("ColorMode", "Color Mode", NDAttrInt32, &outColorMode);
         getAttributes((*pArray)->pAttributeList);
         return asynSuccess;
     }
@@ -842,168 +1083,2252 @@ asynStatus ADEmergentVision::evtFrame2NDArray(CEmergentFrame* evtFrame, CEmergen
 
 
 /**
- * Wrapper function that accepts a void pointer as an input and output, and starts
- * the main callback loop
+ * Function that passes the software crop, ADReverseX/Y and rotation PVs to the frame transform
  * 
- * @params: pPtr -> void pointer referencing the current driver object instance
- * @returns: NULL pointer
+ * @return: status
  */
-void* ADEmergentVision::evtCallbackWrapper(void* pPtr){
-    ADEmergentVision* pEVT = (ADEmergentVision*) pPtr;
-    pEVT->evtCallback();
-    return NULL;
+asynStatus ADEmergentVision::configureFrameTransform(){
+    int cropX = 0, cropY = 0, cropSizeX = 0, cropSizeY = 0, reverseX = 0, reverseY = 0, rotation = EVT_ROTATE_0;
+    getIntegerParam(ADEVT_CropX, &cropX);
+    getIntegerParam(ADEVT_CropY, &cropY);
+    getIntegerParam(ADEVT_CropSizeX, &cropSizeX);
+    getIntegerParam(ADEVT_CropSizeY, &cropSizeY);
+    getIntegerParam(ADReverseX, &reverseX);
+    getIntegerParam(ADReverseY, &reverseY);
+    getIntegerParam(ADEVT_Rotation, &rotation);
+    if(rotation < EVT_ROTATE_0 || rotation > EVT_ROTATE_270) rotation = EVT_ROTATE_0;
+    this->frameTransform.configure(cropX < 0 ? 0 : cropX, cropY < 0 ? 0 : cropY, cropSizeX < 0 ? 0 : cropSizeX,
+                                   cropSizeY < 0 ? 0 : cropSizeY, reverseX != 0, reverseY != 0, (EVTRotation) rotation);
+    return asynSuccess;
 }
 
 
 /**
- * Function that constantly loops and on each loop, it collects a frame and converts it to an NDArray and
- * pushes it to the ArrayData PV. It is called from a pthread.
+ * Function that passes the ADBinX/Y, bin mode and bayer superpixel PVs to the software binning.
+ * If the camera can bin by the requested factors it does so, otherwise the frames are binned in software.
  * 
- * @return: void*
+ * @return: status
  */
-void ADEmergentVision::evtCallback(){
-    const char* functionName = "evtCallback";
-    int imageMode;
-    CEmergentFrame evtFrame;
-    CEmergentFrame evtFrameConvert;
-    asynStatus status;
-
-    int numFramesCollected = 1;
-    int uniqueIDCounter = 0;
-    int imageCounter;
-    int xsize, ysize;
-    unsigned int evtPixelType;
-    this->imageThreadOpen = 1;
-    getIntegerParam(ADImageMode, &imageMode);
+asynStatus ADEmergentVision::configureBinning(){
+    const char* functionName = "configureBinning";
+    int binX = 1, binY = 1, mode = EVT_BIN_SUM, superpixel = EVT_SUPERPIXEL_OFF;
+    getIntegerParam(ADBinX, &binX);
+    getIntegerParam(ADBinY, &binY);
+    getIntegerParam(ADEVT_BinMode, &mode);
+    getIntegerParam(ADEVT_BayerSuperpixel, &superpixel);
+    if(binX < 1) binX = 1;
+    if(binY < 1) binY = 1;
+
+    bool cameraBinning = false;
+    unsigned int maxBinX, maxBinY;
+    if(this->connected && EVT_CameraGetUInt32ParamMax(this->pcamera, "BinningHorizontal", &maxBinX) == EVT_SUCCESS
+            && EVT_CameraGetUInt32ParamMax(this->pcamera, "BinningVertical", &maxBinY) == EVT_SUCCESS){
+        cameraBinning = ((unsigned int) binX <= maxBinX && (unsigned int) binY <= maxBinY);
+        EVT_CameraSetUInt32Param(this->pcamera, "BinningHorizontal", cameraBinning ? binX : 1);
+        EVT_CameraSetUInt32Param(this->pcamera, "BinningVertical", cameraBinning ? binY : 1);
+    }
+    if(!cameraBinning && (binX > EVT_BIN_MAX || binY > EVT_BIN_MAX)){
+        ERR_ARGS("Software binning is limited to %d", EVT_BIN_MAX);
+        updateStatus("Bin factor too large");
+    }
+    this->frameBinning.configure(cameraBinning ? 1 : binX, cameraBinning ? 1 : binY, (EVTBinMode) mode, (EVTSuperpixelMode) superpixel);
+    setIntegerParam(ADEVT_BinSoftware, !cameraBinning && (binX > 1 || binY > 1));
+    return asynSuccess;
+}
 
 
-    while(this->imageCollectionThreadActive == 1){
-        NDArray* pArray;
-        NDArrayInfo arrayInfo;
-        // One frame for current image, one for conversion if necessary
+/**
+ * Function that checks if frames of a color mode are reduced by the software binning. Mono frames are
+ * binned, and raw bayer frames are reduced to superpixels.
+ * 
+ * @params[in]: colorMode   -> color mode of the camera frames
+ * @return: true if frames are binned
+ */
+bool ADEmergentVision::isFrameBinned(int colorMode){
+    if(colorMode == NDColorModeMono) return this->frameBinning.isActive(false);
+    if(colorMode == NDColorModeBayer) return this->frameBinning.isActive(true);
+    return false;
+}
 
-        getIntegerParam(ADNumImagesCounter, &uniqueIDCounter);
-        getIntegerParam(ADSizeX, &xsize);
-        getIntegerParam(ADSizeY, &ysize);
-        
-        asynStatus current = getFrameFormatEVT(&evtPixelType);
 
-        if(current == asynError){
-            ERR("Error finding evt frame format");
+/**
+ * Function that copies the image data of a frame into an NDArray. If defect correction is enabled,
+ * defective pixels are replaced by their neighbours as part of the copy. References are always
+ * captured from uncorrected frames. Software binning, and then the software crop, flip and rotation,
+ * are applied during the copy, and defects are then corrected in place in the output geometry.
+ * RGB frames are split into planes during the copy when a planar color mode is selected.
+ * 
+ * @params[in]:     pSrc        -> image data of the frame
+ * @params[in]:     sizeX       -> width of the frame
+ * @params[in]:     sizeY       -> height of the frame
+ * @params[in]:     colorMode   -> color mode of the frame
+ * @params[out]:    pArray      -> allocated NDArray to copy into
+ * @params[in]:     totalBytes  -> size of the image data
+ * @return:         void
+ */
+void ADEmergentVision::copyFrameData(const void* pSrc, size_t sizeX, size_t sizeY, int colorMode, NDArray* pArray, size_t totalBytes){
+    int enable;
+    getIntegerParam(ADEVT_DefectEnable, &enable);
+    bool correct = enable && pArray->ndims == 2 && !this->flatFieldCorrector.isCapturing();
+    bool is8Bit = (pArray->dataType == NDUInt8 || pArray->dataType == NDInt8);
+    bool is16Bit = (pArray->dataType == NDUInt16 || pArray->dataType == NDInt16);
+    bool bayer = (colorMode == NDColorModeBayer);
+    bool planar = (colorMode == NDColorModeRGB2 || colorMode == NDColorModeRGB3);
+    int numComponents = pArray->ndims == 2 ? 1 : 3;
+    size_t outSizeX = pArray->dims[pArray->ndims == 2 || planar ? 0 : 1].size;
+    size_t outSizeY = pArray->dims[pArray->ndims == 2 ? 1 : (colorMode == NDColorModeRGB3 ? 1 : 2)].size;
+
+    bool binned = (is8Bit || is16Bit) && isFrameBinned(colorMode);
+    size_t binSizeX = sizeX, binSizeY = sizeY;
+    if(binned){
+        int binComponents;
+        this->frameBinning.getOutputSize(sizeX, sizeY, bayer, &binSizeX, &binSizeY, &binComponents);
+    }
+    bool transform = (is8Bit || is16Bit) && (binned || !bayer) && !this->frameTransform.isIdentity(binSizeX, binSizeY);
+    // unbinned Bayer frames stay mosaics, and are corrected from neighbours of the same color
+    bool mosaic = bayer && !binned;
+
+    if(planar && (is8Bit || is16Bit)){
+        // interleaved frames are split into planes while copying, after the transform if there is one
+        const void* pData = pSrc;
+        if(transform){
+            this->binnedFrame.resize(outSizeX * outSizeY * numComponents);
+            if(is8Bit) this->frameTransform.apply((const uint8_t*) pSrc, (uint8_t*) &this->binnedFrame[0], sizeX, sizeY, numComponents);
+            else this->frameTransform.apply((const uint16_t*) pSrc, &this->binnedFrame[0], sizeX, sizeY, numComponents);
+            pData = &this->binnedFrame[0];
         }
-        else{
-
-            // variables storing if buffer allocation was successful, and whether evt cam ops were.
-            EVT_ERROR alloc = EVT_SUCCESS;
-            EVT_ERROR err = EVT_SUCCESS;
-
-            // set sizes and pixel formats here
-            evtFrame.size_x = xsize;
-            evtFrame.size_y = ysize;
-            evtFrame.pixel_type = (PIXEL_FORMAT) evtPixelType;
-
-            evtFrameConvert.size_x = xsize;
-            evtFrameConvert.size_y = ysize;
-            evtFrameConvert.pixel_type = (PIXEL_FORMAT) evtPixelType;
-            evtFrameConvert.convertColor = EVT_COLOR_CONVERT_NONE;
-            evtFrameConvert.convertBitDepth = getConvertBitDepth((PIXEL_FORMAT) evtPixelType);
+        EVTPlanarLayout layout = (colorMode == NDColorModeRGB2) ? EVT_PLANAR_ROWS : EVT_PLANAR_PLANES;
+        if(is8Bit) EVTPlanarRgb::convert((const uint8_t*) pData, (uint8_t*) pArray->pData, outSizeX, outSizeY, layout);
+        else EVTPlanarRgb::convert((const uint16_t*) pData, (uint16_t*) pArray->pData, outSizeX, outSizeY, layout);
+        return;
+    }
+    if(binned || transform){
+        const void* pData = pSrc;
+        if(binned){
+            // binned frames are staged in a scratch buffer if they are transformed afterwards
+            void* pBinned = pArray->pData;
+            if(transform){
+                this->binnedFrame.resize(binSizeX * binSizeY * numComponents);
+                pBinned = &this->binnedFrame[0];
+            }
+            if(is8Bit) this->frameBinning.apply((const uint8_t*) pSrc, (uint8_t*) pBinned, sizeX, sizeY, bayer);
+            else this->frameBinning.apply((const uint16_t*) pSrc, (uint16_t*) pBinned, sizeX, sizeY, bayer);
+            pData = pBinned;
+        }
+        if(transform){
+            if(is8Bit) this->frameTransform.apply((const uint8_t*) pData, (uint8_t*) pArray->pData, binSizeX, binSizeY, numComponents);
+            else this->frameTransform.apply((const uint16_t*) pData, (uint16_t*) pArray->pData, binSizeX, binSizeY, numComponents);
+        }
+        if(correct && this->defectMap.isReady(outSizeX, outSizeY, mosaic)){
+            if(is8Bit) this->defectMap.correct((uint8_t*) pArray->pData);
+            else this->defectMap.correct((uint16_t*) pArray->pData);
+        }
+        return;
+    }
+    if(correct && this->defectMap.isReady(sizeX, sizeY, mosaic)){
+        if(is8Bit){
+            this->defectMap.copy((const uint8_t*) pSrc, (uint8_t*) pArray->pData);
+            return;
+        }
+        else if(is16Bit){
+            this->defectMap.copy((const uint16_t*) pSrc, (uint16_t*) pArray->pData);
+            return;
+        }
+    }
+    setIntegerParam(ADEVT_CopyStreaming, this->frameCopy.copy(pArray->pData, pSrc, totalBytes) ? 1 : 0);
+}
 
-            // allocate the framer buffers for our frame and conversion frame
-            alloc = EVT_AllocateFrameBuffer(this->pcamera, &evtFrame, EVT_FRAME_BUFFER_ZERO_COPY);
-            if (alloc == EVT_SUCCESS) alloc = EVT_AllocateFrameBuffer(this->pcamera, &evtFrameConvert, EVT_FRAME_BUFFER_DEFAULT);
-            
-            if(alloc != EVT_SUCCESS) reportEVTError(alloc, "EVT_AllocateFrameBuffer");
-            else {
 
-                LOG("Queue camera frame");
-                if (alloc == EVT_SUCCESS) err = EVT_CameraQueueFrame(this->pcamera, &evtFrame);
-                if (err != EVT_SUCCESS) reportEVTError(err, "EVT_CameraQueueFrame");
+/**
+ * Function that passes the copy mode and threshold PVs to the frame copy. A threshold of 0 selects
+ * half of the last level cache, and the threshold in use is shown in the readback.
+ * 
+ * @return: status
+ */
+asynStatus ADEmergentVision::configureFrameCopy(){
+    int mode = EVT_COPY_AUTO, thresholdKB = 0;
+    getIntegerParam(ADEVT_CopyMode, &mode);
+    getIntegerParam(ADEVT_CopyThreshold, &thresholdKB);
+    if(mode < EVT_COPY_AUTO || mode > EVT_COPY_STREAMING) mode = EVT_COPY_AUTO;
+    this->frameCopy.configure((EVTCopyMode) mode, thresholdKB > 0 ? (size_t) thresholdKB * 1024 : 0);
+    setIntegerParam(ADEVT_CopyActiveThreshold, (int) (this->frameCopy.getThreshold() / 1024));
+    return asynSuccess;
+}
 
-                //asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW, "%s::%s Triggering w/ software\n", driverName, functionName);
-                //if (err == EVT_SUCCESS) err = EVT_CameraExecuteCommand(this->pcamera, "TriggerSoftware");
-                //if (err != EVT_SUCCESS) reportEVTError(err, "EVT_CameraExecuteCommand - TriggerSoftware");
 
-                LOG("Grabbing frame");
-                if (err == EVT_SUCCESS) err = EVT_CameraGetFrame(this->pcamera, &evtFrame, EVT_INFINITE);
-                if (err != EVT_SUCCESS) reportEVTError(err, "EVT_CameraGetFrame");
+/**
+ * Function that times memcpy against the streaming copy on buffers of the current frame size, or of
+ * the full sensor if no frame has been acquired yet. It takes a few hundred ms, and is refused
+ * during acquisition so it does not compete with the image thread for memory bandwidth.
+ * 
+ * @return: status
+ */
+asynStatus ADEmergentVision::benchmarkFrameCopy(){
+    const char* functionName = "benchmarkFrameCopy";
+    int acquiring, arraySize = 0, maxSizeX = 0, maxSizeY = 0;
+    getIntegerParam(ADAcquire, &acquiring);
+    if(acquiring){
+        ERR("Can not benchmark the frame copy during acquisition");
+        return asynError;
+    }
+    getIntegerParam(NDArraySize, &arraySize);
+    getIntegerParam(ADMaxSizeX, &maxSizeX);
+    getIntegerParam(ADMaxSizeY, &maxSizeY);
+    size_t numBytes = arraySize > 0 ? (size_t) arraySize : (size_t) maxSizeX * maxSizeY;
+    if(numBytes == 0){
+        ERR("Frame size is not known");
+        return asynError;
+    }
+    double memcpyRate, streamRate;
+    EVTFrameCopy::benchmark(numBytes, &memcpyRate, &streamRate);
+    setDoubleParam(ADEVT_CopyMemcpyRate, memcpyRate);
+    setDoubleParam(ADEVT_CopyStreamRate, streamRate);
+    return asynSuccess;
+}
 
 
-                // Only process the frame if we successfully finished all of the above commands.
-                if (err == EVT_SUCCESS) {
-                    // Convert to an ND Array
-                    status = evtFrame2NDArray(&evtFrame, &evtFrameConvert, &pArray);
-                    if (status == asynSuccess) {
-                        //printf("Converted to NDArray\n");
-                        pArray->uniqueId = uniqueIDCounter;
-                        updateTimeStamp(&pArray->epicsTS);
-                        doCallbacksGenericPointer(pArray, NDArrayData, 0);
-                        pArray->getInfo(&arrayInfo);
-                        size_t total_size = arrayInfo.totalBytes;
-                        setIntegerParam(NDArraySize, (int)total_size);
-                        setIntegerParam(NDArraySizeX, arrayInfo.xSize);
-                        setIntegerParam(NDArraySizeY, arrayInfo.ySize);
+// -----------------------------------------------------------------------
+// ADEmergentVision Frame Processing Functions
+// -----------------------------------------------------------------------
 
-                        pArray->release();
-                    }
 
-                    // Update the image counter
-                    getIntegerParam(NDArrayCounter, &imageCounter);
-                    imageCounter++;
-                    setIntegerParam(NDArrayCounter, imageCounter);
-                    callParamCallbacks();
+/**
+ * Function that computes background subtracted, thresholded centroid, sigma and integrated
+ * intensity of the current frame, and writes them to the beam statistics PVs.
+ * Only mono (and raw bayer) 8 and 16 bit images are supported.
+ * Called from the image thread with the driver lock held, which is released while the statistics are computed.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @return:     void
+ */
+void ADEmergentVision::computeBeamStats(NDArray* pArray){
+    int enable, background, threshold;
+    getIntegerParam(ADEVT_BeamEnable, &enable);
+    bool is8Bit = (pArray->dataType == NDUInt8 || pArray->dataType == NDInt8);
+    bool is16Bit = (pArray->dataType == NDUInt16 || pArray->dataType == NDInt16);
+    if(!enable || pArray->ndims != 2 || (!is8Bit && !is16Bit)) return;
+
+    getIntegerParam(ADEVT_BeamBackground, &background);
+    getIntegerParam(ADEVT_BeamThreshold, &threshold);
+    this->beamStatsKernel.configure(background < 0 ? 0 : background, threshold < 0 ? 0 : threshold);
+
+    EVTBeamStats& stats = this->frameMetrics.beamStats;
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+    this->unlock();
+    if(is8Bit) this->beamStatsKernel.compute((const uint8_t*) pArray->pData, sizeX, sizeY, &stats);
+    else this->beamStatsKernel.compute((const uint16_t*) pArray->pData, sizeX, sizeY, &stats);
+    this->lock();
 
-                    if (status == asynError) {
-                        this->imageThreadOpen = 0;
-                        ERR("Error converting to NDArray");
-                        acquireStop();
-                        break;
-                    }
-                    if (imageMode == ADImageSingle) {
-                        this->imageThreadOpen = 0;
-                        acquireStop();
-                    }
-                    else if (imageMode == ADImageMultiple) {
-                        int numImages;
-                        getIntegerParam(ADNumImages, &numImages);
+    setDoubleParam(ADEVT_BeamCentroidX, stats.centroidX);
+    setDoubleParam(ADEVT_BeamCentroidY, stats.centroidY);
+    setDoubleParam(ADEVT_BeamSigmaX, stats.sigmaX);
+    setDoubleParam(ADEVT_BeamSigmaY, stats.sigmaY);
+    setDoubleParam(ADEVT_BeamIntensity, stats.intensity);
+    setIntegerParam(ADEVT_BeamNumPixels, (int) stats.numPixels);
+}
 
-                        if (numFramesCollected == numImages) {
-                            this->imageThreadOpen = 0;
-                            acquireStop();
-                        }
-                    }
-                }
-                else{
-                    reportEVTError(err, functionName);
-                }
 
-                //If frame buffer allocation was successful, we need to deallocate the frame buffer regardless
-                //of the status of later operations
-                err = EVT_ReleaseFrameBuffer(this->pcamera, &evtFrame);
-                if (err != EVT_SUCCESS) reportEVTError(err, "EVT_ReleaseFrameBuffer");
-                err = EVT_ReleaseFrameBuffer(this->pcamera, &evtFrameConvert);
-                if (err != EVT_SUCCESS) reportEVTError(err, "EVT_ReleaseFrameBuffer");
-            }
-        }
-        // count the number of frames in the current acquisition
-        numFramesCollected++;
+/**
+ * Function that parses the ROI definition waveform into a list of ROIs.
+ * The waveform holds groups of four values (x, y, sizeX, sizeY), one group per ROI.
+ * The new list is picked up by the image thread when the next frame is processed.
+ * 
+ * @params[in]: value       -> ROI definition values
+ * @params[in]: nElements   -> number of values, truncated to a multiple of four
+ * @return:     status
+ */
+asynStatus ADEmergentVision::setRoiDefinitions(epicsInt32* value, size_t nElements){
+    const char* functionName = "setRoiDefinitions";
+    size_t numRois = nElements / 4;
+    if(numRois > EVT_MAX_ROIS){
+        ERR_ARGS("Only the first %d ROIs will be used", EVT_MAX_ROIS);
+        numRois = EVT_MAX_ROIS;
     }
-    this->imageThreadOpen = 0;
-}
 
+    this->pendingRois.resize(numRois);
+    for(size_t i = 0; i < numRois; i++){
+        EVTRoi& roi = this->pendingRois[i];
+        roi.x       = value[4 * i]     > 0 ? value[4 * i]     : 0;
+        roi.y       = value[4 * i + 1] > 0 ? value[4 * i + 1] : 0;
+        roi.sizeX   = value[4 * i + 2] > 0 ? value[4 * i + 2] : 0;
+        roi.sizeY   = value[4 * i + 3] > 0 ? value[4 * i + 3] : 0;
+    }
+    this->roisPending = 1;
 
-// -----------------------------------------------------------------------
-// ADEmergentVision Camera Functions (Exposure, Format, Gain etc.)
-// -----------------------------------------------------------------------
+    this->numRoiDefinitions = 4 * numRois;
+    memcpy(this->roiDefinitions, value, this->numRoiDefinitions * sizeof(epicsInt32));
+    doCallbacksInt32Array(this->roiDefinitions, this->numRoiDefinitions, ADEVT_RoiDefinitions, 0);
+    setIntegerParam(ADEVT_RoiNum, (int) numRois);
+    return asynSuccess;
+}
 
 
 /**
- * Function that checks whether new value for camera parameter is valid
+ * Function that computes sum, mean, max and centroid for all configured ROIs in a single pass
+ * over the current frame, and publishes one waveform per statistic, with one element per ROI.
+ * Called from the image thread with the driver lock held, which is released while the statistics are computed.
  * 
- * @params: newVal -> New integer parameter value
- * @params: param -> Name of parameter
- * @returns: valid -> true if new value is OK, false otherwise
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @return:     void
  */
-bool ADEmergentVision::isEVTInt32ParamValid(unsigned int newVal, const char* param){
+void ADEmergentVision::computeRoiStats(NDArray* pArray){
+    int enable;
+    getIntegerParam(ADEVT_RoiEnable, &enable);
+    bool is8Bit = (pArray->dataType == NDUInt8 || pArray->dataType == NDInt8);
+    bool is16Bit = (pArray->dataType == NDUInt16 || pArray->dataType == NDInt16);
+    if(!enable || pArray->ndims != 2 || (!is8Bit && !is16Bit)) return;
+
+    if(this->roisPending){
+        this->roiStatsEngine.setRois(this->pendingRois);
+        this->roisPending = 0;
+    }
+    if(this->roiStatsEngine.getNumRois() == 0) return;
+
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+    this->unlock();
+    if(is8Bit) this->roiStatsEngine.compute((const uint8_t*) pArray->pData, sizeX, sizeY, this->roiStats);
+    else this->roiStatsEngine.compute((const uint16_t*) pArray->pData, sizeX, sizeY, this->roiStats);
+    this->lock();
+
+    const int statParams[] = {ADEVT_RoiSum, ADEVT_RoiMean, ADEVT_RoiMax, ADEVT_RoiCentroidX, ADEVT_RoiCentroidY};
+    double EVTRoiStats::* const statFields[] = {&EVTRoiStats::sum, &EVTRoiStats::mean, &EVTRoiStats::max,
+                                                &EVTRoiStats::centroidX, &EVTRoiStats::centroidY};
+    this->frameMetrics.roiStats = this->roiStats;
+    size_t numRois = this->roiStats.size();
+    this->roiWaveform.resize(numRois);
+    for(int stat = 0; stat < 5; stat++){
+        for(size_t i = 0; i < numRois; i++) this->roiWaveform[i] = this->roiStats[i].*statFields[stat];
+        doCallbacksFloat64Array(&this->roiWaveform[0], numRois, statParams[stat], 0);
+    }
+}
+
+
+/**
+ * Function that computes the focus metric of the focus ROI of the current frame. The value is published
+ * with the timestamp of the frame, so focus scans do not need the frames themselves.
+ * Called from the image thread with the driver lock held, which is released while the metric is computed.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @return:     void
+ */
+void ADEmergentVision::computeFocus(NDArray* pArray){
+    int enable, method, x, y, roiSizeX, roiSizeY;
+    getIntegerParam(ADEVT_FocusEnable, &enable);
+    bool is8Bit = (pArray->dataType == NDUInt8 || pArray->dataType == NDInt8);
+    bool is16Bit = (pArray->dataType == NDUInt16 || pArray->dataType == NDInt16);
+    if(!enable || pArray->ndims != 2 || (!is8Bit && !is16Bit)) return;
+
+    getIntegerParam(ADEVT_FocusMethod, &method);
+    getIntegerParam(ADEVT_FocusRoiX, &x);
+    getIntegerParam(ADEVT_FocusRoiY, &y);
+    getIntegerParam(ADEVT_FocusRoiSizeX, &roiSizeX);
+    getIntegerParam(ADEVT_FocusRoiSizeY, &roiSizeY);
+    EVTRoi roi;
+    roi.x       = x > 0 ? x : 0;
+    roi.y       = y > 0 ? y : 0;
+    roi.sizeX   = roiSizeX > 0 ? roiSizeX : 0;
+    roi.sizeY   = roiSizeY > 0 ? roiSizeY : 0;
+
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+    double focus;
+    this->unlock();
+    if(is8Bit) focus = EVTFocusMetric::compute((const uint8_t*) pArray->pData, sizeX, sizeY, roi, (EVTFocusMethod) method);
+    else focus = EVTFocusMetric::compute((const uint16_t*) pArray->pData, sizeX, sizeY, roi, (EVTFocusMethod) method);
+    this->lock();
+
+    this->frameMetrics.focus = focus;
+    setDoubleParam(ADEVT_FocusValue, focus);
+}
+
+
+/**
+ * Function that starts or stops the drift estimator to match the enable and thread count PVs. The
+ * frames are processed on the shared executor, and the thread count sets how many frames of this
+ * camera may be processed in parallel.
+ * 
+ * @return: status
+ */
+asynStatus ADEmergentVision::configureDriftEstimator(){
+    int enable, numThreads;
+    getIntegerParam(ADEVT_DriftEnable, &enable);
+    getIntegerParam(ADEVT_DriftThreads, &numThreads);
+
+    // the tasks publish results under the driver lock, so it can't be held while waiting for them
+    this->unlock();
+    if(enable) this->driftEstimator.start(this->executorClient, numThreads);
+    else this->driftEstimator.stop();
+    this->lock();
+    this->framesSinceDrift = 0;
+    return asynSuccess;
+}
+
+
+/**
+ * Function that passes the current frame, or every Nth frame, to the drift estimator.
+ * The ROI is cropped here, and the shift is computed by the estimator worker threads.
+ * Called from the image thread with the driver lock held, which is released while the frame is submitted.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @return:     void
+ */
+void ADEmergentVision::computeDrift(NDArray* pArray){
+    int enable, decimation;
+    getIntegerParam(ADEVT_DriftEnable, &enable);
+    if(!enable || pArray->ndims != 2 || !this->driftEstimator.isRunning()) return;
+
+    getIntegerParam(ADEVT_DriftDecimation, &decimation);
+    this->framesSinceDrift++;
+    if(decimation > 1 && this->framesSinceDrift < decimation) return;
+    this->framesSinceDrift = 0;
+
+    int roiX, roiY, roiSizeX, roiSizeY;
+    getIntegerParam(ADEVT_DriftRoiX, &roiX);
+    getIntegerParam(ADEVT_DriftRoiY, &roiY);
+    getIntegerParam(ADEVT_DriftRoiSizeX, &roiSizeX);
+    getIntegerParam(ADEVT_DriftRoiSizeY, &roiSizeY);
+    EVTRoi roi;
+    roi.x = roiX > 0 ? roiX : 0;
+    roi.y = roiY > 0 ? roiY : 0;
+    roi.sizeX = roiSizeX > 0 ? roiSizeX : 0;
+    roi.sizeY = roiSizeY > 0 ? roiSizeY : 0;
+
+    // cropping the ROI, and the FFT of a new reference, are done without the driver lock
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+    this->unlock();
+    if(pArray->dataType == NDUInt8 || pArray->dataType == NDInt8)
+        this->driftEstimator.submit((const uint8_t*) pArray->pData, sizeX, sizeY, roi, pArray->uniqueId, pArray->epicsTS);
+    else if(pArray->dataType == NDUInt16 || pArray->dataType == NDInt16)
+        this->driftEstimator.submit((const uint16_t*) pArray->pData, sizeX, sizeY, roi, pArray->uniqueId, pArray->epicsTS);
+    this->lock();
+    setIntegerParam(ADEVT_DriftDropped, (int) this->driftEstimator.getNumDropped());
+    publishExecutorStats();
+}
+
+
+/**
+ * Function that opens, replaces or closes the shared memory frame ring to match the shared memory PVs.
+ * Slots are sized for the current geometry, or for the given frame if it is larger. Replacing the ring
+ * marks the old one closed, and readers map the new ring by name.
+ * 
+ * @params[in]: frameBytes  -> size of a frame that must fit in a slot, 0 for the current geometry only
+ * @return: status          -> error if the ring could not be created
+ */
+asynStatus ADEmergentVision::configureSharedRing(size_t frameBytes){
+    const char* functionName = "configureSharedRing";
+    int enable = 0, numSlots = 8, sizeX = 0, sizeY = 0, dataType = NDUInt8, colorMode = NDColorModeMono;
+    char name[256] = "";
+    getIntegerParam(ADEVT_ShmEnable, &enable);
+    getIntegerParam(ADEVT_ShmSlots, &numSlots);
+    getStringParam(ADEVT_ShmName, sizeof(name), name);
+    if(!enable){
+        this->sharedRing.close();
+        return asynSuccess;
+    }
+    if(strlen(name) == 0) strncpy(name, this->portName, sizeof(name) - 1);
+
+    // 8 bytes per element covers the floating point outputs of the processing stages
+    getIntegerParam(ADSizeX, &sizeX);
+    getIntegerParam(ADSizeY, &sizeY);
+    getIntegerParam(NDDataType, &dataType);
+    getIntegerParam(NDColorMode, &colorMode);
+    size_t bytesPerElement = (dataType == NDUInt8 || dataType == NDInt8) ? 1 : (dataType == NDUInt16 || dataType == NDInt16) ? 2 : 8;
+    size_t geometryBytes = (size_t) (sizeX > 0 ? sizeX : 1) * (sizeY > 0 ? sizeY : 1) *
+                           (colorMode == NDColorModeMono ? 1 : 3) * bytesPerElement;
+    if(frameBytes < geometryBytes) frameBytes = geometryBytes;
+
+    string error;
+    if(!this->sharedRing.open(name, numSlots, frameBytes, error)){
+        ERR_ARGS("Failed to create shared memory frame ring: %s", error.c_str());
+        updateStatus("Shared memory error");
+        return asynError;
+    }
+    LOG_ARGS("Publishing frames to shared memory %s, %d slots of %lu bytes", name, numSlots,
+             (unsigned long) this->sharedRing.getMaxFrameBytes());
+    return asynSuccess;
+}
+
+
+/**
+ * Function that copies the current frame into the shared memory ring, reopening the ring with larger slots
+ * if the frame does not fit. Every processed frame is written, whether or not it is passed to plugins.
+ * Called from the image thread with the driver lock held.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @params[in]: frame   -> camera frame the NDArray was copied from
+ * @return:     void
+ */
+void ADEmergentVision::publishSharedFrame(NDArray* pArray, CEmergentFrame* frame){
+    if(!this->sharedRing.isOpen()) return;
+    NDArrayInfo info;
+    pArray->getInfo(&info);
+    if(info.totalBytes > this->sharedRing.getMaxFrameBytes() && configureSharedRing(info.totalBytes) != asynSuccess) return;
+
+    size_t dims[EVT_SHM_MAX_DIMS];
+    int ndims = pArray->ndims < EVT_SHM_MAX_DIMS ? pArray->ndims : EVT_SHM_MAX_DIMS;
+    for(int i = 0; i < ndims; i++) dims[i] = pArray->dims[i].size;
+    this->sharedRing.write(pArray->uniqueId, pArray->dataType, info.colorMode, ndims, dims, pArray->pData,
+                           info.totalBytes, getCameraTimeNs(frame), pArray->epicsTS, this->frameCopy);
+
+    EVTShmStats stats;
+    this->sharedRing.getStats(&stats);
+    setIntegerParam(ADEVT_ShmSequence, (int) stats.sequence);
+    setIntegerParam(ADEVT_ShmConsumers, stats.numConsumers);
+    setIntegerParam(ADEVT_ShmMaxLag, (int) stats.maxLag);
+    setIntegerParam(ADEVT_ShmOverwrites, (int) stats.numOverwritten);
+}
+
+
+/**
+ * Function that starts, restarts or stops the TCP raw frame stream server to match the stream PVs.
+ * Restarting disconnects the current subscribers.
+ * 
+ * @return: status  -> error if the server could not listen on the port
+ */
+asynStatus ADEmergentVision::configureStreamServer(){
+    const char* functionName = "configureStreamServer";
+    int enable, port, queueDepth, zeroCopy;
+    getIntegerParam(ADEVT_StreamEnable, &enable);
+    getIntegerParam(ADEVT_StreamPort, &port);
+    getIntegerParam(ADEVT_StreamQueue, &queueDepth);
+    getIntegerParam(ADEVT_StreamZeroCopy, &zeroCopy);
+
+    if(!enable){
+        this->streamServer.stop();
+        return asynSuccess;
+    }
+    string error;
+    if(!this->streamServer.start(port, queueDepth, zeroCopy != 0, error)){
+        ERR_ARGS("Failed to start frame stream server: %s", error.c_str());
+        updateStatus("Stream server error");
+        return asynError;
+    }
+    LOG_ARGS("Streaming frames on TCP port %d", port);
+    return asynSuccess;
+}
+
+
+/**
+ * Function that queues the current frame for the stream subscribers. The NDArray is sent as is, and held
+ * until every send has completed. Called from the image thread with the driver lock held, which is released
+ * while the frame is queued, so the driver lock is never held waiting on the subscriber list.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @params[in]: frame   -> camera frame the NDArray was copied from
+ * @return:     void
+ */
+void ADEmergentVision::publishStreamFrame(NDArray* pArray, CEmergentFrame* frame){
+    if(!this->streamServer.isRunning()) return;
+    uint64_t cameraTimeStamp = getCameraTimeNs(frame);
+    this->unlock();
+    this->streamServer.publish(pArray, cameraTimeStamp);
+    this->lock();
+
+    EVTStreamStats stats;
+    this->streamServer.getStats(&stats);
+    setIntegerParam(ADEVT_StreamClients, stats.numClients);
+    setIntegerParam(ADEVT_StreamSent, (int) stats.numSent);
+    setIntegerParam(ADEVT_StreamDropped, (int) stats.numDropped);
+    setIntegerParam(ADEVT_StreamCopied, (int) stats.numCopied);
+    setIntegerParam(ADEVT_StreamErrors, (int) stats.numErrors);
+}
+
+
+/**
+ * Function that registers an in-process frame consumer. From the next frame on the callback is called with
+ * a read only view of each frame on the image thread, after the frame is processed and before it is passed
+ * to the plugins. The view is only valid during the call. Callbacks must not call back into the driver.
+ * 
+ * @params[in]: name        -> name of the consumer, shown in the report
+ * @params[in]: callback    -> function called with each frame
+ * @params[in]: pUser       -> passed to the callback
+ * @params[in]: budget      -> time the consumer may take for each frame, in microseconds
+ * @return: id of the consumer, passed to unregisterFrameConsumer, or -1 if the callback is NULL
+ */
+int ADEmergentVision::registerFrameConsumer(const char* name, EVTFrameConsumerCallback callback, void* pUser, double budget){
+    const char* functionName = "registerFrameConsumer";
+    this->lock();
+    int consumerId = this->frameConsumers.add(name, callback, pUser, budget);
+    setIntegerParam(ADEVT_ConsumerCount, this->frameConsumers.getNumConsumers());
+    callParamCallbacks();
+    this->unlock();
+    if(consumerId < 0){
+        ERR_ARGS("Frame consumer %s has no callback", name != NULL ? name : "");
+        return consumerId;
+    }
+    LOG_ARGS("Registered frame consumer %d %s with a %.1f us budget", consumerId, name, budget);
+    return consumerId;
+}
+
+
+/**
+ * Function that unregisters an in-process frame consumer. The driver lock is held while consumers are called,
+ * so the callback is not running and is not called again once this returns.
+ * 
+ * @params[in]: consumerId  -> id returned by registerFrameConsumer
+ * @return: void
+ */
+void ADEmergentVision::unregisterFrameConsumer(int consumerId){
+    const char* functionName = "unregisterFrameConsumer";
+    this->lock();
+    bool removed = this->frameConsumers.remove(consumerId);
+    setIntegerParam(ADEVT_ConsumerCount, this->frameConsumers.getNumConsumers());
+    setIntegerParam(ADEVT_ConsumerSuspended, this->frameConsumers.getNumSuspended());
+    callParamCallbacks();
+    this->unlock();
+    if(!removed) ERR_ARGS("No frame consumer with id %d", consumerId);
+}
+
+
+void ADEmergentVision::reportFrameConsumers(FILE* fp){
+    this->lock();
+    this->frameConsumers.report(fp);
+    this->unlock();
+}
+
+
+/**
+ * Function that finds the driver created on a port by ADEmergentVisionConfig
+ * 
+ * @params[in]: portName    -> asyn port name of the driver
+ * @return: the driver, or NULL if there is no ADEmergentVision driver on the port
+ */
+ADEmergentVision* ADEmergentVision::findDriver(const char* portName){
+    lock_guard<mutex> guard(evtDriversMutex);
+    map<string, ADEmergentVision*>::iterator it = evtDrivers.find(portName);
+    if(it == evtDrivers.end()) return NULL;
+    return it->second;
+}
+
+
+/**
+ * Function that passes the current frame to the in-process frame consumers and publishes the time they took.
+ * Called from the image thread with the driver lock held, before the frame is passed to the plugins.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @params[in]: frame   -> camera frame the NDArray was copied from
+ * @return:     void
+ */
+void ADEmergentVision::dispatchFrameConsumers(NDArray* pArray, CEmergentFrame* frame){
+    if(this->frameConsumers.getNumConsumers() == 0) return;
+    double budget;
+    getDoubleParam(ADEVT_ConsumerBudget, &budget);
+
+    EVTFrameView view;
+    view.pArray = pArray;
+    view.pData = pArray->pData;
+    pArray->getInfo(&view.info);
+    view.cameraTimeStamp = getCameraTimeNs(frame);
+    EVTDispatchStats stats;
+    this->frameConsumers.dispatch(view, budget, &stats);
+
+    if(stats.time > this->consumerTimeMax) this->consumerTimeMax = stats.time;
+    this->consumerOverruns += stats.numOverruns;
+    this->consumerSkipped += stats.numSkipped;
+    setDoubleParam(ADEVT_ConsumerTime, stats.time);
+    setDoubleParam(ADEVT_ConsumerTimeMax, this->consumerTimeMax);
+    setIntegerParam(ADEVT_ConsumerOverruns, this->consumerOverruns);
+    setIntegerParam(ADEVT_ConsumerSkipped, this->consumerSkipped);
+    setIntegerParam(ADEVT_ConsumerCount, this->frameConsumers.getNumConsumers());
+    setIntegerParam(ADEVT_ConsumerSuspended, this->frameConsumers.getNumSuspended());
+}
+
+
+/**
+ * Function that resumes the suspended frame consumers and resets the consumer counters
+ * 
+ * @return: void
+ */
+void ADEmergentVision::resumeFrameConsumers(){
+    this->frameConsumers.resume();
+    this->consumerTimeMax = 0;
+    this->consumerOverruns = 0;
+    this->consumerSkipped = 0;
+    setDoubleParam(ADEVT_ConsumerTimeMax, 0);
+    setIntegerParam(ADEVT_ConsumerOverruns, 0);
+    setIntegerParam(ADEVT_ConsumerSkipped, 0);
+    setIntegerParam(ADEVT_ConsumerSuspended, 0);
+}
+
+
+/**
+ * Function that joins, leaves or reconfigures the frame synchronizer group to match the sync PVs.
+ * The match, tolerance and timeout apply to the whole group, so the last camera to write them sets them.
+ * 
+ * @return: status
+ */
+asynStatus ADEmergentVision::configureFrameSync(){
+    const char* functionName = "configureFrameSync";
+    char group[256] = "";
+    int match = EVT_SYNC_TRIGGER_ID, output = EVT_SYNC_OUTPUT_NONE;
+    double toleranceUs = 0, timeout = 1.0;
+    getStringParam(ADEVT_SyncGroup, sizeof(group), group);
+    getIntegerParam(ADEVT_SyncMatch, &match);
+    getDoubleParam(ADEVT_SyncTolerance, &toleranceUs);
+    getDoubleParam(ADEVT_SyncTimeout, &timeout);
+    getIntegerParam(ADEVT_SyncOutput, &output);
+    this->syncOutput = output;
+
+    // callbacks from other cameras do not take the driver lock, so it can be held while leaving
+    if(this->frameSync != NULL && strcmp(this->frameSync->getName(), group) != 0){
+        this->frameSync->leave(this->syncMember);
+        this->frameSync = NULL;
+        this->syncMember = -1;
+        setIntegerParam(ADEVT_SyncMembers, 0);
+    }
+    if(this->frameSync == NULL && strlen(group) > 0){
+        this->frameSync = EVTFrameSync::getGroup(group);
+        this->syncMember = this->frameSync->join(syncSetCallback, this);
+        LOG_ARGS("Joined frame sync group %s as member %d", group, this->syncMember);
+    }
+    if(this->frameSync != NULL){
+        this->frameSync->configure((EVTSyncMatch) match, toleranceUs * 1e-6, timeout);
+        this->frameSync->setPublishing(this->syncMember, output != EVT_SYNC_OUTPUT_NONE);
+        EVTSyncStats stats;
+        if(this->frameSync->getStats(this->syncMember, &stats)) setIntegerParam(ADEVT_SyncMembers, stats.numMembers);
+    }
+    return asynSuccess;
+}
+
+
+/**
+ * Function that passes the current frame to the frame synchronizer group, with its block ID and camera
+ * timestamp. Every frame is matched, whether or not it is published on address 0. A camera with the output
+ * set to none still submits its frames, as other members may publish the sets, but the group does not
+ * queue them while no member publishes. Called from the image thread with the driver lock held.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @params[in]: frame   -> camera frame the NDArray was copied from
+ * @return:     void
+ */
+void ADEmergentVision::submitSyncFrame(NDArray* pArray, CEmergentFrame* frame){
+    if(this->frameSync == NULL) return;
+    this->frameSync->submit(this->syncMember, pArray, frame->frame_id, getCameraTimeNs(frame));
+    EVTSyncStats stats;
+    if(!this->frameSync->getStats(this->syncMember, &stats)) return;
+    setIntegerParam(ADEVT_SyncMembers, stats.numMembers);
+    setIntegerParam(ADEVT_SyncMatched, (int) stats.numMatched);
+    setIntegerParam(ADEVT_SyncUnmatched, (int) stats.numUnmatched);
+}
+
+
+/**
+ * Callback function called by the frame synchronizer with every matched set of the group, from the
+ * image thread of the camera that completed the set. The set is published by a task on the shared
+ * executor, so the lock of this driver is never taken from the image thread of another camera.
+ * 
+ * @params[in]: pPvt    -> pointer to the ADEmergentVision object
+ * @params[in]: pSet    -> matched set
+ * @return:     void
+ */
+void ADEmergentVision::syncSetCallback(void* pPvt, shared_ptr<EVTSyncSet> pSet){
+    ADEmergentVision* pEVT = (ADEmergentVision*) pPvt;
+    if(pEVT->syncOutput == EVT_SYNC_OUTPUT_NONE) return;
+    EVTExecutor::getInstance().submit(pEVT->executorClient, [pEVT, pSet](){
+        pEVT->publishSyncSet(*pSet);
+    });
+}
+
+
+/**
+ * Function that publishes a matched set on address EVT_SYNC_ADDR. A composite places the frames side by side
+ * in one NDArray, and requires mono or RGB1 frames of the same size and type, otherwise the set is published
+ * aligned. An aligned set is published as a copy of each frame, with the set ID as the uniqueId and the
+ * member index in the SyncMember attribute. Called without the driver lock, which is only taken to count
+ * the set, so blocking plugins on the sync address do not hold up writes to the driver.
+ * 
+ * @params[in]: set     -> matched set
+ * @return:     void
+ */
+void ADEmergentVision::publishSyncSet(const EVTSyncSet& set){
+    const char* functionName = "publishSyncSet";
+    epicsInt32 setId = set.setId, numMembers = (epicsInt32) set.frames.size();
+    NDArray* pFirst = set.frames[0];
+    bool composite = (this->syncOutput == EVT_SYNC_OUTPUT_COMPOSITE) &&
+                     (pFirst->ndims == 2 || (pFirst->ndims == 3 && pFirst->dims[0].size == 3));
+    for(size_t i = 1; composite && i < set.frames.size(); i++){
+        NDArray* pFrame = set.frames[i];
+        if(pFrame->ndims != pFirst->ndims || pFrame->dataType != pFirst->dataType) composite = false;
+        for(int d = 0; composite && d < pFirst->ndims; d++){
+            if(pFrame->dims[d].size != pFirst->dims[d].size) composite = false;
+        }
+    }
+
+    if(composite){
+        NDArrayInfo info;
+        pFirst->getInfo(&info);
+        size_t numFrames = set.frames.size();
+        size_t rowBytes = info.xSize * info.bytesPerElement * (pFirst->ndims == 3 ? 3 : 1);
+        size_t dims[3];
+        int ndims = pFirst->ndims;
+        if(ndims == 2){
+            dims[0] = info.xSize * numFrames;
+            dims[1] = info.ySize;
+        }
+        else{
+            dims[0] = 3;
+            dims[1] = info.xSize * numFrames;
+            dims[2] = info.ySize;
+        }
+        NDArray* pComposite = pNDArrayPool->alloc(ndims, dims, pFirst->dataType, 0, NULL);
+        if(pComposite == NULL){
+            ERR("Unable to allocate composite array");
+            return;
+        }
+        unsigned char* pOut = (unsigned char*) pComposite->pData;
+        for(size_t y = 0; y < info.ySize; y++){
+            for(size_t m = 0; m < numFrames; m++){
+                memcpy(pOut + (y * numFrames + m) * rowBytes, (const unsigned char*) set.frames[m]->pData + y * rowBytes, rowBytes);
+            }
+        }
+        pFirst->pAttributeList->copy(pComposite->pAttributeList);
+        pComposite->uniqueId = setId;
+        pComposite->timeStamp = pFirst->timeStamp;
+        pComposite->epicsTS = pFirst->epicsTS;
+        pComposite->pAttributeList->add("SyncSetId", "Frame sync set ID", NDAttrInt32, &setId);
+        pComposite->pAttributeList->add("SyncNumMembers", "Number of frames in the set", NDAttrInt32, &numMembers);
+        doCallbacksGenericPointer(pComposite, NDArrayData, EVT_SYNC_ADDR);
+        pComposite->release();
+    }
+    else{
+        for(size_t m = 0; m < set.frames.size(); m++){
+            NDArray* pCopy = pNDArrayPool->copy(set.frames[m], NULL, true);
+            if(pCopy == NULL){
+                ERR("Unable to allocate aligned array");
+                return;
+            }
+            epicsInt32 member = (epicsInt32) m;
+            pCopy->uniqueId = setId;
+            pCopy->pAttributeList->add("SyncSetId", "Frame sync set ID", NDAttrInt32, &setId);
+            pCopy->pAttributeList->add("SyncMember", "Index of the camera in the set", NDAttrInt32, &member);
+            pCopy->pAttributeList->add("SyncNumMembers", "Number of frames in the set", NDAttrInt32, &numMembers);
+            doCallbacksGenericPointer(pCopy, NDArrayData, EVT_SYNC_ADDR);
+            pCopy->release();
+        }
+    }
+    this->lock();
+    this->syncSetsPublished++;
+    setIntegerParam(ADEVT_SyncSets, this->syncSetsPublished);
+    callParamCallbacks();
+    this->unlock();
+}
+
+
+/**
+ * Function that publishes the shared executor statistics of this camera. The latency mean and max
+ * cover the tasks started since the last call.
+ * 
+ * @return: void
+ */
+void ADEmergentVision::publishExecutorStats(){
+    EVTExecutorStats stats;
+    if(!EVTExecutor::getInstance().getStats(this->executorClient, &stats, true)) return;
+    setDoubleParam(ADEVT_ExecLatencyMean, stats.latencyMean * 1e3);
+    setDoubleParam(ADEVT_ExecLatencyMax, stats.latencyMax * 1e3);
+    setIntegerParam(ADEVT_ExecTasks, (int) stats.numTasks);
+    setIntegerParam(ADEVT_ExecStolen, (int) stats.numStolen);
+    setIntegerParam(ADEVT_ExecQueued, (int) stats.numQueued);
+}
+
+
+/**
+ * Callback function called by the drift estimator worker threads with each result
+ * 
+ * @params[in]: pPvt    -> pointer to the ADEmergentVision object
+ * @params[in]: pResult -> computed shift
+ * @return:     void
+ */
+void ADEmergentVision::driftResultCallback(void* pPvt, const EVTDriftResult* pResult){
+    ADEmergentVision* pEVT = (ADEmergentVision*) pPvt;
+    pEVT->publishDriftResult(pResult);
+}
+
+
+/**
+ * Function that writes a drift estimate to the drift PVs, with the timestamp of the frame it was computed from.
+ * The image thread may be part way through a frame, so its pending params are first published with the
+ * timestamp of that frame, and the driver timestamp is restored once the drift PVs are published.
+ * 
+ * @params[in]: pResult -> computed shift
+ * @return:     void
+ */
+void ADEmergentVision::publishDriftResult(const EVTDriftResult* pResult){
+    epicsTimeStamp frameTimeStamp;
+    this->lock();
+    callParamCallbacks();
+    getTimeStamp(&frameTimeStamp);
+    setTimeStamp(&pResult->timeStamp);
+    setDoubleParam(ADEVT_DriftX, pResult->dx);
+    setDoubleParam(ADEVT_DriftY, pResult->dy);
+    setDoubleParam(ADEVT_DriftQuality, pResult->quality);
+    setIntegerParam(ADEVT_DriftUniqueId, pResult->uniqueId);
+    this->frameMetrics.driftX = pResult->dx;
+    this->frameMetrics.driftY = pResult->dy;
+    this->frameMetrics.driftQuality = pResult->quality;
+    callParamCallbacks();
+    setTimeStamp(&frameTimeStamp);
+    this->unlock();
+}
+
+
+/**
+ * Function that opens or closes the UDP feedback socket to match the enable, address, port and TTL PVs
+ * 
+ * @return: status  -> error if the socket could not be opened
+ */
+asynStatus ADEmergentVision::configureUdpPublisher(){
+    const char* functionName = "configureUdpPublisher";
+    int enable, port, ttl;
+    char address[256];
+    getIntegerParam(ADEVT_UdpEnable, &enable);
+    getIntegerParam(ADEVT_UdpPort, &port);
+    getIntegerParam(ADEVT_UdpTtl, &ttl);
+    getStringParam(ADEVT_UdpAddress, sizeof(address), address);
+
+    if(!enable || strlen(address) == 0){
+        this->udpPublisher.close();
+        return asynSuccess;
+    }
+    string error;
+    if(!this->udpPublisher.open(address, port, ttl, error)){
+        ERR_ARGS("Failed to open UDP feedback socket: %s", error.c_str());
+        updateStatus("UDP feedback error");
+        return asynError;
+    }
+    LOG_ARGS("Sending UDP feedback to %s:%d", address, port);
+    return asynSuccess;
+}
+
+
+/**
+ * Function that parses the list of metrics sent in each UDP feedback datagram
+ * 
+ * @params[in]: fields  -> comma separated list of metric names, see evtFrameMetrics.h
+ * @return: status      -> error if any of the names is invalid, the previous list is kept in that case
+ */
+asynStatus ADEmergentVision::setUdpFields(const char* fields){
+    const char* functionName = "setUdpFields";
+    string error;
+    if(!EVTFrameMetrics::parseSelectors(fields, this->udpSelectors, error)){
+        ERR_ARGS("Invalid UDP feedback fields: %s", error.c_str());
+        updateStatus("Invalid UDP fields");
+        return asynError;
+    }
+    this->udpValues.resize(this->udpSelectors.size());
+    return asynSuccess;
+}
+
+
+/**
+ * Function that sends the UDP feedback datagram for the current frame, and measures the time from
+ * receiving the frame from the camera to the datagram leaving the driver.
+ * Called from the image thread with the driver lock held, before the NDArray is passed to plugins. The
+ * publisher socket does not block, so the lock is only held for the time of the send call.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @params[in]: frame   -> frame recieved from Emergent Vision Camera
+ * @return:     void
+ */
+void ADEmergentVision::publishUdpFeedback(NDArray* pArray, CEmergentFrame* frame){
+    if(!this->udpPublisher.isOpen()) return;
+
+    for(size_t i = 0; i < this->udpSelectors.size(); i++)
+        this->udpValues[i] = this->frameMetrics.getValue(this->udpSelectors[i]);
+    this->udpPublisher.send(pArray->uniqueId, getCameraTimeNs(frame), pArray->epicsTS,
+                            this->udpValues.empty() ? NULL : &this->udpValues[0], this->udpValues.size());
+
+    double latency = chrono::duration<double, micro>(chrono::steady_clock::now() - this->frameReceiveTime).count();
+    if(latency > this->udpLatencyMax) this->udpLatencyMax = latency;
+    setDoubleParam(ADEVT_UdpLatency, latency);
+    setDoubleParam(ADEVT_UdpLatencyMax, this->udpLatencyMax);
+    setIntegerParam(ADEVT_UdpSent, (int) this->udpPublisher.getNumSent());
+    setIntegerParam(ADEVT_UdpErrors, (int) this->udpPublisher.getNumErrors());
+}
+
+
+/**
+ * Function that starts or cancels averaging a dark or flat reference from the next frames.
+ * Only one reference can be captured at a time, starting a capture cancels any other.
+ * 
+ * @params[in]: type    -> dark or flat
+ * @params[in]: start   -> 1 to start capturing, 0 to cancel
+ * @return:     status
+ */
+asynStatus ADEmergentVision::startReferenceCapture(EVTReferenceType type, int start){
+    const char* functionName = "startReferenceCapture";
+    int captureParam = (type == EVT_REFERENCE_DARK) ? ADEVT_FfcAcquireDark : ADEVT_FfcAcquireFlat;
+    int otherParam = (type == EVT_REFERENCE_DARK) ? ADEVT_FfcAcquireFlat : ADEVT_FfcAcquireDark;
+
+    if(!start){
+        if(this->flatFieldCorrector.isCapturing() && this->flatFieldCorrector.getCaptureType() == type)
+            this->flatFieldCorrector.cancelCapture();
+        return asynSuccess;
+    }
+    int numFrames;
+    getIntegerParam(ADEVT_FfcNumFrames, &numFrames);
+    this->flatFieldCorrector.startCapture(type, numFrames);
+    setIntegerParam(captureParam, 1);
+    setIntegerParam(otherParam, 0);
+    setIntegerParam(ADEVT_FfcProgress, 0);
+    LOG_ARGS("Capturing %s reference from %d frames", type == EVT_REFERENCE_DARK ? "dark" : "flat", numFrames);
+    return asynSuccess;
+}
+
+
+/**
+ * Function that maps a dark or flat reference file, called when the file path PV is written.
+ * An empty path clears the reference.
+ * 
+ * @params[in]: type    -> dark or flat
+ * @params[in]: path    -> path of the reference file
+ * @return:     status  -> error if the file could not be loaded, the current reference is kept in that case
+ */
+asynStatus ADEmergentVision::loadReference(EVTReferenceType type, const char* path){
+    const char* functionName = "loadReference";
+    int validParam = (type == EVT_REFERENCE_DARK) ? ADEVT_FfcDarkValid : ADEVT_FfcFlatValid;
+    asynStatus status = asynSuccess;
+
+    if(strlen(path) == 0) this->flatFieldCorrector.clearReference(type);
+    else{
+        string error;
+        if(!this->flatFieldCorrector.loadReference(type, path, error)){
+            ERR_ARGS("Failed to load reference: %s", error.c_str());
+            updateStatus("Failed to load reference");
+            status = asynError;
+        }
+        else LOG_ARGS("Loaded reference %s", path);
+    }
+    this->flatFieldMismatchReported = 0;
+    setIntegerParam(validParam, this->flatFieldCorrector.hasReference(type) ? 1 : 0);
+    return status;
+}
+
+
+/**
+ * Function that adds the raw frame to the reference being captured, and once enough frames have been
+ * averaged, stores the reference in the file given by the file path PV, or in memory if it is empty.
+ * Called from the image thread with the driver lock held, before the frame is corrected.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @return:     void
+ */
+void ADEmergentVision::captureReference(NDArray* pArray){
+    const char* functionName = "captureReference";
+    if(!this->flatFieldCorrector.isCapturing() || pArray->ndims != 2) return;
+
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+    bool done;
+    if(pArray->dataType == NDUInt8 || pArray->dataType == NDInt8)
+        done = this->flatFieldCorrector.capture((const uint8_t*) pArray->pData, sizeX, sizeY);
+    else if(pArray->dataType == NDUInt16 || pArray->dataType == NDInt16)
+        done = this->flatFieldCorrector.capture((const uint16_t*) pArray->pData, sizeX, sizeY);
+    else return;
+    setIntegerParam(ADEVT_FfcProgress, this->flatFieldCorrector.getNumCaptured());
+    if(!done) return;
+
+    EVTReferenceType type = this->flatFieldCorrector.getCaptureType();
+    char path[256];
+    getStringParam(type == EVT_REFERENCE_DARK ? ADEVT_FfcDarkFile : ADEVT_FfcFlatFile, sizeof(path), path);
+    string error;
+    if(!this->flatFieldCorrector.saveCapture(path, error)){
+        ERR_ARGS("Failed to store reference: %s", error.c_str());
+        updateStatus("Failed to store reference");
+    }
+    else LOG_ARGS("Stored %s reference %s", type == EVT_REFERENCE_DARK ? "dark" : "flat", path);
+    this->flatFieldMismatchReported = 0;
+    setIntegerParam(type == EVT_REFERENCE_DARK ? ADEVT_FfcAcquireDark : ADEVT_FfcAcquireFlat, 0);
+    setIntegerParam(type == EVT_REFERENCE_DARK ? ADEVT_FfcDarkValid : ADEVT_FfcFlatValid,
+                    this->flatFieldCorrector.hasReference(type) ? 1 : 0);
+}
+
+
+/**
+ * Function that applies dark and flat field correction to the current frame.
+ * Integer output corrects the frame in place, float output replaces the NDArray with a new
+ * Float32 array, so only plugins (not the in-driver 8/16 bit statistics) see float frames.
+ * Called from the image thread with the driver lock held.
+ * 
+ * @params[in,out]: ppArray -> NDArray holding the current frame, replaced for float output
+ * @return:         void
+ */
+void ADEmergentVision::applyFlatField(NDArray** ppArray){
+    const char* functionName = "applyFlatField";
+    NDArray* pArray = *ppArray;
+    int enable;
+    getIntegerParam(ADEVT_FfcEnable, &enable);
+    if(!enable || pArray->ndims != 2) return;
+
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+    size_t numPixels = sizeX * sizeY;
+    bool is8Bit = (pArray->dataType == NDUInt8 || pArray->dataType == NDInt8);
+    bool is16Bit = (pArray->dataType == NDUInt16 || pArray->dataType == NDInt16);
+    if(!is8Bit && !is16Bit) return;
+    if(!this->flatFieldCorrector.isReady(sizeX, sizeY)){
+        if(!this->flatFieldMismatchReported && (this->flatFieldCorrector.hasReference(EVT_REFERENCE_DARK)
+                                                 || this->flatFieldCorrector.hasReference(EVT_REFERENCE_FLAT))){
+            ERR("References do not match the frame size, frames are not corrected");
+            updateStatus("Reference size mismatch");
+            this->flatFieldMismatchReported = 1;
+        }
+        return;
+    }
+
+    if(this->flatFieldOutput == 0){
+        if(is8Bit) this->flatFieldCorrector.correct((const uint8_t*) pArray->pData, (uint8_t*) pArray->pData, numPixels);
+        else this->flatFieldCorrector.correct((const uint16_t*) pArray->pData, (uint16_t*) pArray->pData, numPixels);
+        return;
+    }
+
+    size_t dims[2] = {sizeX, sizeY};
+    NDArray* pCorrected = pNDArrayPool->alloc(2, dims, NDFloat32, 0, NULL);
+    if(pCorrected == NULL){
+        ERR("Unable to allocate corrected array");
+        return;
+    }
+    if(is8Bit) this->flatFieldCorrector.correct((const uint8_t*) pArray->pData, (float*) pCorrected->pData, numPixels);
+    else this->flatFieldCorrector.correct((const uint16_t*) pArray->pData, (float*) pCorrected->pData, numPixels);
+    pCorrected->uniqueId = pArray->uniqueId;
+    pCorrected->timeStamp = pArray->timeStamp;
+    pCorrected->epicsTS = pArray->epicsTS;
+    pArray->pAttributeList->copy(pCorrected->pAttributeList);
+    pArray->release();
+    this->pArrays[0] = pCorrected;
+    *ppArray = pCorrected;
+}
+
+
+/**
+ * Function that builds the defective pixel map from the current dark and flat references.
+ * Hot pixels are taken from the dark reference and dead pixels from the flat reference,
+ * so either reference may be missing.
+ * 
+ * @return: status  -> error if there are no references, or their sizes do not match
+ */
+asynStatus ADEmergentVision::buildDefectMap(){
+    const char* functionName = "buildDefectMap";
+    double hotSigma, deadFraction;
+    size_t darkSizeX, darkSizeY, flatSizeX, flatSizeY;
+    getDoubleParam(ADEVT_DefectHotSigma, &hotSigma);
+    getDoubleParam(ADEVT_DefectDeadFraction, &deadFraction);
+    const float* pDark = this->flatFieldCorrector.getReference(EVT_REFERENCE_DARK, &darkSizeX, &darkSizeY);
+    const float* pFlat = this->flatFieldCorrector.getReference(EVT_REFERENCE_FLAT, &flatSizeX, &flatSizeY);
+    // references are captured from the frames as output, which are mosaics for unbinned Bayer frames
+    int colorMode;
+    getIntegerParam(NDColorMode, &colorMode);
+    bool mosaic = (colorMode == NDColorModeBayer) && !isFrameBinned(colorMode);
+
+    asynStatus status = asynSuccess;
+    if(pDark != NULL && pFlat != NULL && (darkSizeX != flatSizeX || darkSizeY != flatSizeY)){
+        ERR("Dark and flat references have different sizes");
+        updateStatus("Reference size mismatch");
+        status = asynError;
+    }
+    else if(!this->defectMap.build(pDark, pFlat, pDark != NULL ? darkSizeX : flatSizeX,
+                                   pDark != NULL ? darkSizeY : flatSizeY, mosaic, hotSigma, deadFraction)){
+        ERR("Defect map requires a dark or flat reference");
+        updateStatus("No references for defect map");
+        status = asynError;
+    }
+    else LOG_ARGS("Found %lu hot and %lu dead pixels", (unsigned long) this->defectMap.getNumHot(),
+                  (unsigned long) this->defectMap.getNumDead());
+
+    int enable;
+    getIntegerParam(ADEVT_DefectEnable, &enable);
+    this->flatFieldCorrector.setDefectMap(enable ? &this->defectMap : NULL);
+    setIntegerParam(ADEVT_DefectNumHot, (int) this->defectMap.getNumHot());
+    setIntegerParam(ADEVT_DefectNumDead, (int) this->defectMap.getNumDead());
+    return status;
+}
+
+
+/**
+ * Function that rebuilds the driver lookup table from the mode, output bit depth and gamma PVs. The input
+ * depth is that of the selected pixel format, and is rebuilt with the table when the format changes.
+ * 
+ * @return: status
+ */
+asynStatus ADEmergentVision::configureDriverLut(){
+    int mode, outputBits;
+    double gamma;
+    unsigned int evtPixelFormat;
+    int inputBits = 8;
+    if(getFrameFormatEVT(&evtPixelFormat) == asynSuccess) inputBits = getPixelBitDepth((PIXEL_FORMAT) evtPixelFormat);
+    getIntegerParam(ADEVT_DriverLutMode, &mode);
+    getIntegerParam(ADEVT_DriverLutOutputBits, &outputBits);
+    getDoubleParam(ADEVT_DriverLutGamma, &gamma);
+    // output bits PV is an index, 8 or 16 bit
+    this->driverLut.configure((EVTLutMode) mode, inputBits, outputBits == 0 ? 8 : 16, gamma, this->driverLutPoints);
+    setIntegerParam(ADEVT_DriverLutInputBits, this->driverLut.getInputBits());
+    return asynSuccess;
+}
+
+
+/**
+ * Function that stores the points of the arbitrary driver lookup table. The points are output values,
+ * spread evenly over the input range and linearly interpolated between.
+ * 
+ * @params[in]: value       -> table points
+ * @params[in]: nElements   -> number of points, at least two
+ * @return:     status
+ */
+asynStatus ADEmergentVision::setDriverLutTable(epicsInt32* value, size_t nElements){
+    const char* functionName = "setDriverLutTable";
+    if(nElements > EVT_LUT_MAX_POINTS){
+        ERR_ARGS("Only the first %d table points will be used", EVT_LUT_MAX_POINTS);
+        nElements = EVT_LUT_MAX_POINTS;
+    }
+    this->driverLutPoints.assign(value, value + nElements);
+    this->numDriverLutPoints = nElements;
+    memcpy(this->driverLutTable, value, nElements * sizeof(epicsInt32));
+    doCallbacksInt32Array(this->driverLutTable, this->numDriverLutPoints, ADEVT_DriverLutTable, 0);
+    if(nElements < 2) ERR("Table needs at least two points, using a linear table");
+    return configureDriverLut();
+}
+
+
+/**
+ * Function that tone maps a frame that is about to be published through the driver lookup table.
+ * It runs after the in-driver processing, so statistics and references stay in the linear domain,
+ * and only on published frames. Output of a different type, or a frame that is held elsewhere, replaces
+ * the NDArray with a new one.
+ * 
+ * @params[in,out]: ppArray -> NDArray holding the current frame, replaced if the output type changes
+ * @return:         void
+ */
+void ADEmergentVision::applyDriverLut(NDArray** ppArray){
+    const char* functionName = "applyDriverLut";
+    NDArray* pArray = *ppArray;
+    int enable;
+    getIntegerParam(ADEVT_DriverLutEnable, &enable);
+    if(!enable || pArray->ndims != 2) return;
+
+    bool is8Bit = (pArray->dataType == NDUInt8 || pArray->dataType == NDInt8);
+    bool is16Bit = (pArray->dataType == NDUInt16 || pArray->dataType == NDInt16);
+    if(!is8Bit && !is16Bit) return;
+    size_t numPixels = pArray->dims[0].size * pArray->dims[1].size;
+    bool output8Bit = (this->driverLut.getOutputBits() == 8);
+
+    // a frame still held by the stream server or a sync set is mapped into a new array, not in place
+    if(is8Bit == output8Bit && pArray->getReferenceCount() <= 1){
+        if(is8Bit) this->driverLut.apply((const uint8_t*) pArray->pData, (uint8_t*) pArray->pData, numPixels);
+        else this->driverLut.apply((const uint16_t*) pArray->pData, (uint16_t*) pArray->pData, numPixels);
+        return;
+    }
+
+    size_t dims[2] = {pArray->dims[0].size, pArray->dims[1].size};
+    NDArray* pMapped = pNDArrayPool->alloc(2, dims, output8Bit ? NDUInt8 : NDUInt16, 0, NULL);
+    if(pMapped == NULL){
+        ERR("Unable to allocate tone mapped array");
+        return;
+    }
+    if(is8Bit && output8Bit) this->driverLut.apply((const uint8_t*) pArray->pData, (uint8_t*) pMapped->pData, numPixels);
+    else if(is8Bit) this->driverLut.apply((const uint8_t*) pArray->pData, (uint16_t*) pMapped->pData, numPixels);
+    else if(output8Bit) this->driverLut.apply((const uint16_t*) pArray->pData, (uint8_t*) pMapped->pData, numPixels);
+    else this->driverLut.apply((const uint16_t*) pArray->pData, (uint16_t*) pMapped->pData, numPixels);
+    pMapped->uniqueId = pArray->uniqueId;
+    pMapped->timeStamp = pArray->timeStamp;
+    pMapped->epicsTS = pArray->epicsTS;
+    pArray->pAttributeList->copy(pMapped->pAttributeList);
+    pArray->release();
+    this->pArrays[0] = pMapped;
+    *ppArray = pMapped;
+}
+
+
+/**
+ * Function that passes the white balance gains, color matrix and gamma PVs to the color pipeline
+ * 
+ * @return: status
+ */
+asynStatus ADEmergentVision::configureColorPipeline(){
+    double gains[3], gamma;
+    getDoubleParam(ADEVT_ColorGainR, &gains[0]);
+    getDoubleParam(ADEVT_ColorGainG, &gains[1]);
+    getDoubleParam(ADEVT_ColorGainB, &gains[2]);
+    getDoubleParam(ADEVT_ColorGamma, &gamma);
+    this->colorPipeline.configure(gains, this->colorMatrix, gamma, this->colorInputBits);
+    return asynSuccess;
+}
+
+
+/**
+ * Function that stores the color matrix, row major, mapping white balanced camera RGB to output RGB
+ * 
+ * @params[in]: value       -> matrix elements
+ * @params[in]: nElements   -> number of elements, must be 9
+ * @return:     status
+ */
+asynStatus ADEmergentVision::setColorMatrix(epicsFloat64* value, size_t nElements){
+    const char* functionName = "setColorMatrix";
+    if(nElements != 9){
+        ERR_ARGS("Color matrix needs 9 elements, got %d", (int) nElements);
+        updateStatus("Invalid color matrix");
+        return asynError;
+    }
+    memcpy(this->colorMatrix, value, sizeof(this->colorMatrix));
+    doCallbacksFloat64Array(this->colorMatrix, 9, ADEVT_ColorMatrix, 0);
+    return configureColorPipeline();
+}
+
+
+/**
+ * Function that applies the white balance gains, color matrix and gamma to an RGB frame in one pass.
+ * The channel means gathered in the same pass drive the auto white balance, whose gains are used
+ * from the next frame on.
+ * 
+ * @params[in]: pArray          -> NDArray holding the current frame, interleaved or planar RGB
+ * @params[in]: evtPixelFormat  -> pixel format of the camera frames, for the bit depth
+ * @return:     void
+ */
+void ADEmergentVision::applyColorPipeline(NDArray* pArray, PIXEL_FORMAT evtPixelFormat){
+    int enable, awb, colorMode;
+    getIntegerParam(ADEVT_ColorEnable, &enable);
+    getIntegerParam(NDColorMode, &colorMode);
+    if(!enable || pArray->ndims != 3) return;
+    // bayer superpixels are always interleaved
+    bool planar = (colorMode == NDColorModeRGB2 || colorMode == NDColorModeRGB3);
+
+    bool is8Bit = (pArray->dataType == NDUInt8 || pArray->dataType == NDInt8);
+    bool is16Bit = (pArray->dataType == NDUInt16 || pArray->dataType == NDInt16);
+    if(!is8Bit && !is16Bit) return;
+    int bits = getPixelBitDepth(evtPixelFormat);
+    if(is16Bit && bits != this->colorInputBits){
+        this->colorInputBits = bits;
+        configureColorPipeline();
+    }
+
+    double means[3];
+    if(planar){
+        size_t sizeX = pArray->dims[0].size;
+        size_t sizeY = pArray->dims[colorMode == NDColorModeRGB2 ? 2 : 1].size;
+        size_t offsets[3], rowStride;
+        EVTPlanarRgb::getPlanes(sizeX, sizeY, colorMode == NDColorModeRGB2 ? EVT_PLANAR_ROWS : EVT_PLANAR_PLANES, offsets, &rowStride);
+        if(is8Bit) this->colorPipeline.applyPlanar((uint8_t*) pArray->pData, sizeX, sizeY, offsets, rowStride, means);
+        else this->colorPipeline.applyPlanar((uint16_t*) pArray->pData, sizeX, sizeY, offsets, rowStride, means);
+    }
+    else{
+        size_t numPixels = pArray->dims[1].size * pArray->dims[2].size;
+        if(is8Bit) this->colorPipeline.apply((uint8_t*) pArray->pData, numPixels, means);
+        else this->colorPipeline.apply((uint16_t*) pArray->pData, numPixels, means);
+    }
+
+    getIntegerParam(ADEVT_ColorAwb, &awb);
+    if(awb == EVT_AWB_OFF) return;
+    double gains[3], newGains[3];
+    getDoubleParam(ADEVT_ColorGainR, &gains[0]);
+    getDoubleParam(ADEVT_ColorGainG, &gains[1]);
+    getDoubleParam(ADEVT_ColorGainB, &gains[2]);
+    if(EVTColorPipeline::computeWhiteBalance(means, gains, newGains)){
+        setDoubleParam(ADEVT_ColorGainR, newGains[0]);
+        setDoubleParam(ADEVT_ColorGainB, newGains[2]);
+        configureColorPipeline();
+    }
+    if(awb == EVT_AWB_ONCE) setIntegerParam(ADEVT_ColorAwb, EVT_AWB_OFF);
+}
+
+
+/**
+ * Function that passes the background mode, weight and window PVs to the background model
+ * 
+ * @return: status
+ */
+asynStatus ADEmergentVision::configureBackground(){
+    int mode, shift, window;
+    getIntegerParam(ADEVT_BgMode, &mode);
+    getIntegerParam(ADEVT_BgShift, &shift);
+    getIntegerParam(ADEVT_BgWindow, &window);
+    this->backgroundModel.configure((EVTBackgroundMode) mode, shift, window);
+    setIntegerParam(ADEVT_BgNumFrames, this->backgroundModel.getNumFrames());
+    return asynSuccess;
+}
+
+
+/**
+ * Function that updates the rolling background from every Nth mono unsigned 8/16 bit frame, and subtracts
+ * it from the frame in place if the subtracted output is selected. The background is updated from the
+ * raw frame, before the subtraction. Signed frames are not supported, as the model clamps at zero.
+ * 
+ * @params[in,out]: pArray  -> NDArray holding the current frame
+ * @return:         void
+ */
+void ADEmergentVision::applyBackground(NDArray* pArray){
+    int enable, updateInterval, subtract;
+    getIntegerParam(ADEVT_BgEnable, &enable);
+    if(!enable || pArray->ndims != 2) return;
+    int bytesPerPixel;
+    if(pArray->dataType == NDUInt8) bytesPerPixel = 1;
+    else if(pArray->dataType == NDUInt16) bytesPerPixel = 2;
+    else return;
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+
+    getIntegerParam(ADEVT_BgUpdateInterval, &updateInterval);
+    bool ready = this->backgroundModel.isReady(sizeX, sizeY, bytesPerPixel);
+    if(!ready || this->framesSinceBackgroundUpdate == 0){
+        if(bytesPerPixel == 1) this->backgroundModel.update((const uint8_t*) pArray->pData, sizeX, sizeY);
+        else this->backgroundModel.update((const uint16_t*) pArray->pData, sizeX, sizeY);
+        setIntegerParam(ADEVT_BgNumFrames, this->backgroundModel.getNumFrames());
+        this->framesSinceBackgroundUpdate = 0;
+    }
+    this->framesSinceBackgroundUpdate++;
+    if(updateInterval <= 1 || this->framesSinceBackgroundUpdate >= updateInterval) this->framesSinceBackgroundUpdate = 0;
+
+    getIntegerParam(ADEVT_BgSubtract, &subtract);
+    if(!subtract) return;
+    if(bytesPerPixel == 1) this->backgroundModel.subtract((uint8_t*) pArray->pData, sizeX * sizeY);
+    else this->backgroundModel.subtract((uint16_t*) pArray->pData, sizeX * sizeY);
+}
+
+
+/**
+ * Function that publishes the current background as an NDArray on address EVT_BACKGROUND_ADDR,
+ * so it can be viewed or saved by plugins connected to that address. Called with the driver lock held,
+ * which is released while the plugins are called.
+ * 
+ * @return: status -> error if there is no background, or the array could not be allocated
+ */
+asynStatus ADEmergentVision::publishBackground(){
+    const char* functionName = "publishBackground";
+    const void* pBackground = this->backgroundModel.getData();
+    if(pBackground == NULL){
+        ERR("No background has been collected");
+        return asynError;
+    }
+    int bytesPerPixel = this->backgroundModel.getBytesPerPixel();
+    size_t dims[2] = {this->backgroundModel.getSizeX(), this->backgroundModel.getSizeY()};
+    NDArray* pArray = pNDArrayPool->alloc(2, dims, bytesPerPixel == 1 ? NDUInt8 : NDUInt16, 0, NULL);
+    if(pArray == NULL){
+        ERR("Unable to allocate background array");
+        return asynError;
+    }
+    memcpy(pArray->pData, pBackground, dims[0] * dims[1] * bytesPerPixel);
+    int colorMode = NDColorModeMono;
+    pArray->pAttributeList->add("ColorMode", "Color Mode", NDAttrInt32, &colorMode);
+    getIntegerParam(NDArrayCounter, &pArray->uniqueId);
+    epicsTimeGetCurrent(&pArray->epicsTS);
+    pArray->timeStamp = pArray->epicsTS.secPastEpoch + pArray->epicsTS.nsec / ONE_BILLION;
+    this->unlock();
+    doCallbacksGenericPointer(pArray, NDArrayData, EVT_BACKGROUND_ADDR);
+    this->lock();
+    pArray->release();
+    return asynSuccess;
+}
+
+
+/**
+ * Function that starts or cancels accumulating per pixel mean and variance maps from the next frames
+ * 
+ * @params[in]: start   -> 1 to start, 0 to cancel
+ * @return:     status
+ */
+asynStatus ADEmergentVision::startTemporalStats(int start){
+    const char* functionName = "startTemporalStats";
+    if(!start){
+        this->temporalStats.cancel();
+        return asynSuccess;
+    }
+    int numFrames;
+    getIntegerParam(ADEVT_PtcNumFrames, &numFrames);
+    this->temporalStats.start(numFrames);
+    setIntegerParam(ADEVT_PtcProgress, 0);
+    LOG_ARGS("Accumulating mean and variance maps from %d frames", numFrames);
+    return asynSuccess;
+}
+
+
+/**
+ * Function that adds the raw frame to the mean and variance maps. Once enough frames are accumulated the maps
+ * are published on their own addresses, and the spatial averages are used for the photon transfer summary:
+ * a dark series gives the read noise in counts, and an illuminated series the conversion gain in counts per
+ * electron, (variance - dark variance) / (mean - dark mean). Without a dark series the offset and read noise
+ * are taken as zero. Called from the image thread with the driver lock held, before the frame is corrected.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @return:     void
+ */
+void ADEmergentVision::accumulateTemporalStats(NDArray* pArray){
+    if(!this->temporalStats.isRunning() || pArray->ndims != 2) return;
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+    bool done;
+    if(pArray->dataType == NDUInt8 || pArray->dataType == NDInt8)
+        done = this->temporalStats.accumulate((const uint8_t*) pArray->pData, sizeX, sizeY);
+    else if(pArray->dataType == NDUInt16 || pArray->dataType == NDInt16)
+        done = this->temporalStats.accumulate((const uint16_t*) pArray->pData, sizeX, sizeY);
+    else return;
+    int numFrames = this->temporalStats.getNumAccumulated();
+    setIntegerParam(ADEVT_PtcProgress, numFrames);
+    if(!done) return;
+
+    int dark;
+    getIntegerParam(ADEVT_PtcDark, &dark);
+    double mean = this->temporalStats.getMeanLevel();
+    double variance = this->temporalStats.getMeanVariance();
+    setDoubleParam(ADEVT_PtcMean, mean);
+    setDoubleParam(ADEVT_PtcVariance, variance);
+    if(dark){
+        this->ptcDarkMean = mean;
+        this->ptcDarkVariance = variance;
+        this->ptcDarkValid = 1;
+        setDoubleParam(ADEVT_PtcReadNoise, sqrt(variance));
+    }
+    else{
+        double darkMean = this->ptcDarkValid ? this->ptcDarkMean : 0;
+        double darkVariance = this->ptcDarkValid ? this->ptcDarkVariance : 0;
+        setDoubleParam(ADEVT_PtcGain, mean > darkMean ? (variance - darkVariance) / (mean - darkMean) : 0);
+    }
+    setIntegerParam(ADEVT_PtcAcquire, 0);
+    publishFloatMaps(this->temporalStats.getMean(), this->temporalStats.getVariance(), sizeX, sizeY, numFrames);
+}
+
+
+/**
+ * Function that publishes the mean and variance maps as Float32 NDArrays on their own addresses. Called from
+ * the image thread with the driver lock held. Both maps are copied before the lock is released while the
+ * plugins are called, so a new accumulation started meanwhile can not change them.
+ * 
+ * @params[in]: pMean       -> mean map pixels
+ * @params[in]: pVariance   -> variance map pixels
+ * @params[in]: sizeX       -> map width
+ * @params[in]: sizeY       -> map height
+ * @params[in]: numFrames   -> number of frames the maps were computed from, added as an attribute
+ * @return:     status
+ */
+asynStatus ADEmergentVision::publishFloatMaps(const float* pMean, const float* pVariance, size_t sizeX, size_t sizeY, int numFrames){
+    const char* functionName = "publishFloatMaps";
+    const float* maps[2] = {pMean, pVariance};
+    const int addrs[2] = {EVT_MEAN_MAP_ADDR, EVT_VARIANCE_MAP_ADDR};
+    NDArray* pArrays[2] = {NULL, NULL};
+    size_t dims[2] = {sizeX, sizeY};
+    for(int i = 0; i < 2; i++){
+        pArrays[i] = pNDArrayPool->alloc(2, dims, NDFloat32, 0, NULL);
+        if(pArrays[i] == NULL){
+            ERR("Unable to allocate map array");
+            if(i > 0) pArrays[0]->release();
+            return asynError;
+        }
+        memcpy(pArrays[i]->pData, maps[i], sizeX * sizeY * sizeof(float));
+        int colorMode = NDColorModeMono;
+        pArrays[i]->pAttributeList->add("ColorMode", "Color Mode", NDAttrInt32, &colorMode);
+        pArrays[i]->pAttributeList->add("NumFrames", "Number of frames in the map", NDAttrInt32, &numFrames);
+        getIntegerParam(NDArrayCounter, &pArrays[i]->uniqueId);
+        epicsTimeGetCurrent(&pArrays[i]->epicsTS);
+        pArrays[i]->timeStamp = pArrays[i]->epicsTS.secPastEpoch + pArrays[i]->epicsTS.nsec / ONE_BILLION;
+    }
+    this->unlock();
+    for(int i = 0; i < 2; i++) doCallbacksGenericPointer(pArrays[i], NDArrayData, addrs[i]);
+    this->lock();
+    for(int i = 0; i < 2; i++) pArrays[i]->release();
+    return asynSuccess;
+}
+
+
+/**
+ * Function that passes the trigger condition and window PVs to the trigger engine
+ * 
+ * @return: status
+ */
+asynStatus ADEmergentVision::configureTrigger(){
+    int condition, preFrames, postFrames;
+    double threshold;
+    getIntegerParam(ADEVT_TrigCondition, &condition);
+    getDoubleParam(ADEVT_TrigThreshold, &threshold);
+    getIntegerParam(ADEVT_TrigPreFrames, &preFrames);
+    getIntegerParam(ADEVT_TrigPostFrames, &postFrames);
+    this->triggerEngine.configure((EVTTriggerCondition) condition, threshold, preFrames, postFrames);
+    while((int) this->preTriggerFrames.size() > this->triggerEngine.getPreFrames()){
+        this->preTriggerFrames.front().first->release();
+        this->preTriggerFrames.pop_front();
+    }
+    return asynSuccess;
+}
+
+
+/**
+ * Function that selects the per frame metric the trigger condition is evaluated on
+ * 
+ * @params[in]: metric  -> a single metric name, see evtFrameMetrics.h
+ * @return: status      -> error if the name is invalid, the previous metric is kept in that case
+ */
+asynStatus ADEmergentVision::setTriggerMetric(const char* metric){
+    const char* functionName = "setTriggerMetric";
+    vector<EVTMetricSelector> selectors;
+    string error;
+    if(!EVTFrameMetrics::parseSelectors(metric, selectors, error) || selectors.size() != 1){
+        if(error.empty()) error = "exactly one metric must be given";
+        ERR_ARGS("Invalid trigger metric: %s", error.c_str());
+        updateStatus("Invalid trigger metric");
+        return asynError;
+    }
+    this->triggerSelector = selectors[0];
+    this->triggerSelectorValid = 1;
+    return asynSuccess;
+}
+
+
+/**
+ * Function that evaluates the trigger condition on the metrics of the current frame. Called for every frame
+ * from the image thread with the driver lock held, after all per frame metrics have been computed.
+ * 
+ * @return: void
+ */
+void ADEmergentVision::evaluateTrigger(){
+    int enable;
+    getIntegerParam(ADEVT_TrigEnable, &enable);
+    if(!enable) return;
+
+    // without a valid metric no condition is met, as comparisons with NaN are false, and only forced triggers open a window
+    double value = this->triggerSelectorValid ? this->frameMetrics.getValue(this->triggerSelector) : NAN;
+    this->triggerState = this->triggerEngine.evaluate(value, this->triggerForced != 0);
+    this->triggerForced = 0;
+    setIntegerParam(ADEVT_TrigId, this->triggerEngine.getTriggerId());
+    setIntegerParam(ADEVT_TrigActive, this->triggerState != EVT_TRIGGER_IDLE ? 1 : 0);
+}
+
+
+/**
+ * Function that checks whether the current frame is in a recording window. Called for every frame while the
+ * trigger is enabled, in place of decimation and change suppression. Frames outside a window are held as
+ * pre trigger frames, and the held frames are published ahead of the first frame of a window.
+ * Frames are tagged with the trigger ID, and their offset in frames from the frame that opened the window.
+ * 
+ * @params[in]: pArray  -> NDArray holding the current frame
+ * @return: true if the frame should be published now, false if it is held or the trigger is disabled
+ */
+bool ADEmergentVision::isFrameTriggered(NDArray* pArray){
+    int enable;
+    getIntegerParam(ADEVT_TrigEnable, &enable);
+    if(!enable) return true;
+
+    int64_t frameNumber = this->triggerEngine.getFrameNumber();
+    if(this->triggerState == EVT_TRIGGER_IDLE){
+        if(this->triggerEngine.getPreFrames() == 0) return false;
+        pArray->reserve();
+        this->preTriggerFrames.push_back(make_pair(pArray, frameNumber));
+        if((int) this->preTriggerFrames.size() > this->triggerEngine.getPreFrames()){
+            this->preTriggerFrames.front().first->release();
+            this->preTriggerFrames.pop_front();
+        }
+        return false;
+    }
+
+    // held frames are only from before the window opened, as frames in a window are never held
+    while(!this->preTriggerFrames.empty()){
+        NDArray* pHeld = this->preTriggerFrames.front().first;
+        tagTriggerFrame(pHeld, this->preTriggerFrames.front().second);
+        this->preTriggerFrames.pop_front();
+        publishFrame(&pHeld);
+        pHeld->release();
+    }
+    this->pArrays[0] = pArray;
+    tagTriggerFrame(pArray, frameNumber);
+    return true;
+}
+
+
+/**
+ * Function that adds the trigger ID and trigger offset attributes to a frame
+ * 
+ * @params[in]: pArray      -> NDArray to tag
+ * @params[in]: frameNumber -> trigger engine frame number of the frame
+ * @return:     void
+ */
+void ADEmergentVision::tagTriggerFrame(NDArray* pArray, int64_t frameNumber){
+    epicsInt32 triggerId = this->triggerEngine.getTriggerId();
+    epicsInt32 triggerOffset = (epicsInt32) (frameNumber - this->triggerEngine.getTriggerFrameNumber());
+    pArray->pAttributeList->add("TriggerID", "Content trigger ID", NDAttrInt32, &triggerId);
+    pArray->pAttributeList->add("TriggerOffset", "Frames from the trigger frame", NDAttrInt32, &triggerOffset);
+}
+
+
+/**
+ * Function that releases all held pre trigger frames
+ * 
+ * @return: void
+ */
+void ADEmergentVision::releasePreTriggerFrames(){
+    while(!this->preTriggerFrames.empty()){
+        this->preTriggerFrames.front().first->release();
+        this->preTriggerFrames.pop_front();
+    }
+}
+
+
+/**
+ * Function that applies the output stages to a frame and passes it to plugins. Called from the image thread
+ * with the driver lock held. The lock is released while the plugins are called, so blocking plugins do not
+ * hold up writes to the driver.
+ * 
+ * @params[in,out]: ppArray -> NDArray to publish, replaced if an output stage changes its format
+ * @return:         void
+ */
+void ADEmergentVision::publishFrame(NDArray** ppArray){
+    applyDriverLut(ppArray);
+    applySparseOutput(ppArray);
+    this->unlock();
+    doCallbacksGenericPointer(*ppArray, NDArrayData, 0);
+    this->lock();
+}
+
+
+/**
+ * Function that replaces a frame that is about to be published by its sparse encoding, a 1D UInt8 NDArray
+ * holding the pixels at or above the threshold. The encoding is described by the Codec, SparseSizeX,
+ * SparseSizeY, SparseDataType, SparseNumPixels and SparseBytes attributes, see evtSparseEncoder.h.
+ * Every Nth frame, and any frame where the encoding would not be smaller, is published in full.
+ * It runs after the driver LUT, so the threshold and the encoded values are in the tone mapped domain.
+ * 
+ * @params[in,out]: ppArray -> NDArray holding the current frame, replaced by the encoded frame
+ * @return:         void
+ */
+void ADEmergentVision::applySparseOutput(NDArray** ppArray){
+    const char* functionName = "applySparseOutput";
+    NDArray* pArray = *ppArray;
+    int enable, format, threshold, fullInterval;
+    getIntegerParam(ADEVT_SparseEnable, &enable);
+    if(!enable || pArray->ndims != 2) return;
+    bool is8Bit = (pArray->dataType == NDUInt8 || pArray->dataType == NDInt8);
+    bool is16Bit = (pArray->dataType == NDUInt16 || pArray->dataType == NDInt16);
+    if(!is8Bit && !is16Bit) return;
+
+    getIntegerParam(ADEVT_SparseFullInterval, &fullInterval);
+    bool fullFrame = (fullInterval > 0 && this->framesSinceFullFrame == 0);
+    this->framesSinceFullFrame++;
+    if(fullInterval <= 0 || this->framesSinceFullFrame >= fullInterval) this->framesSinceFullFrame = 0;
+    if(fullFrame) return;
+
+    getIntegerParam(ADEVT_SparseFormat, &format);
+    getIntegerParam(ADEVT_SparseThreshold, &threshold);
+    size_t sizeX = pArray->dims[0].size;
+    size_t sizeY = pArray->dims[1].size;
+    size_t denseBytes = sizeX * sizeY * (is8Bit ? 1 : 2);
+    size_t sparseBytes;
+    if(is8Bit) sparseBytes = this->sparseEncoder.encode((const uint8_t*) pArray->pData, sizeX, sizeY,
+                                                        threshold < 0 ? 0 : threshold, (EVTSparseFormat) format);
+    else sparseBytes = this->sparseEncoder.encode((const uint16_t*) pArray->pData, sizeX, sizeY,
+                                                  threshold < 0 ? 0 : threshold, (EVTSparseFormat) format);
+    setIntegerParam(ADEVT_SparseNumPixels, (int) this->sparseEncoder.getNumPixels());
+    setDoubleParam(ADEVT_SparseRatio, (double) denseBytes / (sparseBytes > 0 ? sparseBytes : 1));
+    if(sparseBytes >= denseBytes) return;
+
+    // an empty frame is sent as a single padding byte, SparseBytes gives the length of the stream
+    size_t dims[1] = {sparseBytes > 0 ? sparseBytes : 1};
+    NDArray* pSparse = pNDArrayPool->alloc(1, dims, NDUInt8, 0, NULL);
+    if(pSparse == NULL){
+        ERR("Unable to allocate sparse array");
+        return;
+    }
+    if(sparseBytes > 0) memcpy(pSparse->pData, this->sparseEncoder.getData(), sparseBytes);
+    else memset(pSparse->pData, 0, 1);
+    pSparse->uniqueId = pArray->uniqueId;
+    pSparse->timeStamp = pArray->timeStamp;
+    pSparse->epicsTS = pArray->epicsTS;
+    pArray->pAttributeList->copy(pSparse->pAttributeList);
+
+    epicsInt32 sparseSizeX = (epicsInt32) sizeX, sparseSizeY = (epicsInt32) sizeY;
+    epicsInt32 sparseDataType = (epicsInt32) pArray->dataType;
+    epicsInt32 sparseNumPixels = (epicsInt32) this->sparseEncoder.getNumPixels();
+    epicsInt32 sparseNumBytes = (epicsInt32) sparseBytes;
+    const char* codec = (format == EVT_SPARSE_RUNS) ? EVT_SPARSE_RUNS_CODEC : EVT_SPARSE_PAIRS_CODEC;
+    pSparse->pAttributeList->add("Codec", "Sparse encoding", NDAttrString, (void*) codec);
+    pSparse->pAttributeList->add("SparseSizeX", "Width of the encoded frame", NDAttrInt32, &sparseSizeX);
+    pSparse->pAttributeList->add("SparseSizeY", "Height of the encoded frame", NDAttrInt32, &sparseSizeY);
+    pSparse->pAttributeList->add("SparseDataType", "NDDataType of the encoded frame", NDAttrInt32, &sparseDataType);
+    pSparse->pAttributeList->add("SparseNumPixels", "Number of encoded pixels", NDAttrInt32, &sparseNumPixels);
+    pSparse->pAttributeList->add("SparseBytes", "Length of the encoded stream", NDAttrInt32, &sparseNumBytes);
+
+    pArray->release();
+    this->pArrays[0] = pSparse;
+    *ppArray = pSparse;
+}
+
+
+/**
+ * Wrapper function that accepts a void pointer as an input and output, and starts
+ * the main callback loop
+ * 
+ * @params: pPtr -> void pointer referencing the current driver object instance
+ * @returns: NULL pointer
+ */
+void* ADEmergentVision::evtCallbackWrapper(void* pPtr){
+    ADEmergentVision* pEVT = (ADEmergentVision*) pPtr;
+    pEVT->evtCallback();
+    return NULL;
+}
+
+
+/**
+ * Function that prefaults, and optionally locks in memory, the frame buffers of the image thread, so that
+ * the first frames of an acquisition are not slowed by page faults. Zero copy buffers may already be
+ * pinned by the SDK, in which case locking them again does nothing.
+ * 
+ * @params[in]: pFrame          -> frame buffer the camera writes into
+ * @params[in]: pConvertFrame   -> frame buffer for bit depth conversion
+ * @return: void
+ */
+void ADEmergentVision::prepareFrameBuffers(CEmergentFrame* pFrame, CEmergentFrame* pConvertFrame){
+    const char* functionName = "prepareFrameBuffers";
+    int prefault = 0, lockBuffers = 0;
+    this->lock();
+    getIntegerParam(ADEVT_PrefaultBuffers, &prefault);
+    getIntegerParam(ADEVT_LockBuffers, &lockBuffers);
+    this->unlock();
+
+    CEmergentFrame* frames[2] = {pFrame, pConvertFrame};
+    this->frameBuffersLocked = (lockBuffers != 0);
+    for(int i = 0; i < 2; i++){
+        if(prefault || lockBuffers) EVTPrefault::touch(frames[i]->imagePtr, frames[i]->bufferSize);
+        if(lockBuffers && !EVTPrefault::lock(frames[i]->imagePtr, frames[i]->bufferSize)) this->frameBuffersLocked = false;
+    }
+    if(lockBuffers && !this->frameBuffersLocked) ERR("Failed to lock frame buffers in memory, check the memlock limit");
+
+    this->lock();
+    setIntegerParam(ADEVT_BuffersLocked, this->frameBuffersLocked ? 1 : 0);
+    callParamCallbacks();
+    this->unlock();
+}
+
+
+/**
+ * Function that unlocks and releases the frame buffers of the image thread
+ * 
+ * @params[in]: pFrame          -> frame buffer the camera writes into
+ * @params[in]: pConvertFrame   -> frame buffer for bit depth conversion
+ * @return: void
+ */
+void ADEmergentVision::releaseFrameBuffers(CEmergentFrame* pFrame, CEmergentFrame* pConvertFrame){
+    CEmergentFrame* frames[2] = {pFrame, pConvertFrame};
+    for(int i = 0; i < 2; i++){
+        if(this->frameBuffersLocked) EVTPrefault::unlock(frames[i]->imagePtr, frames[i]->bufferSize);
+        EVT_ERROR err = EVT_ReleaseFrameBuffer(this->pcamera, frames[i]);
+        if (err != EVT_SUCCESS) reportEVTError(err, "EVT_ReleaseFrameBuffer");
+    }
+    this->frameBuffersLocked = false;
+    this->lock();
+    setIntegerParam(ADEVT_BuffersLocked, 0);
+    this->unlock();
+}
+
+
+/**
+ * Function that allocates NDArrays at the current geometry from the driver's pool, touches their pages, and
+ * returns them to the pool. The image thread then reuses these arrays, which are already mapped, rather
+ * than having the pool allocate fresh memory for the first frames.
+ * 
+ * @return: status  -> error if the software crop is outside of the frame
+ */
+asynStatus ADEmergentVision::prewarmArrays(){
+    const char* functionName = "prewarmArrays";
+    int numArrays = 0, sizeX = 0, sizeY = 0, dataType = NDUInt8, colorMode = NDColorModeMono;
+    int ndims, outColorMode;
+    size_t dims[3];
+    getIntegerParam(ADEVT_PrewarmArrays, &numArrays);
+    if(numArrays <= 0) return asynSuccess;
+    getIntegerParam(ADSizeX, &sizeX);
+    getIntegerParam(ADSizeY, &sizeY);
+    getIntegerParam(NDDataType, &dataType);
+    getIntegerParam(NDColorMode, &colorMode);
+    if(sizeX <= 0 || sizeY <= 0) return asynSuccess;
+    if(getArrayDims(colorMode, sizeX, sizeY, &ndims, dims, &outColorMode) != asynSuccess) return asynError;
+
+    vector<NDArray*> arrays;
+    for(int i = 0; i < numArrays; i++){
+        NDArray* pArray = pNDArrayPool->alloc(ndims, dims, (NDDataType_t) dataType, 0, NULL);
+        if(pArray == NULL){
+            ERR_ARGS("Only %d of %d arrays could be pre-allocated, the pool is at its memory limit", i, numArrays);
+            break;
+        }
+        EVTPrefault::touch(pArray->pData, pArray->dataSize);
+        arrays.push_back(pArray);
+    }
+    for(size_t i = 0; i < arrays.size(); i++) arrays[i]->release();
+    return asynSuccess;
+}
+
+
+/**
+ * Function that constantly loops and on each loop, it collects a frame and converts it to an NDArray and
+ * pushes it to the ArrayData PV. It is called from a pthread.
+ * 
+ * @return: void*
+ */
+void ADEmergentVision::evtCallback(){
+    const char* functionName = "evtCallback";
+    int imageMode;
+    CEmergentFrame evtFrame;
+    CEmergentFrame evtFrameConvert;
+    asynStatus status;
+
+    int numFramesCollected = 1;
+    int uniqueIDCounter = 0;
+    int imageCounter;
+    int xsize, ysize;
+    unsigned int evtPixelType;
+    bool buffersAllocated = false;
+    this->imageThreadOpen = 1;
+    getIntegerParam(ADImageMode, &imageMode);
+
+
+    while(this->imageCollectionThreadActive == 1){
+        NDArray* pArray;
+        NDArrayInfo arrayInfo;
+        // One frame for current image, one for conversion if necessary
+
+        getIntegerParam(ADNumImagesCounter, &uniqueIDCounter);
+        getIntegerParam(ADSizeX, &xsize);
+        getIntegerParam(ADSizeY, &ysize);
+        
+        asynStatus current = getFrameFormatEVT(&evtPixelType);
+
+        if(current == asynError){
+            ERR("Error finding evt frame format");
+        }
+        else{
+
+            // variables storing if buffer allocation was successful, and whether evt cam ops were.
+            EVT_ERROR alloc = EVT_SUCCESS;
+            EVT_ERROR err = EVT_SUCCESS;
+
+            // allocate the framer buffers for our frame and conversion frame. They are kept for the whole acquisition,
+            // and only reallocated when the frame size or pixel format changes
+            if(buffersAllocated && (evtFrame.size_x != (unsigned int) xsize || evtFrame.size_y != (unsigned int) ysize ||
+                                    evtFrame.pixel_type != (PIXEL_FORMAT) evtPixelType)){
+                releaseFrameBuffers(&evtFrame, &evtFrameConvert);
+                buffersAllocated = false;
+            }
+            if(!buffersAllocated){
+                // set sizes and pixel formats here
+                evtFrame.size_x = xsize;
+                evtFrame.size_y = ysize;
+                evtFrame.pixel_type = (PIXEL_FORMAT) evtPixelType;
+
+                evtFrameConvert.size_x = xsize;
+                evtFrameConvert.size_y = ysize;
+                evtFrameConvert.pixel_type = (PIXEL_FORMAT) evtPixelType;
+                evtFrameConvert.convertColor = EVT_COLOR_CONVERT_NONE;
+                evtFrameConvert.convertBitDepth = getConvertBitDepth((PIXEL_FORMAT) evtPixelType);
+
+                alloc = EVT_AllocateFrameBuffer(this->pcamera, &evtFrame, EVT_FRAME_BUFFER_ZERO_COPY);
+                if (alloc == EVT_SUCCESS){
+                    alloc = EVT_AllocateFrameBuffer(this->pcamera, &evtFrameConvert, EVT_FRAME_BUFFER_DEFAULT);
+                    if (alloc != EVT_SUCCESS) EVT_ReleaseFrameBuffer(this->pcamera, &evtFrame);
+                }
+                if (alloc == EVT_SUCCESS){
+                    prepareFrameBuffers(&evtFrame, &evtFrameConvert);
+                    buffersAllocated = true;
+                }
+            }
+            
+            if(alloc != EVT_SUCCESS) reportEVTError(alloc, "EVT_AllocateFrameBuffer");
+            else {
+
+                LOG("Queue camera frame");
+                if (alloc == EVT_SUCCESS) err = EVT_CameraQueueFrame(this->pcamera, &evtFrame);
+                if (err != EVT_SUCCESS) reportEVTError(err, "EVT_CameraQueueFrame");
+
+                //asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW, "%s::%s Triggering w/ software\n", driverName, functionName);
+                //if (err == EVT_SUCCESS) err = EVT_CameraExecuteCommand(this->pcamera, "TriggerSoftware");
+                //if (err != EVT_SUCCESS) reportEVTError(err, "EVT_CameraExecuteCommand - TriggerSoftware");
+
+                LOG("Grabbing frame");
+                if (err == EVT_SUCCESS) err = EVT_CameraGetFrame(this->pcamera, &evtFrame, EVT_INFINITE);
+                if (err != EVT_SUCCESS) reportEVTError(err, "EVT_CameraGetFrame");
+                this->frameReceiveTime = chrono::steady_clock::now();
+
+
+                // Only process the frame if we successfully finished all of the above commands.
+                if (err == EVT_SUCCESS) {
+                    this->lock();
+                    // Convert to an ND Array
+                    status = evtFrame2NDArray(&evtFrame, &evtFrameConvert, &pArray);
+                    if (status == asynSuccess) {
+                        //printf("Converted to NDArray\n");
+                        pArray->uniqueId = uniqueIDCounter;
+                        int timeStampSource, trigEnable;
+                        getIntegerParam(ADEVT_CameraTimeStampSource, &timeStampSource);
+                        if(timeStampSource) getCameraTimeStamp(&evtFrame, &pArray->epicsTS);
+                        else updateTimeStamp(&pArray->epicsTS);
+                        pArray->timeStamp = pArray->epicsTS.secPastEpoch + pArray->epicsTS.nsec / ONE_BILLION;
+                        setDoubleParam(ADEVT_CameraTimeStamp, getCameraTimeNs(&evtFrame) / ONE_BILLION);
+
+                        // per frame scalars are published with the timestamp of the frame they were computed from
+                        setTimeStamp(&pArray->epicsTS);
+                        applyColorPipeline(pArray, evtFrame.pixel_type);
+                        captureReference(pArray);
+                        accumulateTemporalStats(pArray);
+                        applyFlatField(&pArray);
+                        applyBackground(pArray);
+                        this->frameMetrics.reset();
+                        computeBeamStats(pArray);
+                        computeRoiStats(pArray);
+                        computeFocus(pArray);
+                        computeDrift(pArray);
+                        publishUdpFeedback(pArray, &evtFrame);
+                        dispatchFrameConsumers(pArray, &evtFrame);
+                        submitSyncFrame(pArray, &evtFrame);
+                        publishSharedFrame(pArray, &evtFrame);
+                        publishStreamFrame(pArray, &evtFrame);
+
+                        evaluateTrigger();
+
+                        // recording windows are counted in camera frames, so with the trigger enabled every frame
+                        // reaches the pre trigger buffer, and decimation and change suppression are not applied
+                        getIntegerParam(ADEVT_TrigEnable, &trigEnable);
+                        if(trigEnable){
+                            if(isFrameTriggered(pArray)) publishFrame(&pArray);
+                        }
+                        else if(isFramePublished() && isFrameChanged(pArray)){
+                            acceptChangedFrame();
+                            publishFrame(&pArray);
+                        }
+                        pArray->getInfo(&arrayInfo);
+                        size_t total_size = arrayInfo.totalBytes;
+                        setIntegerParam(NDArraySize, (int)total_size);
+                        setIntegerParam(NDArraySizeX, arrayInfo.xSize);
+                        setIntegerParam(NDArraySizeY, arrayInfo.ySize);
+
+                        pArray->release();
+                    }
+
+                    // Update the image counter
+                    getIntegerParam(NDArrayCounter, &imageCounter);
+                    imageCounter++;
+                    setIntegerParam(NDArrayCounter, imageCounter);
+                    callParamCallbacks();
+                    this->unlock();
+
+                    if (status == asynError) {
+                        this->imageThreadOpen = 0;
+                        ERR("Error converting to NDArray");
+                        acquireStop();
+                        break;
+                    }
+                    if (imageMode == ADImageSingle) {
+                        this->imageThreadOpen = 0;
+                        acquireStop();
+                    }
+                    else if (imageMode == ADImageMultiple) {
+                        int numImages;
+                        getIntegerParam(ADNumImages, &numImages);
+
+                        if (numFramesCollected == numImages) {
+                            this->imageThreadOpen = 0;
+                            acquireStop();
+                        }
+                    }
+                }
+                else{
+                    reportEVTError(err, functionName);
+                }
+            }
+        }
+        // count the number of frames in the current acquisition
+        numFramesCollected++;
+    }
+    if(buffersAllocated) releaseFrameBuffers(&evtFrame, &evtFrameConvert);
+    this->imageThreadOpen = 0;
+}
+
+
+// -----------------------------------------------------------------------
+// ADEmergentVision Camera Functions (Exposure, Format, Gain etc.)
+// -----------------------------------------------------------------------
+
+
+/**
+ * Function that stores the table to upload to the camera LUT. The table is resampled to the
+ * size of the camera LUT when the upload starts.
+ * 
+ * @params[in]: value       -> LUT output values
+ * @params[in]: nElements   -> number of values
+ * @return:     status
+ */
+asynStatus ADEmergentVision::setCameraLutTable(epicsInt32* value, size_t nElements){
+    this->cameraLutRequested.assign(value, value + nElements);
+    if(nElements > 0) doCallbacksInt32Array(&this->cameraLutRequested[0], nElements, ADEVT_CameraLutTable, 0);
+    return asynSuccess;
+}
+
+
+/**
+ * Function that starts uploading the requested table to the camera LUT, or reading the camera LUT back,
+ * on a separate thread. The requested table is linearly resampled to the number of camera LUT entries,
+ * and clamped to the largest LUTValue.
+ * 
+ * @params[in]: upload  -> 1 to upload the requested table, 0 to read back the camera LUT
+ * @return:     status  -> error if there is no camera, camera LUT, or table, or if acquiring or a transfer is running
+ */
+asynStatus ADEmergentVision::startCameraLutTransfer(int upload){
+    const char* functionName = "startCameraLutTransfer";
+    if(!this->connected){
+        ERR("No camera connected");
+        return asynError;
+    }
+    if(this->cameraLutBusy){
+        ERR("Camera LUT transfer already in progress");
+        return asynError;
+    }
+    // the transfer thread uses the camera handle without the lock, so it must not share it with the image thread
+    int acquiring;
+    getIntegerParam(ADAcquire, &acquiring);
+    if(acquiring){
+        ERR("Camera LUT can not be transferred while acquiring");
+        return asynError;
+    }
+    if(this->cameraLutThread.joinable()) this->cameraLutThread.join();
+
+    unsigned int maxIndex, maxValue;
+    EVT_ERROR err = EVT_CameraGetUInt32ParamMax(this->pcamera, "LUTIndex", &maxIndex);
+    if(err == EVT_SUCCESS) err = EVT_CameraGetUInt32ParamMax(this->pcamera, "LUTValue", &maxValue);
+    if(err != EVT_SUCCESS){
+        reportEVTError(err, functionName);
+        updateStatus("Camera LUT not available");
+        return asynError;
+    }
+    size_t size = (size_t) maxIndex + 1;
+    setIntegerParam(ADEVT_CameraLutSize, (int) size);
+
+    if(upload){
+        size_t numPoints = this->cameraLutRequested.size();
+        if(numPoints < 2){
+            ERR("Camera LUT table needs at least two points");
+            return asynError;
+        }
+        this->cameraLutTarget.resize(size);
+        for(size_t i = 0; i < size; i++){
+            double position = (size > 1) ? (double) i * (numPoints - 1) / (size - 1) : 0;
+            size_t lower = (size_t) position;
+            if(lower >= numPoints - 1) lower = numPoints - 2;
+            double y = this->cameraLutRequested[lower]
+                        + (this->cameraLutRequested[lower + 1] - this->cameraLutRequested[lower]) * (position - lower);
+            if(y < 0) y = 0;
+            if(y > maxValue) y = maxValue;
+            this->cameraLutTarget[i] = (epicsInt32) (y + 0.5);
+        }
+        // contents of a different size cannot be used to skip entries
+        if(this->cameraLutContents.size() != size) this->cameraLutContentsValid = 0;
+        setIntegerParam(ADEVT_CameraLutVerified, 0);
+    }
+
+    this->cameraLutBusy = 1;
+    this->cameraLutAbort = 0;
+    setIntegerParam(upload ? ADEVT_CameraLutUpload : ADEVT_CameraLutReadback, 1);
+    setIntegerParam(ADEVT_CameraLutProgress, 0);
+    // the size is passed to the thread, which does not read params without the lock
+    this->cameraLutThread = thread(&ADEmergentVision::cameraLutTransfer, this, upload, size);
+    return asynSuccess;
+}
+
+
+/**
+ * Function that aborts a running camera LUT transfer and waits for its thread.
+ * Must be called with the driver lock held.
+ * 
+ * @return: void
+ */
+void ADEmergentVision::stopCameraLutTransfer(){
+    this->cameraLutAbort = 1;
+    if(this->cameraLutThread.joinable()){
+        // the transfer thread takes the lock to publish its progress
+        this->unlock();
+        this->cameraLutThread.join();
+        this->lock();
+    }
+    this->cameraLutContentsValid = 0;
+}
+
+
+/**
+ * Function run on the camera LUT thread. Uploads write LUTIndex/LUTValue only for entries that differ from
+ * the last known camera contents, with the camera LUT disabled while it is written. Readbacks read every
+ * entry, publish them, and compare them to the last uploaded table.
+ * 
+ * @params[in]: upload  -> 1 to upload, 0 to read back
+ * @params[in]: size    -> number of camera LUT entries
+ * @return:     void
+ */
+void ADEmergentVision::cameraLutTransfer(int upload, size_t size){
+    const char* functionName = "cameraLutTransfer";
+    vector<epicsInt32> readback;
+    if(!upload) readback.resize(size);
+
+    epicsTimeStamp start, end;
+    epicsTimeGetCurrent(&start);
+    EVT_ERROR err = EVT_SUCCESS;
+    bool lutEnabled = false;
+    if(upload){
+        err = EVT_CameraGetBoolParam(this->pcamera, "LUTEnable", &lutEnabled);
+        if(err == EVT_SUCCESS && lutEnabled) err = EVT_CameraSetBoolParam(this->pcamera, "LUTEnable", false);
+    }
+
+    int numWritten = 0;
+    size_t i;
+    for(i = 0; i < size && err == EVT_SUCCESS && !this->cameraLutAbort; i++){
+        if(upload){
+            if(this->cameraLutContentsValid && this->cameraLutContents[i] == this->cameraLutTarget[i]) continue;
+            err = EVT_CameraSetUInt32Param(this->pcamera, "LUTIndex", (unsigned int) i);
+            if(err == EVT_SUCCESS) err = EVT_CameraSetUInt32Param(this->pcamera, "LUTValue", (unsigned int) this->cameraLutTarget[i]);
+            numWritten++;
+        }
+        else{
+            unsigned int value = 0;
+            err = EVT_CameraSetUInt32Param(this->pcamera, "LUTIndex", (unsigned int) i);
+            if(err == EVT_SUCCESS) err = EVT_CameraGetUInt32Param(this->pcamera, "LUTValue", &value);
+            readback[i] = (epicsInt32) value;
+        }
+        if((i & 0xFF) == 0xFF){
+            this->lock();
+            setIntegerParam(ADEVT_CameraLutProgress, (int) i + 1);
+            callParamCallbacks();
+            this->unlock();
+        }
+    }
+    if(upload && lutEnabled){
+        EVT_ERROR enableErr = EVT_CameraSetBoolParam(this->pcamera, "LUTEnable", true);
+        if(err == EVT_SUCCESS) err = enableErr;
+    }
+    epicsTimeGetCurrent(&end);
+
+    this->lock();
+    bool complete = (err == EVT_SUCCESS && i == size);
+    if(err != EVT_SUCCESS) reportEVTError(err, functionName);
+    else if(!complete) ERR("Camera LUT transfer aborted");
+
+    if(!complete) this->cameraLutContentsValid = 0;
+    else if(upload){
+        this->cameraLutContents = this->cameraLutTarget;
+        this->cameraLutContentsValid = 1;
+        setIntegerParam(ADEVT_CameraLutWritten, numWritten);
+        LOG_ARGS("Uploaded %d of %d camera LUT entries", numWritten, (int) size);
+    }
+    else{
+        this->cameraLutContents = readback;
+        this->cameraLutContentsValid = 1;
+        doCallbacksInt32Array(&this->cameraLutContents[0], size, ADEVT_CameraLutReadTable, 0);
+        setIntegerParam(ADEVT_CameraLutVerified, readback == this->cameraLutTarget ? 1 : 0);
+    }
+    setDoubleParam(ADEVT_CameraLutTime, epicsTimeDiffInSeconds(&end, &start));
+    setIntegerParam(ADEVT_CameraLutProgress, (int) i);
+    setIntegerParam(upload ? ADEVT_CameraLutUpload : ADEVT_CameraLutReadback, 0);
+    this->cameraLutBusy = 0;
+    callParamCallbacks();
+    this->unlock();
+}
+
+
+/**
+ * Function that checks whether new value for camera parameter is valid
+ * 
+ * @params: newVal -> New integer parameter value
+ * @params: param -> Name of parameter
+ * @returns: valid -> true if new value is OK, false otherwise
+ */
+bool ADEmergentVision::isEVTInt32ParamValid(unsigned int newVal, const char* param){
 
     const char* functionName = "validateEVTInt32Param";
     if(this->connected == 0) return false;
@@ -1140,6 +3465,7 @@ asynStatus ADEmergentVision::writeInt32(asynUser* pasynUser, epicsInt32 value){
                         status = asynError;
                     }
                     else printf("Set camera pixel format parameter: %s\n", pixelFormatStr.c_str());
+                    configureDriverLut();
                 }
                 else{
                     ERR_ARGS("Unsupported Mode! Supported: %s", this->supportedModes);
@@ -1151,6 +3477,68 @@ asynStatus ADEmergentVision::writeInt32(asynUser* pasynUser, epicsInt32 value){
         else if(function == ADEVT_OffsetX) status = setEVTInt32Param((unsigned int) value, "OffsetX");
         else if(function == ADEVT_OffsetY) status = setEVTInt32Param((unsigned int) value, "OffsetY");
         //else if(function == ADEVT_BufferNum) status = setEVTInt32Param((unsigned int) value, "BufferNum");
+        else if(function == ADEVT_DriftEnable || function == ADEVT_DriftThreads) status = configureDriftEstimator();
+        else if(function == ADEVT_UdpEnable || function == ADEVT_UdpPort || function == ADEVT_UdpTtl) status = configureUdpPublisher();
+        else if(function == ADEVT_FfcAcquireDark) status = startReferenceCapture(EVT_REFERENCE_DARK, value);
+        else if(function == ADEVT_FfcAcquireFlat) status = startReferenceCapture(EVT_REFERENCE_FLAT, value);
+        else if(function == ADEVT_DefectEnable) this->flatFieldCorrector.setDefectMap(value ? &this->defectMap : NULL);
+        else if(function == ADEVT_DefectBuild){
+            if(value) status = buildDefectMap();
+            setIntegerParam(ADEVT_DefectBuild, 0);
+        }
+        else if(function == ADEVT_DriverLutMode || function == ADEVT_DriverLutOutputBits) status = configureDriverLut();
+        else if(function == ADEVT_CameraLutUpload || function == ADEVT_CameraLutReadback){
+            if(value) status = startCameraLutTransfer(function == ADEVT_CameraLutUpload);
+            if(status != asynSuccess) setIntegerParam(function, 0);
+        }
+        else if(function == ADEVT_BgMode || function == ADEVT_BgShift || function == ADEVT_BgWindow)
+            status = configureBackground();
+        else if(function == ADEVT_BgReset){
+            if(value){
+                this->backgroundModel.reset();
+                setIntegerParam(ADEVT_BgNumFrames, 0);
+            }
+            setIntegerParam(ADEVT_BgReset, 0);
+        }
+        else if(function == ADEVT_BgPublish){
+            if(value) status = publishBackground();
+            setIntegerParam(ADEVT_BgPublish, 0);
+        }
+        else if(function == ADEVT_PtcAcquire) status = startTemporalStats(value);
+        else if(function == ADEVT_TrigEnable){
+            this->triggerEngine.reset();
+            this->triggerState = EVT_TRIGGER_IDLE;
+            releasePreTriggerFrames();
+        }
+        else if(function == ADEVT_TrigCondition || function == ADEVT_TrigPreFrames || function == ADEVT_TrigPostFrames)
+            status = configureTrigger();
+        else if(function == ADEVT_TrigForce){
+            if(value) this->triggerForced = 1;
+            setIntegerParam(ADEVT_TrigForce, 0);
+        }
+        else if(function == ADBinX || function == ADBinY || function == ADEVT_BinMode || function == ADEVT_BayerSuperpixel)
+            status = configureBinning();
+        else if(function == ADEVT_CropX || function == ADEVT_CropY || function == ADEVT_CropSizeX || function == ADEVT_CropSizeY ||
+                function == ADEVT_Rotation || function == ADReverseX || function == ADReverseY)
+            status = configureFrameTransform();
+        else if(function == ADEVT_CopyMode || function == ADEVT_CopyThreshold) status = configureFrameCopy();
+        else if(function == ADEVT_ExecPriority) EVTExecutor::getInstance().setPriority(this->executorClient, value);
+        else if(function == ADEVT_SyncMatch || function == ADEVT_SyncOutput) status = configureFrameSync();
+        else if(function == ADEVT_ShmEnable || function == ADEVT_ShmSlots) status = configureSharedRing(0);
+        else if(function == ADEVT_StreamEnable || function == ADEVT_StreamPort || function == ADEVT_StreamQueue ||
+                function == ADEVT_StreamZeroCopy) status = configureStreamServer();
+        else if(function == ADEVT_CopyBenchmark){
+            if(value) status = benchmarkFrameCopy();
+            setIntegerParam(ADEVT_CopyBenchmark, 0);
+        }
+        else if(function == ADEVT_ConsumerResume){
+            if(value) resumeFrameConsumers();
+            setIntegerParam(ADEVT_ConsumerResume, 0);
+        }
+        else if(function == ADEVT_DriftSetReference){
+            if(value) this->driftEstimator.requestReference();
+            setIntegerParam(ADEVT_DriftSetReference, 0);
+        }
         else if(function == ADEVT_LUTEnable) status = setEVTBoolParam(value > 0, "LUTEnable");
         else if(function == ADEVT_AutoGain) status = setEVTBoolParam(value > 0, "AutoGain");
         else if(function == ADEVT_BufferMode){
@@ -1206,6 +3594,11 @@ asynStatus ADEmergentVision::writeFloat64(asynUser* pasynUser, epicsFloat64 valu
         unsigned int gain = (unsigned int) (value * 1000);
         status = setEVTInt32Param(gain, "Gain");
     }
+    else if(function == ADEVT_DriverLutGamma) status = configureDriverLut();
+    else if(function == ADEVT_TrigThreshold) status = configureTrigger();
+    else if(function == ADEVT_ColorGainR || function == ADEVT_ColorGainG || function == ADEVT_ColorGainB || function == ADEVT_ColorGamma)
+        status = configureColorPipeline();
+    else if(function == ADEVT_SyncTolerance || function == ADEVT_SyncTimeout) status = configureFrameSync();
     else if(function < ADEVT_FIRST_PARAM){
         status = ADDriver::writeFloat64(pasynUser, value);
     }
@@ -1218,6 +3611,96 @@ asynStatus ADEmergentVision::writeFloat64(asynUser* pasynUser, epicsFloat64 valu
 }
 
 
+/**
+ * Function overwriting asynPortDriver base function.
+ * Used for waveform PVs that configure driver side processing
+ *
+ * @params[in]: pasynUser       -> asyn client who requests a write
+ * @params[in]: value           -> int32 array to write
+ * @params[in]: nElements       -> number of elements in the array
+ * @return:     asynStatus      -> success if write was successful, else failure
+ */
+asynStatus ADEmergentVision::writeInt32Array(asynUser* pasynUser, epicsInt32* value, size_t nElements){
+    int function = pasynUser->reason;
+    asynStatus status = asynSuccess;
+    const char* functionName = "writeInt32Array";
+
+    if(function == ADEVT_RoiDefinitions) status = setRoiDefinitions(value, nElements);
+    else if(function == ADEVT_DriverLutTable) status = setDriverLutTable(value, nElements);
+    else if(function == ADEVT_CameraLutTable) status = setCameraLutTable(value, nElements);
+    else status = ADDriver::writeInt32Array(pasynUser, value, nElements);
+
+    callParamCallbacks();
+    if(status == asynError){
+        ERR_ARGS("ERROR status=%d, function=%d, nElements=%d\n", status, function, (int) nElements);
+    }
+    else LOG_ARGS("function=%d nElements=%d\n", function, (int) nElements);
+    return status;
+}
+
+
+/**
+ * Function overwriting asynPortDriver base function.
+ * Used for float array PVs that configure driver side processing
+ *
+ * @params[in]: pasynUser       -> asyn client who requests a write
+ * @params[in]: value           -> array to write
+ * @params[in]: nElements       -> number of elements to write
+ * @return:     asynStatus      -> success if write was successful, else failure
+ */
+asynStatus ADEmergentVision::writeFloat64Array(asynUser* pasynUser, epicsFloat64* value, size_t nElements){
+    int function = pasynUser->reason;
+    asynStatus status = asynSuccess;
+    const char* functionName = "writeFloat64Array";
+
+    if(function == ADEVT_ColorMatrix) status = setColorMatrix(value, nElements);
+    else status = ADDriver::writeFloat64Array(pasynUser, value, nElements);
+
+    callParamCallbacks();
+    if(status == asynError){
+        ERR_ARGS("ERROR status=%d, function=%d, nElements=%d\n", status, function, (int) nElements);
+    }
+    else LOG_ARGS("function=%d nElements=%d\n", function, (int) nElements);
+    return status;
+}
+
+
+/**
+ * Function overwriting asynNDArrayDriver base function.
+ * Used for string PVs that configure driver side processing
+ *
+ * @params[in]:  pasynUser      -> asyn client who requests a write
+ * @params[in]:  value          -> string to write
+ * @params[in]:  nChars         -> number of characters to write
+ * @params[out]: nActual        -> number of characters written
+ * @return:      asynStatus     -> success if write was successful, else failure
+ */
+asynStatus ADEmergentVision::writeOctet(asynUser* pasynUser, const char* value, size_t nChars, size_t* nActual){
+    int function = pasynUser->reason;
+    asynStatus status = asynSuccess;
+    const char* functionName = "writeOctet";
+
+    if(function < ADEVT_FIRST_PARAM) return ADDriver::writeOctet(pasynUser, value, nChars, nActual);
+
+    setStringParam(function, value);
+    if(function == ADEVT_UdpAddress) status = configureUdpPublisher();
+    else if(function == ADEVT_UdpFields) status = setUdpFields(value);
+    else if(function == ADEVT_FfcDarkFile) status = loadReference(EVT_REFERENCE_DARK, value);
+    else if(function == ADEVT_FfcFlatFile) status = loadReference(EVT_REFERENCE_FLAT, value);
+    else if(function == ADEVT_TrigMetric) status = setTriggerMetric(value);
+    else if(function == ADEVT_SyncGroup) status = configureFrameSync();
+    else if(function == ADEVT_ShmName) status = configureSharedRing(0);
+    *nActual = nChars;
+
+    callParamCallbacks();
+    if(status == asynError){
+        ERR_ARGS("ERROR status=%d, function=%d, value=%s\n", status, function, value);
+    }
+    else LOG_ARGS("function=%d value=%s\n", function, value);
+    return status;
+}
+
+
 /**
  * Function used for reporting ADEmergentVision device and library information to a external
  * log file. The function first prints all GigEVision specific information to the file,
@@ -1262,7 +3745,11 @@ void ADEmergentVision::report(FILE* fp, int details){
  * @params[in]: stackSize       -> size of the driver on the stack
  */
 ADEmergentVision::ADEmergentVision(const char* portName, const char* serialNumber, int maxBuffers, size_t maxMemory, int priority, int stackSize)
-    : ADDriver(portName, 1, (int)NUM_EVT_PARAMS, maxBuffers, maxMemory, asynEnumMask, asynEnumMask, ASYN_CANBLOCK, 1, priority, stackSize){
+    : ADDriver(portName, EVT_NUM_ADDR, (int)NUM_EVT_PARAMS, maxBuffers, maxMemory,
+               asynEnumMask | asynInt32ArrayMask | asynFloat64ArrayMask,
+               asynEnumMask | asynInt32ArrayMask | asynFloat64ArrayMask,
+               ASYN_CANBLOCK | ASYN_MULTIDEVICE, 1, priority, stackSize),
+      driftEstimator(driftResultCallback, this) {
 
     asynStatus status;
 
@@ -1294,10 +3781,238 @@ ADEmergentVision::ADEmergentVision(const char* portName, const char* serialNumbe
     createParam(ADEVT_PacketSizeString,         asynParamInt32,     &ADEVT_PacketSize);
     createParam(ADEVT_LUTEnableString,          asynParamInt32,     &ADEVT_LUTEnable);
     createParam(ADEVT_AutoGainString,           asynParamInt32,     &ADEVT_AutoGain);
+    createParam(ADEVT_DecimationString,         asynParamInt32,     &ADEVT_Decimation);
+    createParam(ADEVT_CameraTimeStampString,    asynParamFloat64,   &ADEVT_CameraTimeStamp);
+    createParam(ADEVT_CameraTimeStampSourceString, asynParamInt32,  &ADEVT_CameraTimeStampSource);
+    createParam(ADEVT_BeamEnableString,         asynParamInt32,     &ADEVT_BeamEnable);
+    createParam(ADEVT_BeamBackgroundString,     asynParamInt32,     &ADEVT_BeamBackground);
+    createParam(ADEVT_BeamThresholdString,      asynParamInt32,     &ADEVT_BeamThreshold);
+    createParam(ADEVT_BeamCentroidXString,      asynParamFloat64,   &ADEVT_BeamCentroidX);
+    createParam(ADEVT_BeamCentroidYString,      asynParamFloat64,   &ADEVT_BeamCentroidY);
+    createParam(ADEVT_BeamSigmaXString,         asynParamFloat64,   &ADEVT_BeamSigmaX);
+    createParam(ADEVT_BeamSigmaYString,         asynParamFloat64,   &ADEVT_BeamSigmaY);
+    createParam(ADEVT_BeamIntensityString,      asynParamFloat64,   &ADEVT_BeamIntensity);
+    createParam(ADEVT_BeamNumPixelsString,      asynParamInt32,     &ADEVT_BeamNumPixels);
+    createParam(ADEVT_RoiEnableString,          asynParamInt32,     &ADEVT_RoiEnable);
+    createParam(ADEVT_RoiDefinitionsString,     asynParamInt32Array, &ADEVT_RoiDefinitions);
+    createParam(ADEVT_RoiNumString,             asynParamInt32,     &ADEVT_RoiNum);
+    createParam(ADEVT_RoiSumString,             asynParamFloat64Array, &ADEVT_RoiSum);
+    createParam(ADEVT_RoiMeanString,            asynParamFloat64Array, &ADEVT_RoiMean);
+    createParam(ADEVT_RoiMaxString,             asynParamFloat64Array, &ADEVT_RoiMax);
+    createParam(ADEVT_RoiCentroidXString,       asynParamFloat64Array, &ADEVT_RoiCentroidX);
+    createParam(ADEVT_RoiCentroidYString,       asynParamFloat64Array, &ADEVT_RoiCentroidY);
+    createParam(ADEVT_DriftEnableString,        asynParamInt32,     &ADEVT_DriftEnable);
+    createParam(ADEVT_DriftThreadsString,       asynParamInt32,     &ADEVT_DriftThreads);
+    createParam(ADEVT_DriftDecimationString,    asynParamInt32,     &ADEVT_DriftDecimation);
+    createParam(ADEVT_DriftRoiXString,          asynParamInt32,     &ADEVT_DriftRoiX);
+    createParam(ADEVT_DriftRoiYString,          asynParamInt32,     &ADEVT_DriftRoiY);
+    createParam(ADEVT_DriftRoiSizeXString,      asynParamInt32,     &ADEVT_DriftRoiSizeX);
+    createParam(ADEVT_DriftRoiSizeYString,      asynParamInt32,     &ADEVT_DriftRoiSizeY);
+    createParam(ADEVT_DriftSetReferenceString,  asynParamInt32,     &ADEVT_DriftSetReference);
+    createParam(ADEVT_DriftXString,             asynParamFloat64,   &ADEVT_DriftX);
+    createParam(ADEVT_DriftYString,             asynParamFloat64,   &ADEVT_DriftY);
+    createParam(ADEVT_DriftQualityString,       asynParamFloat64,   &ADEVT_DriftQuality);
+    createParam(ADEVT_DriftUniqueIdString,      asynParamInt32,     &ADEVT_DriftUniqueId);
+    createParam(ADEVT_DriftDroppedString,       asynParamInt32,     &ADEVT_DriftDropped);
+    createParam(ADEVT_UdpEnableString,          asynParamInt32,     &ADEVT_UdpEnable);
+    createParam(ADEVT_UdpAddressString,         asynParamOctet,     &ADEVT_UdpAddress);
+    createParam(ADEVT_UdpPortString,            asynParamInt32,     &ADEVT_UdpPort);
+    createParam(ADEVT_UdpTtlString,             asynParamInt32,     &ADEVT_UdpTtl);
+    createParam(ADEVT_UdpFieldsString,          asynParamOctet,     &ADEVT_UdpFields);
+    createParam(ADEVT_UdpSentString,            asynParamInt32,     &ADEVT_UdpSent);
+    createParam(ADEVT_UdpErrorsString,          asynParamInt32,     &ADEVT_UdpErrors);
+    createParam(ADEVT_UdpLatencyString,         asynParamFloat64,   &ADEVT_UdpLatency);
+    createParam(ADEVT_UdpLatencyMaxString,      asynParamFloat64,   &ADEVT_UdpLatencyMax);
+    createParam(ADEVT_FfcEnableString,          asynParamInt32,     &ADEVT_FfcEnable);
+    createParam(ADEVT_FfcOutputString,          asynParamInt32,     &ADEVT_FfcOutput);
+    createParam(ADEVT_FfcNumFramesString,       asynParamInt32,     &ADEVT_FfcNumFrames);
+    createParam(ADEVT_FfcAcquireDarkString,     asynParamInt32,     &ADEVT_FfcAcquireDark);
+    createParam(ADEVT_FfcAcquireFlatString,     asynParamInt32,     &ADEVT_FfcAcquireFlat);
+    createParam(ADEVT_FfcProgressString,        asynParamInt32,     &ADEVT_FfcProgress);
+    createParam(ADEVT_FfcDarkFileString,        asynParamOctet,     &ADEVT_FfcDarkFile);
+    createParam(ADEVT_FfcFlatFileString,        asynParamOctet,     &ADEVT_FfcFlatFile);
+    createParam(ADEVT_FfcDarkValidString,       asynParamInt32,     &ADEVT_FfcDarkValid);
+    createParam(ADEVT_FfcFlatValidString,       asynParamInt32,     &ADEVT_FfcFlatValid);
+    createParam(ADEVT_DefectEnableString,       asynParamInt32,     &ADEVT_DefectEnable);
+    createParam(ADEVT_DefectBuildString,        asynParamInt32,     &ADEVT_DefectBuild);
+    createParam(ADEVT_DefectHotSigmaString,     asynParamFloat64,   &ADEVT_DefectHotSigma);
+    createParam(ADEVT_DefectDeadFractionString, asynParamFloat64,   &ADEVT_DefectDeadFraction);
+    createParam(ADEVT_DefectNumHotString,       asynParamInt32,     &ADEVT_DefectNumHot);
+    createParam(ADEVT_DefectNumDeadString,      asynParamInt32,     &ADEVT_DefectNumDead);
+    createParam(ADEVT_DriverLutEnableString,    asynParamInt32,     &ADEVT_DriverLutEnable);
+    createParam(ADEVT_DriverLutModeString,      asynParamInt32,     &ADEVT_DriverLutMode);
+    createParam(ADEVT_DriverLutInputBitsString, asynParamInt32,     &ADEVT_DriverLutInputBits);
+    createParam(ADEVT_DriverLutOutputBitsString, asynParamInt32,    &ADEVT_DriverLutOutputBits);
+    createParam(ADEVT_DriverLutGammaString,     asynParamFloat64,   &ADEVT_DriverLutGamma);
+    createParam(ADEVT_DriverLutTableString,     asynParamInt32Array, &ADEVT_DriverLutTable);
+    createParam(ADEVT_CameraLutTableString,     asynParamInt32Array, &ADEVT_CameraLutTable);
+    createParam(ADEVT_CameraLutReadTableString, asynParamInt32Array, &ADEVT_CameraLutReadTable);
+    createParam(ADEVT_CameraLutUploadString,    asynParamInt32,     &ADEVT_CameraLutUpload);
+    createParam(ADEVT_CameraLutReadbackString,  asynParamInt32,     &ADEVT_CameraLutReadback);
+    createParam(ADEVT_CameraLutSizeString,      asynParamInt32,     &ADEVT_CameraLutSize);
+    createParam(ADEVT_CameraLutProgressString,  asynParamInt32,     &ADEVT_CameraLutProgress);
+    createParam(ADEVT_CameraLutWrittenString,   asynParamInt32,     &ADEVT_CameraLutWritten);
+    createParam(ADEVT_CameraLutVerifiedString,  asynParamInt32,     &ADEVT_CameraLutVerified);
+    createParam(ADEVT_CameraLutTimeString,      asynParamFloat64,   &ADEVT_CameraLutTime);
+    createParam(ADEVT_SparseEnableString,       asynParamInt32,     &ADEVT_SparseEnable);
+    createParam(ADEVT_SparseFormatString,       asynParamInt32,     &ADEVT_SparseFormat);
+    createParam(ADEVT_SparseThresholdString,    asynParamInt32,     &ADEVT_SparseThreshold);
+    createParam(ADEVT_SparseFullIntervalString, asynParamInt32,     &ADEVT_SparseFullInterval);
+    createParam(ADEVT_SparseNumPixelsString,    asynParamInt32,     &ADEVT_SparseNumPixels);
+    createParam(ADEVT_SparseRatioString,        asynParamFloat64,   &ADEVT_SparseRatio);
+    createParam(ADEVT_ChangeEnableString,       asynParamInt32,     &ADEVT_ChangeEnable);
+    createParam(ADEVT_ChangeThresholdString,    asynParamFloat64,   &ADEVT_ChangeThreshold);
+    createParam(ADEVT_ChangeBlockSizeString,    asynParamInt32,     &ADEVT_ChangeBlockSize);
+    createParam(ADEVT_ChangeKeepAliveString,    asynParamFloat64,   &ADEVT_ChangeKeepAlive);
+    createParam(ADEVT_ChangeValueString,        asynParamFloat64,   &ADEVT_ChangeValue);
+    createParam(ADEVT_ChangeSuppressedString,   asynParamInt32,     &ADEVT_ChangeSuppressed);
+    createParam(ADEVT_BgEnableString,           asynParamInt32,     &ADEVT_BgEnable);
+    createParam(ADEVT_BgModeString,             asynParamInt32,     &ADEVT_BgMode);
+    createParam(ADEVT_BgShiftString,            asynParamInt32,     &ADEVT_BgShift);
+    createParam(ADEVT_BgWindowString,           asynParamInt32,     &ADEVT_BgWindow);
+    createParam(ADEVT_BgUpdateIntervalString,   asynParamInt32,     &ADEVT_BgUpdateInterval);
+    createParam(ADEVT_BgSubtractString,         asynParamInt32,     &ADEVT_BgSubtract);
+    createParam(ADEVT_BgResetString,            asynParamInt32,     &ADEVT_BgReset);
+    createParam(ADEVT_BgPublishString,          asynParamInt32,     &ADEVT_BgPublish);
+    createParam(ADEVT_BgNumFramesString,        asynParamInt32,     &ADEVT_BgNumFrames);
+    createParam(ADEVT_PtcNumFramesString,       asynParamInt32,     &ADEVT_PtcNumFrames);
+    createParam(ADEVT_PtcAcquireString,         asynParamInt32,     &ADEVT_PtcAcquire);
+    createParam(ADEVT_PtcDarkString,            asynParamInt32,     &ADEVT_PtcDark);
+    createParam(ADEVT_PtcProgressString,        asynParamInt32,     &ADEVT_PtcProgress);
+    createParam(ADEVT_PtcMeanString,            asynParamFloat64,   &ADEVT_PtcMean);
+    createParam(ADEVT_PtcVarianceString,        asynParamFloat64,   &ADEVT_PtcVariance);
+    createParam(ADEVT_PtcReadNoiseString,       asynParamFloat64,   &ADEVT_PtcReadNoise);
+    createParam(ADEVT_PtcGainString,            asynParamFloat64,   &ADEVT_PtcGain);
+    createParam(ADEVT_FocusEnableString,        asynParamInt32,     &ADEVT_FocusEnable);
+    createParam(ADEVT_FocusMethodString,        asynParamInt32,     &ADEVT_FocusMethod);
+    createParam(ADEVT_FocusRoiXString,          asynParamInt32,     &ADEVT_FocusRoiX);
+    createParam(ADEVT_FocusRoiYString,          asynParamInt32,     &ADEVT_FocusRoiY);
+    createParam(ADEVT_FocusRoiSizeXString,      asynParamInt32,     &ADEVT_FocusRoiSizeX);
+    createParam(ADEVT_FocusRoiSizeYString,      asynParamInt32,     &ADEVT_FocusRoiSizeY);
+    createParam(ADEVT_FocusValueString,         asynParamFloat64,   &ADEVT_FocusValue);
+    createParam(ADEVT_TrigEnableString,         asynParamInt32,     &ADEVT_TrigEnable);
+    createParam(ADEVT_TrigMetricString,         asynParamOctet,     &ADEVT_TrigMetric);
+    createParam(ADEVT_TrigConditionString,      asynParamInt32,     &ADEVT_TrigCondition);
+    createParam(ADEVT_TrigThresholdString,      asynParamFloat64,   &ADEVT_TrigThreshold);
+    createParam(ADEVT_TrigPreFramesString,      asynParamInt32,     &ADEVT_TrigPreFrames);
+    createParam(ADEVT_TrigPostFramesString,     asynParamInt32,     &ADEVT_TrigPostFrames);
+    createParam(ADEVT_TrigForceString,          asynParamInt32,     &ADEVT_TrigForce);
+    createParam(ADEVT_TrigIdString,             asynParamInt32,     &ADEVT_TrigId);
+    createParam(ADEVT_TrigActiveString,         asynParamInt32,     &ADEVT_TrigActive);
+    createParam(ADEVT_CropXString,              asynParamInt32,     &ADEVT_CropX);
+    createParam(ADEVT_CropYString,              asynParamInt32,     &ADEVT_CropY);
+    createParam(ADEVT_CropSizeXString,          asynParamInt32,     &ADEVT_CropSizeX);
+    createParam(ADEVT_CropSizeYString,          asynParamInt32,     &ADEVT_CropSizeY);
+    createParam(ADEVT_RotationString,           asynParamInt32,     &ADEVT_Rotation);
+    createParam(ADEVT_BinModeString,            asynParamInt32,     &ADEVT_BinMode);
+    createParam(ADEVT_BayerSuperpixelString,    asynParamInt32,     &ADEVT_BayerSuperpixel);
+    createParam(ADEVT_BinSoftwareString,        asynParamInt32,     &ADEVT_BinSoftware);
+    createParam(ADEVT_ColorEnableString,        asynParamInt32,     &ADEVT_ColorEnable);
+    createParam(ADEVT_ColorGainRString,         asynParamFloat64,   &ADEVT_ColorGainR);
+    createParam(ADEVT_ColorGainGString,         asynParamFloat64,   &ADEVT_ColorGainG);
+    createParam(ADEVT_ColorGainBString,         asynParamFloat64,   &ADEVT_ColorGainB);
+    createParam(ADEVT_ColorMatrixString,        asynParamFloat64Array, &ADEVT_ColorMatrix);
+    createParam(ADEVT_ColorGammaString,         asynParamFloat64,   &ADEVT_ColorGamma);
+    createParam(ADEVT_ColorAwbString,           asynParamInt32,     &ADEVT_ColorAwb);
+    createParam(ADEVT_CopyModeString,           asynParamInt32,     &ADEVT_CopyMode);
+    createParam(ADEVT_CopyThresholdString,      asynParamInt32,     &ADEVT_CopyThreshold);
+    createParam(ADEVT_CopyActiveThresholdString, asynParamInt32,    &ADEVT_CopyActiveThreshold);
+    createParam(ADEVT_CopyStreamingString,      asynParamInt32,     &ADEVT_CopyStreaming);
+    createParam(ADEVT_CopyBenchmarkString,      asynParamInt32,     &ADEVT_CopyBenchmark);
+    createParam(ADEVT_CopyMemcpyRateString,     asynParamFloat64,   &ADEVT_CopyMemcpyRate);
+    createParam(ADEVT_CopyStreamRateString,     asynParamFloat64,   &ADEVT_CopyStreamRate);
+    createParam(ADEVT_PrewarmArraysString,      asynParamInt32,     &ADEVT_PrewarmArrays);
+    createParam(ADEVT_PrefaultBuffersString,    asynParamInt32,     &ADEVT_PrefaultBuffers);
+    createParam(ADEVT_LockBuffersString,        asynParamInt32,     &ADEVT_LockBuffers);
+    createParam(ADEVT_BuffersLockedString,      asynParamInt32,     &ADEVT_BuffersLocked);
+    createParam(ADEVT_ExecPriorityString,       asynParamInt32,     &ADEVT_ExecPriority);
+    createParam(ADEVT_ExecLatencyMeanString,    asynParamFloat64,   &ADEVT_ExecLatencyMean);
+    createParam(ADEVT_ExecLatencyMaxString,     asynParamFloat64,   &ADEVT_ExecLatencyMax);
+    createParam(ADEVT_ExecTasksString,          asynParamInt32,     &ADEVT_ExecTasks);
+    createParam(ADEVT_ExecStolenString,         asynParamInt32,     &ADEVT_ExecStolen);
+    createParam(ADEVT_ExecQueuedString,         asynParamInt32,     &ADEVT_ExecQueued);
+    createParam(ADEVT_SyncGroupString,          asynParamOctet,     &ADEVT_SyncGroup);
+    createParam(ADEVT_SyncMatchString,          asynParamInt32,     &ADEVT_SyncMatch);
+    createParam(ADEVT_SyncToleranceString,      asynParamFloat64,   &ADEVT_SyncTolerance);
+    createParam(ADEVT_SyncTimeoutString,        asynParamFloat64,   &ADEVT_SyncTimeout);
+    createParam(ADEVT_SyncOutputString,         asynParamInt32,     &ADEVT_SyncOutput);
+    createParam(ADEVT_SyncMembersString,        asynParamInt32,     &ADEVT_SyncMembers);
+    createParam(ADEVT_SyncMatchedString,        asynParamInt32,     &ADEVT_SyncMatched);
+    createParam(ADEVT_SyncUnmatchedString,      asynParamInt32,     &ADEVT_SyncUnmatched);
+    createParam(ADEVT_SyncSetsString,           asynParamInt32,     &ADEVT_SyncSets);
+    createParam(ADEVT_ShmEnableString,          asynParamInt32,     &ADEVT_ShmEnable);
+    createParam(ADEVT_ShmNameString,            asynParamOctet,     &ADEVT_ShmName);
+    createParam(ADEVT_ShmSlotsString,           asynParamInt32,     &ADEVT_ShmSlots);
+    createParam(ADEVT_ShmSequenceString,        asynParamInt32,     &ADEVT_ShmSequence);
+    createParam(ADEVT_ShmConsumersString,       asynParamInt32,     &ADEVT_ShmConsumers);
+    createParam(ADEVT_ShmMaxLagString,          asynParamInt32,     &ADEVT_ShmMaxLag);
+    createParam(ADEVT_ShmOverwritesString,      asynParamInt32,     &ADEVT_ShmOverwrites);
+    createParam(ADEVT_StreamEnableString,       asynParamInt32,     &ADEVT_StreamEnable);
+    createParam(ADEVT_StreamPortString,         asynParamInt32,     &ADEVT_StreamPort);
+    createParam(ADEVT_StreamQueueString,        asynParamInt32,     &ADEVT_StreamQueue);
+    createParam(ADEVT_StreamZeroCopyString,     asynParamInt32,     &ADEVT_StreamZeroCopy);
+    createParam(ADEVT_StreamClientsString,      asynParamInt32,     &ADEVT_StreamClients);
+    createParam(ADEVT_StreamSentString,         asynParamInt32,     &ADEVT_StreamSent);
+    createParam(ADEVT_StreamDroppedString,      asynParamInt32,     &ADEVT_StreamDropped);
+    createParam(ADEVT_StreamCopiedString,       asynParamInt32,     &ADEVT_StreamCopied);
+    createParam(ADEVT_StreamErrorsString,       asynParamInt32,     &ADEVT_StreamErrors);
+    createParam(ADEVT_ConsumerBudgetString,     asynParamFloat64,   &ADEVT_ConsumerBudget);
+    createParam(ADEVT_ConsumerCountString,      asynParamInt32,     &ADEVT_ConsumerCount);
+    createParam(ADEVT_ConsumerTimeString,       asynParamFloat64,   &ADEVT_ConsumerTime);
+    createParam(ADEVT_ConsumerTimeMaxString,    asynParamFloat64,   &ADEVT_ConsumerTimeMax);
+    createParam(ADEVT_ConsumerOverrunsString,   asynParamInt32,     &ADEVT_ConsumerOverruns);
+    createParam(ADEVT_ConsumerSkippedString,    asynParamInt32,     &ADEVT_ConsumerSkipped);
+    createParam(ADEVT_ConsumerSuspendedString,  asynParamInt32,     &ADEVT_ConsumerSuspended);
+    createParam(ADEVT_ConsumerResumeString,     asynParamInt32,     &ADEVT_ConsumerResume);
+
+    setIntegerParam(ADEVT_Decimation, 1);
+    setIntegerParam(ADEVT_DriftThreads, 2);
+    setIntegerParam(ADEVT_DriftDecimation, 1);
+    setIntegerParam(ADEVT_UdpTtl, 1);
+    setIntegerParam(ADEVT_FfcNumFrames, 10);
+    setDoubleParam(ADEVT_DefectHotSigma, 6.0);
+    setDoubleParam(ADEVT_DefectDeadFraction, 0.5);
+    setDoubleParam(ADEVT_DriverLutGamma, 2.2);
+    setIntegerParam(ADEVT_SparseThreshold, 100);
+    setDoubleParam(ADEVT_ChangeThreshold, 5.0);
+    setIntegerParam(ADEVT_ChangeBlockSize, 16);
+    setDoubleParam(ADEVT_ChangeKeepAlive, 10.0);
+    setIntegerParam(ADEVT_BgShift, 4);
+    setIntegerParam(ADEVT_BgWindow, 7);
+    setIntegerParam(ADEVT_BgUpdateInterval, 10);
+    configureBackground();
+    setIntegerParam(ADEVT_PtcNumFrames, 100);
+    setIntegerParam(ADEVT_TrigPreFrames, 10);
+    setIntegerParam(ADEVT_TrigPostFrames, 100);
+    configureTrigger();
+    configureFrameTransform();
+    configureBinning();
+    setDoubleParam(ADEVT_ColorGainR, 1.0);
+    setDoubleParam(ADEVT_ColorGainG, 1.0);
+    setDoubleParam(ADEVT_ColorGainB, 1.0);
+    setDoubleParam(ADEVT_ColorGamma, 1.0);
+    configureColorPipeline();
+    configureFrameCopy();
+    setIntegerParam(ADEVT_PrewarmArrays, 4);
+    setIntegerParam(ADEVT_PrefaultBuffers, 1);
+    setIntegerParam(ADEVT_ExecPriority, EVT_EXECUTOR_DEFAULT_PRIORITY);
+    this->executorClient = EVTExecutor::getInstance().registerClient(portName, EVT_EXECUTOR_DEFAULT_PRIORITY);
+    setDoubleParam(ADEVT_SyncTolerance, 100.0);
+    setDoubleParam(ADEVT_SyncTimeout, 1.0);
+    setIntegerParam(ADEVT_ShmSlots, 8);
+    setIntegerParam(ADEVT_StreamPort, 7020);
+    setIntegerParam(ADEVT_StreamQueue, 4);
+    setIntegerParam(ADEVT_StreamZeroCopy, 1);
+    setDoubleParam(ADEVT_ConsumerBudget, 1000.0);
+    configureDriverLut();
 
     if(status == asynError)
         ERR("Failed to connect to device");
 
+    evtDriversMutex.lock();
+    evtDrivers[portName] = this;
+    evtDriversMutex.unlock();
+
     epicsAtExit(exitCallback, (void*) this);
 }
 
@@ -1305,7 +4020,15 @@ ADEmergentVision::ADEmergentVision(const char* portName, const char* serialNumbe
 /* ADEmergentVision Destructor */
 ADEmergentVision::~ADEmergentVision(){
     printf("Uninitializing Emergent Vision Detector API.\n");
+    evtDriversMutex.lock();
+    evtDrivers.erase(this->portName);
+    evtDriversMutex.unlock();
+    if(this->frameSync != NULL) this->frameSync->leave(this->syncMember);
+    this->driftEstimator.stop();
+    EVTExecutor::getInstance().unregisterClient(this->executorClient);
+    this->udpPublisher.close();
     this->lock();
+    stopCameraLutTransfer();
     disconnectFromDeviceEVT();
     this->unlock();
     printf("ADEmergentVision Driver Exiting...\n");
@@ -1343,9 +4066,91 @@ static void configEVTCallFunc(const iocshArgBuf *args) {
 static const iocshFuncDef configEVT = { "ADEmergentVisionConfig", 5, EVTConfigArgs };
 
 
+/* EVTFeedbackListen -> receives and prints UDP feedback datagrams, used to test feedback on loopback */
+static const iocshArg EVTFeedbackListenArg0 = { "Multicast group (empty for unicast)", iocshArgString };
+static const iocshArg EVTFeedbackListenArg1 = { "Port",                     iocshArgInt };
+static const iocshArg EVTFeedbackListenArg2 = { "Number of datagrams",      iocshArgInt };
+static const iocshArg EVTFeedbackListenArg3 = { "Timeout (s)",              iocshArgDouble };
+static const iocshArg * const EVTFeedbackListenArgs[] =
+        { &EVTFeedbackListenArg0, &EVTFeedbackListenArg1, &EVTFeedbackListenArg2, &EVTFeedbackListenArg3 };
+
+static void feedbackListenEVTCallFunc(const iocshArgBuf *args) {
+    evtFeedbackListen(args[0].sval, args[1].ival, args[2].ival, args[3].dval);
+}
+
+static const iocshFuncDef feedbackListenEVT = { "EVTFeedbackListen", 4, EVTFeedbackListenArgs };
+
+
+/* EVTShmRead -> reads and prints frames from a shared memory frame ring, used to test the ring on the IOC host */
+static const iocshArg EVTShmReadArg0 = { "Ring name (port name unless EVTShmName is set)", iocshArgString };
+static const iocshArg EVTShmReadArg1 = { "Number of frames",         iocshArgInt };
+static const iocshArg EVTShmReadArg2 = { "Timeout (s)",              iocshArgDouble };
+static const iocshArg * const EVTShmReadArgs[] = { &EVTShmReadArg0, &EVTShmReadArg1, &EVTShmReadArg2 };
+
+static void shmReadEVTCallFunc(const iocshArgBuf *args) {
+    evtSharedRingRead(args[0].sval, args[1].ival, args[2].dval);
+}
+
+static const iocshFuncDef shmReadEVT = { "EVTShmRead", 3, EVTShmReadArgs };
+
+
+/* EVTStreamListen -> connects to a frame stream server and prints the frames received, used to test the server on loopback */
+static const iocshArg EVTStreamListenArg0 = { "Server address",           iocshArgString };
+static const iocshArg EVTStreamListenArg1 = { "Port",                     iocshArgInt };
+static const iocshArg EVTStreamListenArg2 = { "Number of frames",         iocshArgInt };
+static const iocshArg EVTStreamListenArg3 = { "Timeout (s)",              iocshArgDouble };
+static const iocshArg * const EVTStreamListenArgs[] =
+        { &EVTStreamListenArg0, &EVTStreamListenArg1, &EVTStreamListenArg2, &EVTStreamListenArg3 };
+
+static void streamListenEVTCallFunc(const iocshArgBuf *args) {
+    evtStreamListen(args[0].sval, args[1].ival, args[2].ival, args[3].dval);
+}
+
+static const iocshFuncDef streamListenEVT = { "EVTStreamListen", 4, EVTStreamListenArgs };
+
+
+/* EVTExecutorConfig -> sets the worker count and CPU set of the executor shared by all cameras */
+static const iocshArg EVTExecutorConfigArg0 = { "Number of threads (0 for one per core)", iocshArgInt };
+static const iocshArg EVTExecutorConfigArg1 = { "CPU set (such as 0-3,6, empty for any)", iocshArgString };
+static const iocshArg * const EVTExecutorConfigArgs[] = { &EVTExecutorConfigArg0, &EVTExecutorConfigArg1 };
+
+static void executorConfigEVTCallFunc(const iocshArgBuf *args) {
+    evtExecutorConfig(args[0].ival, args[1].sval);
+}
+
+static const iocshFuncDef executorConfigEVT = { "EVTExecutorConfig", 2, EVTExecutorConfigArgs };
+
+
+/* EVTExecutorReport -> prints the workers and the per camera statistics of the shared executor */
+static void executorReportEVTCallFunc(const iocshArgBuf *args) {
+    evtExecutorReport();
+}
+
+static const iocshFuncDef executorReportEVT = { "EVTExecutorReport", 0, NULL };
+
+
+/* EVTConsumerReport -> prints the in-process frame consumers of a camera and the time they take */
+static const iocshArg EVTConsumerReportArg0 = { "Port name", iocshArgString };
+static const iocshArg * const EVTConsumerReportArgs[] = { &EVTConsumerReportArg0 };
+
+static void consumerReportEVTCallFunc(const iocshArgBuf *args) {
+    ADEmergentVision* pEVT = ADEmergentVision::findDriver(args[0].sval != NULL ? args[0].sval : "");
+    if(pEVT == NULL) printf("No ADEmergentVision driver on port %s\n", args[0].sval);
+    else pEVT->reportFrameConsumers(stdout);
+}
+
+static const iocshFuncDef consumerReportEVT = { "EVTConsumerReport", 1, EVTConsumerReportArgs };
+
+
 /* IOC register function */
 static void EVTRegister(void) {
     iocshRegister(&configEVT, configEVTCallFunc);
+    iocshRegister(&feedbackListenEVT, feedbackListenEVTCallFunc);
+    iocshRegister(&shmReadEVT, shmReadEVTCallFunc);
+    iocshRegister(&streamListenEVT, streamListenEVTCallFunc);
+    iocshRegister(&executorConfigEVT, executorConfigEVTCallFunc);
+    iocshRegister(&executorReportEVT, executorReportEVTCallFunc);
+    iocshRegister(&consumerReportEVT, consumerReportEVTCallFunc);
 }
 
 
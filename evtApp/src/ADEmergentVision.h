@@ -28,8 +28,36 @@
 #include <EvtParamAttribute.h>
 #include <gigevisiondeviceinfo.h>
 #include <emergentcameradef.h>
+#include <atomic>
 #include <thread>
+#include <chrono>
+#include <deque>
 #include "ADDriver.h"
+#include "evtBeamStats.h"
+#include "evtRoiStats.h"
+#include "evtDriftEstimator.h"
+#include "evtFrameMetrics.h"
+#include "evtUdpPublisher.h"
+#include "evtFlatField.h"
+#include "evtDefectMap.h"
+#include "evtLookupTable.h"
+#include "evtSparseEncoder.h"
+#include "evtChangeDetector.h"
+#include "evtBackground.h"
+#include "evtTemporalStats.h"
+#include "evtFocusMetric.h"
+#include "evtTriggerEngine.h"
+#include "evtFrameTransform.h"
+#include "evtBinning.h"
+#include "evtColorPipeline.h"
+#include "evtPlanarRgb.h"
+#include "evtFrameCopy.h"
+#include "evtPrefault.h"
+#include "evtExecutor.h"
+#include "evtFrameSync.h"
+#include "evtSharedRing.h"
+#include "evtStreamServer.h"
+#include "evtFrameConsumers.h"
 
 using namespace std;
 using namespace Emergent;
@@ -46,6 +74,244 @@ using namespace Emergent;
 #define ADEVT_PacketSizeString              "EVT_PACKET"               //asynParamInt32
 #define ADEVT_LUTEnableString               "EVT_LUT"                  //asynParamInt32
 #define ADEVT_AutoGainString                "EVT_AUTOGAIN"             //asynParamInt32
+#define ADEVT_DecimationString              "EVT_DECIMATION"           //asynParamInt32
+#define ADEVT_CameraTimeStampString         "EVT_CAM_TIMESTAMP"        //asynParamFloat64
+#define ADEVT_CameraTimeStampSourceString   "EVT_CAM_TS_SOURCE"        //asynParamInt32
+
+// Beam statistics PV Definitions
+#define ADEVT_BeamEnableString              "EVT_BEAM_ENABLE"          //asynParamInt32
+#define ADEVT_BeamBackgroundString          "EVT_BEAM_BACKGROUND"      //asynParamInt32
+#define ADEVT_BeamThresholdString           "EVT_BEAM_THRESHOLD"       //asynParamInt32
+#define ADEVT_BeamCentroidXString           "EVT_BEAM_CX"              //asynParamFloat64
+#define ADEVT_BeamCentroidYString           "EVT_BEAM_CY"              //asynParamFloat64
+#define ADEVT_BeamSigmaXString              "EVT_BEAM_SX"              //asynParamFloat64
+#define ADEVT_BeamSigmaYString              "EVT_BEAM_SY"              //asynParamFloat64
+#define ADEVT_BeamIntensityString           "EVT_BEAM_INTENSITY"       //asynParamFloat64
+#define ADEVT_BeamNumPixelsString           "EVT_BEAM_NPIXELS"         //asynParamInt32
+
+// Multi-ROI statistics PV Definitions
+#define ADEVT_RoiEnableString               "EVT_ROI_ENABLE"           //asynParamInt32
+#define ADEVT_RoiDefinitionsString          "EVT_ROI_DEFS"             //asynParamInt32Array
+#define ADEVT_RoiNumString                  "EVT_ROI_NUM"              //asynParamInt32
+#define ADEVT_RoiSumString                  "EVT_ROI_SUM"              //asynParamFloat64Array
+#define ADEVT_RoiMeanString                 "EVT_ROI_MEAN"             //asynParamFloat64Array
+#define ADEVT_RoiMaxString                  "EVT_ROI_MAX"              //asynParamFloat64Array
+#define ADEVT_RoiCentroidXString            "EVT_ROI_CX"               //asynParamFloat64Array
+#define ADEVT_RoiCentroidYString            "EVT_ROI_CY"               //asynParamFloat64Array
+
+// Drift estimation PV Definitions
+#define ADEVT_DriftEnableString             "EVT_DRIFT_ENABLE"         //asynParamInt32
+#define ADEVT_DriftThreadsString            "EVT_DRIFT_THREADS"        //asynParamInt32
+#define ADEVT_DriftDecimationString         "EVT_DRIFT_DECIMATION"     //asynParamInt32
+#define ADEVT_DriftRoiXString               "EVT_DRIFT_ROI_X"          //asynParamInt32
+#define ADEVT_DriftRoiYString               "EVT_DRIFT_ROI_Y"          //asynParamInt32
+#define ADEVT_DriftRoiSizeXString           "EVT_DRIFT_ROI_SIZEX"      //asynParamInt32
+#define ADEVT_DriftRoiSizeYString           "EVT_DRIFT_ROI_SIZEY"      //asynParamInt32
+#define ADEVT_DriftSetReferenceString       "EVT_DRIFT_SET_REF"        //asynParamInt32
+#define ADEVT_DriftXString                  "EVT_DRIFT_X"              //asynParamFloat64
+#define ADEVT_DriftYString                  "EVT_DRIFT_Y"              //asynParamFloat64
+#define ADEVT_DriftQualityString            "EVT_DRIFT_QUALITY"        //asynParamFloat64
+#define ADEVT_DriftUniqueIdString           "EVT_DRIFT_UID"            //asynParamInt32
+#define ADEVT_DriftDroppedString            "EVT_DRIFT_DROPPED"        //asynParamInt32
+
+// UDP feedback PV Definitions
+#define ADEVT_UdpEnableString               "EVT_UDP_ENABLE"           //asynParamInt32
+#define ADEVT_UdpAddressString              "EVT_UDP_ADDRESS"          //asynParamOctet
+#define ADEVT_UdpPortString                 "EVT_UDP_PORT"             //asynParamInt32
+#define ADEVT_UdpTtlString                  "EVT_UDP_TTL"              //asynParamInt32
+#define ADEVT_UdpFieldsString               "EVT_UDP_FIELDS"           //asynParamOctet
+#define ADEVT_UdpSentString                 "EVT_UDP_SENT"             //asynParamInt32
+#define ADEVT_UdpErrorsString               "EVT_UDP_ERRORS"           //asynParamInt32
+#define ADEVT_UdpLatencyString              "EVT_UDP_LATENCY"          //asynParamFloat64
+#define ADEVT_UdpLatencyMaxString           "EVT_UDP_LATENCY_MAX"      //asynParamFloat64
+
+// Flat field correction PV Definitions
+#define ADEVT_FfcEnableString               "EVT_FFC_ENABLE"           //asynParamInt32
+#define ADEVT_FfcOutputString               "EVT_FFC_OUTPUT"           //asynParamInt32
+#define ADEVT_FfcNumFramesString            "EVT_FFC_NUM_FRAMES"       //asynParamInt32
+#define ADEVT_FfcAcquireDarkString          "EVT_FFC_ACQ_DARK"         //asynParamInt32
+#define ADEVT_FfcAcquireFlatString          "EVT_FFC_ACQ_FLAT"         //asynParamInt32
+#define ADEVT_FfcProgressString             "EVT_FFC_PROGRESS"         //asynParamInt32
+#define ADEVT_FfcDarkFileString             "EVT_FFC_DARK_FILE"        //asynParamOctet
+#define ADEVT_FfcFlatFileString             "EVT_FFC_FLAT_FILE"        //asynParamOctet
+#define ADEVT_FfcDarkValidString            "EVT_FFC_DARK_VALID"       //asynParamInt32
+#define ADEVT_FfcFlatValidString            "EVT_FFC_FLAT_VALID"       //asynParamInt32
+
+// Defective pixel correction PV Definitions
+#define ADEVT_DefectEnableString            "EVT_DEFECT_ENABLE"        //asynParamInt32
+#define ADEVT_DefectBuildString             "EVT_DEFECT_BUILD"         //asynParamInt32
+#define ADEVT_DefectHotSigmaString          "EVT_DEFECT_HOT_SIGMA"     //asynParamFloat64
+#define ADEVT_DefectDeadFractionString      "EVT_DEFECT_DEAD_FRACTION" //asynParamFloat64
+#define ADEVT_DefectNumHotString            "EVT_DEFECT_NUM_HOT"       //asynParamInt32
+#define ADEVT_DefectNumDeadString           "EVT_DEFECT_NUM_DEAD"      //asynParamInt32
+
+// Driver lookup table PV Definitions
+#define ADEVT_DriverLutEnableString         "EVT_DLUT_ENABLE"          //asynParamInt32
+#define ADEVT_DriverLutModeString           "EVT_DLUT_MODE"            //asynParamInt32
+#define ADEVT_DriverLutInputBitsString      "EVT_DLUT_IN_BITS"         //asynParamInt32
+#define ADEVT_DriverLutOutputBitsString     "EVT_DLUT_OUT_BITS"        //asynParamInt32
+#define ADEVT_DriverLutGammaString          "EVT_DLUT_GAMMA"           //asynParamFloat64
+#define ADEVT_DriverLutTableString          "EVT_DLUT_TABLE"           //asynParamInt32Array
+
+// Camera lookup table upload PV Definitions
+#define ADEVT_CameraLutTableString          "EVT_LUT_TABLE"            //asynParamInt32Array
+#define ADEVT_CameraLutReadTableString      "EVT_LUT_READ_TABLE"       //asynParamInt32Array
+#define ADEVT_CameraLutUploadString         "EVT_LUT_UPLOAD"           //asynParamInt32
+#define ADEVT_CameraLutReadbackString       "EVT_LUT_READBACK"         //asynParamInt32
+#define ADEVT_CameraLutSizeString           "EVT_LUT_SIZE"             //asynParamInt32
+#define ADEVT_CameraLutProgressString       "EVT_LUT_PROGRESS"         //asynParamInt32
+#define ADEVT_CameraLutWrittenString        "EVT_LUT_WRITTEN"          //asynParamInt32
+#define ADEVT_CameraLutVerifiedString       "EVT_LUT_VERIFIED"         //asynParamInt32
+#define ADEVT_CameraLutTimeString           "EVT_LUT_TIME"             //asynParamFloat64
+
+// Sparse output PV Definitions
+#define ADEVT_SparseEnableString            "EVT_SPARSE_ENABLE"        //asynParamInt32
+#define ADEVT_SparseFormatString            "EVT_SPARSE_FORMAT"        //asynParamInt32
+#define ADEVT_SparseThresholdString         "EVT_SPARSE_THRESHOLD"     //asynParamInt32
+#define ADEVT_SparseFullIntervalString      "EVT_SPARSE_FULL_INTERVAL" //asynParamInt32
+#define ADEVT_SparseNumPixelsString         "EVT_SPARSE_NUM_PIXELS"    //asynParamInt32
+#define ADEVT_SparseRatioString             "EVT_SPARSE_RATIO"         //asynParamFloat64
+
+// Change detection PV Definitions
+#define ADEVT_ChangeEnableString            "EVT_CHANGE_ENABLE"        //asynParamInt32
+#define ADEVT_ChangeThresholdString         "EVT_CHANGE_THRESHOLD"     //asynParamFloat64
+#define ADEVT_ChangeBlockSizeString         "EVT_CHANGE_BLOCK_SIZE"    //asynParamInt32
+#define ADEVT_ChangeKeepAliveString         "EVT_CHANGE_KEEP_ALIVE"    //asynParamFloat64
+#define ADEVT_ChangeValueString             "EVT_CHANGE_VALUE"         //asynParamFloat64
+#define ADEVT_ChangeSuppressedString        "EVT_CHANGE_SUPPRESSED"    //asynParamInt32
+
+// Rolling background PV Definitions
+#define ADEVT_BgEnableString                "EVT_BG_ENABLE"            //asynParamInt32
+#define ADEVT_BgModeString                  "EVT_BG_MODE"              //asynParamInt32
+#define ADEVT_BgShiftString                 "EVT_BG_SHIFT"             //asynParamInt32
+#define ADEVT_BgWindowString                "EVT_BG_WINDOW"            //asynParamInt32
+#define ADEVT_BgUpdateIntervalString        "EVT_BG_UPDATE_INTERVAL"   //asynParamInt32
+#define ADEVT_BgSubtractString              "EVT_BG_SUBTRACT"          //asynParamInt32
+#define ADEVT_BgResetString                 "EVT_BG_RESET"             //asynParamInt32
+#define ADEVT_BgPublishString               "EVT_BG_PUBLISH"           //asynParamInt32
+#define ADEVT_BgNumFramesString             "EVT_BG_NUM_FRAMES"        //asynParamInt32
+
+// Photon transfer characterization PV Definitions
+#define ADEVT_PtcNumFramesString            "EVT_PTC_NUM_FRAMES"       //asynParamInt32
+#define ADEVT_PtcAcquireString              "EVT_PTC_ACQUIRE"          //asynParamInt32
+#define ADEVT_PtcDarkString                 "EVT_PTC_DARK"             //asynParamInt32
+#define ADEVT_PtcProgressString             "EVT_PTC_PROGRESS"         //asynParamInt32
+#define ADEVT_PtcMeanString                 "EVT_PTC_MEAN"             //asynParamFloat64
+#define ADEVT_PtcVarianceString             "EVT_PTC_VARIANCE"         //asynParamFloat64
+#define ADEVT_PtcReadNoiseString            "EVT_PTC_READ_NOISE"       //asynParamFloat64
+#define ADEVT_PtcGainString                 "EVT_PTC_GAIN"             //asynParamFloat64
+
+// Focus metric PV Definitions
+#define ADEVT_FocusEnableString             "EVT_FOCUS_ENABLE"         //asynParamInt32
+#define ADEVT_FocusMethodString             "EVT_FOCUS_METHOD"         //asynParamInt32
+#define ADEVT_FocusRoiXString               "EVT_FOCUS_ROI_X"          //asynParamInt32
+#define ADEVT_FocusRoiYString               "EVT_FOCUS_ROI_Y"          //asynParamInt32
+#define ADEVT_FocusRoiSizeXString           "EVT_FOCUS_ROI_SIZE_X"     //asynParamInt32
+#define ADEVT_FocusRoiSizeYString           "EVT_FOCUS_ROI_SIZE_Y"     //asynParamInt32
+#define ADEVT_FocusValueString              "EVT_FOCUS_VALUE"          //asynParamFloat64
+
+// Content trigger PV Definitions
+#define ADEVT_TrigEnableString              "EVT_TRIG_ENABLE"          //asynParamInt32
+#define ADEVT_TrigMetricString              "EVT_TRIG_METRIC"          //asynParamOctet
+#define ADEVT_TrigConditionString           "EVT_TRIG_CONDITION"       //asynParamInt32
+#define ADEVT_TrigThresholdString           "EVT_TRIG_THRESHOLD"       //asynParamFloat64
+#define ADEVT_TrigPreFramesString           "EVT_TRIG_PRE_FRAMES"      //asynParamInt32
+#define ADEVT_TrigPostFramesString          "EVT_TRIG_POST_FRAMES"     //asynParamInt32
+#define ADEVT_TrigForceString               "EVT_TRIG_FORCE"           //asynParamInt32
+#define ADEVT_TrigIdString                  "EVT_TRIG_ID"              //asynParamInt32
+#define ADEVT_TrigActiveString              "EVT_TRIG_ACTIVE"          //asynParamInt32
+
+// Software crop and rotation PV Definitions, flips use ADReverseX/Y
+#define ADEVT_CropXString                   "EVT_CROP_X"               //asynParamInt32
+#define ADEVT_CropYString                   "EVT_CROP_Y"               //asynParamInt32
+#define ADEVT_CropSizeXString               "EVT_CROP_SIZE_X"          //asynParamInt32
+#define ADEVT_CropSizeYString               "EVT_CROP_SIZE_Y"          //asynParamInt32
+#define ADEVT_RotationString                "EVT_ROTATION"             //asynParamInt32
+
+// Software binning PV Definitions, bin factors use ADBinX/Y
+#define ADEVT_BinModeString                 "EVT_BIN_MODE"             //asynParamInt32
+#define ADEVT_BayerSuperpixelString         "EVT_BAYER_SUPERPIXEL"     //asynParamInt32
+#define ADEVT_BinSoftwareString             "EVT_BIN_SOFTWARE"         //asynParamInt32
+
+// Color pipeline PV Definitions
+#define ADEVT_ColorEnableString             "EVT_COLOR_ENABLE"         //asynParamInt32
+#define ADEVT_ColorGainRString              "EVT_COLOR_GAIN_R"         //asynParamFloat64
+#define ADEVT_ColorGainGString              "EVT_COLOR_GAIN_G"         //asynParamFloat64
+#define ADEVT_ColorGainBString              "EVT_COLOR_GAIN_B"         //asynParamFloat64
+#define ADEVT_ColorMatrixString             "EVT_COLOR_MATRIX"         //asynParamFloat64Array
+#define ADEVT_ColorGammaString              "EVT_COLOR_GAMMA"          //asynParamFloat64
+#define ADEVT_ColorAwbString                "EVT_COLOR_AWB"            //asynParamInt32
+
+// Frame copy PV Definitions
+#define ADEVT_CopyModeString                "EVT_COPY_MODE"            //asynParamInt32
+#define ADEVT_CopyThresholdString           "EVT_COPY_THRESHOLD"       //asynParamInt32
+#define ADEVT_CopyActiveThresholdString     "EVT_COPY_ACTIVE_THRESHOLD" //asynParamInt32
+#define ADEVT_CopyStreamingString           "EVT_COPY_STREAMING"       //asynParamInt32
+#define ADEVT_CopyBenchmarkString           "EVT_COPY_BENCHMARK"       //asynParamInt32
+#define ADEVT_CopyMemcpyRateString          "EVT_COPY_MEMCPY_RATE"     //asynParamFloat64
+#define ADEVT_CopyStreamRateString          "EVT_COPY_STREAM_RATE"     //asynParamFloat64
+
+// Acquisition start pre-warm PV Definitions
+#define ADEVT_PrewarmArraysString           "EVT_PREWARM_ARRAYS"       //asynParamInt32
+#define ADEVT_PrefaultBuffersString         "EVT_PREFAULT_BUFFERS"     //asynParamInt32
+#define ADEVT_LockBuffersString             "EVT_LOCK_BUFFERS"         //asynParamInt32
+#define ADEVT_BuffersLockedString           "EVT_BUFFERS_LOCKED"       //asynParamInt32
+
+// Shared executor PV Definitions
+#define ADEVT_ExecPriorityString            "EVT_EXEC_PRIORITY"        //asynParamInt32
+#define ADEVT_ExecLatencyMeanString         "EVT_EXEC_LATENCY_MEAN"    //asynParamFloat64
+#define ADEVT_ExecLatencyMaxString          "EVT_EXEC_LATENCY_MAX"     //asynParamFloat64
+#define ADEVT_ExecTasksString               "EVT_EXEC_TASKS"           //asynParamInt32
+#define ADEVT_ExecStolenString              "EVT_EXEC_STOLEN"          //asynParamInt32
+#define ADEVT_ExecQueuedString              "EVT_EXEC_QUEUED"          //asynParamInt32
+
+// Frame synchronizer PV Definitions
+#define ADEVT_SyncGroupString               "EVT_SYNC_GROUP"           //asynParamOctet
+#define ADEVT_SyncMatchString               "EVT_SYNC_MATCH"           //asynParamInt32
+#define ADEVT_SyncToleranceString           "EVT_SYNC_TOLERANCE"       //asynParamFloat64
+#define ADEVT_SyncTimeoutString             "EVT_SYNC_TIMEOUT"         //asynParamFloat64
+#define ADEVT_SyncOutputString              "EVT_SYNC_OUTPUT"          //asynParamInt32
+#define ADEVT_SyncMembersString             "EVT_SYNC_MEMBERS"         //asynParamInt32
+#define ADEVT_SyncMatchedString             "EVT_SYNC_MATCHED"         //asynParamInt32
+#define ADEVT_SyncUnmatchedString           "EVT_SYNC_UNMATCHED"       //asynParamInt32
+#define ADEVT_SyncSetsString                "EVT_SYNC_SETS"            //asynParamInt32
+
+// Shared memory frame ring PV Definitions
+#define ADEVT_ShmEnableString               "EVT_SHM_ENABLE"           //asynParamInt32
+#define ADEVT_ShmNameString                 "EVT_SHM_NAME"             //asynParamOctet
+#define ADEVT_ShmSlotsString                "EVT_SHM_SLOTS"            //asynParamInt32
+#define ADEVT_ShmSequenceString             "EVT_SHM_SEQUENCE"         //asynParamInt32
+#define ADEVT_ShmConsumersString            "EVT_SHM_CONSUMERS"        //asynParamInt32
+#define ADEVT_ShmMaxLagString               "EVT_SHM_MAX_LAG"          //asynParamInt32
+#define ADEVT_ShmOverwritesString           "EVT_SHM_OVERWRITES"       //asynParamInt32
+
+// TCP frame stream PV Definitions
+#define ADEVT_StreamEnableString            "EVT_STREAM_ENABLE"        //asynParamInt32
+#define ADEVT_StreamPortString              "EVT_STREAM_PORT"          //asynParamInt32
+#define ADEVT_StreamQueueString             "EVT_STREAM_QUEUE"         //asynParamInt32
+#define ADEVT_StreamZeroCopyString          "EVT_STREAM_ZERO_COPY"     //asynParamInt32
+#define ADEVT_StreamClientsString           "EVT_STREAM_CLIENTS"       //asynParamInt32
+#define ADEVT_StreamSentString              "EVT_STREAM_SENT"          //asynParamInt32
+#define ADEVT_StreamDroppedString           "EVT_STREAM_DROPPED"       //asynParamInt32
+#define ADEVT_StreamCopiedString            "EVT_STREAM_COPIED"        //asynParamInt32
+#define ADEVT_StreamErrorsString            "EVT_STREAM_ERRORS"        //asynParamInt32
+
+// In-process frame consumer PV Definitions
+#define ADEVT_ConsumerBudgetString          "EVT_CONSUMER_BUDGET"      //asynParamFloat64
+#define ADEVT_ConsumerCountString           "EVT_CONSUMER_COUNT"       //asynParamInt32
+#define ADEVT_ConsumerTimeString            "EVT_CONSUMER_TIME"        //asynParamFloat64
+#define ADEVT_ConsumerTimeMaxString         "EVT_CONSUMER_TIME_MAX"    //asynParamFloat64
+#define ADEVT_ConsumerOverrunsString        "EVT_CONSUMER_OVERRUNS"    //asynParamInt32
+#define ADEVT_ConsumerSkippedString         "EVT_CONSUMER_SKIPPED"     //asynParamInt32
+#define ADEVT_ConsumerSuspendedString       "EVT_CONSUMER_SUSPENDED"   //asynParamInt32
+#define ADEVT_ConsumerResumeString          "EVT_CONSUMER_RESUME"      //asynParamInt32
+
+// NDArray addresses of the auxiliary outputs, frames are published on address 0
+#define EVT_BACKGROUND_ADDR     1
+#define EVT_MEAN_MAP_ADDR       2
+#define EVT_VARIANCE_MAP_ADDR   3
+#define EVT_SYNC_ADDR           4
+#define EVT_NUM_ADDR            5
 
 
 class ADEmergentVision : ADDriver {
@@ -58,9 +324,18 @@ class ADEmergentVision : ADDriver {
         // ADDriver overrides
         virtual asynStatus writeInt32(asynUser* pasynUser, epicsInt32 value);
         virtual asynStatus writeFloat64(asynUser* pasynUser, epicsFloat64 value);
+        virtual asynStatus writeInt32Array(asynUser* pasynUser, epicsInt32* value, size_t nElements);
+        virtual asynStatus writeFloat64Array(asynUser* pasynUser, epicsFloat64* value, size_t nElements);
+        virtual asynStatus writeOctet(asynUser* pasynUser, const char* value, size_t nChars, size_t* nActual);
         virtual asynStatus connect(asynUser* pasynUser);
         virtual asynStatus disconnect(asynUser* pasynUser);
 
+        // in-process frame consumers, called on the image thread before the plugins
+        int registerFrameConsumer(const char* name, EVTFrameConsumerCallback callback, void* pUser, double budget);
+        void unregisterFrameConsumer(int consumerId);
+        void reportFrameConsumers(FILE* fp);
+        static ADEmergentVision* findDriver(const char* portName);
+
         // destructor
         ~ADEmergentVision();
 
@@ -77,7 +352,190 @@ class ADEmergentVision : ADDriver {
         int ADEVT_PacketSize;
         int ADEVT_LUTEnable;
         int ADEVT_AutoGain;
-        #define ADEVT_LAST_PARAM   ADEVT_AutoGain
+        int ADEVT_Decimation;
+        int ADEVT_CameraTimeStamp;
+        int ADEVT_CameraTimeStampSource;
+        int ADEVT_BeamEnable;
+        int ADEVT_BeamBackground;
+        int ADEVT_BeamThreshold;
+        int ADEVT_BeamCentroidX;
+        int ADEVT_BeamCentroidY;
+        int ADEVT_BeamSigmaX;
+        int ADEVT_BeamSigmaY;
+        int ADEVT_BeamIntensity;
+        int ADEVT_BeamNumPixels;
+        int ADEVT_RoiEnable;
+        int ADEVT_RoiDefinitions;
+        int ADEVT_RoiNum;
+        int ADEVT_RoiSum;
+        int ADEVT_RoiMean;
+        int ADEVT_RoiMax;
+        int ADEVT_RoiCentroidX;
+        int ADEVT_RoiCentroidY;
+        int ADEVT_DriftEnable;
+        int ADEVT_DriftThreads;
+        int ADEVT_DriftDecimation;
+        int ADEVT_DriftRoiX;
+        int ADEVT_DriftRoiY;
+        int ADEVT_DriftRoiSizeX;
+        int ADEVT_DriftRoiSizeY;
+        int ADEVT_DriftSetReference;
+        int ADEVT_DriftX;
+        int ADEVT_DriftY;
+        int ADEVT_DriftQuality;
+        int ADEVT_DriftUniqueId;
+        int ADEVT_DriftDropped;
+        int ADEVT_UdpEnable;
+        int ADEVT_UdpAddress;
+        int ADEVT_UdpPort;
+        int ADEVT_UdpTtl;
+        int ADEVT_UdpFields;
+        int ADEVT_UdpSent;
+        int ADEVT_UdpErrors;
+        int ADEVT_UdpLatency;
+        int ADEVT_UdpLatencyMax;
+        int ADEVT_FfcEnable;
+        int ADEVT_FfcOutput;
+        int ADEVT_FfcNumFrames;
+        int ADEVT_FfcAcquireDark;
+        int ADEVT_FfcAcquireFlat;
+        int ADEVT_FfcProgress;
+        int ADEVT_FfcDarkFile;
+        int ADEVT_FfcFlatFile;
+        int ADEVT_FfcDarkValid;
+        int ADEVT_FfcFlatValid;
+        int ADEVT_DefectEnable;
+        int ADEVT_DefectBuild;
+        int ADEVT_DefectHotSigma;
+        int ADEVT_DefectDeadFraction;
+        int ADEVT_DefectNumHot;
+        int ADEVT_DefectNumDead;
+        int ADEVT_DriverLutEnable;
+        int ADEVT_DriverLutMode;
+        int ADEVT_DriverLutInputBits;
+        int ADEVT_DriverLutOutputBits;
+        int ADEVT_DriverLutGamma;
+        int ADEVT_DriverLutTable;
+        int ADEVT_CameraLutTable;
+        int ADEVT_CameraLutReadTable;
+        int ADEVT_CameraLutUpload;
+        int ADEVT_CameraLutReadback;
+        int ADEVT_CameraLutSize;
+        int ADEVT_CameraLutProgress;
+        int ADEVT_CameraLutWritten;
+        int ADEVT_CameraLutVerified;
+        int ADEVT_CameraLutTime;
+        int ADEVT_SparseEnable;
+        int ADEVT_SparseFormat;
+        int ADEVT_SparseThreshold;
+        int ADEVT_SparseFullInterval;
+        int ADEVT_SparseNumPixels;
+        int ADEVT_SparseRatio;
+        int ADEVT_ChangeEnable;
+        int ADEVT_ChangeThreshold;
+        int ADEVT_ChangeBlockSize;
+        int ADEVT_ChangeKeepAlive;
+        int ADEVT_ChangeValue;
+        int ADEVT_ChangeSuppressed;
+        int ADEVT_BgEnable;
+        int ADEVT_BgMode;
+        int ADEVT_BgShift;
+        int ADEVT_BgWindow;
+        int ADEVT_BgUpdateInterval;
+        int ADEVT_BgSubtract;
+        int ADEVT_BgReset;
+        int ADEVT_BgPublish;
+        int ADEVT_BgNumFrames;
+        int ADEVT_PtcNumFrames;
+        int ADEVT_PtcAcquire;
+        int ADEVT_PtcDark;
+        int ADEVT_PtcProgress;
+        int ADEVT_PtcMean;
+        int ADEVT_PtcVariance;
+        int ADEVT_PtcReadNoise;
+        int ADEVT_PtcGain;
+        int ADEVT_FocusEnable;
+        int ADEVT_FocusMethod;
+        int ADEVT_FocusRoiX;
+        int ADEVT_FocusRoiY;
+        int ADEVT_FocusRoiSizeX;
+        int ADEVT_FocusRoiSizeY;
+        int ADEVT_FocusValue;
+        int ADEVT_TrigEnable;
+        int ADEVT_TrigMetric;
+        int ADEVT_TrigCondition;
+        int ADEVT_TrigThreshold;
+        int ADEVT_TrigPreFrames;
+        int ADEVT_TrigPostFrames;
+        int ADEVT_TrigForce;
+        int ADEVT_TrigId;
+        int ADEVT_TrigActive;
+        int ADEVT_CropX;
+        int ADEVT_CropY;
+        int ADEVT_CropSizeX;
+        int ADEVT_CropSizeY;
+        int ADEVT_Rotation;
+        int ADEVT_BinMode;
+        int ADEVT_BayerSuperpixel;
+        int ADEVT_BinSoftware;
+        int ADEVT_ColorEnable;
+        int ADEVT_ColorGainR;
+        int ADEVT_ColorGainG;
+        int ADEVT_ColorGainB;
+        int ADEVT_ColorMatrix;
+        int ADEVT_ColorGamma;
+        int ADEVT_ColorAwb;
+        int ADEVT_CopyMode;
+        int ADEVT_CopyThreshold;
+        int ADEVT_CopyActiveThreshold;
+        int ADEVT_CopyStreaming;
+        int ADEVT_CopyBenchmark;
+        int ADEVT_CopyMemcpyRate;
+        int ADEVT_CopyStreamRate;
+        int ADEVT_PrewarmArrays;
+        int ADEVT_PrefaultBuffers;
+        int ADEVT_LockBuffers;
+        int ADEVT_BuffersLocked;
+        int ADEVT_ExecPriority;
+        int ADEVT_ExecLatencyMean;
+        int ADEVT_ExecLatencyMax;
+        int ADEVT_ExecTasks;
+        int ADEVT_ExecStolen;
+        int ADEVT_ExecQueued;
+        int ADEVT_SyncGroup;
+        int ADEVT_SyncMatch;
+        int ADEVT_SyncTolerance;
+        int ADEVT_SyncTimeout;
+        int ADEVT_SyncOutput;
+        int ADEVT_SyncMembers;
+        int ADEVT_SyncMatched;
+        int ADEVT_SyncUnmatched;
+        int ADEVT_SyncSets;
+        int ADEVT_ShmEnable;
+        int ADEVT_ShmName;
+        int ADEVT_ShmSlots;
+        int ADEVT_ShmSequence;
+        int ADEVT_ShmConsumers;
+        int ADEVT_ShmMaxLag;
+        int ADEVT_ShmOverwrites;
+        int ADEVT_StreamEnable;
+        int ADEVT_StreamPort;
+        int ADEVT_StreamQueue;
+        int ADEVT_StreamZeroCopy;
+        int ADEVT_StreamClients;
+        int ADEVT_StreamSent;
+        int ADEVT_StreamDropped;
+        int ADEVT_StreamCopied;
+        int ADEVT_StreamErrors;
+        int ADEVT_ConsumerBudget;
+        int ADEVT_ConsumerCount;
+        int ADEVT_ConsumerTime;
+        int ADEVT_ConsumerTimeMax;
+        int ADEVT_ConsumerOverruns;
+        int ADEVT_ConsumerSkipped;
+        int ADEVT_ConsumerSuspended;
+        int ADEVT_ConsumerResume;
+        #define ADEVT_LAST_PARAM   ADEVT_ConsumerResume
 
     private:
 
@@ -100,6 +558,139 @@ class ADEmergentVision : ADDriver {
     const char* serialNumber;
     int connected = 0;
 
+    // Camera timestamp of the first frame, and the host time it was received, used to convert
+    // camera timestamps to epics timestamps, and the frequency of the camera timestamp clock
+    unsigned int cameraTickFrequency = 1000000000;
+    int cameraTimeStampAnchored = 0;
+    unsigned long long cameraTimeStampAnchorTicks = 0;
+    epicsTimeStamp cameraTimeStampAnchor;
+
+    // Number of frames processed since the last published NDArray
+    int framesSincePublish = 0;
+
+    // Per frame processing kernels
+    EVTBeamStatsKernel beamStatsKernel;
+    EVTRoiStatsEngine roiStatsEngine;
+
+    // ROI list written from the ROI definition PV, picked up by the image thread on the next frame
+    vector<EVTRoi> pendingRois;
+    int roisPending = 0;
+    epicsInt32 roiDefinitions[4 * EVT_MAX_ROIS];
+    size_t numRoiDefinitions = 0;
+    vector<EVTRoiStats> roiStats;
+    vector<epicsFloat64> roiWaveform;
+
+    // Drift estimation against a reference frame, computed on worker threads
+    EVTDriftEstimator driftEstimator;
+    int framesSinceDrift = 0;
+
+    // Scalar results for the current frame, selectable by name
+    EVTFrameMetrics frameMetrics;
+
+    // Host time at which the current frame was received from the camera
+    chrono::steady_clock::time_point frameReceiveTime;
+
+    // Per frame UDP feedback
+    EVTUdpPublisher udpPublisher;
+    vector<EVTMetricSelector> udpSelectors;
+    vector<double> udpValues;
+    double udpLatencyMax = 0;
+
+    // Dark and flat field correction, output type is latched when acquisition starts
+    EVTFlatFieldCorrector flatFieldCorrector;
+    int flatFieldOutput = 0;
+    int flatFieldMismatchReported = 0;
+
+    // Hot and dead pixels found in the references, corrected while the frame is copied
+    EVTDefectMap defectMap;
+
+    // Tone mapping table applied to published frames, and the points of the arbitrary table
+    EVTLookupTable driverLut;
+    vector<double> driverLutPoints;
+    epicsInt32 driverLutTable[EVT_LUT_MAX_POINTS];
+    size_t numDriverLutPoints = 0;
+
+    // Camera LUT transfers run on their own thread, as they take one or two GenICam accesses per entry.
+    // The last uploaded or read back contents are kept, so later uploads only write changed entries.
+    thread cameraLutThread;
+    // shared with the transfer thread, which does not hold the driver lock while it runs
+    atomic<int> cameraLutBusy{0};
+    atomic<int> cameraLutAbort{0};
+    vector<epicsInt32> cameraLutRequested;
+    vector<epicsInt32> cameraLutTarget;
+    vector<epicsInt32> cameraLutContents;
+    int cameraLutContentsValid = 0;
+
+    // Thresholded sparse encoding of published frames
+    EVTSparseEncoder sparseEncoder;
+    int framesSinceFullFrame = 0;
+
+    // Frames too similar to the last published frame are not published, apart from keep alive frames
+    EVTChangeDetector changeDetector;
+    chrono::steady_clock::time_point lastChangePublishTime;
+    // set when the current frame passed the change detector, it becomes the reference once it is published
+    bool changePending = false;
+
+    // Rolling background, updated from every Nth frame on the image thread
+    EVTBackgroundModel backgroundModel;
+    int framesSinceBackgroundUpdate = 0;
+
+    // Per pixel temporal mean and variance, and the spatial averages of the last dark series
+    EVTTemporalStats temporalStats;
+    double ptcDarkMean = 0;
+    double ptcDarkVariance = 0;
+    int ptcDarkValid = 0;
+
+    // Content trigger, frames outside of recording windows are held as pre trigger frames, with their frame number
+    EVTTriggerEngine triggerEngine;
+    EVTMetricSelector triggerSelector;
+    int triggerSelectorValid = 0;
+    int triggerForced = 0;
+    EVTTriggerState triggerState = EVT_TRIGGER_IDLE;
+    deque<pair<NDArray*, int64_t> > preTriggerFrames;
+
+    // Software crop, flips and rotation, applied while copying frames out of the camera buffer
+    EVTFrameTransform frameTransform;
+
+    // Software binning and bayer superpixels, binned frames are staged here when they are also transformed,
+    // and so are transformed RGB frames before they are split into planes
+    EVTBinning frameBinning;
+    vector<uint16_t> binnedFrame;
+
+    // Color pipeline for RGB frames, rebuilt when the bit depth of the frames changes
+    EVTColorPipeline colorPipeline;
+    epicsFloat64 colorMatrix[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    int colorInputBits = 8;
+
+    // Copies frames that need no processing out of the camera buffer, with streaming stores for large frames
+    EVTFrameCopy frameCopy;
+
+    // Set when the image thread's frame buffers were locked in memory
+    bool frameBuffersLocked = false;
+
+    // Client id of this camera on the executor shared by all cameras in the IOC
+    int executorClient = -1;
+
+    // Frame synchronizer group this camera is a member of, NULL if none. The output mode is read by
+    // the callbacks made from the image threads of other cameras, which do not take this driver's lock
+    EVTFrameSync* frameSync = NULL;
+    int syncMember = -1;
+    std::atomic<int> syncOutput{EVT_SYNC_OUTPUT_NONE};
+    int syncSetsPublished = 0;
+
+    // Shared memory ring the processed frames are published to, for readers on the IOC host
+    EVTSharedRing sharedRing;
+
+    // TCP server streaming the processed frames to remote subscribers
+    EVTStreamServer streamServer;
+
+    // Consumers registered by code in the IOC, only used with the driver locked. Overruns and skips are
+    // counted since the last resume
+    EVTFrameConsumers frameConsumers;
+    double consumerTimeMax = 0;
+    int consumerOverruns = 0;
+    int consumerSkipped = 0;
+
     //EVT Camera supported modes
     unsigned long supportedModeSizeReturn = 0;
     char supportedModes[SUPPORTED_MODE_BUFFER_SIZE];
@@ -145,8 +736,86 @@ class ADEmergentVision : ADDriver {
     asynStatus getFrameFormatEVT(unsigned int* evtPixelType);
     asynStatus getConvertFormatEVT(unsigned int* evtPixelType, NDDataType_t dataType, NDColorMode_t colorMode);
     asynStatus getFrameFormatND(CEmergentFrame* frame, NDDataType_t* dataType, NDColorMode_t* colorMode);
+    asynStatus getArrayDims(int colorMode, size_t sizeX, size_t sizeY, int* pNdims, size_t dims[3], int* pOutColorMode);
     asynStatus evtFrame2NDArray(CEmergentFrame* frame, CEmergentFrame* convertFrame, NDArray** pArray);
     unsigned int getConvertBitDepth(PIXEL_FORMAT evtPixelFormat);
+    int getPixelBitDepth(PIXEL_FORMAT evtPixelFormat);
+    asynStatus configureFrameTransform();
+    asynStatus configureBinning();
+    bool isFrameBinned(int colorMode);
+    void copyFrameData(const void* pSrc, size_t sizeX, size_t sizeY, int colorMode, NDArray* pArray, size_t totalBytes);
+    asynStatus configureFrameCopy();
+    asynStatus benchmarkFrameCopy();
+    asynStatus prewarmArrays();
+    void prepareFrameBuffers(CEmergentFrame* pFrame, CEmergentFrame* pConvertFrame);
+    void releaseFrameBuffers(CEmergentFrame* pFrame, CEmergentFrame* pConvertFrame);
+    void readCameraTickFrequency();
+    uint64_t getCameraTimeNs(CEmergentFrame* frame);
+    void getCameraTimeStamp(CEmergentFrame* frame, epicsTimeStamp* pTimeStamp);
+    bool isFramePublished();
+    bool isFrameChanged(NDArray* pArray);
+    void acceptChangedFrame();
+
+    // -----------------------------
+    // EVT Frame processing functions
+    // -----------------------------
+
+    void computeBeamStats(NDArray* pArray);
+    asynStatus setRoiDefinitions(epicsInt32* value, size_t nElements);
+    void computeRoiStats(NDArray* pArray);
+    void computeFocus(NDArray* pArray);
+    asynStatus configureDriftEstimator();
+    void computeDrift(NDArray* pArray);
+    static void driftResultCallback(void* pPvt, const EVTDriftResult* pResult);
+    void publishDriftResult(const EVTDriftResult* pResult);
+    void publishExecutorStats();
+    asynStatus configureFrameSync();
+    void submitSyncFrame(NDArray* pArray, CEmergentFrame* frame);
+    static void syncSetCallback(void* pPvt, std::shared_ptr<EVTSyncSet> pSet);
+    void publishSyncSet(const EVTSyncSet& set);
+    asynStatus configureSharedRing(size_t frameBytes);
+    void publishSharedFrame(NDArray* pArray, CEmergentFrame* frame);
+    asynStatus configureStreamServer();
+    void publishStreamFrame(NDArray* pArray, CEmergentFrame* frame);
+    void dispatchFrameConsumers(NDArray* pArray, CEmergentFrame* frame);
+    void resumeFrameConsumers();
+    asynStatus configureUdpPublisher();
+    asynStatus setUdpFields(const char* fields);
+    void publishUdpFeedback(NDArray* pArray, CEmergentFrame* frame);
+    asynStatus startReferenceCapture(EVTReferenceType type, int start);
+    asynStatus loadReference(EVTReferenceType type, const char* path);
+    void captureReference(NDArray* pArray);
+    void applyFlatField(NDArray** ppArray);
+    asynStatus buildDefectMap();
+    asynStatus configureDriverLut();
+    asynStatus setDriverLutTable(epicsInt32* value, size_t nElements);
+    void applyDriverLut(NDArray** ppArray);
+    void applySparseOutput(NDArray** ppArray);
+    asynStatus configureBackground();
+    void applyBackground(NDArray* pArray);
+    asynStatus publishBackground();
+    asynStatus startTemporalStats(int start);
+    void accumulateTemporalStats(NDArray* pArray);
+    asynStatus publishFloatMaps(const float* pMean, const float* pVariance, size_t sizeX, size_t sizeY, int numFrames);
+    asynStatus configureTrigger();
+    asynStatus setTriggerMetric(const char* metric);
+    void evaluateTrigger();
+    bool isFrameTriggered(NDArray* pArray);
+    void tagTriggerFrame(NDArray* pArray, int64_t frameNumber);
+    void releasePreTriggerFrames();
+    void publishFrame(NDArray** ppArray);
+    asynStatus configureColorPipeline();
+    asynStatus setColorMatrix(epicsFloat64* value, size_t nElements);
+    void applyColorPipeline(NDArray* pArray, PIXEL_FORMAT evtPixelFormat);
+
+    // -----------------------------
+    // EVT Camera LUT functions
+    // -----------------------------
+
+    asynStatus setCameraLutTable(epicsInt32* value, size_t nElements);
+    asynStatus startCameraLutTransfer(int upload);
+    void stopCameraLutTransfer();
+    void cameraLutTransfer(int upload, size_t size);
     
     void evtCallback();
     static void* evtCallbackWrapper(void* pPtr);
@@ -0,0 +1,306 @@
+/**
+ * Source file for the ADEmergentVision rolling background model
+ *
+ * The exponential average is kept in 32 bit fixed point, so an update is a widen, a shift, a subtract and
+ * an arithmetic shift per pixel. The median is an odd-even transposition sort of the history, done on
+ * 16 bytes of pixels at a time with SSE2 min and max. 16 bit pixels are biased by 0x8000, as SSE2 only
+ * has signed 16 bit min and max.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <string.h>
+
+#include "evtSimd.h"
+#include "evtBackground.h"
+
+using namespace std;
+
+
+#ifdef EVT_SIMD_SSE2
+
+/**
+ * One exponential update of 4 pixels widened to 32 bit, returns the rounded background
+ */
+static inline __m128i evtExponentialStep(__m128i pixels, int32_t* pAverage, __m128i fixedShift, __m128i weightShift, __m128i round){
+    __m128i target = _mm_sll_epi32(pixels, fixedShift);
+    __m128i average = _mm_loadu_si128((const __m128i*) pAverage);
+    average = _mm_add_epi32(average, _mm_sra_epi32(_mm_sub_epi32(target, average), weightShift));
+    _mm_storeu_si128((__m128i*) pAverage, average);
+    return _mm_srl_epi32(_mm_add_epi32(average, round), fixedShift);
+}
+
+
+static inline size_t evtExponentialVector(const uint8_t* pData, uint8_t* pBackground, int32_t* pAverage, size_t numPixels,
+                                          __m128i fixedShift, __m128i weightShift, __m128i round){
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for(; i + 16 <= numPixels; i += 16){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pData + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i b0 = evtExponentialStep(_mm_unpacklo_epi16(lo, zero), pAverage + i,      fixedShift, weightShift, round);
+        __m128i b1 = evtExponentialStep(_mm_unpackhi_epi16(lo, zero), pAverage + i + 4,  fixedShift, weightShift, round);
+        __m128i b2 = evtExponentialStep(_mm_unpacklo_epi16(hi, zero), pAverage + i + 8,  fixedShift, weightShift, round);
+        __m128i b3 = evtExponentialStep(_mm_unpackhi_epi16(hi, zero), pAverage + i + 12, fixedShift, weightShift, round);
+        _mm_storeu_si128((__m128i*) (pBackground + i), _mm_packus_epi16(_mm_packs_epi32(b0, b1), _mm_packs_epi32(b2, b3)));
+    }
+    return i;
+}
+
+
+static inline size_t evtExponentialVector(const uint16_t* pData, uint16_t* pBackground, int32_t* pAverage, size_t numPixels,
+                                          __m128i fixedShift, __m128i weightShift, __m128i round){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short) 0x8000);
+    size_t i = 0;
+    for(; i + 8 <= numPixels; i += 8){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pData + i));
+        __m128i b0 = evtExponentialStep(_mm_unpacklo_epi16(v, zero), pAverage + i,     fixedShift, weightShift, round);
+        __m128i b1 = evtExponentialStep(_mm_unpackhi_epi16(v, zero), pAverage + i + 4, fixedShift, weightShift, round);
+        // there is no unsigned 32 to 16 bit pack in SSE2, so pack signed around 0x8000
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(b0, bias32), _mm_sub_epi32(b1, bias32));
+        _mm_storeu_si128((__m128i*) (pBackground + i), _mm_xor_si128(packed, bias16));
+    }
+    return i;
+}
+
+
+static inline void evtSortVectors(__m128i* v, int n, bool is8Bit){
+    for(int round = 0; round < n; round++){
+        for(int j = round & 1; j + 1 < n; j += 2){
+            __m128i a = v[j], b = v[j + 1];
+            v[j]     = is8Bit ? _mm_min_epu8(a, b) : _mm_min_epi16(a, b);
+            v[j + 1] = is8Bit ? _mm_max_epu8(a, b) : _mm_max_epi16(a, b);
+        }
+    }
+}
+
+
+static inline size_t evtMedianVector(const uint8_t* pHistory, uint8_t* pBackground, size_t numPixels, int numFrames){
+    __m128i v[EVT_BACKGROUND_MAX_WINDOW];
+    size_t i = 0;
+    for(; i + 16 <= numPixels; i += 16){
+        for(int f = 0; f < numFrames; f++) v[f] = _mm_loadu_si128((const __m128i*) (pHistory + f * numPixels + i));
+        evtSortVectors(v, numFrames, true);
+        _mm_storeu_si128((__m128i*) (pBackground + i), v[numFrames / 2]);
+    }
+    return i;
+}
+
+
+static inline size_t evtMedianVector(const uint16_t* pHistory, uint16_t* pBackground, size_t numPixels, int numFrames){
+    const __m128i bias = _mm_set1_epi16((short) 0x8000);
+    __m128i v[EVT_BACKGROUND_MAX_WINDOW];
+    size_t i = 0;
+    for(; i + 8 <= numPixels; i += 8){
+        for(int f = 0; f < numFrames; f++) v[f] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pHistory + f * numPixels + i)), bias);
+        evtSortVectors(v, numFrames, false);
+        _mm_storeu_si128((__m128i*) (pBackground + i), _mm_xor_si128(v[numFrames / 2], bias));
+    }
+    return i;
+}
+
+
+static inline size_t evtSubtractVector(uint8_t* pData, const uint8_t* pBackground, size_t numPixels){
+    size_t i = 0;
+    for(; i + 16 <= numPixels; i += 16){
+        __m128i* p = (__m128i*) (pData + i);
+        _mm_storeu_si128(p, _mm_subs_epu8(_mm_loadu_si128(p), _mm_loadu_si128((const __m128i*) (pBackground + i))));
+    }
+    return i;
+}
+
+
+static inline size_t evtSubtractVector(uint16_t* pData, const uint16_t* pBackground, size_t numPixels){
+    size_t i = 0;
+    for(; i + 8 <= numPixels; i += 8){
+        __m128i* p = (__m128i*) (pData + i);
+        _mm_storeu_si128(p, _mm_subs_epu16(_mm_loadu_si128(p), _mm_loadu_si128((const __m128i*) (pBackground + i))));
+    }
+    return i;
+}
+
+#endif
+
+
+EVTBackgroundModel::EVTBackgroundModel()
+    : mode(EVT_BACKGROUND_EXPONENTIAL), shift(4), window(7), sizeX(0), sizeY(0), bytesPerPixel(0),
+      numFrames(0), historyIndex(0) {}
+
+
+/**
+ * Sets the background model parameters
+ *
+ * @params[in]: mode    -> exponential average or windowed median
+ * @params[in]: shift   -> each exponential update is weighted 1/2^shift, 1 to 12
+ * @params[in]: window  -> number of updates in the median window, 1 to 15
+ * @return: void
+ */
+void EVTBackgroundModel::configure(EVTBackgroundMode mode, int shift, int window){
+    if(shift < 1) shift = 1;
+    if(shift > EVT_BACKGROUND_MAX_SHIFT) shift = EVT_BACKGROUND_MAX_SHIFT;
+    if(window < 1) window = 1;
+    if(window > EVT_BACKGROUND_MAX_WINDOW) window = EVT_BACKGROUND_MAX_WINDOW;
+    if(mode != this->mode || (mode == EVT_BACKGROUND_MEDIAN && window != this->window)) reset();
+    this->mode = mode;
+    this->shift = shift;
+    this->window = window;
+}
+
+
+void EVTBackgroundModel::reset(){
+    this->numFrames = 0;
+    this->historyIndex = 0;
+}
+
+
+template <typename T>
+void EVTBackgroundModel::updateExponential(const T* pData, T* pBackground, size_t numPixels, bool first){
+    const int fixedShift = 30 - 8 * (int) sizeof(T);
+    // the first frame initializes the average
+    const int weightShift = first ? 0 : this->shift;
+    int32_t* pAverage = &this->average[0];
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    i = evtExponentialVector(pData, pBackground, pAverage, numPixels, _mm_cvtsi32_si128(fixedShift),
+                             _mm_cvtsi32_si128(weightShift), _mm_set1_epi32(1 << (fixedShift - 1)));
+#endif
+    for(; i < numPixels; i++){
+        int32_t target = (int32_t) pData[i] << fixedShift;
+        pAverage[i] += (target - pAverage[i]) >> weightShift;
+        pBackground[i] = (T) ((pAverage[i] + (1 << (fixedShift - 1))) >> fixedShift);
+    }
+}
+
+
+template <typename T>
+void EVTBackgroundModel::updateMedian(const T* pHistory, T* pBackground, size_t numPixels, int numFrames){
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    i = evtMedianVector(pHistory, pBackground, numPixels, numFrames);
+#endif
+    T values[EVT_BACKGROUND_MAX_WINDOW] = {0};
+    for(; i < numPixels; i++){
+        for(int f = 0; f < numFrames; f++){
+            T value = pHistory[f * numPixels + i];
+            int j = f;
+            for(; j > 0 && values[j - 1] > value; j--) values[j] = values[j - 1];
+            values[j] = value;
+        }
+        pBackground[i] = values[numFrames / 2];
+    }
+}
+
+
+template <typename T>
+void EVTBackgroundModel::updateFrame(const T* pData, size_t sizeX, size_t sizeY, vector<T>& background, vector<T>& history){
+    size_t numPixels = sizeX * sizeY;
+    if(sizeX != this->sizeX || sizeY != this->sizeY || (int) sizeof(T) != this->bytesPerPixel){
+        this->sizeX = sizeX;
+        this->sizeY = sizeY;
+        this->bytesPerPixel = (int) sizeof(T);
+        this->background8.clear();
+        this->background16.clear();
+        this->history8.clear();
+        this->history16.clear();
+        this->average.clear();
+        reset();
+    }
+    background.resize(numPixels);
+
+    if(this->mode == EVT_BACKGROUND_EXPONENTIAL){
+        this->average.resize(numPixels);
+        updateExponential(pData, &background[0], numPixels, this->numFrames == 0);
+        if(this->numFrames < (1 << this->shift)) this->numFrames++;
+    }
+    else{
+        history.resize(numPixels * this->window);
+        memcpy(&history[this->historyIndex * numPixels], pData, numPixels * sizeof(T));
+        this->historyIndex = (this->historyIndex + 1) % this->window;
+        if(this->numFrames < this->window) this->numFrames++;
+        // while the window fills, the first numFrames slots hold the updates so far
+        updateMedian(&history[0], &background[0], numPixels, this->numFrames);
+    }
+}
+
+
+/**
+ * Updates the background with a frame
+ *
+ * @params[in]: pData   -> pointer to image data
+ * @params[in]: sizeX   -> image width
+ * @params[in]: sizeY   -> image height
+ * @return: void
+ */
+void EVTBackgroundModel::update(const uint8_t* pData, size_t sizeX, size_t sizeY){
+    updateFrame(pData, sizeX, sizeY, this->background8, this->history8);
+}
+
+
+void EVTBackgroundModel::update(const uint16_t* pData, size_t sizeX, size_t sizeY){
+    updateFrame(pData, sizeX, sizeY, this->background16, this->history16);
+}
+
+
+bool EVTBackgroundModel::isReady(size_t sizeX, size_t sizeY, int bytesPerPixel) const {
+    return this->numFrames > 0 && sizeX == this->sizeX && sizeY == this->sizeY && bytesPerPixel == this->bytesPerPixel;
+}
+
+
+int EVTBackgroundModel::getNumFrames() const {
+    return this->numFrames;
+}
+
+
+size_t EVTBackgroundModel::getSizeX() const {
+    return this->sizeX;
+}
+
+
+size_t EVTBackgroundModel::getSizeY() const {
+    return this->sizeY;
+}
+
+
+int EVTBackgroundModel::getBytesPerPixel() const {
+    return this->bytesPerPixel;
+}
+
+
+const void* EVTBackgroundModel::getData() const {
+    if(this->numFrames == 0) return NULL;
+    if(this->bytesPerPixel == 1) return &this->background8[0];
+    return &this->background16[0];
+}
+
+
+/**
+ * Subtracts the background from a frame in place, saturating at zero
+ *
+ * @params[in,out]: pData       -> pointer to image data
+ * @params[in]:     numPixels   -> number of pixels, must match the model
+ * @return: void
+ */
+void EVTBackgroundModel::subtract(uint8_t* pData, size_t numPixels) const {
+    const uint8_t* pBackground = &this->background8[0];
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    i = evtSubtractVector(pData, pBackground, numPixels);
+#endif
+    for(; i < numPixels; i++) pData[i] = pData[i] > pBackground[i] ? pData[i] - pBackground[i] : 0;
+}
+
+
+void EVTBackgroundModel::subtract(uint16_t* pData, size_t numPixels) const {
+    const uint16_t* pBackground = &this->background16[0];
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    i = evtSubtractVector(pData, pBackground, numPixels);
+#endif
+    for(; i < numPixels; i++) pData[i] = pData[i] > pBackground[i] ? pData[i] - pBackground[i] : 0;
+}
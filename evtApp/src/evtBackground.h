@@ -0,0 +1,90 @@
+/**
+ * Header file for the ADEmergentVision rolling background model
+ *
+ * Keeps a slowly varying background estimate of mono unsigned 8/16 bit frames, updated with SSE2 integer
+ * arithmetic from every Nth frame, either as an exponential moving average, where each update is
+ * weighted 1/2^shift, or as the per pixel median of the last few updates. The background can be
+ * subtracted from frames in place, saturating at zero.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTBACKGROUND_H
+#define EVTBACKGROUND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Largest number of updates in the median window, and largest exponential weight shift
+#define EVT_BACKGROUND_MAX_WINDOW   15
+#define EVT_BACKGROUND_MAX_SHIFT    12
+
+
+typedef enum {
+    EVT_BACKGROUND_EXPONENTIAL  = 0,
+    EVT_BACKGROUND_MEDIAN       = 1
+} EVTBackgroundMode;
+
+
+class EVTBackgroundModel {
+
+    public:
+
+        EVTBackgroundModel();
+
+        // changing the mode or the median window resets the model
+        void configure(EVTBackgroundMode mode, int shift, int window);
+        void reset();
+
+        // a frame of a different size or bit depth than the model restarts it
+        void update(const uint8_t* pData, size_t sizeX, size_t sizeY);
+        void update(const uint16_t* pData, size_t sizeX, size_t sizeY);
+
+        // true if the model holds a background for frames of this size and bytes per pixel
+        bool isReady(size_t sizeX, size_t sizeY, int bytesPerPixel) const;
+        int getNumFrames() const;
+        size_t getSizeX() const;
+        size_t getSizeY() const;
+        int getBytesPerPixel() const;
+        const void* getData() const;
+
+        // pixel = max(pixel - background, 0), the frame must match the model
+        void subtract(uint8_t* pData, size_t numPixels) const;
+        void subtract(uint16_t* pData, size_t numPixels) const;
+
+    private:
+
+        EVTBackgroundMode mode;
+        int shift;
+        int window;
+
+        size_t sizeX;
+        size_t sizeY;
+        int bytesPerPixel;
+        int numFrames;
+
+        // current background, in the pixel type of the frames
+        std::vector<uint8_t> background8;
+        std::vector<uint16_t> background16;
+
+        // exponential average in fixed point with 30 - bit depth fractional bits
+        std::vector<int32_t> average;
+
+        // last window updates for the median, and the slot of the next update
+        std::vector<uint8_t> history8;
+        std::vector<uint16_t> history16;
+        int historyIndex;
+
+        template <typename T> void updateFrame(const T* pData, size_t sizeX, size_t sizeY,
+                                               std::vector<T>& background, std::vector<T>& history);
+        template <typename T> void updateExponential(const T* pData, T* pBackground, size_t numPixels, bool first);
+        template <typename T> void updateMedian(const T* pHistory, T* pBackground, size_t numPixels, int numFrames);
+};
+
+
+#endif
@@ -0,0 +1,213 @@
+/**
+ * Source file for the ADEmergentVision beam statistics kernel
+ *
+ * Each pixel has the background subtracted (saturating at zero), and is ignored if the result is
+ * below the threshold. The remaining weights are accumulated into a column profile (vertical SIMD adds)
+ * and a row profile (horizontal sums), so the frame is only read once. Centroid and sigma in X and Y
+ * are then computed from the profiles.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "evtSimd.h"
+#include "evtBeamStats.h"
+
+
+EVTBeamStatsKernel::EVTBeamStatsKernel()
+    : background(0), threshold(0) {}
+
+
+/**
+ * Sets the background and threshold used by the next computation
+ *
+ * @params[in]: background  -> constant background level subtracted from each pixel
+ * @params[in]: threshold   -> minimum background subtracted value for a pixel to be counted
+ * @return: void
+ */
+void EVTBeamStatsKernel::configure(unsigned int background, unsigned int threshold){
+    this->background = background;
+    this->threshold = threshold;
+}
+
+
+void EVTBeamStatsKernel::resetProfiles(size_t sizeX, size_t sizeY){
+    this->colProfile.assign(sizeX, 0);
+    this->rowProfile.assign(sizeY, 0);
+}
+
+
+/**
+ * Computes moments from the accumulated row and column profiles
+ *
+ * @params[in]:  numPixels  -> number of pixels above threshold
+ * @params[out]: pStats     -> computed statistics
+ * @return: void
+ */
+void EVTBeamStatsKernel::computeMoments(size_t numPixels, EVTBeamStats* pStats){
+    double sum = 0, sumX = 0, sumX2 = 0, sumY = 0, sumY2 = 0;
+    for(size_t x = 0; x < this->colProfile.size(); x++){
+        double w = (double) this->colProfile[x];
+        sumX += w * x;
+        sumX2 += w * x * x;
+    }
+    for(size_t y = 0; y < this->rowProfile.size(); y++){
+        double w = (double) this->rowProfile[y];
+        sum += w;
+        sumY += w * y;
+        sumY2 += w * y * y;
+    }
+
+    memset(pStats, 0, sizeof(EVTBeamStats));
+    pStats->numPixels = numPixels;
+    pStats->intensity = sum;
+    if(sum <= 0) return;
+
+    pStats->centroidX = sumX / sum;
+    pStats->centroidY = sumY / sum;
+    double varX = sumX2 / sum - pStats->centroidX * pStats->centroidX;
+    double varY = sumY2 / sum - pStats->centroidY * pStats->centroidY;
+    pStats->sigmaX = varX > 0 ? sqrt(varX) : 0;
+    pStats->sigmaY = varY > 0 ? sqrt(varY) : 0;
+}
+
+
+/**
+ * Computes beam statistics for an 8 bit mono image
+ *
+ * @params[in]:  pData  -> pointer to image data, rows are contiguous
+ * @params[in]:  sizeX  -> image width
+ * @params[in]:  sizeY  -> image height
+ * @params[out]: pStats -> computed statistics
+ * @return: void
+ */
+void EVTBeamStatsKernel::compute(const uint8_t* pData, size_t sizeX, size_t sizeY, EVTBeamStats* pStats){
+    resetProfiles(sizeX, sizeY);
+    uint32_t* cols = &this->colProfile[0];
+    uint8_t bg = (uint8_t) (this->background > 0xFF ? 0xFF : this->background);
+    // a pixel must carry some signal after background subtraction to be counted
+    unsigned int thr = this->threshold > 0 ? this->threshold : 1;
+    size_t numPixels = 0;
+
+    for(size_t y = 0; y < sizeY; y++){
+        const uint8_t* row = pData + y * sizeX;
+        uint64_t rowSum = 0;
+        size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+        if(thr <= 0xFF){
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i bgv = _mm_set1_epi8((char) bg);
+            const __m128i thrv = _mm_set1_epi8((char) thr);
+            __m128i rowAcc = _mm_setzero_si128();
+            __m128i countAcc = _mm_setzero_si128();
+            for(; x + 16 <= sizeX; x += 16){
+                __m128i w = _mm_subs_epu8(_mm_loadu_si128((const __m128i*) (row + x)), bgv);
+                // keep pixels where threshold - w saturates to zero, i.e. w >= threshold
+                __m128i keep = _mm_cmpeq_epi8(_mm_subs_epu8(thrv, w), zero);
+                w = _mm_and_si128(w, keep);
+                // SAD against zero gives two 64 bit horizontal sums per register
+                rowAcc = _mm_add_epi64(rowAcc, _mm_sad_epu8(w, zero));
+                countAcc = _mm_add_epi64(countAcc, _mm_sad_epu8(_mm_and_si128(keep, _mm_set1_epi8(1)), zero));
+
+                __m128i lo = _mm_unpacklo_epi8(w, zero);
+                __m128i hi = _mm_unpackhi_epi8(w, zero);
+                __m128i* c = (__m128i*) (cols + x);
+                _mm_storeu_si128(c,     _mm_add_epi32(_mm_loadu_si128(c),     _mm_unpacklo_epi16(lo, zero)));
+                _mm_storeu_si128(c + 1, _mm_add_epi32(_mm_loadu_si128(c + 1), _mm_unpackhi_epi16(lo, zero)));
+                _mm_storeu_si128(c + 2, _mm_add_epi32(_mm_loadu_si128(c + 2), _mm_unpacklo_epi16(hi, zero)));
+                _mm_storeu_si128(c + 3, _mm_add_epi32(_mm_loadu_si128(c + 3), _mm_unpackhi_epi16(hi, zero)));
+            }
+            uint64_t partial[2];
+            _mm_storeu_si128((__m128i*) partial, rowAcc);
+            rowSum += partial[0] + partial[1];
+            _mm_storeu_si128((__m128i*) partial, countAcc);
+            numPixels += (size_t) (partial[0] + partial[1]);
+        }
+#endif
+        for(; x < sizeX; x++){
+            unsigned int w = row[x] > bg ? row[x] - bg : 0;
+            if(w < thr) continue;
+            cols[x] += w;
+            rowSum += w;
+            numPixels++;
+        }
+        this->rowProfile[y] = rowSum;
+    }
+    computeMoments(numPixels, pStats);
+}
+
+
+/**
+ * Computes beam statistics for a 16 bit mono image
+ *
+ * @params[in]:  pData  -> pointer to image data, rows are contiguous
+ * @params[in]:  sizeX  -> image width
+ * @params[in]:  sizeY  -> image height
+ * @params[out]: pStats -> computed statistics
+ * @return: void
+ */
+void EVTBeamStatsKernel::compute(const uint16_t* pData, size_t sizeX, size_t sizeY, EVTBeamStats* pStats){
+    resetProfiles(sizeX, sizeY);
+    uint32_t* cols = &this->colProfile[0];
+    uint16_t bg = (uint16_t) (this->background > 0xFFFF ? 0xFFFF : this->background);
+    // a pixel must carry some signal after background subtraction to be counted
+    unsigned int thr = this->threshold > 0 ? this->threshold : 1;
+    size_t numPixels = 0;
+
+    for(size_t y = 0; y < sizeY; y++){
+        const uint16_t* row = pData + y * sizeX;
+        uint64_t rowSum = 0;
+        size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+        if(thr <= 0xFFFF){
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i bgv = _mm_set1_epi16((short) bg);
+            const __m128i thrv = _mm_set1_epi16((short) thr);
+            __m128i rowAcc = _mm_setzero_si128();
+            __m128i countAcc = _mm_setzero_si128();
+            for(; x + 8 <= sizeX; x += 8){
+                __m128i w = _mm_subs_epu16(_mm_loadu_si128((const __m128i*) (row + x)), bgv);
+                __m128i keep = _mm_cmpeq_epi16(_mm_subs_epu16(thrv, w), zero);
+                w = _mm_and_si128(w, keep);
+                __m128i lo = _mm_unpacklo_epi16(w, zero);
+                __m128i hi = _mm_unpackhi_epi16(w, zero);
+                rowAcc = _mm_add_epi32(rowAcc, _mm_add_epi32(lo, hi));
+                // keep is all ones (-1) for counted pixels
+                countAcc = _mm_sub_epi32(countAcc, _mm_srai_epi32(_mm_unpacklo_epi16(keep, keep), 16));
+                countAcc = _mm_sub_epi32(countAcc, _mm_srai_epi32(_mm_unpackhi_epi16(keep, keep), 16));
+
+                __m128i* c = (__m128i*) (cols + x);
+                _mm_storeu_si128(c,     _mm_add_epi32(_mm_loadu_si128(c),     lo));
+                _mm_storeu_si128(c + 1, _mm_add_epi32(_mm_loadu_si128(c + 1), hi));
+
+                // flush the 32 bit row accumulator before it can overflow
+                if(((x + 8) & 0x3FFF) == 0){
+                    uint32_t lanes[4];
+                    _mm_storeu_si128((__m128i*) lanes, rowAcc);
+                    rowSum += (uint64_t) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+                    rowAcc = _mm_setzero_si128();
+                }
+            }
+            uint32_t lanes[4];
+            _mm_storeu_si128((__m128i*) lanes, rowAcc);
+            rowSum += (uint64_t) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            _mm_storeu_si128((__m128i*) lanes, countAcc);
+            numPixels += (size_t) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+#endif
+        for(; x < sizeX; x++){
+            unsigned int w = row[x] > bg ? row[x] - bg : 0;
+            if(w < thr) continue;
+            cols[x] += w;
+            rowSum += w;
+            numPixels++;
+        }
+        this->rowProfile[y] = rowSum;
+    }
+    computeMoments(numPixels, pStats);
+}
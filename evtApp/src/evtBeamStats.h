@@ -0,0 +1,60 @@
+/**
+ * Header file for the ADEmergentVision beam statistics kernel
+ * 
+ * Computes background subtracted, thresholded first and second moments of a mono image.
+ * The kernel accumulates row and column profiles in a single SIMD pass over the frame, and
+ * the moments are then computed from the profiles.
+ * 
+ * Created On: October-18-2026
+ * 
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ * 
+ */
+
+// header guard
+#ifndef EVTBEAMSTATS_H
+#define EVTBEAMSTATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+
+// Results of a single beam statistics computation
+typedef struct EVTBeamStats {
+    double centroidX;
+    double centroidY;
+    double sigmaX;
+    double sigmaY;
+    double intensity;
+    size_t numPixels;
+} EVTBeamStats;
+
+
+class EVTBeamStatsKernel {
+
+    public:
+
+        EVTBeamStatsKernel();
+
+        // background is subtracted from each pixel, pixels below threshold after subtraction are ignored
+        void configure(unsigned int background, unsigned int threshold);
+
+        void compute(const uint8_t* pData, size_t sizeX, size_t sizeY, EVTBeamStats* pStats);
+        void compute(const uint16_t* pData, size_t sizeX, size_t sizeY, EVTBeamStats* pStats);
+
+    private:
+
+        unsigned int background;
+        unsigned int threshold;
+
+        // column and row profiles of the most recent frame
+        std::vector<uint32_t> colProfile;
+        std::vector<uint64_t> rowProfile;
+
+        void resetProfiles(size_t sizeX, size_t sizeY);
+        void computeMoments(size_t numPixels, EVTBeamStats* pStats);
+};
+
+
+#endif
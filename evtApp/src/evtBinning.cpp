@@ -0,0 +1,300 @@
+/**
+ * Source file for the ADEmergentVision software binning
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <limits>
+
+#include "evtSimd.h"
+#include "evtBinning.h"
+
+using namespace std;
+
+
+// BT.601 luma weights, scaled by 512 with the green weight split over the two green pixels
+#define EVT_LUMA_R      154
+#define EVT_LUMA_G      150
+#define EVT_LUMA_B      58
+#define EVT_LUMA_SHIFT  9
+
+
+#ifdef EVT_SIMD_SSE2
+
+/**
+ * 2x2 bins 8 bit pixels [0, n) of an output row from source rows r0 and r1.
+ * Returns the first output pixel left for the scalar path.
+ */
+static size_t evtBin2x2Row(const uint8_t* r0, const uint8_t* r1, uint8_t* pDst, size_t n, bool average){
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    const __m128i two = _mm_set1_epi16(2);
+    size_t x = 0;
+    for(; x + 16 <= n; x += 16){
+        __m128i a0 = _mm_loadu_si128((const __m128i*) (r0 + 2 * x));
+        __m128i a1 = _mm_loadu_si128((const __m128i*) (r0 + 2 * x + 16));
+        __m128i b0 = _mm_loadu_si128((const __m128i*) (r1 + 2 * x));
+        __m128i b1 = _mm_loadu_si128((const __m128i*) (r1 + 2 * x + 16));
+        // horizontal pairs are summed within each 16 bit lane
+        __m128i s0 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a0, mask), _mm_srli_epi16(a0, 8)),
+                                   _mm_add_epi16(_mm_and_si128(b0, mask), _mm_srli_epi16(b0, 8)));
+        __m128i s1 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a1, mask), _mm_srli_epi16(a1, 8)),
+                                   _mm_add_epi16(_mm_and_si128(b1, mask), _mm_srli_epi16(b1, 8)));
+        if(average){
+            s0 = _mm_srli_epi16(_mm_add_epi16(s0, two), 2);
+            s1 = _mm_srli_epi16(_mm_add_epi16(s1, two), 2);
+        }
+        _mm_storeu_si128((__m128i*) (pDst + x), _mm_packus_epi16(s0, s1));
+    }
+    return x;
+}
+
+
+/**
+ * Packs 32 bit sums to unsigned 16 bits with saturation, by packing with a bias of 32768
+ */
+static inline __m128i evtPackUnsigned32(__m128i a, __m128i b){
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16((short) 0x8000);
+    return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32)), bias16);
+}
+
+
+static size_t evtBin2x2Row(const uint16_t* r0, const uint16_t* r1, uint16_t* pDst, size_t n, bool average){
+    const __m128i mask = _mm_set1_epi32(0xFFFF);
+    const __m128i two = _mm_set1_epi32(2);
+    size_t x = 0;
+    for(; x + 8 <= n; x += 8){
+        __m128i a0 = _mm_loadu_si128((const __m128i*) (r0 + 2 * x));
+        __m128i a1 = _mm_loadu_si128((const __m128i*) (r0 + 2 * x + 8));
+        __m128i b0 = _mm_loadu_si128((const __m128i*) (r1 + 2 * x));
+        __m128i b1 = _mm_loadu_si128((const __m128i*) (r1 + 2 * x + 8));
+        __m128i s0 = _mm_add_epi32(_mm_add_epi32(_mm_and_si128(a0, mask), _mm_srli_epi32(a0, 16)),
+                                   _mm_add_epi32(_mm_and_si128(b0, mask), _mm_srli_epi32(b0, 16)));
+        __m128i s1 = _mm_add_epi32(_mm_add_epi32(_mm_and_si128(a1, mask), _mm_srli_epi32(a1, 16)),
+                                   _mm_add_epi32(_mm_and_si128(b1, mask), _mm_srli_epi32(b1, 16)));
+        if(average){
+            s0 = _mm_srli_epi32(_mm_add_epi32(s0, two), 2);
+            s1 = _mm_srli_epi32(_mm_add_epi32(s1, two), 2);
+        }
+        _mm_storeu_si128((__m128i*) (pDst + x), evtPackUnsigned32(s0, s1));
+    }
+    return x;
+}
+
+
+/**
+ * Adds pixels [0, n) of a source row to the row buffer, returns the first pixel left for the scalar path
+ */
+static size_t evtAddRow(const uint8_t* pRow, uint32_t* pSums, size_t n){
+    const __m128i zero = _mm_setzero_si128();
+    size_t x = 0;
+    for(; x + 16 <= n; x += 16){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pRow + x));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i w[4] = {_mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                        _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)};
+        for(int k = 0; k < 4; k++){
+            __m128i* pAcc = (__m128i*) (pSums + x + 4 * k);
+            _mm_storeu_si128(pAcc, _mm_add_epi32(_mm_loadu_si128(pAcc), w[k]));
+        }
+    }
+    return x;
+}
+
+
+static size_t evtAddRow(const uint16_t* pRow, uint32_t* pSums, size_t n){
+    const __m128i zero = _mm_setzero_si128();
+    size_t x = 0;
+    for(; x + 8 <= n; x += 8){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pRow + x));
+        __m128i* pAcc = (__m128i*) (pSums + x);
+        _mm_storeu_si128(pAcc, _mm_add_epi32(_mm_loadu_si128(pAcc), _mm_unpacklo_epi16(v, zero)));
+        _mm_storeu_si128(pAcc + 1, _mm_add_epi32(_mm_loadu_si128(pAcc + 1), _mm_unpackhi_epi16(v, zero)));
+    }
+    return x;
+}
+
+
+/**
+ * Luma of 8 bit superpixels [0, n) from an R G and a G B row, returns the first one left for the scalar path
+ */
+static size_t evtLumaRow(const uint8_t* r0, const uint8_t* r1, uint8_t* pDst, size_t n){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weightsRG = _mm_set1_epi32((EVT_LUMA_G << 16) | EVT_LUMA_R);
+    const __m128i weightsGB = _mm_set1_epi32((EVT_LUMA_B << 16) | EVT_LUMA_G);
+    const __m128i round = _mm_set1_epi32(1 << (EVT_LUMA_SHIFT - 1));
+    size_t x = 0;
+    for(; x + 8 <= n; x += 8){
+        __m128i a = _mm_loadu_si128((const __m128i*) (r0 + 2 * x));
+        __m128i b = _mm_loadu_si128((const __m128i*) (r1 + 2 * x));
+        __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(a, zero), weightsRG),
+                                   _mm_madd_epi16(_mm_unpacklo_epi8(b, zero), weightsGB));
+        __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi8(a, zero), weightsRG),
+                                   _mm_madd_epi16(_mm_unpackhi_epi8(b, zero), weightsGB));
+        lo = _mm_srli_epi32(_mm_add_epi32(lo, round), EVT_LUMA_SHIFT);
+        hi = _mm_srli_epi32(_mm_add_epi32(hi, round), EVT_LUMA_SHIFT);
+        __m128i y = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i*) (pDst + x), _mm_packus_epi16(y, y));
+    }
+    return x;
+}
+
+
+// 16 bit luma uses the scalar path only
+static inline size_t evtLumaRow(const uint16_t*, const uint16_t*, uint16_t*, size_t){
+    return 0;
+}
+
+#endif
+
+
+EVTBinning::EVTBinning()
+    : binX(1), binY(1), mode(EVT_BIN_SUM), superpixel(EVT_SUPERPIXEL_OFF) {}
+
+
+/**
+ * Sets the bin factors and the bayer reduction
+ *
+ * @params[in]: binX        -> horizontal bin factor, 1 to EVT_BIN_MAX
+ * @params[in]: binY        -> vertical bin factor, 1 to EVT_BIN_MAX
+ * @params[in]: mode        -> sum or average the pixels of a bin
+ * @params[in]: superpixel  -> reduction of bayer frames, bayer frames are never binned
+ * @return: void
+ */
+void EVTBinning::configure(int binX, int binY, EVTBinMode mode, EVTSuperpixelMode superpixel){
+    this->binX = binX < 1 ? 1 : (binX > EVT_BIN_MAX ? EVT_BIN_MAX : binX);
+    this->binY = binY < 1 ? 1 : (binY > EVT_BIN_MAX ? EVT_BIN_MAX : binY);
+    this->mode = mode;
+    this->superpixel = superpixel;
+}
+
+
+bool EVTBinning::isActive(bool bayer) const {
+    if(bayer) return this->superpixel != EVT_SUPERPIXEL_OFF;
+    return this->binX > 1 || this->binY > 1;
+}
+
+
+void EVTBinning::getOutputSize(size_t sizeX, size_t sizeY, bool bayer, size_t* pOutSizeX, size_t* pOutSizeY, int* pNumComponents) const {
+    *pNumComponents = 1;
+    if(!isActive(bayer)){
+        *pOutSizeX = sizeX;
+        *pOutSizeY = sizeY;
+    }
+    else if(bayer){
+        *pOutSizeX = sizeX / 2;
+        *pOutSizeY = sizeY / 2;
+        if(this->superpixel == EVT_SUPERPIXEL_RGB) *pNumComponents = 3;
+    }
+    else{
+        *pOutSizeX = sizeX / this->binX;
+        *pOutSizeY = sizeY / this->binY;
+    }
+}
+
+
+template <typename T>
+void EVTBinning::binFrame(const T* pSrc, T* pDst, size_t sizeX, size_t sizeY){
+    size_t outSizeX = sizeX / this->binX;
+    size_t outSizeY = sizeY / this->binY;
+    bool average = (this->mode == EVT_BIN_AVERAGE);
+    uint32_t numPixels = this->binX * this->binY;
+    uint32_t maxValue = numeric_limits<T>::max();
+
+    if(this->binX == 2 && this->binY == 2){
+        for(size_t y = 0; y < outSizeY; y++){
+            const T* r0 = pSrc + 2 * y * sizeX;
+            const T* r1 = r0 + sizeX;
+            T* pOut = pDst + y * outSizeX;
+            size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+            x = evtBin2x2Row(r0, r1, pOut, outSizeX, average);
+#endif
+            for(; x < outSizeX; x++){
+                uint32_t sum = (uint32_t) r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1];
+                sum = average ? (sum + 2) >> 2 : sum;
+                pOut[x] = (T) (sum > maxValue ? maxValue : sum);
+            }
+        }
+        return;
+    }
+
+    size_t width = outSizeX * this->binX;
+    this->rowSums.resize(width);
+    for(size_t y = 0; y < outSizeY; y++){
+        uint32_t* pSums = &this->rowSums[0];
+        for(size_t x = 0; x < width; x++) pSums[x] = 0;
+        for(int k = 0; k < this->binY; k++){
+            const T* pRow = pSrc + (y * this->binY + k) * sizeX;
+            size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+            x = evtAddRow(pRow, pSums, width);
+#endif
+            for(; x < width; x++) pSums[x] += pRow[x];
+        }
+        T* pOut = pDst + y * outSizeX;
+        for(size_t x = 0; x < outSizeX; x++){
+            const uint32_t* pBin = pSums + x * this->binX;
+            uint32_t sum = 0;
+            for(int k = 0; k < this->binX; k++) sum += pBin[k];
+            sum = average ? (sum + numPixels / 2) / numPixels : sum;
+            pOut[x] = (T) (sum > maxValue ? maxValue : sum);
+        }
+    }
+}
+
+
+template <typename T>
+void EVTBinning::superpixelFrame(const T* pSrc, T* pDst, size_t sizeX, size_t sizeY) const {
+    size_t outSizeX = sizeX / 2;
+    size_t outSizeY = sizeY / 2;
+    for(size_t y = 0; y < outSizeY; y++){
+        const T* r0 = pSrc + 2 * y * sizeX;
+        const T* r1 = r0 + sizeX;
+        if(this->superpixel == EVT_SUPERPIXEL_RGB){
+            T* pOut = pDst + 3 * y * outSizeX;
+            for(size_t x = 0; x < outSizeX; x++){
+                pOut[3 * x]     = r0[2 * x];
+                pOut[3 * x + 1] = (T) (((uint32_t) r0[2 * x + 1] + r1[2 * x] + 1) >> 1);
+                pOut[3 * x + 2] = r1[2 * x + 1];
+            }
+            continue;
+        }
+        T* pOut = pDst + y * outSizeX;
+        size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+        x = evtLumaRow(r0, r1, pOut, outSizeX);
+#endif
+        for(; x < outSizeX; x++){
+            uint32_t luma = EVT_LUMA_R * (uint32_t) r0[2 * x] + EVT_LUMA_G * ((uint32_t) r0[2 * x + 1] + r1[2 * x])
+                            + EVT_LUMA_B * (uint32_t) r1[2 * x + 1];
+            pOut[x] = (T) ((luma + (1 << (EVT_LUMA_SHIFT - 1))) >> EVT_LUMA_SHIFT);
+        }
+    }
+}
+
+
+/**
+ * Bins a mono frame, or reduces an RGGB bayer frame to superpixels
+ *
+ * @params[in]:  pSrc   -> source frame
+ * @params[out]: pDst   -> output, with the size given by getOutputSize
+ * @params[in]:  sizeX  -> source width
+ * @params[in]:  sizeY  -> source height
+ * @params[in]:  bayer  -> the source is an RGGB bayer frame
+ * @return: void
+ */
+void EVTBinning::apply(const uint8_t* pSrc, uint8_t* pDst, size_t sizeX, size_t sizeY, bool bayer){
+    if(bayer) superpixelFrame(pSrc, pDst, sizeX, sizeY);
+    else binFrame(pSrc, pDst, sizeX, sizeY);
+}
+
+
+void EVTBinning::apply(const uint16_t* pSrc, uint16_t* pDst, size_t sizeX, size_t sizeY, bool bayer){
+    if(bayer) superpixelFrame(pSrc, pDst, sizeX, sizeY);
+    else binFrame(pSrc, pDst, sizeX, sizeY);
+}
@@ -0,0 +1,71 @@
+/**
+ * Header file for the ADEmergentVision software binning
+ *
+ * Bins mono frames by binX x binY, summing or averaging, and reduces RGGB bayer frames to one RGB or
+ * luma pixel per 2x2 cell. Partial bins at the right and bottom edges are dropped. 2x2 binning is done
+ * entirely in SSE2 registers, other factors add the rows of a bin into a 32 bit row buffer with SSE2,
+ * and then sum the columns. Sums saturate at the largest value of the data type.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTBINNING_H
+#define EVTBINNING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Largest bin factor in either direction
+#define EVT_BIN_MAX 16
+
+
+typedef enum {
+    EVT_BIN_SUM     = 0,
+    EVT_BIN_AVERAGE = 1
+} EVTBinMode;
+
+
+typedef enum {
+    EVT_SUPERPIXEL_OFF  = 0,
+    EVT_SUPERPIXEL_RGB  = 1,    // R, mean of the two G, B
+    EVT_SUPERPIXEL_LUMA = 2     // BT.601 luma of the above
+} EVTSuperpixelMode;
+
+
+class EVTBinning {
+
+    public:
+
+        EVTBinning();
+
+        void configure(int binX, int binY, EVTBinMode mode, EVTSuperpixelMode superpixel);
+
+        // true if frames are reduced, bayer selects between the superpixel and the binning settings
+        bool isActive(bool bayer) const;
+
+        // output size and values per pixel for a source frame of the given size
+        void getOutputSize(size_t sizeX, size_t sizeY, bool bayer, size_t* pOutSizeX, size_t* pOutSizeY, int* pNumComponents) const;
+
+        // bins a mono frame, or reduces a bayer frame, into the output
+        void apply(const uint8_t* pSrc, uint8_t* pDst, size_t sizeX, size_t sizeY, bool bayer);
+        void apply(const uint16_t* pSrc, uint16_t* pDst, size_t sizeX, size_t sizeY, bool bayer);
+
+    private:
+
+        int binX;
+        int binY;
+        EVTBinMode mode;
+        EVTSuperpixelMode superpixel;
+        std::vector<uint32_t> rowSums;
+
+        template <typename T> void binFrame(const T* pSrc, T* pDst, size_t sizeX, size_t sizeY);
+        template <typename T> void superpixelFrame(const T* pSrc, T* pDst, size_t sizeX, size_t sizeY) const;
+};
+
+
+#endif
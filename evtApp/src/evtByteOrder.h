@@ -0,0 +1,57 @@
+/**
+ * Header file for the ADEmergentVision byte order helpers
+ *
+ * Converts values between host and little endian byte order, for the headers the driver sends over the
+ * network. Each conversion is its own inverse, and compiles to nothing on little endian hosts.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTBYTEORDER_H
+#define EVTBYTEORDER_H
+
+#include <stdint.h>
+#include <string.h>
+
+
+static inline uint16_t evtLittleEndian16(uint16_t value){
+    uint8_t bytes[2] = {(uint8_t) value, (uint8_t) (value >> 8)};
+    uint16_t result;
+    memcpy(&result, bytes, sizeof(result));
+    return result;
+}
+
+
+static inline uint32_t evtLittleEndian32(uint32_t value){
+    uint8_t bytes[4];
+    for(int i = 0; i < 4; i++) bytes[i] = (uint8_t) (value >> (8 * i));
+    uint32_t result;
+    memcpy(&result, bytes, sizeof(result));
+    return result;
+}
+
+
+static inline uint64_t evtLittleEndian64(uint64_t value){
+    uint8_t bytes[8];
+    for(int i = 0; i < 8; i++) bytes[i] = (uint8_t) (value >> (8 * i));
+    uint64_t result;
+    memcpy(&result, bytes, sizeof(result));
+    return result;
+}
+
+
+static inline double evtLittleEndianDouble(double value){
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = evtLittleEndian64(bits);
+    double result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+
+#endif
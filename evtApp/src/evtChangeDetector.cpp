@@ -0,0 +1,123 @@
+/**
+ * Source file for the ADEmergentVision frame change detector
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <stdlib.h>
+
+#include "evtSimd.h"
+#include "evtChangeDetector.h"
+
+using namespace std;
+
+
+/**
+ * Sums n consecutive 8 bit pixels, SAD against zero gives the horizontal sums of 16 or 8 bytes
+ */
+static inline uint32_t evtSumPixels(const uint8_t* p, int n){
+    uint32_t sum = 0;
+    int i = 0;
+#ifdef EVT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for(; i + 16 <= n; i += 16) acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i*) (p + i)), zero));
+    for(; i + 8 <= n; i += 8) acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadl_epi64((const __m128i*) (p + i)), zero));
+    uint64_t partial[2];
+    _mm_storeu_si128((__m128i*) partial, acc);
+    sum = (uint32_t) (partial[0] + partial[1]);
+#endif
+    for(; i < n; i++) sum += p[i];
+    return sum;
+}
+
+
+/**
+ * Sums n consecutive 16 bit pixels, widened to 32 bit lanes
+ */
+static inline uint32_t evtSumPixels(const uint16_t* p, int n){
+    uint32_t sum = 0;
+    int i = 0;
+#ifdef EVT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for(; i + 8 <= n; i += 8){
+        __m128i v = _mm_loadu_si128((const __m128i*) (p + i));
+        acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_unpacklo_epi16(v, zero), _mm_unpackhi_epi16(v, zero)));
+    }
+    uint32_t partial[4];
+    _mm_storeu_si128((__m128i*) partial, acc);
+    sum = partial[0] + partial[1] + partial[2] + partial[3];
+#endif
+    for(; i < n; i++) sum += p[i];
+    return sum;
+}
+
+
+EVTChangeDetector::EVTChangeDetector()
+    : gridX(0), gridY(0), blockSize(0), hasReference(false) {}
+
+
+template <typename T>
+double EVTChangeDetector::measureFrame(const T* pData, size_t sizeX, size_t sizeY, int blockSize){
+    if(blockSize < 1) blockSize = 1;
+    if(blockSize > EVT_CHANGE_MAX_BLOCK) blockSize = EVT_CHANGE_MAX_BLOCK;
+    size_t gridX = sizeX / blockSize;
+    size_t gridY = sizeY / blockSize;
+    if(gridX != this->gridX || gridY != this->gridY || blockSize != this->blockSize){
+        this->gridX = gridX;
+        this->gridY = gridY;
+        this->blockSize = blockSize;
+        this->hasReference = false;
+    }
+    this->current.assign(gridX * gridY, 0);
+    if(gridX == 0 || gridY == 0) return -1.0;
+
+    for(size_t y = 0; y < gridY * blockSize; y++){
+        const T* row = pData + y * sizeX;
+        uint32_t* cells = &this->current[(y / blockSize) * gridX];
+        for(size_t bx = 0; bx < gridX; bx++) cells[bx] += evtSumPixels(row + bx * blockSize, blockSize);
+    }
+    if(!this->hasReference) return -1.0;
+
+    uint32_t maxDiff = 0;
+    for(size_t i = 0; i < this->current.size(); i++){
+        uint32_t a = this->current[i], b = this->reference[i];
+        uint32_t diff = a > b ? a - b : b - a;
+        if(diff > maxDiff) maxDiff = diff;
+    }
+    return (double) maxDiff / ((double) blockSize * blockSize);
+}
+
+
+/**
+ * Measures the change of a frame against the reference
+ *
+ * @params[in]: pData       -> pointer to image data, rows are contiguous
+ * @params[in]: sizeX       -> image width
+ * @params[in]: sizeY       -> image height
+ * @params[in]: blockSize   -> edge length of a grid block in pixels
+ * @return: largest block mean difference in counts, negative if there is no comparable reference
+ */
+double EVTChangeDetector::measure(const uint8_t* pData, size_t sizeX, size_t sizeY, int blockSize){
+    return measureFrame(pData, sizeX, sizeY, blockSize);
+}
+
+
+double EVTChangeDetector::measure(const uint16_t* pData, size_t sizeX, size_t sizeY, int blockSize){
+    return measureFrame(pData, sizeX, sizeY, blockSize);
+}
+
+
+void EVTChangeDetector::accept(){
+    this->reference.swap(this->current);
+    this->hasReference = !this->reference.empty();
+}
+
+
+void EVTChangeDetector::reset(){
+    this->hasReference = false;
+}
@@ -0,0 +1,55 @@
+/**
+ * Header file for the ADEmergentVision frame change detector
+ *
+ * Reduces each frame to a grid of block sums with SSE2, and compares it with the grid of the last
+ * published frame. The change of a frame is the largest absolute difference of a block mean, so a
+ * small moving feature is not averaged away by the rest of the frame, while pixel noise is.
+ * Pixels in partial blocks at the right and bottom edges are ignored.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTCHANGEDETECTOR_H
+#define EVTCHANGEDETECTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Largest block edge length, so 16 bit block sums fit in 32 bits
+#define EVT_CHANGE_MAX_BLOCK 64
+
+
+class EVTChangeDetector {
+
+    public:
+
+        EVTChangeDetector();
+
+        // builds the grid of the frame, and returns its change against the reference grid,
+        // or a negative value if there is no reference of the same geometry
+        double measure(const uint8_t* pData, size_t sizeX, size_t sizeY, int blockSize);
+        double measure(const uint16_t* pData, size_t sizeX, size_t sizeY, int blockSize);
+
+        // makes the grid of the last measured frame the reference
+        void accept();
+        void reset();
+
+    private:
+
+        std::vector<uint32_t> current;
+        std::vector<uint32_t> reference;
+        size_t gridX;
+        size_t gridY;
+        int blockSize;
+        bool hasReference;
+
+        template <typename T> double measureFrame(const T* pData, size_t sizeX, size_t sizeY, int blockSize);
+};
+
+
+#endif
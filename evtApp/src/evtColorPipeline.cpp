@@ -0,0 +1,389 @@
+/**
+ * Source file for the ADEmergentVision color pipeline
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <math.h>
+
+#include "evtSimd.h"
+#include "evtColorPipeline.h"
+
+using namespace std;
+
+
+/**
+ * Builds a gamma table over [0, maxValue], output is input^(1/gamma)
+ */
+template <typename T>
+static void evtBuildGammaTable(vector<T>& table, uint32_t maxValue, double gamma){
+    table.resize(maxValue + 1);
+    for(uint32_t i = 0; i <= maxValue; i++){
+        double y = (gamma == 1.0) ? i : pow((double) i / maxValue, 1.0 / gamma) * maxValue;
+        table[i] = (T) (y + 0.5);
+    }
+}
+
+
+EVTColorPipeline::EVTColorPipeline()
+    : inputBits(16) {
+    double gains[3] = {1, 1, 1};
+    double matrix[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    configure(gains, matrix, 1.0, 16);
+}
+
+
+/**
+ * Sets the gains, matrix and gamma curve
+ *
+ * @params[in]: gains       -> red, green and blue gains
+ * @params[in]: matrix      -> row major 3x3 matrix mapping white balanced RGB to output RGB
+ * @params[in]: gamma       -> output is input^(1/gamma), 1 for a linear output
+ * @params[in]: inputBits   -> bit depth of 16 bit frames, 8 to 16
+ * @return: void
+ */
+void EVTColorPipeline::configure(const double gains[3], const double matrix[9], double gamma, int inputBits){
+    if(inputBits < 8) inputBits = 8;
+    if(inputBits > 16) inputBits = 16;
+    if(gamma <= 0) gamma = 1.0;
+    this->inputBits = inputBits;
+    for(int row = 0; row < 3; row++){
+        for(int col = 0; col < 3; col++){
+            double c = matrix[3 * row + col] * gains[col];
+            if(c > EVT_COLOR_MAX_COEFFICIENT) c = EVT_COLOR_MAX_COEFFICIENT;
+            if(c < -EVT_COLOR_MAX_COEFFICIENT) c = -EVT_COLOR_MAX_COEFFICIENT;
+            this->coefficients[3 * row + col] = (int16_t) floor(c * (1 << EVT_COLOR_FRACTION_BITS) + 0.5);
+        }
+    }
+    evtBuildGammaTable(this->table8, 255, gamma);
+    evtBuildGammaTable(this->table16, (1u << inputBits) - 1, gamma);
+}
+
+
+int EVTColorPipeline::getInputBits() const {
+    return this->inputBits;
+}
+
+
+/**
+ * Processes pixels whose red, green and blue values are at pR, pG and pB, step values apart
+ */
+template <typename T>
+void EVTColorPipeline::applyScalar(T* pR, T* pG, T* pB, size_t numPixels, size_t step, const T* pTable, uint64_t sums[3]) const {
+    const int64_t maxValue = (int64_t) (1u << (sizeof(T) == 1 ? 8 : this->inputBits)) - 1;
+    const int64_t round = 1 << (EVT_COLOR_FRACTION_BITS - 1);
+    const int16_t* c = this->coefficients;
+    for(size_t i = 0; i < numPixels * step; i += step){
+        int64_t in[3] = {pR[i], pG[i], pB[i]};
+        T* out[3] = {pR + i, pG + i, pB + i};
+        sums[0] += in[0];
+        sums[1] += in[1];
+        sums[2] += in[2];
+        // values above the input depth are clamped before the matrix, as in the vector path
+        for(int k = 0; k < 3; k++) if(in[k] > maxValue) in[k] = maxValue;
+        for(int row = 0; row < 3; row++){
+            int64_t v = (c[3 * row] * in[0] + c[3 * row + 1] * in[1] + c[3 * row + 2] * in[2] + round) >> EVT_COLOR_FRACTION_BITS;
+            *out[row] = pTable[v < 0 ? 0 : (v > maxValue ? maxValue : v)];
+        }
+    }
+}
+
+
+#ifdef EVT_SIMD_SSE2
+
+/**
+ * Builds the multiply-add weights of each output channel. Red and green are weighted as a pair, and the
+ * rounding constant is multiplied by the ones interleaved with blue.
+ */
+static void evtColorWeights(const int16_t* c, __m128i weightsRG[3], __m128i weightsB[3]){
+    for(int row = 0; row < 3; row++){
+        weightsRG[row] = _mm_set1_epi32((int) ((uint32_t) (uint16_t) c[3 * row] | ((uint32_t) (uint16_t) c[3 * row + 1] << 16)));
+        weightsB[row] = _mm_set1_epi32((int) ((uint32_t) (uint16_t) c[3 * row + 2] | (1u << (EVT_COLOR_FRACTION_BITS - 1 + 16))));
+    }
+}
+
+
+/**
+ * Applies the matrix to 16 8 bit pixels held one channel per register, and stores the output values
+ * clamped to [0, 255], ready to index the gamma table
+ */
+static inline void evtColorVector(__m128i r, __m128i g, __m128i b, const __m128i weightsRG[3], const __m128i weightsB[3],
+                                  uint8_t values[3][16]){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i rg[4], b1[4];
+    rg[0] = _mm_unpacklo_epi16(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero));
+    rg[1] = _mm_unpackhi_epi16(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero));
+    rg[2] = _mm_unpacklo_epi16(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero));
+    rg[3] = _mm_unpackhi_epi16(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero));
+    b1[0] = _mm_unpacklo_epi16(_mm_unpacklo_epi8(b, zero), one);
+    b1[1] = _mm_unpackhi_epi16(_mm_unpacklo_epi8(b, zero), one);
+    b1[2] = _mm_unpacklo_epi16(_mm_unpackhi_epi8(b, zero), one);
+    b1[3] = _mm_unpackhi_epi16(_mm_unpackhi_epi8(b, zero), one);
+    for(int row = 0; row < 3; row++){
+        __m128i v[4];
+        for(int k = 0; k < 4; k++)
+            v[k] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(rg[k], weightsRG[row]), _mm_madd_epi16(b1[k], weightsB[row])), EVT_COLOR_FRACTION_BITS);
+        // the packs saturate to [0, 255]
+        _mm_storeu_si128((__m128i*) values[row], _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3])));
+    }
+}
+
+
+/**
+ * Applies the matrix to 8 16 bit pixels held one channel per register. The values must fit in
+ * EVT_COLOR_MAX_SIMD_BITS, so the multiply-adds are signed and their sums can not overflow. The output
+ * values are stored clamped to [0, maxValue], ready to index the gamma table.
+ */
+static inline void evtColorVector16(__m128i r, __m128i g, __m128i b, const __m128i weightsRG[3], const __m128i weightsB[3],
+                                    __m128i maxValue, uint16_t values[3][8]){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i rg[2], b1[2];
+    rg[0] = _mm_unpacklo_epi16(r, g);
+    rg[1] = _mm_unpackhi_epi16(r, g);
+    b1[0] = _mm_unpacklo_epi16(b, one);
+    b1[1] = _mm_unpackhi_epi16(b, one);
+    for(int row = 0; row < 3; row++){
+        __m128i v[2];
+        for(int k = 0; k < 2; k++)
+            v[k] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(rg[k], weightsRG[row]), _mm_madd_epi16(b1[k], weightsB[row])), EVT_COLOR_FRACTION_BITS);
+        __m128i out = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(v[0], v[1]), zero), maxValue);
+        _mm_storeu_si128((__m128i*) values[row], out);
+    }
+}
+
+
+/**
+ * Unsigned 16 bit minimum, which SSE2 only has for signed values
+ */
+static inline __m128i evtMinU16(__m128i a, __m128i b){
+    return _mm_sub_epi16(a, _mm_subs_epu16(a, b));
+}
+
+
+/**
+ * Adds the 8 unsigned 16 bit values of v to the two 64 bit lanes of sum
+ */
+static inline __m128i evtAddSum16(__m128i sum, __m128i v){
+    const __m128i zero = _mm_setzero_si128();
+    __m128i pairs = _mm_add_epi32(_mm_unpacklo_epi16(v, zero), _mm_unpackhi_epi16(v, zero));
+    return _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(pairs, zero), _mm_unpackhi_epi32(pairs, zero)));
+}
+
+
+static inline uint64_t evtSumLanes(__m128i v){
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*) lanes, v);
+    return lanes[0] + lanes[1];
+}
+
+#endif
+
+
+/**
+ * Processes 8 bit interleaved RGB in place
+ *
+ * @params[in,out]: pData       -> interleaved RGB pixels
+ * @params[in]:     numPixels   -> number of pixels
+ * @params[out]:    means       -> red, green and blue means of the input
+ * @return: void
+ */
+void EVTColorPipeline::apply(uint8_t* pData, size_t numPixels, double means[3]) const {
+    uint64_t sums[3] = {0, 0, 0};
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i weightsRG[3], weightsB[3];
+    evtColorWeights(this->coefficients, weightsRG, weightsB);
+    __m128i sumR = zero, sumG = zero, sumB = zero;
+    uint8_t values[3][16];
+    for(; i + 16 <= numPixels; i += 16){
+        uint8_t* p = pData + 3 * i;
+        __m128i r, g, b;
+        evtLoadDeinterleave3(p, &r, &g, &b);
+        sumR = _mm_add_epi64(sumR, _mm_sad_epu8(r, zero));
+        sumG = _mm_add_epi64(sumG, _mm_sad_epu8(g, zero));
+        sumB = _mm_add_epi64(sumB, _mm_sad_epu8(b, zero));
+        evtColorVector(r, g, b, weightsRG, weightsB, values);
+        for(int k = 0; k < 16; k++){
+            p[3 * k]     = this->table8[values[0][k]];
+            p[3 * k + 1] = this->table8[values[1][k]];
+            p[3 * k + 2] = this->table8[values[2][k]];
+        }
+    }
+    sums[0] = evtSumLanes(sumR);
+    sums[1] = evtSumLanes(sumG);
+    sums[2] = evtSumLanes(sumB);
+#endif
+    uint8_t* p = pData + 3 * i;
+    applyScalar(p, p + 1, p + 2, numPixels - i, 3, &this->table8[0], sums);
+    for(int k = 0; k < 3; k++) means[k] = numPixels > 0 ? (double) sums[k] / numPixels : 0;
+}
+
+
+/**
+ * Processes 8 bit planar RGB in place, one channel row of each plane at a time
+ *
+ * @params[in,out]: pData       -> planar RGB frame
+ * @params[in]:     sizeX       -> frame width
+ * @params[in]:     sizeY       -> frame height
+ * @params[in]:     offsets     -> offset of the first red, green and blue value
+ * @params[in]:     rowStride   -> distance between two rows of a channel
+ * @params[out]:    means       -> red, green and blue means of the input
+ * @return: void
+ */
+void EVTColorPipeline::applyPlanar(uint8_t* pData, size_t sizeX, size_t sizeY, const size_t offsets[3], size_t rowStride, double means[3]) const {
+    uint64_t sums[3] = {0, 0, 0};
+#ifdef EVT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i weightsRG[3], weightsB[3];
+    evtColorWeights(this->coefficients, weightsRG, weightsB);
+    __m128i sumR = zero, sumG = zero, sumB = zero;
+    uint8_t values[3][16];
+#endif
+    for(size_t y = 0; y < sizeY; y++){
+        uint8_t* pR = pData + offsets[0] + y * rowStride;
+        uint8_t* pG = pData + offsets[1] + y * rowStride;
+        uint8_t* pB = pData + offsets[2] + y * rowStride;
+        size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+        for(; x + 16 <= sizeX; x += 16){
+            __m128i r = _mm_loadu_si128((const __m128i*) (pR + x));
+            __m128i g = _mm_loadu_si128((const __m128i*) (pG + x));
+            __m128i b = _mm_loadu_si128((const __m128i*) (pB + x));
+            sumR = _mm_add_epi64(sumR, _mm_sad_epu8(r, zero));
+            sumG = _mm_add_epi64(sumG, _mm_sad_epu8(g, zero));
+            sumB = _mm_add_epi64(sumB, _mm_sad_epu8(b, zero));
+            evtColorVector(r, g, b, weightsRG, weightsB, values);
+            for(int k = 0; k < 16; k++){
+                pR[x + k] = this->table8[values[0][k]];
+                pG[x + k] = this->table8[values[1][k]];
+                pB[x + k] = this->table8[values[2][k]];
+            }
+        }
+#endif
+        applyScalar(pR + x, pG + x, pB + x, sizeX - x, 1, &this->table8[0], sums);
+    }
+#ifdef EVT_SIMD_SSE2
+    sums[0] += evtSumLanes(sumR);
+    sums[1] += evtSumLanes(sumG);
+    sums[2] += evtSumLanes(sumB);
+#endif
+    size_t numPixels = sizeX * sizeY;
+    for(int k = 0; k < 3; k++) means[k] = numPixels > 0 ? (double) sums[k] / numPixels : 0;
+}
+
+
+/**
+ * Processes 16 bit interleaved RGB in place, values above the input depth are clamped. Frames of at most
+ * EVT_COLOR_MAX_SIMD_BITS bits, such as RGB10 and RGB12, are processed 8 pixels at a time.
+ *
+ * @params[in,out]: pData       -> interleaved RGB pixels
+ * @params[in]:     numPixels   -> number of pixels
+ * @params[out]:    means       -> red, green and blue means of the input
+ * @return: void
+ */
+void EVTColorPipeline::apply(uint16_t* pData, size_t numPixels, double means[3]) const {
+    uint64_t sums[3] = {0, 0, 0};
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    if(this->inputBits <= EVT_COLOR_MAX_SIMD_BITS){
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i maxValue = _mm_set1_epi16((short) ((1 << this->inputBits) - 1));
+        __m128i weightsRG[3], weightsB[3];
+        evtColorWeights(this->coefficients, weightsRG, weightsB);
+        __m128i sumR = zero, sumG = zero, sumB = zero;
+        uint16_t values[3][8];
+        for(; i + 8 <= numPixels; i += 8){
+            uint16_t* p = pData + 3 * i;
+            __m128i r, g, b;
+            evtLoadDeinterleave3(p, &r, &g, &b);
+            sumR = evtAddSum16(sumR, r);
+            sumG = evtAddSum16(sumG, g);
+            sumB = evtAddSum16(sumB, b);
+            evtColorVector16(evtMinU16(r, maxValue), evtMinU16(g, maxValue), evtMinU16(b, maxValue),
+                             weightsRG, weightsB, maxValue, values);
+            for(int k = 0; k < 8; k++){
+                p[3 * k]     = this->table16[values[0][k]];
+                p[3 * k + 1] = this->table16[values[1][k]];
+                p[3 * k + 2] = this->table16[values[2][k]];
+            }
+        }
+        sums[0] = evtSumLanes(sumR);
+        sums[1] = evtSumLanes(sumG);
+        sums[2] = evtSumLanes(sumB);
+    }
+#endif
+    uint16_t* p = pData + 3 * i;
+    applyScalar(p, p + 1, p + 2, numPixels - i, 3, &this->table16[0], sums);
+    for(int k = 0; k < 3; k++) means[k] = numPixels > 0 ? (double) sums[k] / numPixels : 0;
+}
+
+
+/**
+ * Processes 16 bit planar RGB in place, see the interleaved overload
+ */
+void EVTColorPipeline::applyPlanar(uint16_t* pData, size_t sizeX, size_t sizeY, const size_t offsets[3], size_t rowStride, double means[3]) const {
+    uint64_t sums[3] = {0, 0, 0};
+#ifdef EVT_SIMD_SSE2
+    bool vector = (this->inputBits <= EVT_COLOR_MAX_SIMD_BITS);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i maxValue = _mm_set1_epi16((short) ((1 << this->inputBits) - 1));
+    __m128i weightsRG[3], weightsB[3];
+    evtColorWeights(this->coefficients, weightsRG, weightsB);
+    __m128i sumR = zero, sumG = zero, sumB = zero;
+    uint16_t values[3][8];
+#endif
+    for(size_t y = 0; y < sizeY; y++){
+        uint16_t* pR = pData + offsets[0] + y * rowStride;
+        uint16_t* pG = pData + offsets[1] + y * rowStride;
+        uint16_t* pB = pData + offsets[2] + y * rowStride;
+        size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+        for(; vector && x + 8 <= sizeX; x += 8){
+            __m128i r = _mm_loadu_si128((const __m128i*) (pR + x));
+            __m128i g = _mm_loadu_si128((const __m128i*) (pG + x));
+            __m128i b = _mm_loadu_si128((const __m128i*) (pB + x));
+            sumR = evtAddSum16(sumR, r);
+            sumG = evtAddSum16(sumG, g);
+            sumB = evtAddSum16(sumB, b);
+            evtColorVector16(evtMinU16(r, maxValue), evtMinU16(g, maxValue), evtMinU16(b, maxValue),
+                             weightsRG, weightsB, maxValue, values);
+            for(int k = 0; k < 8; k++){
+                pR[x + k] = this->table16[values[0][k]];
+                pG[x + k] = this->table16[values[1][k]];
+                pB[x + k] = this->table16[values[2][k]];
+            }
+        }
+#endif
+        applyScalar(pR + x, pG + x, pB + x, sizeX - x, 1, &this->table16[0], sums);
+    }
+#ifdef EVT_SIMD_SSE2
+    sums[0] += evtSumLanes(sumR);
+    sums[1] += evtSumLanes(sumG);
+    sums[2] += evtSumLanes(sumB);
+#endif
+    size_t numPixels = sizeX * sizeY;
+    for(int k = 0; k < 3; k++) means[k] = numPixels > 0 ? (double) sums[k] / numPixels : 0;
+}
+
+
+/**
+ * Computes gray world white balance gains
+ *
+ * @params[in]:  means      -> channel means of the input, before the gains
+ * @params[in]:  gains      -> current gains, the green gain is kept
+ * @params[out]: newGains   -> gains that equalize the white balanced channel means
+ * @return: false if a channel is black, newGains is not set in that case
+ */
+bool EVTColorPipeline::computeWhiteBalance(const double means[3], const double gains[3], double newGains[3]){
+    if(means[0] <= 0 || means[1] <= 0 || means[2] <= 0) return false;
+    newGains[0] = gains[1] * means[1] / means[0];
+    newGains[1] = gains[1];
+    newGains[2] = gains[1] * means[1] / means[2];
+    return true;
+}
@@ -0,0 +1,73 @@
+/**
+ * Header file for the ADEmergentVision color pipeline
+ *
+ * Applies white balance gains, a 3x3 color matrix and a gamma curve to interleaved or planar RGB frames
+ * in one pass. The gains are folded into the matrix, which is kept in 4.12 fixed point so each output channel
+ * is two 16 bit multiply-adds in SSE2, with the rounding constant multiplied in. The gamma curve is a
+ * table lookup per value. The channel sums of the input are gathered in the same pass, for gray world
+ * auto white balance. 16 bit frames of up to 14 bits, such as RGB10 and RGB12, take the same multiply-adds
+ * 8 pixels at a time. Deeper frames use the scalar path, since their values do not fit the signed 16 bit
+ * multiply-add.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTCOLORPIPELINE_H
+#define EVTCOLORPIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Fraction bits of the fixed point matrix, coefficients are clamped to the range of a signed 16 bit value
+#define EVT_COLOR_FRACTION_BITS     12
+#define EVT_COLOR_MAX_COEFFICIENT   (32767.0 / (1 << EVT_COLOR_FRACTION_BITS))
+// Deepest 16 bit frames for which the sum of three products with the largest coefficient fits in 32 bits
+#define EVT_COLOR_MAX_SIMD_BITS     14
+
+
+typedef enum {
+    EVT_AWB_OFF         = 0,
+    EVT_AWB_ONCE        = 1,    // gains are computed from the next frame, then the mode returns to off
+    EVT_AWB_CONTINUOUS  = 2     // gains are computed from every frame, and applied to the next one
+} EVTWhiteBalanceMode;
+
+
+class EVTColorPipeline {
+
+    public:
+
+        EVTColorPipeline();
+
+        // gains are applied before the row major matrix, inputBits is the depth of 16 bit frames
+        void configure(const double gains[3], const double matrix[9], double gamma, int inputBits);
+
+        int getInputBits() const;
+
+        // processes interleaved RGB in place, and returns the channel means of the input
+        void apply(uint8_t* pData, size_t numPixels, double means[3]) const;
+        void apply(uint16_t* pData, size_t numPixels, double means[3]) const;
+
+        // processes planar RGB in place, offsets are where each channel starts, rowStride the distance between its rows
+        void applyPlanar(uint8_t* pData, size_t sizeX, size_t sizeY, const size_t offsets[3], size_t rowStride, double means[3]) const;
+        void applyPlanar(uint16_t* pData, size_t sizeX, size_t sizeY, const size_t offsets[3], size_t rowStride, double means[3]) const;
+
+        // gray world gains, scaling red and blue so their means match the green mean
+        static bool computeWhiteBalance(const double means[3], const double gains[3], double newGains[3]);
+
+    private:
+
+        int16_t coefficients[9];
+        std::vector<uint8_t> table8;
+        std::vector<uint16_t> table16;
+        int inputBits;
+
+        template <typename T> void applyScalar(T* pR, T* pG, T* pB, size_t numPixels, size_t step, const T* pTable, uint64_t sums[3]) const;
+};
+
+
+#endif
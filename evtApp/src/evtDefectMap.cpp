@@ -0,0 +1,264 @@
+/**
+ * Source file for the ADEmergentVision defective pixel map
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "evtDefectMap.h"
+
+using namespace std;
+
+
+/**
+ * Computes the median of a buffer, reordering a scratch copy
+ */
+static float evtMedian(vector<float>& scratch){
+    size_t middle = scratch.size() / 2;
+    nth_element(scratch.begin(), scratch.begin() + middle, scratch.end());
+    return scratch[middle];
+}
+
+
+/**
+ * Computes the median of each color channel of an image, 4 channels on a Bayer mosaic and 1 otherwise
+ */
+static void evtChannelMedians(const vector<float>& image, size_t sizeX, size_t sizeY, bool mosaic, vector<float>& scratch, float medians[4]){
+    if(!mosaic){
+        scratch.assign(image.begin(), image.end());
+        for(int c = 0; c < 4; c++) medians[c] = evtMedian(scratch);
+        return;
+    }
+    for(int c = 0; c < 4; c++){
+        scratch.clear();
+        for(size_t y = c / 2; y < sizeY; y += 2){
+            for(size_t x = c % 2; x < sizeX; x += 2) scratch.push_back(image[y * sizeX + x]);
+        }
+        medians[c] = scratch.empty() ? 0.0f : evtMedian(scratch);
+    }
+}
+
+
+/**
+ * Returns the color channel of a pixel, used to index the channel medians
+ */
+static inline int evtChannel(size_t x, size_t y, bool mosaic){
+    return mosaic ? (int) ((y % 2) * 2 + x % 2) : 0;
+}
+
+
+/**
+ * Replaces one defective pixel by the rounded mean of its good neighbours
+ */
+template <typename T>
+static inline void evtPatchDefect(T* pData, uint32_t defect, size_t sizeX, size_t step){
+    size_t index = defect & EVT_DEFECT_INDEX_MASK;
+    uint32_t sum = 0, count = 0;
+    if(defect & EVT_DEFECT_LEFT)  { sum += pData[index - step];         count++; }
+    if(defect & EVT_DEFECT_RIGHT) { sum += pData[index + step];         count++; }
+    if(defect & EVT_DEFECT_UP)    { sum += pData[index - step * sizeX]; count++; }
+    if(defect & EVT_DEFECT_DOWN)  { sum += pData[index + step * sizeX]; count++; }
+    if(count > 0) pData[index] = (T) ((sum + count / 2) / count);
+}
+
+
+EVTDefectMap::EVTDefectMap()
+    : sizeX(0), sizeY(0), step(1), numHot(0), numDead(0) {}
+
+
+/**
+ * Builds the defect map. A pixel is hot if its dark value is more than hotSigma robust standard
+ * deviations (1.4826 * median absolute deviation, at least one count) above the median dark value.
+ * A pixel is dead if its dark subtracted flat response is below deadFraction of the median response.
+ * On a Bayer mosaic the medians are those of the color channel of the pixel.
+ *
+ * @params[in]: pDark           -> averaged dark reference, or NULL
+ * @params[in]: pFlat           -> averaged flat reference, or NULL
+ * @params[in]: sizeX           -> reference width
+ * @params[in]: sizeY           -> reference height
+ * @params[in]: mosaic          -> true if the references are raw Bayer mosaics
+ * @params[in]: hotSigma        -> hot pixel threshold in robust standard deviations
+ * @params[in]: deadFraction    -> dead pixel threshold as a fraction of the median flat response
+ * @return: false if there are no references, or the image is too large to index
+ */
+bool EVTDefectMap::build(const float* pDark, const float* pFlat, size_t sizeX, size_t sizeY, bool mosaic,
+                         double hotSigma, double deadFraction){
+    clear();
+    size_t numPixels = sizeX * sizeY;
+    if((pDark == NULL && pFlat == NULL) || numPixels == 0 || numPixels > EVT_DEFECT_INDEX_MASK) return false;
+
+    vector<uint8_t> isDefect(numPixels, 0);
+    vector<float> image, scratch;
+    float medians[4], sigmas[4];
+    if(pDark != NULL){
+        image.assign(pDark, pDark + numPixels);
+        evtChannelMedians(image, sizeX, sizeY, mosaic, scratch, medians);
+        for(size_t y = 0; y < sizeY; y++){
+            for(size_t x = 0; x < sizeX; x++){
+                size_t index = y * sizeX + x;
+                image[index] = fabsf(pDark[index] - medians[evtChannel(x, y, mosaic)]);
+            }
+        }
+        evtChannelMedians(image, sizeX, sizeY, mosaic, scratch, sigmas);
+        for(size_t y = 0; y < sizeY; y++){
+            for(size_t x = 0; x < sizeX; x++){
+                int channel = evtChannel(x, y, mosaic);
+                float sigma = 1.4826f * sigmas[channel];
+                if(sigma < 1.0f) sigma = 1.0f;
+                size_t index = y * sizeX + x;
+                if(pDark[index] <= medians[channel] + (float) hotSigma * sigma) continue;
+                isDefect[index] = 1;
+                this->numHot++;
+            }
+        }
+    }
+    if(pFlat != NULL){
+        image.resize(numPixels);
+        for(size_t i = 0; i < numPixels; i++) image[i] = pFlat[i] - (pDark != NULL ? pDark[i] : 0.0f);
+        evtChannelMedians(image, sizeX, sizeY, mosaic, scratch, medians);
+        for(size_t y = 0; y < sizeY; y++){
+            for(size_t x = 0; x < sizeX; x++){
+                size_t index = y * sizeX + x;
+                if(isDefect[index] || image[index] >= (float) deadFraction * medians[evtChannel(x, y, mosaic)]) continue;
+                isDefect[index] = 1;
+                this->numDead++;
+            }
+        }
+    }
+
+    size_t step = mosaic ? 2 : 1;
+    for(size_t y = 0; y < sizeY; y++){
+        for(size_t x = 0; x < sizeX; x++){
+            size_t index = y * sizeX + x;
+            if(!isDefect[index]) continue;
+            uint32_t defect = (uint32_t) index;
+            if(x >= step && !isDefect[index - step])                    defect |= EVT_DEFECT_LEFT;
+            if(x + step < sizeX && !isDefect[index + step])             defect |= EVT_DEFECT_RIGHT;
+            if(y >= step && !isDefect[index - step * sizeX])            defect |= EVT_DEFECT_UP;
+            if(y + step < sizeY && !isDefect[index + step * sizeX])     defect |= EVT_DEFECT_DOWN;
+            this->defects.push_back(defect);
+        }
+    }
+    this->sizeX = sizeX;
+    this->sizeY = sizeY;
+    this->step = step;
+    return true;
+}
+
+
+void EVTDefectMap::clear(){
+    this->defects.clear();
+    this->sizeX = 0;
+    this->sizeY = 0;
+    this->step = 1;
+    this->numHot = 0;
+    this->numDead = 0;
+}
+
+
+bool EVTDefectMap::isReady(size_t sizeX, size_t sizeY, bool mosaic) const {
+    return this->sizeX != 0 && sizeX == this->sizeX && sizeY == this->sizeY && (this->step == 2) == mosaic;
+}
+
+
+size_t EVTDefectMap::getNumHot() const {
+    return this->numHot;
+}
+
+
+size_t EVTDefectMap::getNumDead() const {
+    return this->numDead;
+}
+
+
+bool EVTDefectMap::isMosaic() const {
+    return this->step == 2;
+}
+
+
+/**
+ * Copies the frame in strips. The defects of a row are patched once the row of its lower neighbour has
+ * been copied, reading only good neighbours, so the result does not depend on the patching order.
+ */
+template <typename T>
+void EVTDefectMap::copyFrame(const T* pSrc, T* pDst) const {
+    size_t rowBytes = this->sizeX * sizeof(T);
+    size_t stripRows = rowBytes >= EVT_DEFECT_STRIP_BYTES ? 1 : EVT_DEFECT_STRIP_BYTES / rowBytes;
+    size_t numPixels = this->sizeX * this->sizeY;
+    size_t next = 0;
+    for(size_t y = 0; y < this->sizeY; y += stripRows){
+        size_t rows = min(stripRows, this->sizeY - y);
+        memcpy(pDst + y * this->sizeX, pSrc + y * this->sizeX, rows * rowBytes);
+        size_t copied = y + rows;
+        size_t end = (copied == this->sizeY) ? numPixels : (copied > this->step ? (copied - this->step) * this->sizeX : 0);
+        for(; next < this->defects.size() && (this->defects[next] & EVT_DEFECT_INDEX_MASK) < end; next++)
+            evtPatchDefect(pDst, this->defects[next], this->sizeX, this->step);
+    }
+}
+
+
+/**
+ * Copies an 8 bit frame, and corrects defective pixels
+ *
+ * @params[in]:  pSrc   -> raw frame with the size of the map
+ * @params[out]: pDst   -> corrected frame
+ * @return: void
+ */
+void EVTDefectMap::copy(const uint8_t* pSrc, uint8_t* pDst) const {
+    copyFrame(pSrc, pDst);
+}
+
+
+/**
+ * Copies a 16 bit frame, and corrects defective pixels
+ *
+ * @params[in]:  pSrc   -> raw frame with the size of the map
+ * @params[out]: pDst   -> corrected frame
+ * @return: void
+ */
+void EVTDefectMap::copy(const uint16_t* pSrc, uint16_t* pDst) const {
+    copyFrame(pSrc, pDst);
+}
+
+
+/**
+ * Replaces defective pixels of a float image by the mean of their good neighbours
+ *
+ * @params[in,out]: pData   -> image with the size of the map
+ * @return: void
+ */
+void EVTDefectMap::correct(float* pData) const {
+    for(size_t i = 0; i < this->defects.size(); i++){
+        uint32_t defect = this->defects[i];
+        size_t index = defect & EVT_DEFECT_INDEX_MASK;
+        float sum = 0;
+        int count = 0;
+        if(defect & EVT_DEFECT_LEFT)  { sum += pData[index - this->step];               count++; }
+        if(defect & EVT_DEFECT_RIGHT) { sum += pData[index + this->step];               count++; }
+        if(defect & EVT_DEFECT_UP)    { sum += pData[index - this->step * this->sizeX]; count++; }
+        if(defect & EVT_DEFECT_DOWN)  { sum += pData[index + this->step * this->sizeX]; count++; }
+        if(count > 0) pData[index] = sum / count;
+    }
+}
+
+
+/**
+ * Replaces defective pixels of an 8 bit frame in place, used when the frame was not copied by the map
+ *
+ * @params[in,out]: pData   -> frame with the size of the map
+ * @return: void
+ */
+void EVTDefectMap::correct(uint8_t* pData) const {
+    for(size_t i = 0; i < this->defects.size(); i++) evtPatchDefect(pData, this->defects[i], this->sizeX, this->step);
+}
+
+
+void EVTDefectMap::correct(uint16_t* pData) const {
+    for(size_t i = 0; i < this->defects.size(); i++) evtPatchDefect(pData, this->defects[i], this->sizeX, this->step);
+}
@@ -0,0 +1,76 @@
+/**
+ * Header file for the ADEmergentVision defective pixel map
+ *
+ * Hot pixels are found in the averaged dark reference (robust outliers above the median), and dead
+ * pixels in the averaged flat reference (response far below the median). The defects are kept as a
+ * sorted list of 32 bit entries, holding the pixel index and a mask of the good 4-neighbours to
+ * interpolate from, so correcting a frame only touches the defective pixels. On a Bayer mosaic the
+ * medians are taken per color channel, and the neighbours are the nearest pixels of the same color,
+ * two pixels away.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTDEFECTMAP_H
+#define EVTDEFECTMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Each defect entry holds the pixel index in the low 28 bits, and the neighbour mask in the high 4 bits
+#define EVT_DEFECT_INDEX_BITS       28
+#define EVT_DEFECT_INDEX_MASK       ((1u << EVT_DEFECT_INDEX_BITS) - 1)
+#define EVT_DEFECT_LEFT             (1u << 28)
+#define EVT_DEFECT_RIGHT            (1u << 29)
+#define EVT_DEFECT_UP               (1u << 30)
+#define EVT_DEFECT_DOWN             (1u << 31)
+
+// Frames are copied in strips of about this many bytes, and the defects patched while the strip is in cache
+#define EVT_DEFECT_STRIP_BYTES      65536
+
+
+class EVTDefectMap {
+
+    public:
+
+        EVTDefectMap();
+
+        // builds the map from averaged dark and/or flat references, either may be NULL
+        bool build(const float* pDark, const float* pFlat, size_t sizeX, size_t sizeY, bool mosaic,
+                   double hotSigma, double deadFraction);
+        void clear();
+
+        bool isReady(size_t sizeX, size_t sizeY, bool mosaic) const;
+        size_t getNumHot() const;
+        size_t getNumDead() const;
+        bool isMosaic() const;
+
+        // copies a frame with the size of the map, replacing defective pixels by the mean of their good neighbours
+        void copy(const uint8_t* pSrc, uint8_t* pDst) const;
+        void copy(const uint16_t* pSrc, uint16_t* pDst) const;
+
+        // corrects defective pixels in place, used for per pixel calibration data and transformed frames
+        void correct(float* pData) const;
+        void correct(uint8_t* pData) const;
+        void correct(uint16_t* pData) const;
+
+    private:
+
+        std::vector<uint32_t> defects;
+        size_t sizeX;
+        size_t sizeY;
+        // distance to the neighbours, 2 on a Bayer mosaic
+        size_t step;
+        size_t numHot;
+        size_t numDead;
+
+        template <typename T> void copyFrame(const T* pSrc, T* pDst) const;
+};
+
+
+#endif
@@ -0,0 +1,362 @@
+/**
+ * Source file for the ADEmergentVision drift estimator
+ *
+ * Phase correlation: both the reference and the current ROI have their mean removed and a Hann window
+ * applied, and are transformed with a radix-2 FFT. The normalized cross power spectrum is transformed
+ * back, and the location of its peak is the shift of the current frame relative to the reference.
+ * Sub-pixel precision is obtained with a parabolic fit through the peak and its neighbors on each axis.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <math.h>
+
+#include "evtDriftEstimator.h"
+
+using namespace std;
+
+
+static const double EVT_PI = 3.14159265358979323846;
+
+// Fraction of the mean cross power magnitude added to the normalization of each frequency
+static const double EVT_DRIFT_REGULARIZATION = 0.1;
+
+
+// -----------------------------------------------------------------------
+// FFT helpers
+// -----------------------------------------------------------------------
+
+
+/**
+ * In place iterative radix-2 FFT. The inverse is not scaled.
+ *
+ * @params[in,out]: a       -> data to transform
+ * @params[in]:     n       -> number of elements, must be a power of two
+ * @params[in]:     inverse -> true for the inverse transform
+ */
+static void evtFFT(complex<double>* a, size_t n, bool inverse){
+    for(size_t i = 1, j = 0; i < n; i++){
+        size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if(i < j) swap(a[i], a[j]);
+    }
+    for(size_t len = 2; len <= n; len <<= 1){
+        double angle = 2 * EVT_PI / len * (inverse ? 1 : -1);
+        complex<double> wLen(cos(angle), sin(angle));
+        size_t half = len / 2;
+        for(size_t i = 0; i < n; i += len){
+            complex<double> w(1, 0);
+            for(size_t j = 0; j < half; j++){
+                complex<double> u = a[i + j];
+                complex<double> v = a[i + j + half] * w;
+                a[i + j] = u + v;
+                a[i + j + half] = u - v;
+                w *= wLen;
+            }
+        }
+    }
+}
+
+
+/**
+ * 2D FFT of a row major nx by ny array, rows first, then columns
+ */
+static void evtFFT2D(vector<complex<double> >& data, size_t nx, size_t ny, bool inverse, vector<complex<double> >& line){
+    for(size_t y = 0; y < ny; y++) evtFFT(&data[y * nx], nx, inverse);
+    line.resize(ny);
+    for(size_t x = 0; x < nx; x++){
+        for(size_t y = 0; y < ny; y++) line[y] = data[y * nx + x];
+        evtFFT(&line[0], ny, inverse);
+        for(size_t y = 0; y < ny; y++) data[y * nx + x] = line[y];
+    }
+}
+
+
+/**
+ * Removes the mean, applies a Hann window and computes the spectrum of a cropped ROI
+ */
+static void evtComputeSpectrum(const vector<float>& pixels, size_t nx, size_t ny, vector<complex<double> >& spectrum, vector<complex<double> >& line){
+    double mean = 0;
+    for(size_t i = 0; i < pixels.size(); i++) mean += pixels[i];
+    mean /= pixels.size();
+
+    spectrum.resize(nx * ny);
+    for(size_t y = 0; y < ny; y++){
+        double wy = 0.5 - 0.5 * cos(2 * EVT_PI * y / (ny - 1));
+        for(size_t x = 0; x < nx; x++){
+            double wx = 0.5 - 0.5 * cos(2 * EVT_PI * x / (nx - 1));
+            spectrum[y * nx + x] = complex<double>((pixels[y * nx + x] - mean) * wx * wy, 0);
+        }
+    }
+    evtFFT2D(spectrum, nx, ny, false, line);
+}
+
+
+/**
+ * Largest power of two that is not larger than n, capped at EVT_DRIFT_MAX_FFT_SIZE
+ */
+static size_t evtFloorPow2(size_t n){
+    size_t p = 1;
+    while(p * 2 <= n && p * 2 <= EVT_DRIFT_MAX_FFT_SIZE) p *= 2;
+    return p;
+}
+
+
+/**
+ * Sub-pixel offset of a peak from its two neighbors using a parabolic fit
+ */
+static double evtParabolicOffset(double left, double center, double right){
+    double denom = left - 2 * center + right;
+    if(fabs(denom) < 1e-12) return 0;
+    double offset = 0.5 * (left - right) / denom;
+    if(offset > 0.5) offset = 0.5;
+    if(offset < -0.5) offset = -0.5;
+    return offset;
+}
+
+
+// -----------------------------------------------------------------------
+// EVTDriftEstimator
+// -----------------------------------------------------------------------
+
+
+EVTDriftEstimator::EVTDriftEstimator(EVTDriftCallback callback, void* pUser)
+    : callback(callback), pUser(pUser), executorClient(-1), maxJobs(0), numInFlight(0), running(false),
+      referenceSizeX(0), referenceSizeY(0), referenceRequested(false), numDropped(0) {}
+
+
+EVTDriftEstimator::~EVTDriftEstimator(){
+    stop();
+}
+
+
+/**
+ * Starts queueing frames on the shared executor. If the estimator is already running it is restarted.
+ *
+ * @params[in]: executorClient  -> executor client of the camera
+ * @params[in]: maxInFlight     -> frames processed in parallel, twice as many may be queued or running
+ * @return: void
+ */
+void EVTDriftEstimator::start(int executorClient, int maxInFlight){
+    stop();
+    if(maxInFlight < 1) maxInFlight = 1;
+    lock_guard<mutex> lock(this->jobMutex);
+    this->executorClient = executorClient;
+    this->running = true;
+    // allow a frame in flight on every worker, plus one waiting
+    this->maxJobs = 2 * maxInFlight;
+    this->numDropped = 0;
+}
+
+
+/**
+ * Stops queueing frames, and waits for the queued and running tasks to return. Queued frames are
+ * discarded without being processed.
+ *
+ * @return: void
+ */
+void EVTDriftEstimator::stop(){
+    unique_lock<mutex> lock(this->jobMutex);
+    this->running = false;
+    while(this->numInFlight > 0) this->jobDone.wait(lock);
+}
+
+
+bool EVTDriftEstimator::isRunning(){
+    lock_guard<mutex> lock(this->jobMutex);
+    return this->running;
+}
+
+
+void EVTDriftEstimator::requestReference(){
+    lock_guard<mutex> lock(this->jobMutex);
+    this->referenceRequested = true;
+}
+
+
+bool EVTDriftEstimator::hasReference(){
+    lock_guard<mutex> lock(this->jobMutex);
+    return this->reference.get() != NULL;
+}
+
+
+size_t EVTDriftEstimator::getNumDropped() const {
+    return this->numDropped;
+}
+
+
+/**
+ * Crops a power of two sized window from the center of the ROI, and either stores it as the new reference
+ * or queues it on the executor. The first frame, and the first frame after the window size changes,
+ * always becomes the reference.
+ */
+template <typename T>
+bool EVTDriftEstimator::submitFrame(const T* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, int uniqueId, const epicsTimeStamp& timeStamp){
+    // an empty ROI selects the full frame
+    EVTRoi window = roi;
+    if(window.sizeX == 0 || window.sizeY == 0){
+        window.x = 0;
+        window.y = 0;
+        window.sizeX = sizeX;
+        window.sizeY = sizeY;
+    }
+    if(window.x >= sizeX || window.y >= sizeY) return false;
+    if(window.x + window.sizeX > sizeX) window.sizeX = sizeX - window.x;
+    if(window.y + window.sizeY > sizeY) window.sizeY = sizeY - window.y;
+
+    size_t nx = evtFloorPow2(window.sizeX);
+    size_t ny = evtFloorPow2(window.sizeY);
+    if(nx < 8 || ny < 8) return false;
+    size_t x0 = window.x + (window.sizeX - nx) / 2;
+    size_t y0 = window.y + (window.sizeY - ny) / 2;
+
+    EVTDriftJob job;
+    job.pixels.resize(nx * ny);
+    for(size_t y = 0; y < ny; y++){
+        const T* row = pData + (y0 + y) * sizeX + x0;
+        float* out = &job.pixels[y * nx];
+        for(size_t x = 0; x < nx; x++) out[x] = (float) row[x];
+    }
+    job.fftSizeX = nx;
+    job.fftSizeY = ny;
+    job.uniqueId = uniqueId;
+    job.timeStamp = timeStamp;
+
+    unique_lock<mutex> lock(this->jobMutex);
+    if(!this->running) return false;
+    if(this->referenceRequested || !this->reference || this->referenceSizeX != nx || this->referenceSizeY != ny){
+        this->referenceRequested = false;
+        lock.unlock();
+        shared_ptr<EVTSpectrum> spectrum(new EVTSpectrum());
+        vector<complex<double> > line;
+        evtComputeSpectrum(job.pixels, nx, ny, *spectrum, line);
+        lock.lock();
+        this->reference = spectrum;
+        this->referenceSizeX = nx;
+        this->referenceSizeY = ny;
+        return true;
+    }
+    if(this->numInFlight >= this->maxJobs){
+        this->numDropped++;
+        return false;
+    }
+    job.reference = this->reference;
+    this->numInFlight++;
+    int client = this->executorClient;
+    lock.unlock();
+
+    shared_ptr<EVTDriftJob> pJob(new EVTDriftJob(move(job)));
+    if(!EVTExecutor::getInstance().submit(client, [this, pJob](){ runJob(*pJob); })){
+        lock.lock();
+        this->numInFlight--;
+        this->jobDone.notify_all();
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Queues an 8 bit frame for drift estimation
+ *
+ * @params[in]: pData       -> pointer to image data, rows are contiguous
+ * @params[in]: sizeX       -> image width
+ * @params[in]: sizeY       -> image height
+ * @params[in]: roi         -> region used for the correlation, empty for the full frame
+ * @params[in]: uniqueId    -> id of the frame, passed back with the result
+ * @params[in]: timeStamp   -> timestamp of the frame, passed back with the result
+ * @return: false if the frame was not queued
+ */
+bool EVTDriftEstimator::submit(const uint8_t* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, int uniqueId, const epicsTimeStamp& timeStamp){
+    return submitFrame(pData, sizeX, sizeY, roi, uniqueId, timeStamp);
+}
+
+
+/**
+ * Queues a 16 bit frame for drift estimation, see the 8 bit overload
+ */
+bool EVTDriftEstimator::submit(const uint16_t* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, int uniqueId, const epicsTimeStamp& timeStamp){
+    return submitFrame(pData, sizeX, sizeY, roi, uniqueId, timeStamp);
+}
+
+
+/**
+ * Executor task for one frame. Frames queued before the estimator was stopped are discarded.
+ */
+void EVTDriftEstimator::runJob(EVTDriftJob& job){
+    unique_ptr<EVTDriftScratch> scratch;
+    {
+        lock_guard<mutex> lock(this->jobMutex);
+        if(this->running){
+            if(this->scratchPool.empty()) scratch.reset(new EVTDriftScratch());
+            else{
+                scratch = move(this->scratchPool.back());
+                this->scratchPool.pop_back();
+            }
+        }
+    }
+    if(scratch) processJob(job, scratch->spectrum, scratch->line);
+
+    // stop may return, and the estimator be destroyed, as soon as the lock is released
+    lock_guard<mutex> lock(this->jobMutex);
+    if(scratch) this->scratchPool.push_back(move(scratch));
+    this->numInFlight--;
+    this->jobDone.notify_all();
+}
+
+
+/**
+ * Computes the shift of a single job against the reference it was queued with, and reports it
+ */
+void EVTDriftEstimator::processJob(EVTDriftJob& job, EVTSpectrum& scratch, vector<complex<double> >& line){
+    size_t nx = job.fftSizeX;
+    size_t ny = job.fftSizeY;
+    const EVTSpectrum& reference = *job.reference;
+
+    evtComputeSpectrum(job.pixels, nx, ny, scratch, line);
+    double meanMagnitude = 0;
+    for(size_t i = 0; i < scratch.size(); i++){
+        scratch[i] *= conj(reference[i]);
+        meanMagnitude += abs(scratch[i]);
+    }
+    meanMagnitude /= scratch.size();
+    // regularize the normalization so weak, noise dominated frequencies do not get full weight
+    double epsilon = EVT_DRIFT_REGULARIZATION * meanMagnitude + 1e-12;
+    // the highest possible correlation peak is reached when all normalized phases line up
+    double peakLimit = 0;
+    for(size_t i = 0; i < scratch.size(); i++){
+        scratch[i] /= abs(scratch[i]) + epsilon;
+        peakLimit += abs(scratch[i]);
+    }
+    evtFFT2D(scratch, nx, ny, true, line);
+
+    size_t peakIndex = 0;
+    double peak = scratch[0].real();
+    for(size_t i = 1; i < scratch.size(); i++){
+        if(scratch[i].real() > peak){
+            peak = scratch[i].real();
+            peakIndex = i;
+        }
+    }
+    size_t px = peakIndex % nx;
+    size_t py = peakIndex / nx;
+    double left   = scratch[py * nx + (px + nx - 1) % nx].real();
+    double right  = scratch[py * nx + (px + 1) % nx].real();
+    double up     = scratch[((py + ny - 1) % ny) * nx + px].real();
+    double down   = scratch[((py + 1) % ny) * nx + px].real();
+
+    EVTDriftResult result;
+    result.dx = px + evtParabolicOffset(left, peak, right);
+    result.dy = py + evtParabolicOffset(up, peak, down);
+    // the correlation is circular, so large shifts are negative shifts
+    if(result.dx > nx / 2.0) result.dx -= nx;
+    if(result.dy > ny / 2.0) result.dy -= ny;
+    result.quality = peakLimit > 0 ? peak / peakLimit : 0;
+    result.uniqueId = job.uniqueId;
+    result.timeStamp = job.timeStamp;
+    this->callback(this->pUser, &result);
+}
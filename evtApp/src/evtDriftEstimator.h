@@ -0,0 +1,116 @@
+/**
+ * Header file for the ADEmergentVision drift estimator
+ *
+ * Estimates the sub-pixel shift of frames against a reference frame using phase correlation
+ * over a power of two sized ROI. Frames are cropped on the image thread, and the FFTs are computed
+ * as tasks on the shared executor, which report each result through a callback.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTDRIFTESTIMATOR_H
+#define EVTDRIFTESTIMATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <complex>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <epicsTime.h>
+
+#include "evtRoiStats.h"
+#include "evtExecutor.h"
+
+// Largest FFT size used in either dimension
+#define EVT_DRIFT_MAX_FFT_SIZE 1024
+
+
+// Result of a single drift estimate
+typedef struct EVTDriftResult {
+    double dx;
+    double dy;
+    // height of the normalized phase correlation peak, 1 for a perfect match
+    double quality;
+    int uniqueId;
+    epicsTimeStamp timeStamp;
+} EVTDriftResult;
+
+
+typedef void (*EVTDriftCallback)(void* pUser, const EVTDriftResult* pResult);
+
+
+class EVTDriftEstimator {
+
+    public:
+
+        EVTDriftEstimator(EVTDriftCallback callback, void* pUser);
+        ~EVTDriftEstimator();
+
+        // frames are processed as tasks of the executor client, with at most maxInFlight queued or running
+        void start(int executorClient, int maxInFlight);
+        // discards the queued frames, and waits for the running ones to finish
+        void stop();
+        bool isRunning();
+
+        // the next submitted frame replaces the reference
+        void requestReference();
+        bool hasReference();
+
+        // crops the ROI out of the frame and queues it, returns false if the frame was dropped
+        bool submit(const uint8_t* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, int uniqueId, const epicsTimeStamp& timeStamp);
+        bool submit(const uint16_t* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, int uniqueId, const epicsTimeStamp& timeStamp);
+
+        size_t getNumDropped() const;
+
+    private:
+
+        typedef std::vector<std::complex<double> > EVTSpectrum;
+
+        // FFT buffers, reused by the tasks
+        typedef struct EVTDriftScratch {
+            EVTSpectrum spectrum;
+            std::vector<std::complex<double> > line;
+        } EVTDriftScratch;
+
+        // Cropped frame waiting to be processed by a worker
+        typedef struct EVTDriftJob {
+            std::vector<float> pixels;
+            size_t fftSizeX;
+            size_t fftSizeY;
+            std::shared_ptr<const EVTSpectrum> reference;
+            int uniqueId;
+            epicsTimeStamp timeStamp;
+        } EVTDriftJob;
+
+        EVTDriftCallback callback;
+        void* pUser;
+
+        int executorClient;
+        size_t maxJobs;
+        size_t numInFlight;
+        bool running;
+        std::mutex jobMutex;
+        std::condition_variable jobDone;
+        std::vector<std::unique_ptr<EVTDriftScratch> > scratchPool;
+
+        // spectrum of the windowed reference ROI, replaced atomically under jobMutex
+        std::shared_ptr<const EVTSpectrum> reference;
+        size_t referenceSizeX;
+        size_t referenceSizeY;
+        bool referenceRequested;
+        size_t numDropped;
+
+        template <typename T> bool submitFrame(const T* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, int uniqueId, const epicsTimeStamp& timeStamp);
+        void runJob(EVTDriftJob& job);
+        void processJob(EVTDriftJob& job, EVTSpectrum& scratch, std::vector<std::complex<double> >& lineScratch);
+};
+
+
+#endif
@@ -0,0 +1,490 @@
+/**
+ * Source file for the ADEmergentVision shared executor
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "evtExecutor.h"
+
+using namespace std;
+
+
+// Pass increment of a client with priority 1, higher priorities advance by a fraction of it
+static const uint64_t EVT_EXECUTOR_STRIDE = 1 << 20;
+
+
+static int evtClampPriority(int priority){
+    if(priority < EVT_EXECUTOR_MIN_PRIORITY) return EVT_EXECUTOR_MIN_PRIORITY;
+    if(priority > EVT_EXECUTOR_MAX_PRIORITY) return EVT_EXECUTOR_MAX_PRIORITY;
+    return priority;
+}
+
+
+EVTExecutor::EVTExecutor()
+    : running(false), started(false), clients(new EVTClientList()), nextClientId(0), virtualTime(0) {}
+
+
+EVTExecutor& EVTExecutor::getInstance(){
+    // never destroyed, so the workers are not joined while the process is exiting
+    static EVTExecutor* instance = new EVTExecutor();
+    return *instance;
+}
+
+
+/**
+ * Restarts the workers with a new thread count and CPU set. Queued tasks are kept, and running tasks
+ * finish before the workers are replaced.
+ *
+ * @params[in]: numThreads  -> number of workers, 0 for one per core of the CPU set, or of the machine
+ * @params[in]: cpuSet      -> cores the workers may run on, such as "0-3,6", empty or NULL for any
+ * @return: false if the CPU set could not be parsed
+ */
+bool EVTExecutor::configure(int numThreads, const char* cpuSet){
+    vector<int> newCpus;
+    if(!parseCpuSet(cpuSet, newCpus)) return false;
+    if(numThreads < 1) numThreads = newCpus.empty() ? (int) thread::hardware_concurrency() : (int) newCpus.size();
+    if(numThreads < 1) numThreads = 1;
+
+    lock_guard<mutex> lock(this->configMutex);
+    stopWorkers();
+    this->cpus = newCpus;
+    startWorkers(numThreads);
+    this->started = true;
+    return true;
+}
+
+
+/**
+ * Starts one worker per core, unless the workers were already started by configure or an earlier task
+ */
+void EVTExecutor::startDefaultWorkers(){
+    lock_guard<mutex> lock(this->configMutex);
+    if(this->started) return;
+    int numThreads = (int) thread::hardware_concurrency();
+    startWorkers(numThreads > 0 ? numThreads : 1);
+    this->started = true;
+}
+
+
+int EVTExecutor::getNumThreads(){
+    lock_guard<mutex> lock(this->configMutex);
+    return (int) this->workers.size();
+}
+
+
+/**
+ * Adds a client. Clients are spread over the workers in the order they register.
+ *
+ * @params[in]: name        -> name shown in the report, usually the port name
+ * @params[in]: priority    -> share of the home worker, from EVT_EXECUTOR_MIN_PRIORITY to EVT_EXECUTOR_MAX_PRIORITY
+ * @return: id of the client
+ */
+int EVTExecutor::registerClient(const char* name, int priority){
+    lock_guard<mutex> configLock(this->configMutex);
+    shared_ptr<EVTExecutorClient> client(new EVTExecutorClient());
+    client->name = name != NULL ? name : "";
+    client->priority = evtClampPriority(priority);
+    client->numQueued = 0;
+    client->pass = this->virtualTime.load();
+    client->numRunning = 0;
+    client->removed = false;
+    client->numTasks = 0;
+    client->numStolen = 0;
+    client->latencySum = 0;
+    client->latencyMax = 0;
+    client->latencyCount = 0;
+
+    lock_guard<mutex> lock(this->clientMutex);
+    client->id = this->nextClientId++;
+    shared_ptr<EVTClientList> list(new EVTClientList(*this->clients));
+    list->push_back(client);
+    assignHomes(*list, (int) this->workers.size());
+    this->clients = list;
+    return client->id;
+}
+
+
+/**
+ * Removes a client. Must not be called from one of the client's own tasks.
+ *
+ * @params[in]: clientId    -> id returned by registerClient
+ * @return: void
+ */
+void EVTExecutor::unregisterClient(int clientId){
+    shared_ptr<EVTExecutorClient> client;
+    {
+        lock_guard<mutex> configLock(this->configMutex);
+        lock_guard<mutex> lock(this->clientMutex);
+        shared_ptr<EVTClientList> list(new EVTClientList());
+        for(size_t i = 0; i < this->clients->size(); i++){
+            if((*this->clients)[i]->id == clientId) client = (*this->clients)[i];
+            else list->push_back((*this->clients)[i]);
+        }
+        if(!client) return;
+        assignHomes(*list, (int) this->workers.size());
+        this->clients = list;
+    }
+
+    // the client is no longer in the list, so the workers do not count its queued tasks as runnable
+    unique_lock<mutex> lock(client->mutex);
+    client->removed = true;
+    client->tasks.clear();
+    client->numQueued = 0;
+    while(client->numRunning > 0) client->idle.wait(lock);
+}
+
+
+void EVTExecutor::setPriority(int clientId, int priority){
+    shared_ptr<EVTExecutorClient> client = findClient(clientId);
+    if(!client) return;
+    lock_guard<mutex> lock(client->mutex);
+    client->priority = evtClampPriority(priority);
+}
+
+
+/**
+ * Queues a task for a client
+ *
+ * @params[in]: clientId    -> id returned by registerClient
+ * @params[in]: task        -> function to run on a worker
+ * @return: false if the client is not registered
+ */
+bool EVTExecutor::submit(int clientId, function<void()> task){
+    shared_ptr<EVTExecutorClient> client = findClient(clientId);
+    if(!client) return false;
+    if(!this->started.load()) startDefaultWorkers();
+    {
+        lock_guard<mutex> lock(client->mutex);
+        if(client->removed) return false;
+        // a client that was idle resumes at the current position, rather than catching up on the time it was idle
+        uint64_t now = this->virtualTime.load();
+        if(client->tasks.empty() && client->pass.load() < now) client->pass = now;
+        EVTExecutorTask queued;
+        queued.run = move(task);
+        queued.submitted = chrono::steady_clock::now();
+        client->tasks.push_back(move(queued));
+        client->numQueued++;
+    }
+    {
+        // taken so a worker can not miss the task between checking for tasks and waiting
+        lock_guard<mutex> lock(this->idleMutex);
+    }
+    this->taskReady.notify_one();
+    return true;
+}
+
+
+/**
+ * Reads the statistics of a client
+ *
+ * @params[in]:  clientId       -> id returned by registerClient
+ * @params[out]: pStats         -> statistics of the client
+ * @params[in]:  resetLatency   -> restart the latency mean and max after reading them
+ * @return: false if the client is not registered
+ */
+bool EVTExecutor::getStats(int clientId, EVTExecutorStats* pStats, bool resetLatency){
+    shared_ptr<EVTExecutorClient> client = findClient(clientId);
+    if(!client) return false;
+    lock_guard<mutex> lock(client->mutex);
+    pStats->numTasks = client->numTasks;
+    pStats->numStolen = client->numStolen;
+    pStats->numQueued = client->tasks.size();
+    pStats->latencyMean = client->latencyCount > 0 ? client->latencySum / client->latencyCount : 0;
+    pStats->latencyMax = client->latencyMax;
+    if(resetLatency){
+        client->latencySum = 0;
+        client->latencyMax = 0;
+        client->latencyCount = 0;
+    }
+    return true;
+}
+
+
+/**
+ * Prints the workers and the statistics of every client
+ *
+ * @params[in]: fp  -> file to print to
+ * @return: void
+ */
+void EVTExecutor::report(FILE* fp){
+    shared_ptr<const EVTClientList> list;
+    {
+        lock_guard<mutex> configLock(this->configMutex);
+        fprintf(fp, "EVT executor: %d workers, CPU set:", (int) this->workers.size());
+        if(this->cpus.empty()) fprintf(fp, " any");
+        for(size_t i = 0; i < this->cpus.size(); i++) fprintf(fp, " %d", this->cpus[i]);
+        fprintf(fp, "\n");
+        lock_guard<mutex> lock(this->clientMutex);
+        list = this->clients;
+    }
+    for(size_t i = 0; i < list->size(); i++){
+        EVTExecutorStats stats;
+        EVTExecutorClient& client = *(*list)[i];
+        if(!getStats(client.id, &stats, false)) continue;
+        int priority;
+        {
+            lock_guard<mutex> lock(client.mutex);
+            priority = client.priority;
+        }
+        fprintf(fp, "  %-20s priority %2d, worker %2d, queued %4lu, tasks %10llu, stolen %10llu, latency mean %.3f ms, max %.3f ms\n",
+                client.name.c_str(), priority, client.home.load(), (unsigned long) stats.numQueued,
+                (unsigned long long) stats.numTasks, (unsigned long long) stats.numStolen,
+                stats.latencyMean * 1e3, stats.latencyMax * 1e3);
+    }
+}
+
+
+// -----------------------------------------------------------------------
+// Workers
+// -----------------------------------------------------------------------
+
+
+void EVTExecutor::startWorkers(int numThreads){
+    {
+        lock_guard<mutex> lock(this->idleMutex);
+        this->running = true;
+    }
+    {
+        lock_guard<mutex> lock(this->clientMutex);
+        shared_ptr<EVTClientList> list(new EVTClientList(*this->clients));
+        assignHomes(*list, numThreads);
+        this->clients = list;
+    }
+    for(int i = 0; i < numThreads; i++){
+        this->workers.push_back(thread(&EVTExecutor::workerLoop, this, i));
+        if(!this->cpus.empty()) setAffinity(this->workers.back(), this->cpus);
+    }
+}
+
+
+void EVTExecutor::stopWorkers(){
+    {
+        lock_guard<mutex> lock(this->idleMutex);
+        this->running = false;
+    }
+    this->taskReady.notify_all();
+    for(size_t i = 0; i < this->workers.size(); i++) this->workers[i].join();
+    this->workers.clear();
+}
+
+
+/**
+ * Spreads the clients over the workers in list order
+ */
+void EVTExecutor::assignHomes(EVTClientList& list, int numThreads){
+    for(size_t i = 0; i < list.size(); i++) list[i]->home = numThreads > 0 ? (int) (i % numThreads) : 0;
+}
+
+
+shared_ptr<EVTExecutor::EVTExecutorClient> EVTExecutor::findClient(int clientId){
+    lock_guard<mutex> lock(this->clientMutex);
+    for(size_t i = 0; i < this->clients->size(); i++){
+        if((*this->clients)[i]->id == clientId) return (*this->clients)[i];
+    }
+    return shared_ptr<EVTExecutorClient>();
+}
+
+
+/**
+ * Chooses the client a worker runs next. Among the worker's own clients with queued tasks, the one with
+ * the lowest pass runs. If none has tasks, the worker steals from the client with the longest queue.
+ *
+ * @params[in]:  worker     -> index of the worker
+ * @params[out]: pStolen    -> true if the client belongs to another worker
+ * @return: chosen client, empty if there are no queued tasks
+ */
+shared_ptr<EVTExecutor::EVTExecutorClient> EVTExecutor::pickClient(int worker, bool* pStolen){
+    shared_ptr<const EVTClientList> list;
+    {
+        lock_guard<mutex> lock(this->clientMutex);
+        list = this->clients;
+    }
+    shared_ptr<EVTExecutorClient> best;
+    uint64_t bestPass = 0;
+    for(size_t i = 0; i < list->size(); i++){
+        const shared_ptr<EVTExecutorClient>& client = (*list)[i];
+        if(client->home.load() != worker || client->numQueued.load() == 0) continue;
+        uint64_t pass = client->pass.load();
+        if(!best || pass < bestPass){
+            best = client;
+            bestPass = pass;
+        }
+    }
+    *pStolen = false;
+    if(best) return best;
+
+    size_t longest = 0;
+    for(size_t i = 0; i < list->size(); i++){
+        size_t numQueued = (*list)[i]->numQueued.load();
+        if(numQueued > longest){
+            best = (*list)[i];
+            longest = numQueued;
+        }
+    }
+    *pStolen = (best && best->home.load() != worker);
+    return best;
+}
+
+
+/**
+ * Checks whether a registered client has a queued task
+ */
+bool EVTExecutor::hasQueuedTask(){
+    shared_ptr<const EVTClientList> list;
+    {
+        lock_guard<mutex> lock(this->clientMutex);
+        list = this->clients;
+    }
+    for(size_t i = 0; i < list->size(); i++){
+        if((*list)[i]->numQueued.load() > 0) return true;
+    }
+    return false;
+}
+
+
+/**
+ * Main loop of the workers. A worker sleeps until a registered client has a queued task. If another
+ * worker takes the task first, the check is repeated before sleeping again.
+ *
+ * @params[in]: worker  -> index of the worker
+ * @return: void
+ */
+void EVTExecutor::workerLoop(int worker){
+    while(true){
+        {
+            unique_lock<mutex> lock(this->idleMutex);
+            while(this->running && !hasQueuedTask()) this->taskReady.wait(lock);
+            if(!this->running) return;
+        }
+        bool stolen;
+        shared_ptr<EVTExecutorClient> client = pickClient(worker, &stolen);
+        if(!client) continue;
+
+        EVTExecutorTask task;
+        {
+            lock_guard<mutex> lock(client->mutex);
+            if(client->tasks.empty()) continue;
+            task = move(client->tasks.front());
+            client->tasks.pop_front();
+            client->numQueued--;
+            client->numRunning++;
+
+            double latency = chrono::duration<double>(chrono::steady_clock::now() - task.submitted).count();
+            client->latencySum += latency;
+            client->latencyCount++;
+            if(latency > client->latencyMax) client->latencyMax = latency;
+
+            uint64_t pass = client->pass.load();
+            if(pass > this->virtualTime.load()) this->virtualTime = pass;
+            client->pass = pass + EVT_EXECUTOR_STRIDE / client->priority;
+        }
+
+        task.run();
+
+        {
+            lock_guard<mutex> lock(client->mutex);
+            client->numRunning--;
+            client->numTasks++;
+            if(stolen) client->numStolen++;
+        }
+        client->idle.notify_all();
+    }
+}
+
+
+/**
+ * Parses a list of cores and ranges, such as "0-3,6"
+ *
+ * @params[in]:  cpuSet -> list to parse, empty or NULL for no cores
+ * @params[out]: cpus   -> parsed cores
+ * @return: false if the list is not valid
+ */
+bool EVTExecutor::parseCpuSet(const char* cpuSet, vector<int>& cpus){
+    cpus.clear();
+    if(cpuSet == NULL) return true;
+    const char* p = cpuSet;
+    while(*p == ' ') p++;
+    if(*p == '\0') return true;
+    while(true){
+        char* end;
+        long first = strtol(p, &end, 10);
+        if(end == p || first < 0) return false;
+        long last = first;
+        p = end;
+        if(*p == '-'){
+            p++;
+            last = strtol(p, &end, 10);
+            if(end == p || last < first) return false;
+            p = end;
+        }
+        for(long cpu = first; cpu <= last; cpu++) cpus.push_back((int) cpu);
+        if(*p == '\0') return true;
+        if(*p != ',') return false;
+        p++;
+    }
+}
+
+
+/**
+ * Restricts a worker to a set of cores. Workers may move between the cores of the set, so stolen
+ * tasks are not held up by a busy core. Not supported on platforms other than Linux and MSVC builds.
+ */
+void EVTExecutor::setAffinity(thread& worker, const vector<int>& cpus){
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(size_t i = 0; i < cpus.size(); i++){
+        if(cpus[i] < CPU_SETSIZE) CPU_SET(cpus[i], &set);
+    }
+    pthread_setaffinity_np(worker.native_handle(), sizeof(set), &set);
+#elif defined(_WIN32) && defined(_MSC_VER)
+    DWORD_PTR mask = 0;
+    for(size_t i = 0; i < cpus.size(); i++){
+        if(cpus[i] < (int) (8 * sizeof(DWORD_PTR))) mask |= ((DWORD_PTR) 1) << cpus[i];
+    }
+    SetThreadAffinityMask((HANDLE) worker.native_handle(), mask);
+#else
+    (void) worker;
+    (void) cpus;
+#endif
+}
+
+
+// -----------------------------------------------------------------------
+// IOC shell functions
+// -----------------------------------------------------------------------
+
+
+/**
+ * Sets the worker count and CPU set of the shared executor. Can be called before or after the
+ * cameras are configured.
+ *
+ * @params[in]: numThreads  -> number of workers, 0 for one per core of the CPU set
+ * @params[in]: cpuSet      -> cores the workers may run on, such as "0-3,6", empty for any
+ * @return: 0 on success, -1 if the CPU set is not valid
+ */
+int evtExecutorConfig(int numThreads, const char* cpuSet){
+    if(!EVTExecutor::getInstance().configure(numThreads, cpuSet)){
+        printf("Invalid CPU set %s, expected a list of cores and ranges such as 0-3,6\n", cpuSet);
+        return -1;
+    }
+    return 0;
+}
+
+
+void evtExecutorReport(){
+    EVTExecutor::getInstance().report(stdout);
+}
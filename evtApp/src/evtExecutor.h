@@ -0,0 +1,142 @@
+/**
+ * Header file for the ADEmergentVision shared executor
+ *
+ * Process wide thread pool that runs the per frame processing tasks of every camera in the IOC, so
+ * that several cameras share one set of worker threads rather than each starting its own. Each camera
+ * registers as a client with its own task queue. Every client has a home worker, which serves its
+ * clients by stride scheduling, so each camera gets a share of the worker proportional to its priority.
+ * A worker with nothing left on its own clients steals a task from the longest queue of another worker's
+ * clients, so idle cameras do not leave workers unused. The time tasks wait in the queue is kept per client.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTEXECUTOR_H
+#define EVTEXECUTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Range of client priorities, a client gets a share of its home worker proportional to its priority
+#define EVT_EXECUTOR_MIN_PRIORITY   1
+#define EVT_EXECUTOR_MAX_PRIORITY   10
+#define EVT_EXECUTOR_DEFAULT_PRIORITY 5
+
+
+// Statistics of a single client
+typedef struct EVTExecutorStats {
+    uint64_t numTasks;
+    // tasks run by a worker other than the home worker of the client
+    uint64_t numStolen;
+    size_t numQueued;
+    // time from submission to the start of a task, in seconds, since the statistics were last reset
+    double latencyMean;
+    double latencyMax;
+} EVTExecutorStats;
+
+
+class EVTExecutor {
+
+    public:
+
+        // the executor is created on first use and never destroyed. Its workers are started by configure,
+        // or with one worker per core when the first task is submitted.
+        static EVTExecutor& getInstance();
+
+        // restarts the workers, cpuSet is a list of cores and ranges such as "0-3,6", empty for no affinity
+        bool configure(int numThreads, const char* cpuSet);
+        int getNumThreads();
+
+        int registerClient(const char* name, int priority);
+        // discards the queued tasks of a client, and waits for its running tasks to finish
+        void unregisterClient(int clientId);
+        void setPriority(int clientId, int priority);
+
+        // queues a task, returns false if the client is not registered
+        bool submit(int clientId, std::function<void()> task);
+
+        bool getStats(int clientId, EVTExecutorStats* pStats, bool resetLatency);
+        void report(FILE* fp);
+
+    private:
+
+        typedef struct EVTExecutorTask {
+            std::function<void()> run;
+            std::chrono::steady_clock::time_point submitted;
+        } EVTExecutorTask;
+
+        // Queue and statistics of one client, guarded by its mutex
+        typedef struct EVTExecutorClient {
+            int id;
+            std::string name;
+            int priority;
+            // index of the worker that serves the client first, read by the workers without the client lock
+            std::atomic<int> home;
+            std::mutex mutex;
+            std::condition_variable idle;
+            std::deque<EVTExecutorTask> tasks;
+            std::atomic<size_t> numQueued;
+            // stride scheduling position, the client with the lowest pass runs next
+            std::atomic<uint64_t> pass;
+            int numRunning;
+            bool removed;
+            uint64_t numTasks;
+            uint64_t numStolen;
+            double latencySum;
+            double latencyMax;
+            uint64_t latencyCount;
+        } EVTExecutorClient;
+
+        typedef std::vector<std::shared_ptr<EVTExecutorClient> > EVTClientList;
+
+        EVTExecutor();
+
+        std::mutex configMutex;
+        std::vector<std::thread> workers;
+        std::vector<int> cpus;
+        bool running;
+        std::atomic<bool> started;
+
+        // the client list is replaced, never modified, so workers can scan a snapshot without holding the lock
+        std::mutex clientMutex;
+        std::shared_ptr<const EVTClientList> clients;
+        int nextClientId;
+
+        std::mutex idleMutex;
+        std::condition_variable taskReady;
+        std::atomic<uint64_t> virtualTime;
+
+        void startDefaultWorkers();
+        void startWorkers(int numThreads);
+        void stopWorkers();
+        void assignHomes(EVTClientList& list, int numThreads);
+        std::shared_ptr<EVTExecutorClient> findClient(int clientId);
+        bool hasQueuedTask();
+        std::shared_ptr<EVTExecutorClient> pickClient(int worker, bool* pStolen);
+        void workerLoop(int worker);
+        static bool parseCpuSet(const char* cpuSet, std::vector<int>& cpus);
+        static void setAffinity(std::thread& worker, const std::vector<int>& cpus);
+};
+
+
+// Functions called from the IOC shell
+int evtExecutorConfig(int numThreads, const char* cpuSet);
+void evtExecutorReport();
+
+
+#endif
@@ -0,0 +1,432 @@
+/**
+ * Source file for the ADEmergentVision flat field correction engine
+ *
+ * The correction kernels convert four pixels at a time to float with SSE2, apply the dark offset and gain,
+ * and either store the floats, or round and pack them back to the input type with saturation.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "evtSimd.h"
+#include "evtFlatField.h"
+
+using namespace std;
+
+
+#ifdef EVT_SIMD_SSE2
+/**
+ * Applies offset and gain to four pixels held as 32 bit integers
+ */
+static inline __m128 evtCorrect4(__m128i v, const float* pOffset, const float* pGain){
+    return _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(v), _mm_loadu_ps(pOffset)), _mm_loadu_ps(pGain));
+}
+
+
+/**
+ * Rounds four corrected values to integers clamped to [0, maxValue]
+ */
+static inline __m128i evtRound4(__m128 v, __m128 maxValue){
+    return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), maxValue));
+}
+#endif
+
+
+/**
+ * Scalar correction of a single pixel, rounding matches the SSE2 conversion (to nearest even)
+ */
+static inline float evtCorrect1(unsigned int value, float offset, float gain){
+    return ((float) value - offset) * gain;
+}
+
+
+static inline long evtRound1(float value, float maxValue){
+    if(value < 0) value = 0;
+    if(value > maxValue) value = maxValue;
+    return lrintf(value);
+}
+
+
+EVTFlatFieldCorrector::EVTFlatFieldCorrector()
+    : pDefects(NULL), sizeX(0), sizeY(0), ready(false), capturing(false), captureType(EVT_REFERENCE_DARK),
+      captureFrames(0), numCaptured(0), captureSizeX(0), captureSizeY(0) {
+    for(int i = 0; i < EVT_REFERENCE_NUM_TYPES; i++){
+        this->references[i].pixels = NULL;
+        this->references[i].sizeX = 0;
+        this->references[i].sizeY = 0;
+    }
+}
+
+
+/**
+ * Maps a reference file, and rebuilds the correction. The current reference is kept if the file is invalid.
+ *
+ * @params[in]:  type   -> dark or flat
+ * @params[in]:  path   -> path of the reference file
+ * @params[out]: error  -> reason for failure
+ * @return: true if the reference was loaded
+ */
+bool EVTFlatFieldCorrector::loadReference(EVTReferenceType type, const char* path, string& error){
+    EVTMappedFile file;
+    if(!file.open(path, error)) return false;
+
+    const EVTReferenceHeader* pHeader = (const EVTReferenceHeader*) file.getData();
+    if(file.getSize() < sizeof(EVTReferenceHeader) || pHeader->magic != EVT_REFERENCE_MAGIC
+        || pHeader->version != EVT_REFERENCE_VERSION){
+        error = string(path) + " is not a reference file";
+        return false;
+    }
+    if(pHeader->type != (uint32_t) type){
+        error = string(path) + (type == EVT_REFERENCE_DARK ? " is not a dark reference" : " is not a flat reference");
+        return false;
+    }
+    size_t numPixels = (size_t) pHeader->sizeX * pHeader->sizeY;
+    if(numPixels == 0 || file.getSize() < sizeof(EVTReferenceHeader) + numPixels * sizeof(float)){
+        error = string(path) + " is truncated";
+        return false;
+    }
+
+    EVTReference& reference = this->references[type];
+    reference.memory.clear();
+    reference.sizeX = pHeader->sizeX;
+    reference.sizeY = pHeader->sizeY;
+    // the header is 32 bytes, so the pixels are aligned within the page aligned mapping
+    reference.pixels = (const float*) (pHeader + 1);
+    reference.file.swap(file);
+    rebuild();
+    return true;
+}
+
+
+void EVTFlatFieldCorrector::clearReference(EVTReferenceType type){
+    EVTReference& reference = this->references[type];
+    reference.file.close();
+    reference.memory.clear();
+    reference.pixels = NULL;
+    reference.sizeX = 0;
+    reference.sizeY = 0;
+    rebuild();
+}
+
+
+bool EVTFlatFieldCorrector::hasReference(EVTReferenceType type) const {
+    return this->references[type].pixels != NULL;
+}
+
+
+/**
+ * Returns the averaged pixels of a reference
+ *
+ * @params[in]:  type   -> dark or flat
+ * @params[out]: pSizeX -> reference width
+ * @params[out]: pSizeY -> reference height
+ * @return: pointer to the reference pixels, NULL if there is no reference
+ */
+const float* EVTFlatFieldCorrector::getReference(EVTReferenceType type, size_t* pSizeX, size_t* pSizeY) const {
+    const EVTReference& reference = this->references[type];
+    *pSizeX = reference.sizeX;
+    *pSizeY = reference.sizeY;
+    return reference.pixels;
+}
+
+
+void EVTFlatFieldCorrector::setDefectMap(const EVTDefectMap* pDefects){
+    this->pDefects = pDefects;
+    rebuild();
+}
+
+
+/**
+ * Rebuilds the offset and gain used by the correction from the current references.
+ * The gain scales the dark subtracted flat to its mean over all responding pixels, pixels
+ * that do not respond in the flat are left with a gain of one.
+ */
+void EVTFlatFieldCorrector::rebuild(){
+    const EVTReference& dark = this->references[EVT_REFERENCE_DARK];
+    const EVTReference& flat = this->references[EVT_REFERENCE_FLAT];
+    this->ready = false;
+    this->offset.clear();
+    this->gain.clear();
+    if(dark.pixels == NULL && flat.pixels == NULL) return;
+    if(dark.pixels != NULL && flat.pixels != NULL && (dark.sizeX != flat.sizeX || dark.sizeY != flat.sizeY)) return;
+
+    this->sizeX = dark.pixels != NULL ? dark.sizeX : flat.sizeX;
+    this->sizeY = dark.pixels != NULL ? dark.sizeY : flat.sizeY;
+    size_t numPixels = this->sizeX * this->sizeY;
+    if(dark.pixels != NULL) this->offset.assign(dark.pixels, dark.pixels + numPixels);
+    else this->offset.assign(numPixels, 0.0f);
+    this->gain.assign(numPixels, 1.0f);
+
+    if(flat.pixels != NULL){
+        double sum = 0;
+        size_t numResponding = 0;
+        for(size_t i = 0; i < numPixels; i++){
+            float response = flat.pixels[i] - this->offset[i];
+            if(response <= 0) continue;
+            sum += response;
+            numResponding++;
+        }
+        if(numResponding > 0){
+            float mean = (float) (sum / numResponding);
+            for(size_t i = 0; i < numPixels; i++){
+                float response = flat.pixels[i] - this->offset[i];
+                if(response > 0) this->gain[i] = mean / response;
+            }
+        }
+    }
+    // defective pixels are replaced by their neighbours before correction, so they must use neighbouring calibration
+    if(this->pDefects != NULL && this->pDefects->isReady(this->sizeX, this->sizeY, this->pDefects->isMosaic())){
+        this->pDefects->correct(&this->offset[0]);
+        this->pDefects->correct(&this->gain[0]);
+    }
+    this->ready = true;
+}
+
+
+/**
+ * Starts averaging a new reference from the next frames passed to capture
+ *
+ * @params[in]: type        -> dark or flat
+ * @params[in]: numFrames   -> number of frames to average
+ * @return: void
+ */
+void EVTFlatFieldCorrector::startCapture(EVTReferenceType type, int numFrames){
+    if(numFrames < 1) numFrames = 1;
+    if(numFrames > EVT_REFERENCE_MAX_FRAMES) numFrames = EVT_REFERENCE_MAX_FRAMES;
+    this->captureType = type;
+    this->captureFrames = numFrames;
+    this->numCaptured = 0;
+    this->captureSum.clear();
+    this->capturing = true;
+}
+
+
+void EVTFlatFieldCorrector::cancelCapture(){
+    this->capturing = false;
+    this->captureSum.clear();
+}
+
+
+bool EVTFlatFieldCorrector::isCapturing() const {
+    return this->capturing;
+}
+
+
+EVTReferenceType EVTFlatFieldCorrector::getCaptureType() const {
+    return this->captureType;
+}
+
+
+int EVTFlatFieldCorrector::getNumCaptured() const {
+    return this->numCaptured;
+}
+
+
+/**
+ * Adds a raw frame to the capture sums. A change of frame size restarts the capture.
+ */
+template <typename T>
+bool EVTFlatFieldCorrector::captureFrame(const T* pData, size_t sizeX, size_t sizeY){
+    if(!this->capturing) return false;
+    size_t numPixels = sizeX * sizeY;
+    if(this->numCaptured == 0 || sizeX != this->captureSizeX || sizeY != this->captureSizeY){
+        this->captureSizeX = sizeX;
+        this->captureSizeY = sizeY;
+        this->captureSum.assign(numPixels, 0);
+        this->numCaptured = 0;
+    }
+    uint32_t* pSum = &this->captureSum[0];
+    for(size_t i = 0; i < numPixels; i++) pSum[i] += pData[i];
+    this->numCaptured++;
+    return this->numCaptured >= this->captureFrames;
+}
+
+
+bool EVTFlatFieldCorrector::capture(const uint8_t* pData, size_t sizeX, size_t sizeY){
+    return captureFrame(pData, sizeX, sizeY);
+}
+
+
+bool EVTFlatFieldCorrector::capture(const uint16_t* pData, size_t sizeX, size_t sizeY){
+    return captureFrame(pData, sizeX, sizeY);
+}
+
+
+/**
+ * Averages the captured frames into a new reference, and rebuilds the correction.
+ * If a path is given the reference is written to a new mapped file, and used from the mapping.
+ *
+ * @params[in]:  path   -> path of the reference file, or empty to keep the reference in memory only
+ * @params[out]: error  -> reason for failure
+ * @return: true if the reference was stored
+ */
+bool EVTFlatFieldCorrector::saveCapture(const char* path, string& error){
+    if(!this->capturing || this->numCaptured == 0){
+        error = "No frames captured";
+        return false;
+    }
+    this->capturing = false;
+
+    size_t numPixels = this->captureSizeX * this->captureSizeY;
+    EVTReference& reference = this->references[this->captureType];
+    float* pPixels;
+    EVTMappedFile file;
+    vector<float> memory;
+    if(path != NULL && strlen(path) > 0){
+        if(!file.create(path, sizeof(EVTReferenceHeader) + numPixels * sizeof(float), error)){
+            this->captureSum.clear();
+            return false;
+        }
+        EVTReferenceHeader* pHeader = (EVTReferenceHeader*) file.getData();
+        memset(pHeader, 0, sizeof(EVTReferenceHeader));
+        pHeader->magic = EVT_REFERENCE_MAGIC;
+        pHeader->version = EVT_REFERENCE_VERSION;
+        pHeader->type = (uint32_t) this->captureType;
+        pHeader->sizeX = (uint32_t) this->captureSizeX;
+        pHeader->sizeY = (uint32_t) this->captureSizeY;
+        pHeader->numFrames = (uint32_t) this->numCaptured;
+        pPixels = (float*) (pHeader + 1);
+    }
+    else{
+        memory.resize(numPixels);
+        pPixels = &memory[0];
+    }
+
+    float scale = 1.0f / this->numCaptured;
+    for(size_t i = 0; i < numPixels; i++) pPixels[i] = this->captureSum[i] * scale;
+    this->captureSum.clear();
+    if(file.isOpen() && !file.flush()){
+        error = string("Failed to write ") + path;
+        return false;
+    }
+
+    reference.file.swap(file);
+    reference.memory.swap(memory);
+    reference.pixels = pPixels;
+    reference.sizeX = this->captureSizeX;
+    reference.sizeY = this->captureSizeY;
+    rebuild();
+    return true;
+}
+
+
+bool EVTFlatFieldCorrector::isReady(size_t sizeX, size_t sizeY) const {
+    return this->ready && sizeX == this->sizeX && sizeY == this->sizeY;
+}
+
+
+/**
+ * Corrects an 8 bit frame, the result is rounded and saturated to 8 bits
+ *
+ * @params[in]:  pIn        -> raw pixels
+ * @params[out]: pOut       -> corrected pixels, may be the same as pIn
+ * @params[in]:  numPixels  -> number of pixels, must match the reference size
+ * @return: void
+ */
+void EVTFlatFieldCorrector::correct(const uint8_t* pIn, uint8_t* pOut, size_t numPixels) const {
+    const float* pOffset = &this->offset[0];
+    const float* pGain = &this->gain[0];
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 maxValue = _mm_set1_ps(255.0f);
+    for(; i + 16 <= numPixels; i += 16){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pIn + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i r0 = evtRound4(evtCorrect4(_mm_unpacklo_epi16(lo, zero), pOffset + i,      pGain + i),      maxValue);
+        __m128i r1 = evtRound4(evtCorrect4(_mm_unpackhi_epi16(lo, zero), pOffset + i + 4,  pGain + i + 4),  maxValue);
+        __m128i r2 = evtRound4(evtCorrect4(_mm_unpacklo_epi16(hi, zero), pOffset + i + 8,  pGain + i + 8),  maxValue);
+        __m128i r3 = evtRound4(evtCorrect4(_mm_unpackhi_epi16(hi, zero), pOffset + i + 12, pGain + i + 12), maxValue);
+        _mm_storeu_si128((__m128i*) (pOut + i), _mm_packus_epi16(_mm_packs_epi32(r0, r1), _mm_packs_epi32(r2, r3)));
+    }
+#endif
+    for(; i < numPixels; i++) pOut[i] = (uint8_t) evtRound1(evtCorrect1(pIn[i], pOffset[i], pGain[i]), 255.0f);
+}
+
+
+/**
+ * Corrects a 16 bit frame, the result is rounded and saturated to 16 bits
+ *
+ * @params[in]:  pIn        -> raw pixels
+ * @params[out]: pOut       -> corrected pixels, may be the same as pIn
+ * @params[in]:  numPixels  -> number of pixels, must match the reference size
+ * @return: void
+ */
+void EVTFlatFieldCorrector::correct(const uint16_t* pIn, uint16_t* pOut, size_t numPixels) const {
+    const float* pOffset = &this->offset[0];
+    const float* pGain = &this->gain[0];
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 maxValue = _mm_set1_ps(65535.0f);
+    // SSE2 only has a signed 32 to 16 bit pack, so values are biased by 0x8000 around it
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short) 0x8000);
+    for(; i + 8 <= numPixels; i += 8){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pIn + i));
+        __m128i r0 = evtRound4(evtCorrect4(_mm_unpacklo_epi16(v, zero), pOffset + i,     pGain + i),     maxValue);
+        __m128i r1 = evtRound4(evtCorrect4(_mm_unpackhi_epi16(v, zero), pOffset + i + 4, pGain + i + 4), maxValue);
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(r0, bias32), _mm_sub_epi32(r1, bias32));
+        _mm_storeu_si128((__m128i*) (pOut + i), _mm_xor_si128(packed, bias16));
+    }
+#endif
+    for(; i < numPixels; i++) pOut[i] = (uint16_t) evtRound1(evtCorrect1(pIn[i], pOffset[i], pGain[i]), 65535.0f);
+}
+
+
+/**
+ * Corrects an 8 bit frame into a float buffer, without rounding or clamping
+ *
+ * @params[in]:  pIn        -> raw pixels
+ * @params[out]: pOut       -> corrected pixels
+ * @params[in]:  numPixels  -> number of pixels, must match the reference size
+ * @return: void
+ */
+void EVTFlatFieldCorrector::correct(const uint8_t* pIn, float* pOut, size_t numPixels) const {
+    const float* pOffset = &this->offset[0];
+    const float* pGain = &this->gain[0];
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for(; i + 16 <= numPixels; i += 16){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pIn + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_ps(pOut + i,      evtCorrect4(_mm_unpacklo_epi16(lo, zero), pOffset + i,      pGain + i));
+        _mm_storeu_ps(pOut + i + 4,  evtCorrect4(_mm_unpackhi_epi16(lo, zero), pOffset + i + 4,  pGain + i + 4));
+        _mm_storeu_ps(pOut + i + 8,  evtCorrect4(_mm_unpacklo_epi16(hi, zero), pOffset + i + 8,  pGain + i + 8));
+        _mm_storeu_ps(pOut + i + 12, evtCorrect4(_mm_unpackhi_epi16(hi, zero), pOffset + i + 12, pGain + i + 12));
+    }
+#endif
+    for(; i < numPixels; i++) pOut[i] = evtCorrect1(pIn[i], pOffset[i], pGain[i]);
+}
+
+
+/**
+ * Corrects a 16 bit frame into a float buffer, without rounding or clamping
+ *
+ * @params[in]:  pIn        -> raw pixels
+ * @params[out]: pOut       -> corrected pixels
+ * @params[in]:  numPixels  -> number of pixels, must match the reference size
+ * @return: void
+ */
+void EVTFlatFieldCorrector::correct(const uint16_t* pIn, float* pOut, size_t numPixels) const {
+    const float* pOffset = &this->offset[0];
+    const float* pGain = &this->gain[0];
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for(; i + 8 <= numPixels; i += 8){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pIn + i));
+        _mm_storeu_ps(pOut + i,     evtCorrect4(_mm_unpacklo_epi16(v, zero), pOffset + i,     pGain + i));
+        _mm_storeu_ps(pOut + i + 4, evtCorrect4(_mm_unpackhi_epi16(v, zero), pOffset + i + 4, pGain + i + 4));
+    }
+#endif
+    for(; i < numPixels; i++) pOut[i] = evtCorrect1(pIn[i], pOffset[i], pGain[i]);
+}
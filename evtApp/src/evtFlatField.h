@@ -0,0 +1,130 @@
+/**
+ * Header file for the ADEmergentVision flat field correction engine
+ *
+ * Dark and flat references are averaged from N raw frames on the image thread, and stored in memory
+ * mapped reference files, which are used directly from the mapping when they are reloaded at startup.
+ * Each frame is then corrected as (raw - dark) * gain, where the gain normalizes the dark subtracted flat
+ * to its mean. The correction can be written back in place as integers, or into a float buffer.
+ *
+ * Reference file layout:
+ *      EVTReferenceHeader          (32 bytes)
+ *      float pixels[sizeX * sizeY]
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTFLATFIELD_H
+#define EVTFLATFIELD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "evtMappedFile.h"
+#include "evtDefectMap.h"
+
+// "EVTR" when read as little endian bytes
+#define EVT_REFERENCE_MAGIC     0x52545645
+#define EVT_REFERENCE_VERSION   1
+
+// Largest number of frames averaged into a reference, so 16 bit sums fit in 32 bits
+#define EVT_REFERENCE_MAX_FRAMES 65536
+
+
+typedef enum {
+    EVT_REFERENCE_DARK  = 0,
+    EVT_REFERENCE_FLAT  = 1,
+    EVT_REFERENCE_NUM_TYPES
+} EVTReferenceType;
+
+
+typedef struct EVTReferenceHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t type;
+    uint32_t sizeX;
+    uint32_t sizeY;
+    uint32_t numFrames;
+    uint32_t reserved[2];
+} EVTReferenceHeader;
+
+
+class EVTFlatFieldCorrector {
+
+    public:
+
+        EVTFlatFieldCorrector();
+
+        // maps a reference file written by saveCapture
+        bool loadReference(EVTReferenceType type, const char* path, std::string& error);
+        void clearReference(EVTReferenceType type);
+        bool hasReference(EVTReferenceType type) const;
+        const float* getReference(EVTReferenceType type, size_t* pSizeX, size_t* pSizeY) const;
+
+        // defective pixels of the offset and gain are interpolated from their neighbours, NULL to disable
+        void setDefectMap(const EVTDefectMap* pDefects);
+
+        // the next numFrames frames passed to capture are averaged into a new reference
+        void startCapture(EVTReferenceType type, int numFrames);
+        void cancelCapture();
+        bool isCapturing() const;
+        EVTReferenceType getCaptureType() const;
+        int getNumCaptured() const;
+
+        // returns true once the requested number of frames has been captured
+        bool capture(const uint8_t* pData, size_t sizeX, size_t sizeY);
+        bool capture(const uint16_t* pData, size_t sizeX, size_t sizeY);
+
+        // stores the averaged capture in a reference file, or in memory if path is empty
+        bool saveCapture(const char* path, std::string& error);
+
+        // true if at least one reference is present, and all references match the frame size
+        bool isReady(size_t sizeX, size_t sizeY) const;
+
+        // corrects numPixels pixels, input and output may be the same buffer for integer output
+        void correct(const uint8_t* pIn, uint8_t* pOut, size_t numPixels) const;
+        void correct(const uint16_t* pIn, uint16_t* pOut, size_t numPixels) const;
+        void correct(const uint8_t* pIn, float* pOut, size_t numPixels) const;
+        void correct(const uint16_t* pIn, float* pOut, size_t numPixels) const;
+
+    private:
+
+        // A reference is used either from its mapped file, or from memory if it has no file
+        typedef struct EVTReference {
+            EVTMappedFile file;
+            std::vector<float> memory;
+            const float* pixels;
+            size_t sizeX;
+            size_t sizeY;
+        } EVTReference;
+
+        EVTReference references[EVT_REFERENCE_NUM_TYPES];
+        const EVTDefectMap* pDefects;
+
+        // dark offset and gain used by the correction, zero and one where a reference is missing
+        std::vector<float> offset;
+        std::vector<float> gain;
+        size_t sizeX;
+        size_t sizeY;
+        bool ready;
+
+        // reference capture in progress
+        bool capturing;
+        EVTReferenceType captureType;
+        int captureFrames;
+        int numCaptured;
+        size_t captureSizeX;
+        size_t captureSizeY;
+        std::vector<uint32_t> captureSum;
+
+        void rebuild();
+        template <typename T> bool captureFrame(const T* pData, size_t sizeX, size_t sizeY);
+};
+
+
+#endif
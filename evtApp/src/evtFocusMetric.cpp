@@ -0,0 +1,161 @@
+/**
+ * Source file for the ADEmergentVision focus metric
+ *
+ * 8 bit frames are evaluated 8 pixels at a time in SSE2, where the Laplacian and Sobel gradients fit in
+ * 16 bits and are squared and pairwise summed with a single multiply-add. The 32 bit lane sums are moved
+ * to 64 bit accumulators every 256 vectors, before they can overflow. 16 bit gradients do not fit the
+ * 16 bit multiply-add, so 16 bit frames use the scalar path with 64 bit sums.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include "evtSimd.h"
+#include "evtFocusMetric.h"
+
+using namespace std;
+
+
+/**
+ * Accumulates the Laplacian or the squared gradient of pixels [x, xEnd) of a row, whose neighbours
+ * are in rows up and down, and at x - 1 and xEnd
+ */
+template <typename T>
+static void evtFocusRow(const T* up, const T* row, const T* down, size_t x, size_t xEnd, EVTFocusMethod method,
+                        int64_t* pSum, uint64_t* pSumSq){
+    int64_t sum = 0;
+    uint64_t sumSq = 0;
+    for(; x < xEnd; x++){
+        if(method == EVT_FOCUS_LAPLACIAN_VARIANCE){
+            int64_t l = 4 * (int64_t) row[x] - row[x - 1] - row[x + 1] - up[x] - down[x];
+            sum += l;
+            sumSq += (uint64_t) (l * l);
+        }
+        else{
+            int64_t gx = ((int64_t) up[x + 1] + 2 * row[x + 1] + down[x + 1]) - ((int64_t) up[x - 1] + 2 * row[x - 1] + down[x - 1]);
+            int64_t gy = ((int64_t) down[x - 1] + 2 * down[x] + down[x + 1]) - ((int64_t) up[x - 1] + 2 * up[x] + up[x + 1]);
+            sumSq += (uint64_t) (gx * gx + gy * gy);
+        }
+    }
+    *pSum += sum;
+    *pSumSq += sumSq;
+}
+
+
+#ifdef EVT_SIMD_SSE2
+
+static inline __m128i evtLoadWiden(const uint8_t* p){
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) p), _mm_setzero_si128());
+}
+
+
+static inline void evtFlushLanes(__m128i* pSum, __m128i* pSumSq, int64_t* pTotal, uint64_t* pTotalSq){
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*) lanes, *pSum);
+    *pTotal += (int64_t) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_storeu_si128((__m128i*) lanes, *pSumSq);
+    *pTotalSq += (uint64_t) lanes[0] + (uint64_t) lanes[1] + (uint64_t) lanes[2] + (uint64_t) lanes[3];
+    *pSum = _mm_setzero_si128();
+    *pSumSq = _mm_setzero_si128();
+}
+
+
+/**
+ * SSE2 version of evtFocusRow for 8 bit pixels, returns the first pixel left for the scalar path
+ */
+static size_t evtFocusRowVector(const uint8_t* up, const uint8_t* row, const uint8_t* down, size_t x, size_t xEnd,
+                                EVTFocusMethod method, int64_t* pSum, uint64_t* pSumSq){
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    __m128i sumSq = _mm_setzero_si128();
+    int numVectors = 0;
+    for(; x + 8 <= xEnd; x += 8){
+        __m128i w = evtLoadWiden(row + x - 1);
+        __m128i e = evtLoadWiden(row + x + 1);
+        __m128i n = evtLoadWiden(up + x);
+        __m128i s = evtLoadWiden(down + x);
+        if(method == EVT_FOCUS_LAPLACIAN_VARIANCE){
+            __m128i c = evtLoadWiden(row + x);
+            __m128i l = _mm_sub_epi16(_mm_slli_epi16(c, 2), _mm_add_epi16(_mm_add_epi16(w, e), _mm_add_epi16(n, s)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(l, ones));
+            sumSq = _mm_add_epi32(sumSq, _mm_madd_epi16(l, l));
+        }
+        else{
+            __m128i nw = evtLoadWiden(up + x - 1);
+            __m128i ne = evtLoadWiden(up + x + 1);
+            __m128i sw = evtLoadWiden(down + x - 1);
+            __m128i se = evtLoadWiden(down + x + 1);
+            __m128i gx = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(ne, se), _mm_slli_epi16(e, 1)),
+                                       _mm_add_epi16(_mm_add_epi16(nw, sw), _mm_slli_epi16(w, 1)));
+            __m128i gy = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(sw, se), _mm_slli_epi16(s, 1)),
+                                       _mm_add_epi16(_mm_add_epi16(nw, ne), _mm_slli_epi16(n, 1)));
+            sumSq = _mm_add_epi32(sumSq, _mm_add_epi32(_mm_madd_epi16(gx, gx), _mm_madd_epi16(gy, gy)));
+        }
+        if(++numVectors == 256){
+            evtFlushLanes(&sum, &sumSq, pSum, pSumSq);
+            numVectors = 0;
+        }
+    }
+    evtFlushLanes(&sum, &sumSq, pSum, pSumSq);
+    return x;
+}
+
+
+// 16 bit frames use the scalar path only
+static inline size_t evtFocusRowVector(const uint16_t*, const uint16_t*, const uint16_t*, size_t x, size_t,
+                                       EVTFocusMethod, int64_t*, uint64_t*){
+    return x;
+}
+
+#endif
+
+
+template <typename T>
+static double evtComputeFocus(const T* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, EVTFocusMethod method){
+    size_t x0 = roi.x, y0 = roi.y;
+    size_t x1 = (roi.sizeX == 0) ? sizeX : roi.x + roi.sizeX;
+    size_t y1 = (roi.sizeY == 0) ? sizeY : roi.y + roi.sizeY;
+    if(roi.sizeX == 0) x0 = 0;
+    if(roi.sizeY == 0) y0 = 0;
+    if(x1 > sizeX) x1 = sizeX;
+    if(y1 > sizeY) y1 = sizeY;
+    if(x0 + 3 > x1 || y0 + 3 > y1) return 0;
+
+    int64_t sum = 0;
+    uint64_t sumSq = 0;
+    for(size_t y = y0 + 1; y + 1 < y1; y++){
+        const T* row = pData + y * sizeX;
+        size_t x = x0 + 1;
+#ifdef EVT_SIMD_SSE2
+        x = evtFocusRowVector(row - sizeX, row, row + sizeX, x, x1 - 1, method, &sum, &sumSq);
+#endif
+        evtFocusRow(row - sizeX, row, row + sizeX, x, x1 - 1, method, &sum, &sumSq);
+    }
+
+    double numPixels = (double) (x1 - x0 - 2) * (y1 - y0 - 2);
+    if(method == EVT_FOCUS_TENENGRAD) return sumSq / numPixels;
+    double mean = sum / numPixels;
+    return sumSq / numPixels - mean * mean;
+}
+
+
+/**
+ * Computes the focus metric of a region
+ *
+ * @params[in]: pData   -> pointer to image data, rows are contiguous
+ * @params[in]: sizeX   -> image width
+ * @params[in]: sizeY   -> image height
+ * @params[in]: roi     -> region to evaluate
+ * @params[in]: method  -> Laplacian variance or Tenengrad
+ * @return: focus value, larger is sharper
+ */
+double EVTFocusMetric::compute(const uint8_t* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, EVTFocusMethod method){
+    return evtComputeFocus(pData, sizeX, sizeY, roi, method);
+}
+
+
+double EVTFocusMetric::compute(const uint16_t* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, EVTFocusMethod method){
+    return evtComputeFocus(pData, sizeX, sizeY, roi, method);
+}
@@ -0,0 +1,42 @@
+/**
+ * Header file for the ADEmergentVision focus metric
+ *
+ * Computes a sharpness value of a rectangular region of a mono 8/16 bit frame, either the variance of
+ * the 4 neighbour Laplacian, or the Tenengrad value, the mean squared Sobel gradient magnitude.
+ * Both grow as the image comes into focus. Only the region is read, and the outermost rows and columns
+ * of the region are used as neighbours only.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTFOCUSMETRIC_H
+#define EVTFOCUSMETRIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "evtRoiStats.h"
+
+
+typedef enum {
+    EVT_FOCUS_LAPLACIAN_VARIANCE    = 0,
+    EVT_FOCUS_TENENGRAD             = 1
+} EVTFocusMethod;
+
+
+class EVTFocusMetric {
+
+    public:
+
+        // the region is clipped to the frame, a region with zero size is the full frame.
+        // returns 0 if the clipped region is smaller than 3x3
+        static double compute(const uint8_t* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, EVTFocusMethod method);
+        static double compute(const uint16_t* pData, size_t sizeX, size_t sizeY, const EVTRoi& roi, EVTFocusMethod method);
+};
+
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * Source file for the ADEmergentVision in-process frame consumers
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <chrono>
+
+#include "evtFrameConsumers.h"
+
+using namespace std;
+
+
+EVTFrameConsumers::EVTFrameConsumers() : nextId(1), dispatching(false) {}
+
+
+/**
+ * Adds a consumer, called with every frame dispatched from the next frame on
+ *
+ * @params[in]: name        -> name shown in the report
+ * @params[in]: callback    -> called with a view of each frame
+ * @params[in]: pUser       -> passed to the callback
+ * @params[in]: budget      -> time the consumer may take for each frame, in microseconds
+ * @return: consumer id, used to remove the consumer, or -1 if the callback is NULL
+ */
+int EVTFrameConsumers::add(const char* name, EVTFrameConsumerCallback callback, void* pUser, double budget){
+    if(callback == NULL) return -1;
+    EVTConsumer consumer;
+    consumer.id = this->nextId++;
+    consumer.name = (name != NULL) ? name : "";
+    consumer.callback = callback;
+    consumer.pUser = pUser;
+    consumer.budget = budget;
+    consumer.removed = false;
+    consumer.suspended = false;
+    consumer.consecutiveOverruns = 0;
+    consumer.numCalls = 0;
+    consumer.numOverruns = 0;
+    consumer.numSkipped = 0;
+    consumer.lastTime = 0;
+    consumer.maxTime = 0;
+    this->consumers.push_back(consumer);
+    return consumer.id;
+}
+
+
+/**
+ * Removes a consumer. It is not called again, even if it is removed by a consumer during a dispatch.
+ *
+ * @params[in]: id  -> id returned by add
+ * @return: false if there is no consumer with the id
+ */
+bool EVTFrameConsumers::remove(int id){
+    for(size_t i = 0; i < this->consumers.size(); i++){
+        if(this->consumers[i].id != id || this->consumers[i].removed) continue;
+        if(this->dispatching) this->consumers[i].removed = true;
+        else this->consumers.erase(this->consumers.begin() + i);
+        return true;
+    }
+    return false;
+}
+
+
+void EVTFrameConsumers::resume(){
+    for(size_t i = 0; i < this->consumers.size(); i++){
+        this->consumers[i].suspended = false;
+        this->consumers[i].consecutiveOverruns = 0;
+        this->consumers[i].maxTime = 0;
+    }
+}
+
+
+int EVTFrameConsumers::getNumConsumers() const {
+    int numConsumers = 0;
+    for(size_t i = 0; i < this->consumers.size(); i++){
+        if(!this->consumers[i].removed) numConsumers++;
+    }
+    return numConsumers;
+}
+
+
+int EVTFrameConsumers::getNumSuspended() const {
+    int numSuspended = 0;
+    for(size_t i = 0; i < this->consumers.size(); i++){
+        if(!this->consumers[i].removed && this->consumers[i].suspended) numSuspended++;
+    }
+    return numSuspended;
+}
+
+
+/**
+ * Calls the consumers in the order they were added. Before each call the time already spent on the frame
+ * is checked against the total budget, and once it is used the remaining consumers are skipped. Each call
+ * is timed against the budget of its consumer. Consumers may add or remove consumers from the callback,
+ * which takes effect from the next frame.
+ *
+ * @params[in]:  view           -> frame passed to the consumers
+ * @params[in]:  totalBudget    -> time all consumers may take for the frame, in microseconds
+ * @params[out]: pStats         -> time spent and number of consumers called, overrun and skipped
+ * @return: void
+ */
+void EVTFrameConsumers::dispatch(const EVTFrameView& view, double totalBudget, EVTDispatchStats* pStats){
+    pStats->time = 0;
+    pStats->numCalled = 0;
+    pStats->numOverruns = 0;
+    pStats->numSkipped = 0;
+    this->dispatching = true;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // consumers added by a callback are past the end, and are first called with the next frame
+    size_t numConsumers = this->consumers.size();
+    for(size_t i = 0; i < numConsumers; i++){
+        if(this->consumers[i].removed || this->consumers[i].suspended) continue;
+        if(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() >= totalBudget){
+            this->consumers[i].numSkipped++;
+            pStats->numSkipped++;
+            continue;
+        }
+        chrono::steady_clock::time_point callStart = chrono::steady_clock::now();
+        this->consumers[i].callback(this->consumers[i].pUser, &view);
+        double time = chrono::duration<double, micro>(chrono::steady_clock::now() - callStart).count();
+
+        // the vector may have grown during the call, so the consumer is looked up again
+        EVTConsumer& consumer = this->consumers[i];
+        consumer.numCalls++;
+        consumer.lastTime = time;
+        if(time > consumer.maxTime) consumer.maxTime = time;
+        pStats->numCalled++;
+        if(time > consumer.budget){
+            consumer.numOverruns++;
+            pStats->numOverruns++;
+            if(++consumer.consecutiveOverruns >= EVT_CONSUMER_MAX_OVERRUNS) consumer.suspended = true;
+        }
+        else consumer.consecutiveOverruns = 0;
+    }
+
+    pStats->time = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    this->dispatching = false;
+    for(size_t i = 0; i < this->consumers.size();){
+        if(this->consumers[i].removed) this->consumers.erase(this->consumers.begin() + i);
+        else i++;
+    }
+}
+
+
+void EVTFrameConsumers::report(FILE* fp) const {
+    fprintf(fp, "Frame consumers: %d\n", getNumConsumers());
+    for(size_t i = 0; i < this->consumers.size(); i++){
+        const EVTConsumer& consumer = this->consumers[i];
+        if(consumer.removed) continue;
+        fprintf(fp, "  %d %s: budget %.1f us, last %.1f us, max %.1f us, calls %llu, overruns %llu, skipped %llu%s\n",
+                consumer.id, consumer.name.c_str(), consumer.budget, consumer.lastTime, consumer.maxTime,
+                (unsigned long long) consumer.numCalls, (unsigned long long) consumer.numOverruns,
+                (unsigned long long) consumer.numSkipped, consumer.suspended ? ", suspended" : "");
+    }
+}
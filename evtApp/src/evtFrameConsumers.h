@@ -0,0 +1,109 @@
+/**
+ * Header file for the ADEmergentVision in-process frame consumers
+ *
+ * Lets code running in the IOC receive each processed frame directly on the image thread, without
+ * being written as an NDPlugin, so there is no queue and no thread switch between the driver and the
+ * consumer. Consumers get a read only view of the frame, which is only valid during the call, and are
+ * called before the frame is passed to plugins, so they add their time to the latency of every output.
+ *
+ * Every consumer has a time budget for each frame, and all consumers share a total budget. Budgets are
+ * not enforced: a call can not be interrupted, so overruns are only detected once a call returns. Once the
+ * total budget of a frame is used, the remaining consumers are skipped for that frame, and a consumer that
+ * overruns its own budget on EVT_CONSUMER_MAX_OVERRUNS frames in a row is suspended until it is resumed.
+ * A consumer that never returns stalls the image thread, with the driver lock held. Consumers are called
+ * in the order they registered, so the most important consumer should register first.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTFRAMECONSUMERS_H
+#define EVTFRAMECONSUMERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "NDArray.h"
+
+// consecutive overruns of its own budget after which a consumer is suspended
+#define EVT_CONSUMER_MAX_OVERRUNS 3
+
+
+// Read only view of a frame, valid only for the duration of the call
+typedef struct EVTFrameView {
+    // for the attributes and dimensions, the array must not be modified, reserved or kept
+    const NDArray* pArray;
+    const void* pData;
+    // sizes and strides of the frame
+    NDArrayInfo info;
+    // raw camera timestamp in nanoseconds
+    uint64_t cameraTimeStamp;
+} EVTFrameView;
+
+
+typedef void (*EVTFrameConsumerCallback)(void* pUser, const EVTFrameView* pView);
+
+
+// Totals for the consumers of the last frame dispatched
+typedef struct EVTDispatchStats {
+    // time spent in the consumers, in microseconds
+    double time;
+    int numCalled;
+    int numOverruns;
+    int numSkipped;
+} EVTDispatchStats;
+
+
+class EVTFrameConsumers {
+
+    public:
+
+        EVTFrameConsumers();
+
+        // budget is the time the consumer may take for each frame, in microseconds, returns -1 for a NULL callback
+        int add(const char* name, EVTFrameConsumerCallback callback, void* pUser, double budget);
+        bool remove(int id);
+
+        // resumes suspended consumers and resets the maximum call times
+        void resume();
+
+        int getNumConsumers() const;
+        int getNumSuspended() const;
+
+        // calls every active consumer with the frame, totalBudget is in microseconds
+        void dispatch(const EVTFrameView& view, double totalBudget, EVTDispatchStats* pStats);
+
+        void report(FILE* fp) const;
+
+    private:
+
+        typedef struct EVTConsumer {
+            int id;
+            std::string name;
+            EVTFrameConsumerCallback callback;
+            void* pUser;
+            double budget;
+            bool removed;
+            bool suspended;
+            int consecutiveOverruns;
+            uint64_t numCalls;
+            uint64_t numOverruns;
+            uint64_t numSkipped;
+            double lastTime;
+            double maxTime;
+        } EVTConsumer;
+
+        std::vector<EVTConsumer> consumers;
+        int nextId;
+        // consumers removed by a consumer are erased once the dispatch is done
+        bool dispatching;
+};
+
+
+#endif
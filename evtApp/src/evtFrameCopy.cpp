@@ -0,0 +1,166 @@
+/**
+ * Source file for the ADEmergentVision frame copy
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "evtSimd.h"
+#include "evtFrameCopy.h"
+
+using namespace std;
+
+
+EVTFrameCopy::EVTFrameCopy()
+    : mode(EVT_COPY_AUTO), threshold(getLastLevelCacheSize() / 2) {}
+
+
+/**
+ * Sets when streaming stores are used
+ *
+ * @params[in]: mode            -> automatic by size, or always one of the two copies
+ * @params[in]: thresholdBytes  -> smallest frame copied with streaming stores in automatic mode,
+ *                                 0 for half of the last level cache
+ * @return: void
+ */
+void EVTFrameCopy::configure(EVTCopyMode mode, size_t thresholdBytes){
+    this->mode = mode;
+    this->threshold = (thresholdBytes > 0) ? thresholdBytes : getLastLevelCacheSize() / 2;
+}
+
+
+size_t EVTFrameCopy::getThreshold() const {
+    return this->threshold;
+}
+
+
+/**
+ * Copies a frame with memcpy or streaming stores, depending on the mode and its size
+ *
+ * @params[out]: pDst       -> destination
+ * @params[in]:  pSrc       -> source
+ * @params[in]:  numBytes   -> number of bytes to copy
+ * @return: true if streaming stores were used
+ */
+bool EVTFrameCopy::copy(void* pDst, const void* pSrc, size_t numBytes) const {
+    bool streaming = (this->mode == EVT_COPY_STREAMING) || (this->mode == EVT_COPY_AUTO && numBytes >= this->threshold);
+    if(streaming) streamCopy(pDst, pSrc, numBytes);
+    else memcpy(pDst, pSrc, numBytes);
+    return streaming;
+}
+
+
+/**
+ * Copies with non-temporal stores. The head is copied with memcpy up to 16 byte alignment of the
+ * destination, then 64 bytes are copied per iteration, and the tail with memcpy. Prefetching past the
+ * end of the source is harmless, prefetches do not fault.
+ *
+ * @params[out]: pDst       -> destination
+ * @params[in]:  pSrc       -> source
+ * @params[in]:  numBytes   -> number of bytes to copy
+ * @return: void
+ */
+void EVTFrameCopy::streamCopy(void* pDst, const void* pSrc, size_t numBytes){
+#ifdef EVT_SIMD_SSE2
+    uint8_t* d = (uint8_t*) pDst;
+    const uint8_t* s = (const uint8_t*) pSrc;
+    size_t head = (16 - ((uintptr_t) d & 15)) & 15;
+    if(head > numBytes) head = numBytes;
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    numBytes -= head;
+    for(; numBytes >= 64; numBytes -= 64, d += 64, s += 64){
+        _mm_prefetch((const char*) (s + EVT_COPY_PREFETCH_DISTANCE), _MM_HINT_NTA);
+        __m128i v0 = _mm_loadu_si128((const __m128i*) s);
+        __m128i v1 = _mm_loadu_si128((const __m128i*) (s + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i*) (s + 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i*) (s + 48));
+        _mm_stream_si128((__m128i*) d, v0);
+        _mm_stream_si128((__m128i*) (d + 16), v1);
+        _mm_stream_si128((__m128i*) (d + 32), v2);
+        _mm_stream_si128((__m128i*) (d + 48), v3);
+    }
+    // the streaming stores are weakly ordered, fence them before the frame is handed to other threads
+    _mm_sfence();
+    memcpy(d, s, numBytes);
+#else
+    memcpy(pDst, pSrc, numBytes);
+#endif
+}
+
+
+/**
+ * Times both copies on buffers of a frame size. Each copy is repeated until it has run for at least
+ * 100 ms, after a first copy that faults in the pages.
+ *
+ * @params[in]:  numBytes       -> buffer size
+ * @params[out]: pMemcpyRate    -> memcpy rate in GB/s
+ * @params[out]: pStreamRate    -> streaming copy rate in GB/s
+ * @return: void
+ */
+void EVTFrameCopy::benchmark(size_t numBytes, double* pMemcpyRate, double* pStreamRate){
+    *pMemcpyRate = 0;
+    *pStreamRate = 0;
+    if(numBytes == 0) return;
+    vector<uint8_t> src(numBytes, 1), dst(numBytes, 0);
+    for(int pass = 0; pass < 2; pass++){
+        if(pass == 0) memcpy(&dst[0], &src[0], numBytes);
+        else streamCopy(&dst[0], &src[0], numBytes);
+        int numCopies = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        chrono::duration<double> elapsed(0);
+        while(elapsed.count() < 0.1){
+            if(pass == 0) memcpy(&dst[0], &src[0], numBytes);
+            else streamCopy(&dst[0], &src[0], numBytes);
+            numCopies++;
+            elapsed = chrono::steady_clock::now() - start;
+        }
+        double rate = (double) numBytes * numCopies / elapsed.count() / 1e9;
+        if(pass == 0) *pMemcpyRate = rate;
+        else *pStreamRate = rate;
+    }
+}
+
+
+/**
+ * Reads the size of the largest data or unified cache
+ *
+ * @return: size in bytes, EVT_COPY_DEFAULT_CACHE_SIZE if it is not known
+ */
+size_t EVTFrameCopy::getLastLevelCacheSize(){
+    size_t size = 0;
+#ifdef _WIN32
+    DWORD length = 0;
+    GetLogicalProcessorInformation(NULL, &length);
+    vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) + 1);
+    if(length > 0 && GetLogicalProcessorInformation(&info[0], &length)){
+        for(size_t i = 0; i < length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION); i++){
+            if(info[i].Relationship == RelationCache && info[i].Cache.Type != CacheInstruction && info[i].Cache.Size > size)
+                size = info[i].Cache.Size;
+        }
+    }
+#else
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if(l3 > 0) size = (size_t) l3;
+#endif
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if(size == 0 && l2 > 0) size = (size_t) l2;
+#endif
+#endif
+    return size > 0 ? size : EVT_COPY_DEFAULT_CACHE_SIZE;
+}
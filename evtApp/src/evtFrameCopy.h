@@ -0,0 +1,65 @@
+/**
+ * Header file for the ADEmergentVision frame copy
+ *
+ * Copies frames that are larger than a threshold with SSE2 non-temporal stores, which write around the
+ * cache, while prefetching the source ahead of the loads with a non-temporal hint. The image thread
+ * never reads a frame back after copying it, so a large frame copied with memcpy only evicts the working
+ * sets of the plugins. Smaller frames are likely to be read by the plugins while still cached, and are
+ * copied with memcpy. By default the threshold is half of the last level cache.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTFRAMECOPY_H
+#define EVTFRAMECOPY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Distance the source is prefetched ahead of the loads
+#define EVT_COPY_PREFETCH_DISTANCE 512
+
+// Last level cache size assumed when it can not be read from the system
+#define EVT_COPY_DEFAULT_CACHE_SIZE (8 * 1024 * 1024)
+
+
+typedef enum {
+    EVT_COPY_AUTO       = 0,    // streaming stores above the threshold
+    EVT_COPY_MEMCPY     = 1,
+    EVT_COPY_STREAMING  = 2
+} EVTCopyMode;
+
+
+class EVTFrameCopy {
+
+    public:
+
+        EVTFrameCopy();
+
+        // a threshold of 0 uses half of the last level cache
+        void configure(EVTCopyMode mode, size_t thresholdBytes);
+        size_t getThreshold() const;
+
+        // copies a frame, and returns true if streaming stores were used
+        bool copy(void* pDst, const void* pSrc, size_t numBytes) const;
+
+        // copy with non-temporal stores, memcpy where SSE2 is not available
+        static void streamCopy(void* pDst, const void* pSrc, size_t numBytes);
+
+        // times memcpy and streamCopy on buffers of the given size, rates are in GB/s
+        static void benchmark(size_t numBytes, double* pMemcpyRate, double* pStreamRate);
+
+        static size_t getLastLevelCacheSize();
+
+    private:
+
+        EVTCopyMode mode;
+        size_t threshold;
+};
+
+
+#endif
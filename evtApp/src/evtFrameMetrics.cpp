@@ -0,0 +1,163 @@
+/**
+ * Source file for the ADEmergentVision per frame metrics
+ * 
+ * Created On: October-18-2026
+ * 
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "evtFrameMetrics.h"
+
+using namespace std;
+
+
+// Names used to select metrics, in the order of EVTMetricId
+static const char* metricNames[EVT_METRIC_NUM_METRICS] = {
+    "BeamCX",
+    "BeamCY",
+    "BeamSX",
+    "BeamSY",
+    "BeamIntensity",
+    "BeamNumPixels",
+    "RoiSum",
+    "RoiMean",
+    "RoiMax",
+    "RoiCX",
+    "RoiCY",
+    "DriftX",
+    "DriftY",
+    "DriftQuality",
+    "Focus"
+};
+
+
+static bool isRoiMetric(EVTMetricId id){
+    return id >= EVT_METRIC_ROI_SUM && id <= EVT_METRIC_ROI_CY;
+}
+
+
+EVTFrameMetrics::EVTFrameMetrics()
+    : driftX(0), driftY(0), driftQuality(0), focus(0) {
+    reset();
+}
+
+
+void EVTFrameMetrics::reset(){
+    memset(&this->beamStats, 0, sizeof(this->beamStats));
+    this->roiStats.clear();
+    this->focus = 0;
+}
+
+
+/**
+ * Gets the value of a single metric for the current frame
+ * 
+ * @params[in]: selector    -> metric to read
+ * @return: value of the metric, 0 if it was not computed
+ */
+double EVTFrameMetrics::getValue(const EVTMetricSelector& selector) const {
+    const EVTRoiStats* roi = NULL;
+    if(isRoiMetric(selector.id)){
+        if(selector.index < 0 || selector.index >= (int) this->roiStats.size()) return 0;
+        roi = &this->roiStats[selector.index];
+    }
+    switch(selector.id){
+        case EVT_METRIC_BEAM_CX:            return this->beamStats.centroidX;
+        case EVT_METRIC_BEAM_CY:            return this->beamStats.centroidY;
+        case EVT_METRIC_BEAM_SX:            return this->beamStats.sigmaX;
+        case EVT_METRIC_BEAM_SY:            return this->beamStats.sigmaY;
+        case EVT_METRIC_BEAM_INTENSITY:     return this->beamStats.intensity;
+        case EVT_METRIC_BEAM_NUM_PIXELS:    return (double) this->beamStats.numPixels;
+        case EVT_METRIC_ROI_SUM:            return roi->sum;
+        case EVT_METRIC_ROI_MEAN:           return roi->mean;
+        case EVT_METRIC_ROI_MAX:            return roi->max;
+        case EVT_METRIC_ROI_CX:             return roi->centroidX;
+        case EVT_METRIC_ROI_CY:             return roi->centroidY;
+        case EVT_METRIC_DRIFT_X:            return this->driftX;
+        case EVT_METRIC_DRIFT_Y:            return this->driftY;
+        case EVT_METRIC_DRIFT_QUALITY:      return this->driftQuality;
+        case EVT_METRIC_FOCUS:              return this->focus;
+        default:                            return 0;
+    }
+}
+
+
+/**
+ * Parses a comma separated list of metric names into selectors
+ * 
+ * @params[in]:  selectorStr    -> list of names, e.g. "BeamCX,RoiSum[3]"
+ * @params[out]: selectors      -> parsed selectors, only modified on success
+ * @params[out]: error          -> description of the first invalid entry
+ * @return: true if every entry was valid
+ */
+bool EVTFrameMetrics::parseSelectors(const char* selectorStr, vector<EVTMetricSelector>& selectors, string& error){
+    vector<EVTMetricSelector> parsed;
+    string list(selectorStr);
+    size_t start = 0;
+    while(start <= list.size()){
+        size_t end = list.find(',', start);
+        if(end == string::npos) end = list.size();
+        string entry = list.substr(start, end - start);
+        start = end + 1;
+
+        // trim whitespace
+        size_t first = entry.find_first_not_of(" \t");
+        if(first == string::npos) continue;
+        entry = entry.substr(first, entry.find_last_not_of(" \t") - first + 1);
+
+        string name = entry;
+        int index = 0;
+        size_t bracket = entry.find('[');
+        if(bracket != string::npos){
+            name = entry.substr(0, bracket);
+            char* endPtr;
+            index = (int) strtol(entry.c_str() + bracket + 1, &endPtr, 10);
+            if(*endPtr != ']' || index < 0 || index >= EVT_MAX_ROIS){
+                error = "Invalid index in " + entry;
+                return false;
+            }
+        }
+
+        int id;
+        for(id = 0; id < EVT_METRIC_NUM_METRICS; id++){
+            if(name == metricNames[id]) break;
+        }
+        if(id == EVT_METRIC_NUM_METRICS){
+            error = "Unknown metric " + name;
+            return false;
+        }
+        if(bracket != string::npos && !isRoiMetric((EVTMetricId) id)){
+            error = name + " does not take an index";
+            return false;
+        }
+        if(parsed.size() == EVT_MAX_SELECTED_METRICS){
+            error = "Too many metrics selected";
+            return false;
+        }
+        EVTMetricSelector selector;
+        selector.id = (EVTMetricId) id;
+        selector.index = index;
+        parsed.push_back(selector);
+    }
+    selectors.swap(parsed);
+    return true;
+}
+
+
+/**
+ * Gets the name of a selector in the format accepted by parseSelectors
+ */
+string EVTFrameMetrics::getSelectorName(const EVTMetricSelector& selector){
+    string name = metricNames[selector.id];
+    if(isRoiMetric(selector.id)){
+        char indexStr[16];
+        snprintf(indexStr, sizeof(indexStr), "[%d]", selector.index);
+        name += indexStr;
+    }
+    return name;
+}
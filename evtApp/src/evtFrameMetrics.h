@@ -0,0 +1,80 @@
+/**
+ * Header file for the ADEmergentVision per frame metrics
+ * 
+ * Collects the scalar results computed by the driver for the current frame, so that consumers such
+ * as the UDP feedback publisher can select them by name. Metrics are selected with a comma separated
+ * list of names, where ROI metrics take the ROI index in brackets, e.g. "BeamCX,BeamCY,RoiSum[2]".
+ * 
+ * Created On: October-18-2026
+ * 
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ * 
+ */
+
+// header guard
+#ifndef EVTFRAMEMETRICS_H
+#define EVTFRAMEMETRICS_H
+
+#include <string>
+#include <vector>
+
+#include "evtBeamStats.h"
+#include "evtRoiStats.h"
+
+// Maximum number of metrics that can be selected at once
+#define EVT_MAX_SELECTED_METRICS 64
+
+
+// Scalar metrics available for every frame
+typedef enum {
+    EVT_METRIC_BEAM_CX,
+    EVT_METRIC_BEAM_CY,
+    EVT_METRIC_BEAM_SX,
+    EVT_METRIC_BEAM_SY,
+    EVT_METRIC_BEAM_INTENSITY,
+    EVT_METRIC_BEAM_NUM_PIXELS,
+    EVT_METRIC_ROI_SUM,
+    EVT_METRIC_ROI_MEAN,
+    EVT_METRIC_ROI_MAX,
+    EVT_METRIC_ROI_CX,
+    EVT_METRIC_ROI_CY,
+    EVT_METRIC_DRIFT_X,
+    EVT_METRIC_DRIFT_Y,
+    EVT_METRIC_DRIFT_QUALITY,
+    EVT_METRIC_FOCUS,
+    EVT_METRIC_NUM_METRICS
+} EVTMetricId;
+
+
+// A selected metric, index is only used for per ROI metrics
+typedef struct EVTMetricSelector {
+    EVTMetricId id;
+    int index;
+} EVTMetricSelector;
+
+
+class EVTFrameMetrics {
+
+    public:
+
+        EVTFrameMetrics();
+
+        // clears all values at the start of a new frame, drift values are kept since they arrive asynchronously
+        void reset();
+
+        EVTBeamStats beamStats;
+        std::vector<EVTRoiStats> roiStats;
+        double driftX;
+        double driftY;
+        double driftQuality;
+        double focus;
+
+        // returns 0 for metrics that were not computed for this frame
+        double getValue(const EVTMetricSelector& selector) const;
+
+        static bool parseSelectors(const char* selectorStr, std::vector<EVTMetricSelector>& selectors, std::string& error);
+        static std::string getSelectorName(const EVTMetricSelector& selector);
+};
+
+
+#endif
@@ -0,0 +1,272 @@
+/**
+ * Source file for the ADEmergentVision multi-camera frame synchronizer
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <map>
+
+#include "evtFrameSync.h"
+
+using namespace std;
+
+
+EVTSyncSet::EVTSyncSet(int setId) : setId(setId) {}
+
+
+EVTSyncSet::~EVTSyncSet(){
+    for(size_t i = 0; i < this->frames.size(); i++) this->frames[i]->release();
+}
+
+
+// -----------------------------------------------------------------------
+// EVTFrameSync
+// -----------------------------------------------------------------------
+
+
+EVTFrameSync::EVTFrameSync(const char* name)
+    : name(name), match(EVT_SYNC_TRIGGER_ID), toleranceNs(0), timeout(1.0), nextSetId(1) {}
+
+
+/**
+ * Returns the group with the given name, creating it if it does not exist
+ *
+ * @params[in]: name    -> name of the group, shared by all cameras that are matched together
+ * @return: the group
+ */
+EVTFrameSync* EVTFrameSync::getGroup(const char* name){
+    static mutex groupMutex;
+    static map<string, EVTFrameSync*> groups;
+    lock_guard<mutex> lock(groupMutex);
+    map<string, EVTFrameSync*>::iterator it = groups.find(name);
+    if(it != groups.end()) return it->second;
+    EVTFrameSync* pGroup = new EVTFrameSync(name);
+    groups[name] = pGroup;
+    return pGroup;
+}
+
+
+const char* EVTFrameSync::getName() const {
+    return this->name.c_str();
+}
+
+
+/**
+ * Adds a member to the group. Frames already queued by other members are dropped, since they can
+ * no longer be matched by a frame of the new member.
+ *
+ * @params[in]: callback    -> called with every matched set
+ * @params[in]: pUser       -> passed to the callback
+ * @return: member index, which is also the position of its frames in each set
+ */
+int EVTFrameSync::join(EVTSyncCallback callback, void* pUser){
+    lock_guard<mutex> lock(this->syncMutex);
+    EVTSyncMember member;
+    member.active = true;
+    member.publishing = false;
+    member.callback = callback;
+    member.pUser = pUser;
+    member.lastTriggerId = 0;
+    member.triggerIdHigh = 0;
+    member.numMatched = 0;
+    member.numUnmatched = 0;
+    for(size_t i = 0; i < this->members.size(); i++) clearMember(this->members[i]);
+    this->members.push_back(member);
+    return (int) this->members.size() - 1;
+}
+
+
+/**
+ * Removes a member from the group, releasing its queued frames
+ *
+ * @params[in]: member  -> index returned by join
+ * @return: void
+ */
+void EVTFrameSync::leave(int member){
+    lock_guard<mutex> callbackLock(this->callbackMutex);
+    lock_guard<mutex> lock(this->syncMutex);
+    if(member < 0 || member >= (int) this->members.size()) return;
+    clearMember(this->members[member]);
+    this->members[member].active = false;
+}
+
+
+/**
+ * Sets how frames are matched
+ *
+ * @params[in]: match       -> match by trigger ID or by camera timestamp
+ * @params[in]: tolerance   -> largest difference of matched timestamps, in seconds
+ * @params[in]: timeout     -> time a frame waits for its match before it is dropped, in seconds
+ * @return: void
+ */
+void EVTFrameSync::configure(EVTSyncMatch match, double tolerance, double timeout){
+    lock_guard<mutex> lock(this->syncMutex);
+    if(match != this->match){
+        for(size_t i = 0; i < this->members.size(); i++) clearMember(this->members[i]);
+    }
+    this->match = match;
+    this->toleranceNs = tolerance > 0 ? (uint64_t) (tolerance * 1e9) : 0;
+    this->timeout = timeout;
+}
+
+
+void EVTFrameSync::reset(int member){
+    lock_guard<mutex> lock(this->syncMutex);
+    if(member < 0 || member >= (int) this->members.size()) return;
+    clearMember(this->members[member]);
+    this->members[member].lastTriggerId = 0;
+    this->members[member].triggerIdHigh = 0;
+}
+
+
+/**
+ * Sets whether a member publishes the sets. The queued frames are dropped once no member publishes.
+ *
+ * @params[in]: member      -> index returned by join
+ * @params[in]: publishing  -> true if the member does something with the sets it is called with
+ * @return: void
+ */
+void EVTFrameSync::setPublishing(int member, bool publishing){
+    lock_guard<mutex> lock(this->syncMutex);
+    if(member < 0 || member >= (int) this->members.size()) return;
+    this->members[member].publishing = publishing;
+    if(!isPublishing()){
+        for(size_t i = 0; i < this->members.size(); i++) clearMember(this->members[i]);
+    }
+}
+
+
+bool EVTFrameSync::getStats(int member, EVTSyncStats* pStats){
+    lock_guard<mutex> lock(this->syncMutex);
+    if(member < 0 || member >= (int) this->members.size()) return false;
+    pStats->numMatched = this->members[member].numMatched;
+    pStats->numUnmatched = this->members[member].numUnmatched;
+    pStats->numMembers = 0;
+    for(size_t i = 0; i < this->members.size(); i++){
+        if(this->members[i].active) pStats->numMembers++;
+    }
+    return true;
+}
+
+
+/**
+ * Queues a frame for matching. The frame is reserved, and released when it is dropped or when the
+ * last user of its set releases the set. The callbacks of the sets completed by the frame are called
+ * from this thread, after the frames are matched. While no member publishes the sets, only the trigger
+ * ID of the frame is tracked, and the frame is not queued.
+ *
+ * @params[in]: member      -> index returned by join
+ * @params[in]: pArray      -> frame to match
+ * @params[in]: triggerId   -> block ID of the frame
+ * @params[in]: timeStampNs -> camera timestamp of the frame, in ns
+ * @return: void
+ */
+void EVTFrameSync::submit(int member, NDArray* pArray, unsigned int triggerId, uint64_t timeStampNs){
+    vector<shared_ptr<EVTSyncSet> > completed;
+    vector<pair<EVTSyncCallback, void*> > callbacks;
+    lock_guard<mutex> callbackLock(this->callbackMutex);
+    {
+        lock_guard<mutex> lock(this->syncMutex);
+        if(member < 0 || member >= (int) this->members.size() || !this->members[member].active) return;
+        EVTSyncMember& self = this->members[member];
+
+        EVTSyncFrame frame;
+        frame.pArray = pArray;
+        frame.arrival = chrono::steady_clock::now();
+        if(this->match == EVT_SYNC_TRIGGER_ID){
+            if(triggerId < self.lastTriggerId && self.lastTriggerId - triggerId > 0x8000) self.triggerIdHigh += 0x10000;
+            self.lastTriggerId = triggerId;
+            frame.key = self.triggerIdHigh + triggerId;
+        }
+        else frame.key = timeStampNs;
+        if(!isPublishing()) return;
+        pArray->reserve();
+        self.frames.push_back(frame);
+        if(self.frames.size() > EVT_SYNC_MAX_QUEUE) dropFront(self);
+
+        matchSets(completed);
+
+        // frames that waited longer than the timeout belong to a trigger that another member missed
+        for(size_t i = 0; i < this->members.size(); i++){
+            EVTSyncMember& other = this->members[i];
+            while(!other.frames.empty() &&
+                  chrono::duration<double>(frame.arrival - other.frames.front().arrival).count() > this->timeout)
+                dropFront(other);
+        }
+        if(!completed.empty()){
+            for(size_t i = 0; i < this->members.size(); i++){
+                if(this->members[i].active) callbacks.push_back(make_pair(this->members[i].callback, this->members[i].pUser));
+            }
+        }
+    }
+    for(size_t s = 0; s < completed.size(); s++){
+        for(size_t i = 0; i < callbacks.size(); i++) callbacks[i].first(callbacks[i].second, completed[s]);
+    }
+}
+
+
+/**
+ * Forms sets from the oldest queued frames. While every active member has a frame, any frame that is
+ * older than the newest front frame by more than the tolerance can not be matched and is dropped.
+ * Once the front frames are all within the tolerance, they form a set.
+ */
+void EVTFrameSync::matchSets(vector<shared_ptr<EVTSyncSet> >& completed){
+    size_t numActive = 0;
+    for(size_t i = 0; i < this->members.size(); i++){
+        if(this->members[i].active) numActive++;
+    }
+    if(numActive < 2) return;
+    uint64_t tolerance = (this->match == EVT_SYNC_TIMESTAMP) ? this->toleranceNs : 0;
+
+    while(true){
+        uint64_t newest = 0;
+        for(size_t i = 0; i < this->members.size(); i++){
+            if(!this->members[i].active) continue;
+            if(this->members[i].frames.empty()) return;
+            if(this->members[i].frames.front().key > newest) newest = this->members[i].frames.front().key;
+        }
+        bool dropped = false;
+        for(size_t i = 0; i < this->members.size(); i++){
+            EVTSyncMember& member = this->members[i];
+            if(!member.active) continue;
+            while(!member.frames.empty() && member.frames.front().key + tolerance < newest){
+                dropFront(member);
+                dropped = true;
+            }
+        }
+        if(dropped) continue;
+
+        shared_ptr<EVTSyncSet> pSet(new EVTSyncSet(this->nextSetId++));
+        for(size_t i = 0; i < this->members.size(); i++){
+            EVTSyncMember& member = this->members[i];
+            if(!member.active) continue;
+            pSet->frames.push_back(member.frames.front().pArray);
+            member.frames.pop_front();
+            member.numMatched++;
+        }
+        completed.push_back(pSet);
+    }
+}
+
+
+bool EVTFrameSync::isPublishing() const {
+    for(size_t i = 0; i < this->members.size(); i++){
+        if(this->members[i].active && this->members[i].publishing) return true;
+    }
+    return false;
+}
+
+
+void EVTFrameSync::dropFront(EVTSyncMember& member){
+    member.frames.front().pArray->release();
+    member.frames.pop_front();
+    member.numUnmatched++;
+}
+
+
+void EVTFrameSync::clearMember(EVTSyncMember& member){
+    while(!member.frames.empty()) dropFront(member);
+}
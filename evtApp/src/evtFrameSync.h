@@ -0,0 +1,143 @@
+/**
+ * Header file for the ADEmergentVision multi-camera frame synchronizer
+ *
+ * Matches frames from several cameras in the same IOC that belong to the same trigger. Cameras join a
+ * named group, and submit every frame with its trigger ID and camera timestamp. Frames are matched either
+ * by trigger ID, which is the block ID of the frame and is equal across cameras started together on a
+ * common hardware trigger, or by camera timestamp within a tolerance, for cameras synchronized with PTP.
+ * When every member has a frame for the same trigger the set is passed to the callbacks of all members.
+ * Frames that can no longer be matched, or that wait longer than the timeout, are dropped and counted.
+ * Frames are only queued while at least one member publishes the sets.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTFRAMESYNC_H
+#define EVTFRAMESYNC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "NDArray.h"
+
+// Frames kept per member while waiting for a match, older frames are dropped first
+#define EVT_SYNC_MAX_QUEUE 32
+
+
+typedef enum {
+    EVT_SYNC_TRIGGER_ID = 0,
+    EVT_SYNC_TIMESTAMP  = 1
+} EVTSyncMatch;
+
+
+// How a member publishes the matched sets
+typedef enum {
+    EVT_SYNC_OUTPUT_NONE        = 0,
+    EVT_SYNC_OUTPUT_COMPOSITE   = 1,    // one NDArray with the frames side by side
+    EVT_SYNC_OUTPUT_ALIGNED     = 2     // every frame of the set, with the set ID as the uniqueId
+} EVTSyncOutput;
+
+
+// A matched set, with one frame per member in the order the members joined
+class EVTSyncSet {
+
+    public:
+
+        EVTSyncSet(int setId);
+        // releases the frames
+        ~EVTSyncSet();
+
+        int setId;
+        std::vector<NDArray*> frames;
+};
+
+
+typedef void (*EVTSyncCallback)(void* pUser, std::shared_ptr<EVTSyncSet> pSet);
+
+
+// Statistics of a single member
+typedef struct EVTSyncStats {
+    uint64_t numMatched;
+    uint64_t numUnmatched;
+    int numMembers;
+} EVTSyncStats;
+
+
+class EVTFrameSync {
+
+    public:
+
+        // returns the group with the given name, created on first use, groups are never destroyed
+        static EVTFrameSync* getGroup(const char* name);
+
+        // the callback is called from the thread that completes a set, and must not block
+        int join(EVTSyncCallback callback, void* pUser);
+        // no callbacks are made to a member once leave returns
+        void leave(int member);
+
+        // applies to the whole group, queued frames are dropped when the match changes
+        void configure(EVTSyncMatch match, double tolerance, double timeout);
+
+        // drops the frames queued for a member, called when its acquisition starts
+        void reset(int member);
+
+        // whether the member publishes the sets, frames of a group where no member does are not queued
+        void setPublishing(int member, bool publishing);
+
+        // queues a frame, reserving it, and passes on any sets it completes
+        void submit(int member, NDArray* pArray, unsigned int triggerId, uint64_t timeStampNs);
+
+        bool getStats(int member, EVTSyncStats* pStats);
+        const char* getName() const;
+
+    private:
+
+        typedef struct EVTSyncFrame {
+            NDArray* pArray;
+            uint64_t key;
+            std::chrono::steady_clock::time_point arrival;
+        } EVTSyncFrame;
+
+        typedef struct EVTSyncMember {
+            bool active;
+            bool publishing;
+            EVTSyncCallback callback;
+            void* pUser;
+            std::deque<EVTSyncFrame> frames;
+            // trigger IDs are 16 bit, and are extended to 64 bits across wraps
+            unsigned int lastTriggerId;
+            uint64_t triggerIdHigh;
+            uint64_t numMatched;
+            uint64_t numUnmatched;
+        } EVTSyncMember;
+
+        EVTFrameSync(const char* name);
+
+        std::string name;
+        std::mutex syncMutex;
+        // held while calling back, so leave can wait for calls in progress
+        std::mutex callbackMutex;
+        std::vector<EVTSyncMember> members;
+        EVTSyncMatch match;
+        uint64_t toleranceNs;
+        double timeout;
+        int nextSetId;
+
+        bool isPublishing() const;
+        void dropFront(EVTSyncMember& member);
+        void clearMember(EVTSyncMember& member);
+        void matchSets(std::vector<std::shared_ptr<EVTSyncSet> >& completed);
+};
+
+
+#endif
@@ -0,0 +1,263 @@
+/**
+ * Source file for the ADEmergentVision frame transform
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <string.h>
+
+#include "evtSimd.h"
+#include "evtFrameTransform.h"
+
+using namespace std;
+
+
+#ifdef EVT_SIMD_SSE2
+
+/**
+ * Transposes an 8x8 tile of bytes. Source row k is the 8 bytes at pSrc + k * srcStep, and
+ * output row i is stored at pDst + i * dstStep.
+ */
+static inline void evtTransposeTile(const uint8_t* pSrc, ptrdiff_t srcStep, uint8_t* pDst, ptrdiff_t dstStep){
+    __m128i r[8];
+    for(int k = 0; k < 8; k++) r[k] = _mm_loadl_epi64((const __m128i*) (pSrc + k * srcStep));
+    __m128i a0 = _mm_unpacklo_epi8(r[0], r[1]);
+    __m128i a1 = _mm_unpacklo_epi8(r[2], r[3]);
+    __m128i a2 = _mm_unpacklo_epi8(r[4], r[5]);
+    __m128i a3 = _mm_unpacklo_epi8(r[6], r[7]);
+    __m128i b0 = _mm_unpacklo_epi16(a0, a1);
+    __m128i b1 = _mm_unpackhi_epi16(a0, a1);
+    __m128i b2 = _mm_unpacklo_epi16(a2, a3);
+    __m128i b3 = _mm_unpackhi_epi16(a2, a3);
+    // each register holds two output rows
+    __m128i c[4];
+    c[0] = _mm_unpacklo_epi32(b0, b2);
+    c[1] = _mm_unpackhi_epi32(b0, b2);
+    c[2] = _mm_unpacklo_epi32(b1, b3);
+    c[3] = _mm_unpackhi_epi32(b1, b3);
+    for(int i = 0; i < 4; i++){
+        _mm_storel_epi64((__m128i*) (pDst + (2 * i) * dstStep), c[i]);
+        _mm_storel_epi64((__m128i*) (pDst + (2 * i + 1) * dstStep), _mm_srli_si128(c[i], 8));
+    }
+}
+
+
+/**
+ * Transposes an 8x8 tile of 16 bit values, with the same layout as the 8 bit version
+ */
+static inline void evtTransposeTile(const uint16_t* pSrc, ptrdiff_t srcStep, uint16_t* pDst, ptrdiff_t dstStep){
+    __m128i r[8];
+    for(int k = 0; k < 8; k++) r[k] = _mm_loadu_si128((const __m128i*) (pSrc + k * srcStep));
+    __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+    __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+    __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+    __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+    __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+    __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+    __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+    __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+    _mm_storeu_si128((__m128i*) (pDst),               _mm_unpacklo_epi64(b0, b4));
+    _mm_storeu_si128((__m128i*) (pDst + dstStep),     _mm_unpackhi_epi64(b0, b4));
+    _mm_storeu_si128((__m128i*) (pDst + 2 * dstStep), _mm_unpacklo_epi64(b1, b5));
+    _mm_storeu_si128((__m128i*) (pDst + 3 * dstStep), _mm_unpackhi_epi64(b1, b5));
+    _mm_storeu_si128((__m128i*) (pDst + 4 * dstStep), _mm_unpacklo_epi64(b2, b6));
+    _mm_storeu_si128((__m128i*) (pDst + 5 * dstStep), _mm_unpackhi_epi64(b2, b6));
+    _mm_storeu_si128((__m128i*) (pDst + 6 * dstStep), _mm_unpacklo_epi64(b3, b7));
+    _mm_storeu_si128((__m128i*) (pDst + 7 * dstStep), _mm_unpackhi_epi64(b3, b7));
+}
+
+
+/**
+ * Copies n pixels in reverse order, pSrc points at the source of the first output pixel.
+ * Returns the number of pixels copied, the rest is left for the scalar path.
+ */
+static inline size_t evtReverseRow(const uint16_t* pSrc, uint16_t* pDst, size_t n){
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pSrc - i - 7));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1B), 0x1B);
+        _mm_storeu_si128((__m128i*) (pDst + i), _mm_shuffle_epi32(v, 0x4E));
+    }
+    return i;
+}
+
+
+static inline size_t evtReverseRow(const uint8_t* pSrc, uint8_t* pDst, size_t n){
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pSrc - i - 15));
+        v = _mm_shuffle_epi32(_mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1B), 0x1B), 0x4E);
+        // words are reversed, swap the bytes within each word
+        _mm_storeu_si128((__m128i*) (pDst + i), _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+    }
+    return i;
+}
+
+#endif
+
+
+EVTFrameTransform::EVTFrameTransform()
+    : cropX(0), cropY(0), cropSizeX(0), cropSizeY(0), flipX(false), flipY(false), rotation(EVT_ROTATE_0) {}
+
+
+/**
+ * Sets the crop, flips and rotation
+ *
+ * @params[in]: cropX       -> first source column
+ * @params[in]: cropY       -> first source row
+ * @params[in]: cropSizeX   -> cropped width, 0 for the rest of the row
+ * @params[in]: cropSizeY   -> cropped height, 0 for the rest of the frame
+ * @params[in]: flipX       -> mirror left to right
+ * @params[in]: flipY       -> mirror top to bottom
+ * @params[in]: rotation    -> clockwise rotation applied after the flips
+ * @return: void
+ */
+void EVTFrameTransform::configure(size_t cropX, size_t cropY, size_t cropSizeX, size_t cropSizeY, bool flipX, bool flipY, EVTRotation rotation){
+    this->cropX = cropX;
+    this->cropY = cropY;
+    this->cropSizeX = cropSizeX;
+    this->cropSizeY = cropSizeY;
+    this->flipX = flipX;
+    this->flipY = flipY;
+    this->rotation = rotation;
+}
+
+
+void EVTFrameTransform::getCrop(size_t sizeX, size_t sizeY, size_t* pX, size_t* pY, size_t* pW, size_t* pH) const {
+    *pX = this->cropX < sizeX ? this->cropX : sizeX;
+    *pY = this->cropY < sizeY ? this->cropY : sizeY;
+    *pW = sizeX - *pX;
+    *pH = sizeY - *pY;
+    if(this->cropSizeX > 0 && this->cropSizeX < *pW) *pW = this->cropSizeX;
+    if(this->cropSizeY > 0 && this->cropSizeY < *pH) *pH = this->cropSizeY;
+}
+
+
+bool EVTFrameTransform::isIdentity(size_t sizeX, size_t sizeY) const {
+    size_t x, y, w, h;
+    getCrop(sizeX, sizeY, &x, &y, &w, &h);
+    return w == sizeX && h == sizeY && !this->flipX && !this->flipY && this->rotation == EVT_ROTATE_0;
+}
+
+
+void EVTFrameTransform::getOutputSize(size_t sizeX, size_t sizeY, size_t* pOutSizeX, size_t* pOutSizeY) const {
+    size_t x, y, w, h;
+    getCrop(sizeX, sizeY, &x, &y, &w, &h);
+    bool swap = (this->rotation == EVT_ROTATE_90 || this->rotation == EVT_ROTATE_270);
+    *pOutSizeX = swap ? h : w;
+    *pOutSizeY = swap ? w : h;
+}
+
+
+template <typename T>
+void EVTFrameTransform::applyFrame(const T* pSrc, T* pDst, size_t sizeX, size_t sizeY, int numComponents) const {
+    size_t x0, y0, w, h;
+    getCrop(sizeX, sizeY, &x0, &y0, &w, &h);
+    if(w == 0 || h == 0) return;
+
+    // source offsets in pixels of the cropped and flipped frame, c0 + u * du + v * dv
+    ptrdiff_t pitch = (ptrdiff_t) sizeX;
+    ptrdiff_t du = this->flipX ? -1 : 1;
+    ptrdiff_t dv = this->flipY ? -pitch : pitch;
+    ptrdiff_t c0 = ((ptrdiff_t) y0 + (this->flipY ? (ptrdiff_t) h - 1 : 0)) * pitch + (ptrdiff_t) x0 + (this->flipX ? (ptrdiff_t) w - 1 : 0);
+
+    // output pixel (x, y) comes from source pixel base + x * dx + y * dy
+    ptrdiff_t base, dx, dy;
+    size_t outW, outH;
+    switch(this->rotation){
+        case EVT_ROTATE_90:
+            base = c0 + ((ptrdiff_t) h - 1) * dv; dx = -dv; dy = du; outW = h; outH = w;
+            break;
+        case EVT_ROTATE_180:
+            base = c0 + ((ptrdiff_t) w - 1) * du + ((ptrdiff_t) h - 1) * dv; dx = -du; dy = -dv; outW = w; outH = h;
+            break;
+        case EVT_ROTATE_270:
+            base = c0 + ((ptrdiff_t) w - 1) * du; dx = dv; dy = -du; outW = h; outH = w;
+            break;
+        default:
+            base = c0; dx = du; dy = dv; outW = w; outH = h;
+            break;
+    }
+
+    const ptrdiff_t nc = numComponents;
+    if(dx == 1 || dx == -1){
+        for(size_t y = 0; y < outH; y++){
+            const T* pRow = pSrc + (base + (ptrdiff_t) y * dy) * nc;
+            T* pOut = pDst + y * outW * nc;
+            if(dx == 1){
+                memcpy(pOut, pRow, outW * nc * sizeof(T));
+                continue;
+            }
+            size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+            if(nc == 1) x = evtReverseRow(pRow, pOut, outW);
+#endif
+            for(; x < outW; x++){
+                for(ptrdiff_t c = 0; c < nc; c++) pOut[x * nc + c] = pRow[-(ptrdiff_t) x * nc + c];
+            }
+        }
+        return;
+    }
+
+    // dx is a source row and dy a source pixel, so output rows are source columns
+    for(size_t by = 0; by < outH; by += EVT_TRANSFORM_BLOCK){
+        size_t yEnd = by + EVT_TRANSFORM_BLOCK < outH ? by + EVT_TRANSFORM_BLOCK : outH;
+        for(size_t bx = 0; bx < outW; bx += EVT_TRANSFORM_BLOCK){
+            size_t xEnd = bx + EVT_TRANSFORM_BLOCK < outW ? bx + EVT_TRANSFORM_BLOCK : outW;
+            size_t y = by;
+#ifdef EVT_SIMD_SSE2
+            if(nc == 1){
+                for(; y + 8 <= yEnd; y += 8){
+                    size_t x = bx;
+                    for(; x + 8 <= xEnd; x += 8){
+                        // tile rows are the source runs of output columns x..x+7, which run backwards if dy is negative
+                        const T* pTile = pSrc + base + (ptrdiff_t) x * dx + (dy > 0 ? (ptrdiff_t) y : -(ptrdiff_t) y - 7);
+                        T* pOut = pDst + (dy > 0 ? y : y + 7) * outW + x;
+                        evtTransposeTile(pTile, dx, pOut, dy > 0 ? (ptrdiff_t) outW : -(ptrdiff_t) outW);
+                    }
+                    for(size_t ty = y; ty < y + 8; ty++){
+                        for(size_t tx = x; tx < xEnd; tx++) pDst[ty * outW + tx] = pSrc[base + (ptrdiff_t) tx * dx + (ptrdiff_t) ty * dy];
+                    }
+                }
+            }
+#endif
+            for(; y < yEnd; y++){
+                for(size_t x = bx; x < xEnd; x++){
+                    const T* pPixel = pSrc + (base + (ptrdiff_t) x * dx + (ptrdiff_t) y * dy) * nc;
+                    for(ptrdiff_t c = 0; c < nc; c++) pDst[(y * outW + x) * nc + c] = pPixel[c];
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * Copies a frame into the output with the configured crop, flips and rotation
+ *
+ * @params[in]:  pSrc           -> source frame
+ * @params[out]: pDst           -> output, with the size given by getOutputSize
+ * @params[in]:  sizeX          -> source width
+ * @params[in]:  sizeY          -> source height
+ * @params[in]:  numComponents  -> values per pixel, 1 for mono, 3 for interleaved RGB
+ * @return: void
+ */
+void EVTFrameTransform::apply(const uint8_t* pSrc, uint8_t* pDst, size_t sizeX, size_t sizeY, int numComponents) const {
+    applyFrame(pSrc, pDst, sizeX, sizeY, numComponents);
+}
+
+
+void EVTFrameTransform::apply(const uint16_t* pSrc, uint16_t* pDst, size_t sizeX, size_t sizeY, int numComponents) const {
+    applyFrame(pSrc, pDst, sizeX, sizeY, numComponents);
+}
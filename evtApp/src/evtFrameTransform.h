@@ -0,0 +1,70 @@
+/**
+ * Header file for the ADEmergentVision frame transform
+ *
+ * Crops, flips and rotates a frame while copying it out of the camera buffer. Every output pixel maps
+ * to a source pixel at base + x * dx + y * dy, so all combinations reduce to two kernels: a row copy,
+ * forwards or reversed, when dx is one pixel, and a transpose when dx is one source row. The transpose
+ * is done in 8x8 tiles with SSE2 unpacks, inside 64x64 blocks so each source cache line is used fully
+ * before it is evicted. Flips are applied to the cropped frame, and the rotation after the flips.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTFRAMETRANSFORM_H
+#define EVTFRAMETRANSFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Edge length of the blocks the transpose is done in
+#define EVT_TRANSFORM_BLOCK 64
+
+
+// Clockwise rotation
+typedef enum {
+    EVT_ROTATE_0    = 0,
+    EVT_ROTATE_90   = 1,
+    EVT_ROTATE_180  = 2,
+    EVT_ROTATE_270  = 3
+} EVTRotation;
+
+
+class EVTFrameTransform {
+
+    public:
+
+        EVTFrameTransform();
+
+        // crop in source pixels, a crop size of 0 extends to the edge of the frame
+        void configure(size_t cropX, size_t cropY, size_t cropSizeX, size_t cropSizeY, bool flipX, bool flipY, EVTRotation rotation);
+
+        // true if frames of this size are copied unchanged
+        bool isIdentity(size_t sizeX, size_t sizeY) const;
+
+        // output size for a source frame of the given size, 0 if the crop is outside the frame
+        void getOutputSize(size_t sizeX, size_t sizeY, size_t* pOutSizeX, size_t* pOutSizeY) const;
+
+        // copies a frame with numComponents (1 or 3) interleaved values per pixel into the output
+        void apply(const uint8_t* pSrc, uint8_t* pDst, size_t sizeX, size_t sizeY, int numComponents) const;
+        void apply(const uint16_t* pSrc, uint16_t* pDst, size_t sizeX, size_t sizeY, int numComponents) const;
+
+    private:
+
+        size_t cropX;
+        size_t cropY;
+        size_t cropSizeX;
+        size_t cropSizeY;
+        bool flipX;
+        bool flipY;
+        EVTRotation rotation;
+
+        void getCrop(size_t sizeX, size_t sizeY, size_t* pX, size_t* pY, size_t* pW, size_t* pH) const;
+        template <typename T> void applyFrame(const T* pSrc, T* pDst, size_t sizeX, size_t sizeY, int numComponents) const;
+};
+
+
+#endif
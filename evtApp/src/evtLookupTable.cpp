@@ -0,0 +1,151 @@
+/**
+ * Source file for the ADEmergentVision driver lookup table
+ *
+ * SSE2 has no gather instruction, and the 16 bit gathers of later instruction sets are not faster than
+ * scalar loads for tables that fit in L1/L2, so the kernel is an unrolled scalar gather with the input
+ * clamp done branch free.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <math.h>
+
+#include "evtLookupTable.h"
+
+using namespace std;
+
+
+EVTLookupTable::EVTLookupTable()
+    : inputBits(0), outputBits(0), maxInput(0) {
+    configure(EVT_LUT_LINEAR, 16, 8, 1.0, vector<double>());
+}
+
+
+/**
+ * Rebuilds the table for the given curve
+ *
+ * @params[in]: mode        -> curve used to build the table
+ * @params[in]: inputBits   -> input bit depth, 8 to 16
+ * @params[in]: outputBits  -> output bit depth, 8 or 16
+ * @params[in]: gamma       -> output is input^(1/gamma), for EVT_LUT_GAMMA
+ * @params[in]: points      -> output values spread evenly over the input range, for EVT_LUT_TABLE
+ * @return: void
+ */
+void EVTLookupTable::configure(EVTLutMode mode, int inputBits, int outputBits, double gamma, const vector<double>& points){
+    if(inputBits < 8) inputBits = 8;
+    if(inputBits > 16) inputBits = 16;
+    outputBits = (outputBits > 8) ? 16 : 8;
+    if(gamma <= 0) gamma = 1.0;
+    if(mode == EVT_LUT_TABLE && points.size() < 2) mode = EVT_LUT_LINEAR;
+
+    this->inputBits = inputBits;
+    this->outputBits = outputBits;
+    this->maxInput = (1u << inputBits) - 1;
+    double maxOutput = (outputBits == 8) ? 255.0 : 65535.0;
+    size_t size = (size_t) this->maxInput + 1;
+
+    vector<double> curve(size);
+    for(size_t i = 0; i < size; i++){
+        double x = (double) i / this->maxInput;
+        double y;
+        switch(mode){
+            case EVT_LUT_GAMMA:
+                y = pow(x, 1.0 / gamma) * maxOutput;
+                break;
+            case EVT_LUT_LOG:
+                y = log1p((double) i) / log1p((double) this->maxInput) * maxOutput;
+                break;
+            case EVT_LUT_TABLE: {
+                double position = x * (points.size() - 1);
+                size_t lower = (size_t) position;
+                if(lower >= points.size() - 1) lower = points.size() - 2;
+                double fraction = position - lower;
+                y = points[lower] + (points[lower + 1] - points[lower]) * fraction;
+                break;
+            }
+            default:
+                y = x * maxOutput;
+                break;
+        }
+        if(y < 0) y = 0;
+        if(y > maxOutput) y = maxOutput;
+        curve[i] = y + 0.5;
+    }
+
+    this->table8.clear();
+    this->table16.clear();
+    if(outputBits == 8){
+        this->table8.resize(size);
+        for(size_t i = 0; i < size; i++) this->table8[i] = (uint8_t) curve[i];
+    }
+    else{
+        this->table16.resize(size);
+        for(size_t i = 0; i < size; i++) this->table16[i] = (uint16_t) curve[i];
+    }
+}
+
+
+int EVTLookupTable::getInputBits() const {
+    return this->inputBits;
+}
+
+
+int EVTLookupTable::getOutputBits() const {
+    return this->outputBits;
+}
+
+
+/**
+ * Table gather, unrolled by four. Input and output may be the same buffer when they have the same type.
+ */
+template <typename TIn, typename TOut>
+void EVTLookupTable::gather(const TIn* pIn, TOut* pOut, size_t numPixels, const TOut* pTable) const {
+    const uint32_t maxInput = this->maxInput;
+    size_t i = 0;
+    for(; i + 4 <= numPixels; i += 4){
+        uint32_t v0 = pIn[i], v1 = pIn[i + 1], v2 = pIn[i + 2], v3 = pIn[i + 3];
+        v0 = v0 > maxInput ? maxInput : v0;
+        v1 = v1 > maxInput ? maxInput : v1;
+        v2 = v2 > maxInput ? maxInput : v2;
+        v3 = v3 > maxInput ? maxInput : v3;
+        pOut[i] = pTable[v0];
+        pOut[i + 1] = pTable[v1];
+        pOut[i + 2] = pTable[v2];
+        pOut[i + 3] = pTable[v3];
+    }
+    for(; i < numPixels; i++){
+        uint32_t v = pIn[i];
+        pOut[i] = pTable[v > maxInput ? maxInput : v];
+    }
+}
+
+
+/**
+ * Applies the table, the output type must match the configured output bit depth
+ *
+ * @params[in]:  pIn        -> input pixels
+ * @params[out]: pOut       -> output pixels
+ * @params[in]:  numPixels  -> number of pixels
+ * @return: void
+ */
+void EVTLookupTable::apply(const uint8_t* pIn, uint8_t* pOut, size_t numPixels) const {
+    gather(pIn, pOut, numPixels, &this->table8[0]);
+}
+
+
+void EVTLookupTable::apply(const uint8_t* pIn, uint16_t* pOut, size_t numPixels) const {
+    gather(pIn, pOut, numPixels, &this->table16[0]);
+}
+
+
+void EVTLookupTable::apply(const uint16_t* pIn, uint8_t* pOut, size_t numPixels) const {
+    gather(pIn, pOut, numPixels, &this->table8[0]);
+}
+
+
+void EVTLookupTable::apply(const uint16_t* pIn, uint16_t* pOut, size_t numPixels) const {
+    gather(pIn, pOut, numPixels, &this->table16[0]);
+}
@@ -0,0 +1,64 @@
+/**
+ * Header file for the ADEmergentVision driver lookup table
+ *
+ * Maps 8 to 16 bit input pixels to 8 or 16 bit output through a precomputed table with one entry
+ * per input value. Tables are built from a linear, gamma or log curve, or interpolated from an
+ * arbitrary list of points spread evenly across the input range.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTLOOKUPTABLE_H
+#define EVTLOOKUPTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Largest number of points in an arbitrary table
+#define EVT_LUT_MAX_POINTS 4096
+
+
+typedef enum {
+    EVT_LUT_LINEAR  = 0,
+    EVT_LUT_GAMMA   = 1,
+    EVT_LUT_LOG     = 2,
+    EVT_LUT_TABLE   = 3
+} EVTLutMode;
+
+
+class EVTLookupTable {
+
+    public:
+
+        EVTLookupTable();
+
+        // rebuilds the table, points are output values used by EVT_LUT_TABLE
+        void configure(EVTLutMode mode, int inputBits, int outputBits, double gamma, const std::vector<double>& points);
+
+        int getInputBits() const;
+        int getOutputBits() const;
+
+        // input values above the input range are clamped to the last table entry
+        void apply(const uint8_t* pIn, uint8_t* pOut, size_t numPixels) const;
+        void apply(const uint8_t* pIn, uint16_t* pOut, size_t numPixels) const;
+        void apply(const uint16_t* pIn, uint8_t* pOut, size_t numPixels) const;
+        void apply(const uint16_t* pIn, uint16_t* pOut, size_t numPixels) const;
+
+    private:
+
+        std::vector<uint8_t> table8;
+        std::vector<uint16_t> table16;
+        int inputBits;
+        int outputBits;
+        uint32_t maxInput;
+
+        template <typename TIn, typename TOut> void gather(const TIn* pIn, TOut* pOut, size_t numPixels, const TOut* pTable) const;
+};
+
+
+#endif
@@ -0,0 +1,327 @@
+/**
+ * Source file for the ADEmergentVision memory mapped file helper
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "evtMappedFile.h"
+
+using namespace std;
+
+
+#ifdef _WIN32
+EVTMappedFile::EVTMappedFile()
+    : pData(NULL), size(0), writable(false), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL) {}
+#else
+EVTMappedFile::EVTMappedFile()
+    : pData(NULL), size(0), writable(false), fd(-1) {}
+#endif
+
+
+EVTMappedFile::~EVTMappedFile(){
+    close();
+}
+
+
+/**
+ * Creates a file of the given size and maps it read/write. Any existing file is truncated.
+ *
+ * @params[in]:  path   -> path of the file
+ * @params[in]:  size   -> size of the file in bytes, must be greater than zero
+ * @params[out]: error  -> reason for failure
+ * @return: true if the file was created and mapped
+ */
+bool EVTMappedFile::create(const char* path, size_t size, string& error){
+    return map(path, size, true, error);
+}
+
+
+/**
+ * Maps an existing file read only. The whole file is mapped.
+ *
+ * @params[in]:  path   -> path of the file
+ * @params[out]: error  -> reason for failure
+ * @return: true if the file was mapped
+ */
+bool EVTMappedFile::open(const char* path, string& error){
+    return map(path, 0, false, error);
+}
+
+
+/**
+ * Creates a shared memory object of the given size and maps it read/write. An existing object with
+ * the same name is removed first, processes that still map it keep the old object. On Windows the name
+ * stays with the old object until every process unmaps it, so creation waits up to
+ * EVT_SHARED_REPLACE_TIMEOUT_MS for that, and fails if the old object is still mapped.
+ *
+ * @params[in]:  name   -> name of the object, a leading / is added on POSIX if missing
+ * @params[in]:  size   -> size of the object in bytes, must be greater than zero
+ * @params[out]: error  -> reason for failure
+ * @return: true if the object was created and mapped
+ */
+bool EVTMappedFile::createShared(const char* name, size_t size, string& error){
+    return mapShared(name, size, true, error);
+}
+
+
+/**
+ * Maps an existing shared memory object read/write. The whole object is mapped.
+ *
+ * @params[in]:  name   -> name of the object
+ * @params[out]: error  -> reason for failure
+ * @return: true if the object was mapped
+ */
+bool EVTMappedFile::openShared(const char* name, string& error){
+    return mapShared(name, 0, false, error);
+}
+
+
+#ifdef _WIN32
+
+bool EVTMappedFile::map(const char* path, size_t size, bool create, string& error){
+    close();
+    this->fileHandle = CreateFileA(path, create ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                                   FILE_SHARE_READ, NULL, create ? CREATE_ALWAYS : OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL, NULL);
+    if(this->fileHandle == INVALID_HANDLE_VALUE){
+        error = string("Failed to open ") + path;
+        return false;
+    }
+    if(!create){
+        LARGE_INTEGER fileSize;
+        if(!GetFileSizeEx(this->fileHandle, &fileSize)){
+            error = string("Failed to get size of ") + path;
+            close();
+            return false;
+        }
+        size = (size_t) fileSize.QuadPart;
+    }
+    if(size == 0){
+        error = string("Empty file ") + path;
+        close();
+        return false;
+    }
+    unsigned long long mappingSize = size;
+    this->mappingHandle = CreateFileMappingA(this->fileHandle, NULL, create ? PAGE_READWRITE : PAGE_READONLY,
+                                             (DWORD) (mappingSize >> 32), (DWORD) (mappingSize & 0xFFFFFFFF), NULL);
+    if(this->mappingHandle != NULL)
+        this->pData = MapViewOfFile(this->mappingHandle, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+    if(this->pData == NULL){
+        error = string("Failed to map ") + path;
+        close();
+        return false;
+    }
+    this->size = size;
+    this->writable = create;
+    return true;
+}
+
+
+// pagefile backed mappings are removed by the system when the last handle is closed
+bool EVTMappedFile::mapShared(const char* name, size_t size, bool create, string& error){
+    close();
+    if(create){
+        // an existing mapping would be returned as is, with its old size and contents
+        unsigned long long mappingSize = size;
+        for(int waited = 0; ; waited += 10){
+            this->mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                                     (DWORD) (mappingSize >> 32), (DWORD) (mappingSize & 0xFFFFFFFF), name);
+            if(this->mappingHandle == NULL || GetLastError() != ERROR_ALREADY_EXISTS) break;
+            CloseHandle(this->mappingHandle);
+            this->mappingHandle = NULL;
+            if(waited >= EVT_SHARED_REPLACE_TIMEOUT_MS){
+                error = string("Shared memory ") + name + " is still mapped by another process";
+                return false;
+            }
+            Sleep(10);
+        }
+    }
+    else this->mappingHandle = OpenFileMappingA(FILE_MAP_WRITE, FALSE, name);
+    if(this->mappingHandle == NULL){
+        error = string("Failed to open shared memory ") + name;
+        return false;
+    }
+    this->pData = MapViewOfFile(this->mappingHandle, FILE_MAP_WRITE, 0, 0, size);
+    MEMORY_BASIC_INFORMATION info;
+    if(this->pData == NULL || VirtualQuery(this->pData, &info, sizeof(info)) == 0){
+        error = string("Failed to map shared memory ") + name;
+        close();
+        return false;
+    }
+    this->size = create ? size : (size_t) info.RegionSize;
+    this->writable = true;
+    return true;
+}
+
+
+bool EVTMappedFile::flush(){
+    if(this->pData == NULL || !this->writable) return false;
+    return FlushViewOfFile(this->pData, this->size) && FlushFileBuffers(this->fileHandle);
+}
+
+
+void EVTMappedFile::close(){
+    if(this->pData != NULL) UnmapViewOfFile(this->pData);
+    if(this->mappingHandle != NULL) CloseHandle(this->mappingHandle);
+    if(this->fileHandle != INVALID_HANDLE_VALUE) CloseHandle(this->fileHandle);
+    this->pData = NULL;
+    this->mappingHandle = NULL;
+    this->fileHandle = INVALID_HANDLE_VALUE;
+    this->size = 0;
+    this->writable = false;
+}
+
+#else
+
+bool EVTMappedFile::map(const char* path, size_t size, bool create, string& error){
+    close();
+    this->fd = create ? ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644) : ::open(path, O_RDONLY);
+    if(this->fd < 0){
+        error = string("Failed to open ") + path + ": " + strerror(errno);
+        return false;
+    }
+    if(create){
+        if(ftruncate(this->fd, (off_t) size) != 0){
+            error = string("Failed to resize ") + path + ": " + strerror(errno);
+            close();
+            return false;
+        }
+    }
+    else{
+        struct stat fileStat;
+        if(fstat(this->fd, &fileStat) != 0){
+            error = string("Failed to get size of ") + path + ": " + strerror(errno);
+            close();
+            return false;
+        }
+        size = (size_t) fileStat.st_size;
+    }
+    if(size == 0){
+        error = string("Empty file ") + path;
+        close();
+        return false;
+    }
+    void* pMap = mmap(NULL, size, create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, this->fd, 0);
+    if(pMap == MAP_FAILED){
+        error = string("Failed to map ") + path + ": " + strerror(errno);
+        close();
+        return false;
+    }
+    this->pData = pMap;
+    this->size = size;
+    this->writable = create;
+    return true;
+}
+
+
+bool EVTMappedFile::mapShared(const char* name, size_t size, bool create, string& error){
+    close();
+    string sharedName = (name[0] == '/') ? string(name) : string("/") + name;
+    if(create){
+        shm_unlink(sharedName.c_str());
+        this->fd = shm_open(sharedName.c_str(), O_RDWR | O_CREAT | O_EXCL, EVT_SHARED_MODE);
+    }
+    else this->fd = shm_open(sharedName.c_str(), O_RDWR, 0);
+    if(this->fd < 0){
+        error = string("Failed to open shared memory ") + sharedName + ": " + strerror(errno);
+        return false;
+    }
+    if(create){
+        this->sharedName = sharedName;
+        // the umask would otherwise remove the group write access readers need
+        if(fchmod(this->fd, EVT_SHARED_MODE) != 0 || ftruncate(this->fd, (off_t) size) != 0){
+            error = string("Failed to resize shared memory ") + sharedName + ": " + strerror(errno);
+            close();
+            return false;
+        }
+    }
+    else{
+        struct stat fileStat;
+        if(fstat(this->fd, &fileStat) != 0){
+            error = string("Failed to get size of shared memory ") + sharedName + ": " + strerror(errno);
+            close();
+            return false;
+        }
+        size = (size_t) fileStat.st_size;
+    }
+    if(size == 0){
+        error = string("Empty shared memory ") + sharedName;
+        close();
+        return false;
+    }
+    void* pMap = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+    if(pMap == MAP_FAILED){
+        error = string("Failed to map shared memory ") + sharedName + ": " + strerror(errno);
+        close();
+        return false;
+    }
+    this->pData = pMap;
+    this->size = size;
+    this->writable = true;
+    return true;
+}
+
+
+bool EVTMappedFile::flush(){
+    if(this->pData == NULL || !this->writable) return false;
+    return msync(this->pData, this->size, MS_SYNC) == 0;
+}
+
+
+void EVTMappedFile::close(){
+    if(this->pData != NULL) munmap(this->pData, this->size);
+    if(this->fd >= 0) ::close(this->fd);
+    if(!this->sharedName.empty()) shm_unlink(this->sharedName.c_str());
+    this->pData = NULL;
+    this->fd = -1;
+    this->sharedName.clear();
+    this->size = 0;
+    this->writable = false;
+}
+
+#endif
+
+
+void EVTMappedFile::swap(EVTMappedFile& other){
+    std::swap(this->pData, other.pData);
+    std::swap(this->size, other.size);
+    std::swap(this->writable, other.writable);
+#ifdef _WIN32
+    std::swap(this->fileHandle, other.fileHandle);
+    std::swap(this->mappingHandle, other.mappingHandle);
+#else
+    std::swap(this->fd, other.fd);
+    std::swap(this->sharedName, other.sharedName);
+#endif
+}
+
+
+bool EVTMappedFile::isOpen() const {
+    return this->pData != NULL;
+}
+
+
+void* EVTMappedFile::getData() const {
+    return this->pData;
+}
+
+
+size_t EVTMappedFile::getSize() const {
+    return this->size;
+}
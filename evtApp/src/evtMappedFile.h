@@ -0,0 +1,84 @@
+/**
+ * Header file for the ADEmergentVision memory mapped file helper
+ *
+ * Thin wrapper around mmap (POSIX) and file mappings (Windows), used to store processing references
+ * on disk in a form that can be used directly from the mapping, without reading or parsing the file.
+ * Also maps named shared memory objects (shm_open on POSIX, pagefile backed mappings on Windows), used
+ * to share frames with other processes on the same host.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTMAPPEDFILE_H
+#define EVTMAPPEDFILE_H
+
+#include <stddef.h>
+#include <string>
+
+// Permissions of shared memory objects on POSIX. Readers map the object read/write, so they must run as
+// the same user as the IOC or be in its group
+#define EVT_SHARED_MODE                 0660
+// Time to wait on Windows for processes mapping a replaced object to unmap it
+#define EVT_SHARED_REPLACE_TIMEOUT_MS   1000
+
+
+class EVTMappedFile {
+
+    public:
+
+        EVTMappedFile();
+        ~EVTMappedFile();
+
+        // creates (or truncates) the file with the given size, and maps it read/write
+        bool create(const char* path, size_t size, std::string& error);
+
+        // maps an existing file read only
+        bool open(const char* path, std::string& error);
+
+        // creates a shared memory object with the given name, replacing any existing one, and maps it read/write.
+        // The object is removed when the mapping that created it is closed. On POSIX it is created with
+        // EVT_SHARED_MODE, so processes of the same user or group can map it read/write
+        bool createShared(const char* name, size_t size, std::string& error);
+
+        // maps an existing shared memory object read/write
+        bool openShared(const char* name, std::string& error);
+
+        // writes modified pages back to the file
+        bool flush();
+        void close();
+
+        // exchanges the mappings held by two objects
+        void swap(EVTMappedFile& other);
+
+        bool isOpen() const;
+        void* getData() const;
+        size_t getSize() const;
+
+    private:
+
+        void* pData;
+        size_t size;
+        bool writable;
+#ifdef _WIN32
+        void* fileHandle;
+        void* mappingHandle;
+#else
+        int fd;
+        // name of the shared memory object created by this mapping, unlinked on close
+        std::string sharedName;
+#endif
+
+        bool map(const char* path, size_t size, bool create, std::string& error);
+        bool mapShared(const char* name, size_t size, bool create, std::string& error);
+
+        // mappings are owned, so copies are not allowed
+        EVTMappedFile(const EVTMappedFile&);
+        EVTMappedFile& operator=(const EVTMappedFile&);
+};
+
+
+#endif
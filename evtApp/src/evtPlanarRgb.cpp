@@ -0,0 +1,103 @@
+/**
+ * Source file for the ADEmergentVision planar RGB conversion
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include "evtSimd.h"
+#include "evtPlanarRgb.h"
+
+
+#ifdef EVT_SIMD_SSE2
+
+/**
+ * Splits pixels [0, n) of a row into the three channel rows, returns the first pixel left for the scalar path
+ */
+static size_t evtSplitRow(const uint8_t* pSrc, uint8_t* pR, uint8_t* pG, uint8_t* pB, size_t n){
+    size_t x = 0;
+    for(; x + 16 <= n; x += 16){
+        __m128i r, g, b;
+        evtLoadDeinterleave3(pSrc + 3 * x, &r, &g, &b);
+        _mm_storeu_si128((__m128i*) (pR + x), r);
+        _mm_storeu_si128((__m128i*) (pG + x), g);
+        _mm_storeu_si128((__m128i*) (pB + x), b);
+    }
+    return x;
+}
+
+
+static size_t evtSplitRow(const uint16_t* pSrc, uint16_t* pR, uint16_t* pG, uint16_t* pB, size_t n){
+    size_t x = 0;
+    for(; x + 8 <= n; x += 8){
+        __m128i r, g, b;
+        evtLoadDeinterleave3(pSrc + 3 * x, &r, &g, &b);
+        _mm_storeu_si128((__m128i*) (pR + x), r);
+        _mm_storeu_si128((__m128i*) (pG + x), g);
+        _mm_storeu_si128((__m128i*) (pB + x), b);
+    }
+    return x;
+}
+
+#endif
+
+
+template <typename T>
+static void evtConvertPlanar(const T* pSrc, T* pDst, size_t sizeX, size_t sizeY, EVTPlanarLayout layout){
+    size_t offsets[3], rowStride;
+    EVTPlanarRgb::getPlanes(sizeX, sizeY, layout, offsets, &rowStride);
+    for(size_t y = 0; y < sizeY; y++){
+        const T* pRow = pSrc + 3 * y * sizeX;
+        T* pR = pDst + offsets[0] + y * rowStride;
+        T* pG = pDst + offsets[1] + y * rowStride;
+        T* pB = pDst + offsets[2] + y * rowStride;
+        size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+        x = evtSplitRow(pRow, pR, pG, pB, sizeX);
+#endif
+        for(; x < sizeX; x++){
+            pR[x] = pRow[3 * x];
+            pG[x] = pRow[3 * x + 1];
+            pB[x] = pRow[3 * x + 2];
+        }
+    }
+}
+
+
+/**
+ * Splits an interleaved RGB frame into a planar layout
+ *
+ * @params[in]:  pSrc   -> interleaved RGB frame
+ * @params[out]: pDst   -> planar output
+ * @params[in]:  sizeX  -> frame width
+ * @params[in]:  sizeY  -> frame height
+ * @params[in]:  layout -> row or plane interleaved output
+ * @return: void
+ */
+void EVTPlanarRgb::convert(const uint8_t* pSrc, uint8_t* pDst, size_t sizeX, size_t sizeY, EVTPlanarLayout layout){
+    evtConvertPlanar(pSrc, pDst, sizeX, sizeY, layout);
+}
+
+
+void EVTPlanarRgb::convert(const uint16_t* pSrc, uint16_t* pDst, size_t sizeX, size_t sizeY, EVTPlanarLayout layout){
+    evtConvertPlanar(pSrc, pDst, sizeX, sizeY, layout);
+}
+
+
+/**
+ * Gets where the channels of a planar frame are, in values
+ *
+ * @params[in]:  sizeX      -> frame width
+ * @params[in]:  sizeY      -> frame height
+ * @params[in]:  layout     -> row or plane interleaved
+ * @params[out]: offsets    -> offset of the first red, green and blue value
+ * @params[out]: pRowStride -> distance between two rows of a channel
+ * @return: void
+ */
+void EVTPlanarRgb::getPlanes(size_t sizeX, size_t sizeY, EVTPlanarLayout layout, size_t offsets[3], size_t* pRowStride){
+    size_t planeStep = (layout == EVT_PLANAR_ROWS) ? sizeX : sizeX * sizeY;
+    for(int c = 0; c < 3; c++) offsets[c] = c * planeStep;
+    *pRowStride = (layout == EVT_PLANAR_ROWS) ? 3 * sizeX : sizeX;
+}
@@ -0,0 +1,41 @@
+/**
+ * Header file for the ADEmergentVision planar RGB conversion
+ *
+ * Splits interleaved RGB (RGB1) frames into row interleaved (RGB2) or plane interleaved (RGB3) layout.
+ * 16 8 bit or 8 16 bit pixels at a time are split into one register per channel with the SSE2 unpack
+ * deinterleave, and each register is stored to its plane.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTPLANARRGB_H
+#define EVTPLANARRGB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+typedef enum {
+    EVT_PLANAR_ROWS     = 0,    // RGB2, a red, a green and a blue row per image row
+    EVT_PLANAR_PLANES   = 1     // RGB3, a red, a green and a blue plane
+} EVTPlanarLayout;
+
+
+class EVTPlanarRgb {
+
+    public:
+
+        // splits an interleaved frame into the output, which has the same number of values
+        static void convert(const uint8_t* pSrc, uint8_t* pDst, size_t sizeX, size_t sizeY, EVTPlanarLayout layout);
+        static void convert(const uint16_t* pSrc, uint16_t* pDst, size_t sizeX, size_t sizeY, EVTPlanarLayout layout);
+
+        // offset of the first value of each channel, and the distance between rows of a channel
+        static void getPlanes(size_t sizeX, size_t sizeY, EVTPlanarLayout layout, size_t offsets[3], size_t* pRowStride);
+};
+
+
+#endif
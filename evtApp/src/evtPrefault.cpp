@@ -0,0 +1,80 @@
+/**
+ * Source file for the ADEmergentVision buffer prefault
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "evtPrefault.h"
+
+
+/**
+ * Touches every page of a buffer. The writes are volatile so they are not removed by the compiler,
+ * and a write rather than a read is needed, since reading an untouched page maps the shared zero page.
+ *
+ * @params[in]: pData       -> buffer
+ * @params[in]: numBytes    -> size of the buffer
+ * @return: void
+ */
+void EVTPrefault::touch(void* pData, size_t numBytes){
+    if(pData == NULL || numBytes == 0) return;
+    volatile unsigned char* p = (volatile unsigned char*) pData;
+    size_t pageSize = getPageSize();
+    for(size_t i = 0; i < numBytes; i += pageSize) p[i] = 0;
+    p[numBytes - 1] = 0;
+}
+
+
+/**
+ * Locks the pages of a buffer in memory
+ *
+ * @params[in]: pData       -> buffer
+ * @params[in]: numBytes    -> size of the buffer
+ * @return: true if the pages were locked
+ */
+bool EVTPrefault::lock(void* pData, size_t numBytes){
+    if(pData == NULL || numBytes == 0) return false;
+#ifdef _WIN32
+    return VirtualLock(pData, numBytes) != 0;
+#else
+    return mlock(pData, numBytes) == 0;
+#endif
+}
+
+
+/**
+ * Unlocks the pages of a buffer locked with lock
+ *
+ * @params[in]: pData       -> buffer
+ * @params[in]: numBytes    -> size of the buffer
+ * @return: void
+ */
+void EVTPrefault::unlock(void* pData, size_t numBytes){
+    if(pData == NULL || numBytes == 0) return;
+#ifdef _WIN32
+    VirtualUnlock(pData, numBytes);
+#else
+    munlock(pData, numBytes);
+#endif
+}
+
+
+size_t EVTPrefault::getPageSize(){
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    long pageSize = sysconf(_SC_PAGESIZE);
+    return pageSize > 0 ? (size_t) pageSize : 4096;
+#endif
+}
@@ -0,0 +1,36 @@
+/**
+ * Header file for the ADEmergentVision buffer prefault
+ *
+ * Touches every page of a buffer so that it is backed by memory and mapped before the first frame is
+ * written into it, and optionally locks the pages so they can not be paged out during acquisition.
+ * Without this, the first frames of an acquisition take a page fault per 4 KB page of every new buffer.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTPREFAULT_H
+#define EVTPREFAULT_H
+
+#include <stddef.h>
+
+
+class EVTPrefault {
+
+    public:
+
+        // writes one byte in every page of the buffer, the buffer contents are zeroed where written
+        static void touch(void* pData, size_t numBytes);
+
+        // lock and unlock the pages of a buffer in memory, false if the system refused, usually for lack of a memlock limit
+        static bool lock(void* pData, size_t numBytes);
+        static void unlock(void* pData, size_t numBytes);
+
+        static size_t getPageSize();
+};
+
+
+#endif
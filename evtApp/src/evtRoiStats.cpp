@@ -0,0 +1,290 @@
+/**
+ * Source file for the ADEmergentVision multi-ROI statistics engine
+ *
+ * The ROI list is converted into row bands whenever the ROIs or image geometry change. The frame is then
+ * walked top to bottom once, and for each row the row segments of all ROIs active in the current band are
+ * reduced with SSE2 (sum, max and x weighted sum). Y moments are accumulated from the per row sums.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <algorithm>
+#include <string.h>
+
+#include "evtSimd.h"
+#include "evtRoiStats.h"
+
+using namespace std;
+
+
+#ifdef EVT_SIMD_SSE2
+/**
+ * Accumulates sum(w * i) for four 32 bit weights and indices into two 64 bit lanes
+ */
+static inline __m128i evtMulAccumulate(__m128i acc, __m128i w, __m128i idx){
+    __m128i even = _mm_mul_epu32(w, idx);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(w, 32), _mm_srli_epi64(idx, 32));
+    return _mm_add_epi64(acc, _mm_add_epi64(even, odd));
+}
+
+
+static inline uint64_t evtSumLanes64(__m128i v){
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*) lanes, v);
+    return lanes[0] + lanes[1];
+}
+#endif
+
+
+/**
+ * Reduces a single 8 bit row segment
+ *
+ * @params[in]:  p      -> pointer to first pixel of the segment
+ * @params[in]:  n      -> number of pixels in the segment
+ * @params[out]: sum    -> sum of pixel values
+ * @params[out]: sumI   -> sum of pixel value times index within the segment
+ * @params[out]: max    -> maximum pixel value
+ */
+static void evtSegmentStats(const uint8_t* p, size_t n, uint64_t* sum, uint64_t* sumI, uint32_t* max){
+    uint64_t s = 0, si = 0;
+    uint32_t m = 0;
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    if(n >= 16){
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i four = _mm_set1_epi32(4);
+        __m128i sumAcc = zero, sumIAcc = zero, maxAcc = zero;
+        __m128i idx = _mm_setr_epi32(0, 1, 2, 3);
+        for(; i + 16 <= n; i += 16){
+            __m128i v = _mm_loadu_si128((const __m128i*) (p + i));
+            sumAcc = _mm_add_epi64(sumAcc, _mm_sad_epu8(v, zero));
+            maxAcc = _mm_max_epu8(maxAcc, v);
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            sumIAcc = evtMulAccumulate(sumIAcc, _mm_unpacklo_epi16(lo, zero), idx);
+            idx = _mm_add_epi32(idx, four);
+            sumIAcc = evtMulAccumulate(sumIAcc, _mm_unpackhi_epi16(lo, zero), idx);
+            idx = _mm_add_epi32(idx, four);
+            sumIAcc = evtMulAccumulate(sumIAcc, _mm_unpacklo_epi16(hi, zero), idx);
+            idx = _mm_add_epi32(idx, four);
+            sumIAcc = evtMulAccumulate(sumIAcc, _mm_unpackhi_epi16(hi, zero), idx);
+            idx = _mm_add_epi32(idx, four);
+        }
+        s = evtSumLanes64(sumAcc);
+        si = evtSumLanes64(sumIAcc);
+        uint8_t maxLanes[16];
+        _mm_storeu_si128((__m128i*) maxLanes, maxAcc);
+        for(int k = 0; k < 16; k++) if(maxLanes[k] > m) m = maxLanes[k];
+    }
+#endif
+    for(; i < n; i++){
+        s += p[i];
+        si += (uint64_t) p[i] * i;
+        if(p[i] > m) m = p[i];
+    }
+    *sum = s;
+    *sumI = si;
+    *max = m;
+}
+
+
+/**
+ * Reduces a single 16 bit row segment
+ *
+ * @params[in]:  p      -> pointer to first pixel of the segment
+ * @params[in]:  n      -> number of pixels in the segment
+ * @params[out]: sum    -> sum of pixel values
+ * @params[out]: sumI   -> sum of pixel value times index within the segment
+ * @params[out]: max    -> maximum pixel value
+ */
+static void evtSegmentStats(const uint16_t* p, size_t n, uint64_t* sum, uint64_t* sumI, uint32_t* max){
+    uint64_t s = 0, si = 0;
+    uint32_t m = 0;
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    if(n >= 8){
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i four = _mm_set1_epi32(4);
+        // SSE2 only has a signed 16 bit max, so values are biased by 0x8000
+        const __m128i bias = _mm_set1_epi16((short) 0x8000);
+        __m128i sumAcc = zero, sumIAcc = zero, maxAcc = bias;
+        __m128i idx = _mm_setr_epi32(0, 1, 2, 3);
+        for(; i + 8 <= n; i += 8){
+            __m128i v = _mm_loadu_si128((const __m128i*) (p + i));
+            maxAcc = _mm_max_epi16(maxAcc, _mm_xor_si128(v, bias));
+            __m128i lo = _mm_unpacklo_epi16(v, zero);
+            __m128i hi = _mm_unpackhi_epi16(v, zero);
+            __m128i pairSum = _mm_add_epi32(lo, hi);
+            sumAcc = _mm_add_epi64(sumAcc, _mm_add_epi64(_mm_unpacklo_epi32(pairSum, zero), _mm_unpackhi_epi32(pairSum, zero)));
+            sumIAcc = evtMulAccumulate(sumIAcc, lo, idx);
+            idx = _mm_add_epi32(idx, four);
+            sumIAcc = evtMulAccumulate(sumIAcc, hi, idx);
+            idx = _mm_add_epi32(idx, four);
+        }
+        s = evtSumLanes64(sumAcc);
+        si = evtSumLanes64(sumIAcc);
+        uint16_t maxLanes[8];
+        _mm_storeu_si128((__m128i*) maxLanes, _mm_xor_si128(maxAcc, bias));
+        for(int k = 0; k < 8; k++) if(maxLanes[k] > m) m = maxLanes[k];
+    }
+#endif
+    for(; i < n; i++){
+        s += p[i];
+        si += (uint64_t) p[i] * i;
+        if(p[i] > m) m = p[i];
+    }
+    *sum = s;
+    *sumI = si;
+    *max = m;
+}
+
+
+EVTRoiStatsEngine::EVTRoiStatsEngine()
+    : bandSizeX(0), bandSizeY(0), bandsValid(false) {}
+
+
+/**
+ * Replaces the list of ROIs evaluated by the engine
+ *
+ * @params[in]: rois    -> new ROI list, only the first EVT_MAX_ROIS are used
+ * @return: void
+ */
+void EVTRoiStatsEngine::setRois(const vector<EVTRoi>& rois){
+    size_t numRois = rois.size() > EVT_MAX_ROIS ? EVT_MAX_ROIS : rois.size();
+    this->rois.assign(rois.begin(), rois.begin() + numRois);
+    this->bandsValid = false;
+}
+
+
+size_t EVTRoiStatsEngine::getNumRois() const {
+    return this->rois.size();
+}
+
+
+/**
+ * Clips the ROIs to the image, and splits the image into row bands at every ROI top and bottom edge.
+ * Each band stores the indexes of the ROIs that cover it.
+ *
+ * @params[in]: sizeX   -> image width
+ * @params[in]: sizeY   -> image height
+ * @return: void
+ */
+void EVTRoiStatsEngine::buildBands(size_t sizeX, size_t sizeY){
+    this->clippedRois.resize(this->rois.size());
+    vector<size_t> edges;
+    for(size_t i = 0; i < this->rois.size(); i++){
+        EVTRoi roi = this->rois[i];
+        if(roi.x > sizeX) roi.x = sizeX;
+        if(roi.y > sizeY) roi.y = sizeY;
+        if(roi.x + roi.sizeX > sizeX) roi.sizeX = sizeX - roi.x;
+        if(roi.y + roi.sizeY > sizeY) roi.sizeY = sizeY - roi.y;
+        this->clippedRois[i] = roi;
+        if(roi.sizeX == 0 || roi.sizeY == 0) continue;
+        edges.push_back(roi.y);
+        edges.push_back(roi.y + roi.sizeY);
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    this->bands.clear();
+    for(size_t e = 0; e + 1 < edges.size(); e++){
+        EVTRoiBand band;
+        band.yStart = edges[e];
+        band.yEnd = edges[e + 1];
+        for(size_t i = 0; i < this->clippedRois.size(); i++){
+            const EVTRoi& roi = this->clippedRois[i];
+            if(roi.sizeX == 0 || roi.sizeY == 0) continue;
+            if(roi.y <= band.yStart && roi.y + roi.sizeY >= band.yEnd) band.active.push_back((int) i);
+        }
+        if(!band.active.empty()) this->bands.push_back(band);
+    }
+
+    this->bandSizeX = sizeX;
+    this->bandSizeY = sizeY;
+    this->bandsValid = true;
+}
+
+
+/**
+ * Walks all row bands once, accumulating the statistics for every active ROI
+ */
+template <typename T>
+void EVTRoiStatsEngine::computeBands(const T* pData, size_t sizeX, size_t sizeY, vector<EVTRoiStats>& stats){
+    if(!this->bandsValid || this->bandSizeX != sizeX || this->bandSizeY != sizeY) buildBands(sizeX, sizeY);
+
+    EVTRoiAccumulator empty;
+    memset(&empty, 0, sizeof(empty));
+    this->accumulators.assign(this->rois.size(), empty);
+
+    for(size_t b = 0; b < this->bands.size(); b++){
+        const EVTRoiBand& band = this->bands[b];
+        for(size_t y = band.yStart; y < band.yEnd; y++){
+            const T* row = pData + y * sizeX;
+            for(size_t a = 0; a < band.active.size(); a++){
+                int index = band.active[a];
+                const EVTRoi& roi = this->clippedRois[index];
+                EVTRoiAccumulator& acc = this->accumulators[index];
+                uint64_t sum, sumI;
+                uint32_t max;
+                evtSegmentStats(row + roi.x, roi.sizeX, &sum, &sumI, &max);
+                acc.sum += sum;
+                acc.sumX += sumI + sum * roi.x;
+                acc.sumY += (double) sum * y;
+                if(max > acc.max) acc.max = max;
+                acc.numPixels += roi.sizeX;
+            }
+        }
+    }
+    finish(stats);
+}
+
+
+/**
+ * Converts the accumulators into the output statistics
+ */
+void EVTRoiStatsEngine::finish(vector<EVTRoiStats>& stats){
+    stats.resize(this->accumulators.size());
+    for(size_t i = 0; i < this->accumulators.size(); i++){
+        const EVTRoiAccumulator& acc = this->accumulators[i];
+        EVTRoiStats& out = stats[i];
+        memset(&out, 0, sizeof(out));
+        out.sum = (double) acc.sum;
+        out.max = (double) acc.max;
+        if(acc.numPixels > 0) out.mean = out.sum / acc.numPixels;
+        if(acc.sum > 0){
+            out.centroidX = (double) acc.sumX / out.sum;
+            out.centroidY = acc.sumY / out.sum;
+        }
+    }
+}
+
+
+/**
+ * Computes statistics for all ROIs on an 8 bit mono image
+ *
+ * @params[in]:  pData  -> pointer to image data, rows are contiguous
+ * @params[in]:  sizeX  -> image width
+ * @params[in]:  sizeY  -> image height
+ * @params[out]: stats  -> statistics, one entry per ROI
+ * @return: void
+ */
+void EVTRoiStatsEngine::compute(const uint8_t* pData, size_t sizeX, size_t sizeY, vector<EVTRoiStats>& stats){
+    computeBands(pData, sizeX, sizeY, stats);
+}
+
+
+/**
+ * Computes statistics for all ROIs on a 16 bit mono image
+ *
+ * @params[in]:  pData  -> pointer to image data, rows are contiguous
+ * @params[in]:  sizeX  -> image width
+ * @params[in]:  sizeY  -> image height
+ * @params[out]: stats  -> statistics, one entry per ROI
+ * @return: void
+ */
+void EVTRoiStatsEngine::compute(const uint16_t* pData, size_t sizeX, size_t sizeY, vector<EVTRoiStats>& stats){
+    computeBands(pData, sizeX, sizeY, stats);
+}
@@ -0,0 +1,94 @@
+/**
+ * Header file for the ADEmergentVision multi-ROI statistics engine
+ * 
+ * Computes sum, mean, max and centroid for up to EVT_MAX_ROIS rectangular regions in a single pass
+ * over the frame. The image is split into row bands, inside of which the set of overlapping ROIs is
+ * constant, so each row is read from memory once and all ROIs covering it are evaluated while it is in cache.
+ * 
+ * Created On: October-18-2026
+ * 
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ * 
+ */
+
+// header guard
+#ifndef EVTROISTATS_H
+#define EVTROISTATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Maximum number of ROIs evaluated by the engine
+#define EVT_MAX_ROIS 64
+
+
+// Rectangular region of interest, in pixels
+typedef struct EVTRoi {
+    size_t x;
+    size_t y;
+    size_t sizeX;
+    size_t sizeY;
+} EVTRoi;
+
+
+// Statistics computed for a single ROI
+typedef struct EVTRoiStats {
+    double sum;
+    double mean;
+    double max;
+    double centroidX;
+    double centroidY;
+} EVTRoiStats;
+
+
+class EVTRoiStatsEngine {
+
+    public:
+
+        EVTRoiStatsEngine();
+
+        // ROIs past EVT_MAX_ROIS are ignored
+        void setRois(const std::vector<EVTRoi>& rois);
+        size_t getNumRois() const;
+
+        // stats is resized to the number of ROIs. ROIs are clipped to the image
+        void compute(const uint8_t* pData, size_t sizeX, size_t sizeY, std::vector<EVTRoiStats>& stats);
+        void compute(const uint16_t* pData, size_t sizeX, size_t sizeY, std::vector<EVTRoiStats>& stats);
+
+    private:
+
+        // Row band in which the same set of ROIs is active
+        typedef struct EVTRoiBand {
+            size_t yStart;
+            size_t yEnd;
+            std::vector<int> active;
+        } EVTRoiBand;
+
+        // Per ROI accumulators
+        typedef struct EVTRoiAccumulator {
+            uint64_t sum;
+            uint64_t sumX;
+            double sumY;
+            uint32_t max;
+            size_t numPixels;
+        } EVTRoiAccumulator;
+
+        std::vector<EVTRoi> rois;
+        std::vector<EVTRoi> clippedRois;
+        std::vector<EVTRoiBand> bands;
+        std::vector<EVTRoiAccumulator> accumulators;
+
+        // image geometry the bands were built for
+        size_t bandSizeX;
+        size_t bandSizeY;
+        bool bandsValid;
+
+        void buildBands(size_t sizeX, size_t sizeY);
+        void finish(std::vector<EVTRoiStats>& stats);
+
+        template <typename T> void computeBands(const T* pData, size_t sizeX, size_t sizeY, std::vector<EVTRoiStats>& stats);
+};
+
+
+#endif
@@ -0,0 +1,375 @@
+/**
+ * Source file for the ADEmergentVision shared memory frame ring
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#include "evtPrefault.h"
+#include "evtSharedRing.h"
+
+using namespace std;
+
+
+static uint64_t evtGetProcessId(){
+#ifdef _WIN32
+    return (uint64_t) GetCurrentProcessId();
+#else
+    return (uint64_t) getpid();
+#endif
+}
+
+
+// false only once the process is known to have exited, so entries are never freed by mistake
+static bool evtIsProcessAlive(uint64_t pid){
+#ifdef _WIN32
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD) pid);
+    if(process == NULL) return GetLastError() != ERROR_INVALID_PARAMETER;
+    bool alive = WaitForSingleObject(process, 0) != WAIT_OBJECT_0;
+    CloseHandle(process);
+    return alive;
+#else
+    return !(kill((pid_t) pid, 0) != 0 && errno == ESRCH);
+#endif
+}
+
+
+static size_t evtRoundUp(size_t value, size_t multiple){
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+
+// -----------------------------------------------------------------------
+// EVTSharedRing
+// -----------------------------------------------------------------------
+
+
+EVTSharedRing::EVTSharedRing()
+    : pHeader(NULL), maxFrameBytes(0), sequence(0), numOverwritten(0) {}
+
+
+EVTSharedRing::~EVTSharedRing(){
+    close();
+}
+
+
+/**
+ * Creates the ring. A ring left with the same name, by this or a previous IOC, is marked closed first
+ * so that its readers move to the new ring. All pages are touched, so the first frames do not fault.
+ *
+ * @params[in]:  name           -> name of the shared memory object
+ * @params[in]:  numSlots       -> number of frames kept
+ * @params[in]:  maxFrameBytes  -> largest frame a slot holds
+ * @params[out]: error          -> reason for failure
+ * @return: true if the ring was created
+ */
+bool EVTSharedRing::open(const char* name, int numSlots, size_t maxFrameBytes, string& error){
+    close();
+    if(numSlots < EVT_SHM_MIN_SLOTS || numSlots > EVT_SHM_MAX_SLOTS || maxFrameBytes == 0){
+        error = "Invalid number of slots or frame size";
+        return false;
+    }
+    EVTMappedFile previous;
+    string ignored;
+    if(previous.openShared(name, ignored) && previous.getSize() >= sizeof(EVTShmHeader)){
+        EVTShmHeader* pPrevious = (EVTShmHeader*) previous.getData();
+        if(pPrevious->magic == EVT_SHM_MAGIC) pPrevious->state.store(0, memory_order_release);
+    }
+    previous.close();
+
+    size_t pageSize = EVTPrefault::getPageSize();
+    size_t dataOffset = evtRoundUp(sizeof(EVTShmHeader), pageSize);
+    size_t slotDataOffset = evtRoundUp(sizeof(EVTShmSlotHeader), pageSize);
+    size_t slotSize = slotDataOffset + evtRoundUp(maxFrameBytes, pageSize);
+    if(!this->mapping.createShared(name, dataOffset + numSlots * slotSize, error)) return false;
+    EVTPrefault::touch(this->mapping.getData(), this->mapping.getSize());
+
+    // a new object is zero filled, so the sequences and consumer entries start cleared
+    this->pHeader = (EVTShmHeader*) this->mapping.getData();
+    this->pHeader->magic = EVT_SHM_MAGIC;
+    this->pHeader->version = EVT_SHM_VERSION;
+    this->pHeader->headerSize = (uint16_t) sizeof(EVTShmHeader);
+    this->pHeader->numSlots = (uint32_t) numSlots;
+    this->pHeader->slotSize = slotSize;
+    this->pHeader->dataOffset = dataOffset;
+    this->pHeader->slotDataOffset = slotDataOffset;
+    this->pHeader->producerPid = evtGetProcessId();
+    this->pHeader->state.store(1, memory_order_release);
+    this->maxFrameBytes = slotSize - slotDataOffset;
+    this->sequence = 0;
+    this->numOverwritten = 0;
+    return true;
+}
+
+
+void EVTSharedRing::close(){
+    if(this->pHeader != NULL) this->pHeader->state.store(0, memory_order_release);
+    this->mapping.close();
+    this->pHeader = NULL;
+    this->maxFrameBytes = 0;
+}
+
+
+bool EVTSharedRing::isOpen() const {
+    return this->pHeader != NULL;
+}
+
+
+size_t EVTSharedRing::getMaxFrameBytes() const {
+    return this->maxFrameBytes;
+}
+
+
+EVTShmSlotHeader* EVTSharedRing::getSlot(uint64_t sequence) const {
+    size_t slot = (size_t) ((sequence - 1) % this->pHeader->numSlots);
+    return (EVTShmSlotHeader*) ((char*) this->pHeader + this->pHeader->dataOffset + slot * this->pHeader->slotSize);
+}
+
+
+/**
+ * Copies a frame into the next slot. Before the slot is reused, every reader that has not finished the
+ * frame it holds has that frame counted as overwritten. The entries of readers that exited are freed.
+ *
+ * @params[in]: uniqueId        -> unique ID of the frame
+ * @params[in]: dataType        -> NDDataType_t of the frame
+ * @params[in]: colorMode       -> NDColorMode_t of the frame
+ * @params[in]: ndims           -> number of dimensions, at most EVT_SHM_MAX_DIMS
+ * @params[in]: dims            -> size of each dimension
+ * @params[in]: pData           -> frame data
+ * @params[in]: dataSize        -> size of the frame data in bytes
+ * @params[in]: cameraTimeStamp -> raw camera timestamp in nanoseconds
+ * @params[in]: timeStamp       -> epics timestamp of the frame
+ * @params[in]: frameCopy       -> copy used for the frame data, so large frames bypass the cache
+ * @return: true if the frame was written
+ */
+bool EVTSharedRing::write(int uniqueId, int dataType, int colorMode, int ndims, const size_t* dims,
+                          const void* pData, size_t dataSize, uint64_t cameraTimeStamp, const epicsTimeStamp& timeStamp,
+                          const EVTFrameCopy& frameCopy){
+    if(this->pHeader == NULL || dataSize > this->maxFrameBytes || ndims < 0 || ndims > EVT_SHM_MAX_DIMS) return false;
+    uint64_t sequence = ++this->sequence;
+
+    if(sequence > this->pHeader->numSlots){
+        uint64_t overwritten = sequence - this->pHeader->numSlots;
+        for(int i = 0; i < EVT_SHM_MAX_CONSUMERS; i++){
+            EVTShmConsumer& consumer = this->pHeader->consumers[i];
+            uint64_t pid = consumer.pid.load(memory_order_acquire);
+            if(pid == 0 || consumer.readSequence.load(memory_order_acquire) >= overwritten) continue;
+            if(!evtIsProcessAlive(pid)){
+                consumer.pid.compare_exchange_strong(pid, 0);
+                continue;
+            }
+            consumer.numOverwritten.fetch_add(1, memory_order_relaxed);
+            this->numOverwritten++;
+        }
+    }
+
+    EVTShmSlotHeader* pSlot = getSlot(sequence);
+    pSlot->sequence.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    pSlot->uniqueId = uniqueId;
+    pSlot->dataType = (uint32_t) dataType;
+    pSlot->colorMode = (uint32_t) colorMode;
+    pSlot->ndims = (uint32_t) ndims;
+    for(int i = 0; i < EVT_SHM_MAX_DIMS; i++) pSlot->dims[i] = (i < ndims) ? dims[i] : 0;
+    pSlot->dataSize = dataSize;
+    pSlot->cameraTimeStamp = cameraTimeStamp;
+    pSlot->secPastEpoch = timeStamp.secPastEpoch;
+    pSlot->nsec = timeStamp.nsec;
+    frameCopy.copy((char*) pSlot + this->pHeader->slotDataOffset, pData, dataSize);
+    pSlot->sequence.store(sequence, memory_order_release);
+    this->pHeader->writeSequence.store(sequence, memory_order_release);
+    return true;
+}
+
+
+void EVTSharedRing::getStats(EVTShmStats* pStats) const {
+    pStats->sequence = this->sequence;
+    pStats->numConsumers = 0;
+    pStats->maxLag = 0;
+    pStats->numOverwritten = this->numOverwritten;
+    if(this->pHeader == NULL) return;
+    for(int i = 0; i < EVT_SHM_MAX_CONSUMERS; i++){
+        const EVTShmConsumer& consumer = this->pHeader->consumers[i];
+        if(consumer.pid.load(memory_order_acquire) == 0) continue;
+        pStats->numConsumers++;
+        uint64_t readSequence = consumer.readSequence.load(memory_order_acquire);
+        if(this->sequence > readSequence && this->sequence - readSequence > pStats->maxLag)
+            pStats->maxLag = this->sequence - readSequence;
+    }
+}
+
+
+// -----------------------------------------------------------------------
+// EVTSharedRingReader
+// -----------------------------------------------------------------------
+
+
+EVTSharedRingReader::EVTSharedRingReader()
+    : pHeader(NULL), pConsumer(NULL), lastSequence(0), numSkipped(0) {}
+
+
+EVTSharedRingReader::~EVTSharedRingReader(){
+    close();
+}
+
+
+/**
+ * Maps a ring and claims a consumer entry
+ *
+ * @params[in]:  name   -> name of the shared memory object
+ * @params[out]: error  -> reason for failure
+ * @return: true if the ring was mapped and an entry was free
+ */
+bool EVTSharedRingReader::open(const char* name, string& error){
+    close();
+    if(!this->mapping.openShared(name, error)) return false;
+    EVTShmHeader* pHeader = (EVTShmHeader*) this->mapping.getData();
+    if(this->mapping.getSize() < sizeof(EVTShmHeader) || pHeader->magic != EVT_SHM_MAGIC ||
+       pHeader->version != EVT_SHM_VERSION || pHeader->state.load(memory_order_acquire) == 0){
+        error = string("No open frame ring ") + name;
+        this->mapping.close();
+        return false;
+    }
+    uint64_t pid = evtGetProcessId();
+    for(int i = 0; i < EVT_SHM_MAX_CONSUMERS && this->pConsumer == NULL; i++){
+        uint64_t expected = 0;
+        if(pHeader->consumers[i].pid.compare_exchange_strong(expected, pid)) this->pConsumer = &pHeader->consumers[i];
+    }
+    if(this->pConsumer == NULL){
+        error = string("No free consumer entry in ") + name;
+        this->mapping.close();
+        return false;
+    }
+    this->pHeader = pHeader;
+    this->lastSequence = pHeader->writeSequence.load(memory_order_acquire);
+    this->pConsumer->readSequence.store(this->lastSequence, memory_order_release);
+    this->pConsumer->numOverwritten.store(0, memory_order_relaxed);
+    this->numSkipped = 0;
+    return true;
+}
+
+
+void EVTSharedRingReader::close(){
+    if(this->pConsumer != NULL) this->pConsumer->pid.store(0, memory_order_release);
+    this->mapping.close();
+    this->pHeader = NULL;
+    this->pConsumer = NULL;
+}
+
+
+/**
+ * Waits for the frame after the last one returned. If the writer has already reused its slot, the
+ * reader moves to the newest frame.
+ *
+ * @params[out]: pView      -> the frame, valid until done is called
+ * @params[in]:  timeout    -> seconds to wait for a frame
+ * @return: false on timeout, or if the ring was closed
+ */
+bool EVTSharedRingReader::next(EVTShmFrameView* pView, double timeout){
+    if(this->pHeader == NULL) return false;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while(this->pHeader->state.load(memory_order_acquire) != 0){
+        uint64_t writeSequence = this->pHeader->writeSequence.load(memory_order_acquire);
+        if(writeSequence > this->lastSequence){
+            uint64_t wanted = this->lastSequence + 1;
+            // a reader that fell a ring behind resumes at the newest frame, which stays in the ring the longest
+            if(writeSequence - wanted >= this->pHeader->numSlots){
+                this->numSkipped += writeSequence - wanted;
+                wanted = writeSequence;
+            }
+            size_t slot = (size_t) ((wanted - 1) % this->pHeader->numSlots);
+            const EVTShmSlotHeader* pSlot = (const EVTShmSlotHeader*) ((const char*) this->pHeader +
+                                            this->pHeader->dataOffset + slot * this->pHeader->slotSize);
+            this->lastSequence = wanted;
+            if(pSlot->sequence.load(memory_order_acquire) != wanted){
+                // reused since writeSequence was read
+                this->numSkipped++;
+                this->pConsumer->readSequence.store(wanted, memory_order_release);
+                continue;
+            }
+            pView->sequence = wanted;
+            pView->pSlot = pSlot;
+            pView->pData = (const char*) pSlot + this->pHeader->slotDataOffset;
+            return true;
+        }
+        if(chrono::duration<double>(chrono::steady_clock::now() - start).count() > timeout) return false;
+        this_thread::sleep_for(chrono::microseconds(50));
+    }
+    return false;
+}
+
+
+bool EVTSharedRingReader::done(const EVTShmFrameView& view){
+    if(this->pConsumer == NULL) return false;
+    atomic_thread_fence(memory_order_acquire);
+    bool intact = view.pSlot->sequence.load(memory_order_relaxed) == view.sequence;
+    if(!intact) this->numSkipped++;
+    this->pConsumer->readSequence.store(view.sequence, memory_order_release);
+    return intact;
+}
+
+
+bool EVTSharedRingReader::isClosed() const {
+    return this->pHeader == NULL || this->pHeader->state.load(memory_order_acquire) == 0;
+}
+
+
+uint64_t EVTSharedRingReader::getNumSkipped() const {
+    return this->numSkipped;
+}
+
+
+/**
+ * Reads frames from a ring and prints their headers along with the age of each frame, computed from
+ * the frame timestamp. Intended for verifying the ring from the IOC shell.
+ *
+ * @params[in]: name        -> name of the shared memory object
+ * @params[in]: numFrames   -> number of frames to read before returning
+ * @params[in]: timeout     -> seconds to wait for each frame
+ * @return: number of frames read intact
+ */
+int evtSharedRingRead(const char* name, int numFrames, double timeout){
+    EVTSharedRingReader reader;
+    string error;
+    if(name == NULL || !reader.open(name, error)){
+        printf("Could not open frame ring: %s\n", error.c_str());
+        return 0;
+    }
+    int received = 0;
+    for(int i = 0; i < numFrames; i++){
+        EVTShmFrameView view;
+        if(!reader.next(&view, timeout)){
+            printf(reader.isClosed() ? "Frame ring closed\n" : "No frame received\n");
+            break;
+        }
+        epicsTimeStamp now, frameTime;
+        epicsTimeGetCurrent(&now);
+        frameTime.secPastEpoch = view.pSlot->secPastEpoch;
+        frameTime.nsec = view.pSlot->nsec;
+        printf("seq %llu, id %d, dims", (unsigned long long) view.sequence, view.pSlot->uniqueId);
+        for(uint32_t d = 0; d < view.pSlot->ndims && d < EVT_SHM_MAX_DIMS; d++)
+            printf(" %llu", (unsigned long long) view.pSlot->dims[d]);
+        printf(", %llu bytes, age %.1f us", (unsigned long long) view.pSlot->dataSize,
+               epicsTimeDiffInSeconds(&now, &frameTime) * 1e6);
+        if(reader.done(view)) received++;
+        else printf(", overwritten");
+        printf("\n");
+    }
+    printf("%d frames read, %llu skipped\n", received, (unsigned long long) reader.getNumSkipped());
+    return received;
+}
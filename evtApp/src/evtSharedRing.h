@@ -0,0 +1,201 @@
+/**
+ * Header file for the ADEmergentVision shared memory frame ring
+ *
+ * Publishes frames into a ring of slots in a named shared memory object, so that analysis processes on
+ * the same host can read them in place instead of receiving them over CA or PVA. The driver is the only
+ * writer. Readers never block the writer: a reader that falls more than a ring behind loses frames, which
+ * is counted for each reader and in total.
+ *
+ * Memory layout (native byte order, offsets from the start of the object):
+ *      EVTShmHeader                    (0, 1088 bytes)
+ *      slot[i], i = 0 .. numSlots - 1  (dataOffset + i * slotSize)
+ *          EVTShmSlotHeader            (128 bytes)
+ *          frame data                  (slotDataOffset, page aligned, up to slotSize - slotDataOffset bytes)
+ *
+ * Protocol:
+ *      - frame sequence numbers start at 1, frame n is written to slot (n - 1) % numSlots
+ *      - the writer sets the slot sequence to 0, writes the slot, then sets the slot sequence to n,
+ *        and then sets writeSequence to n
+ *      - a reader waits for writeSequence to pass the last frame it read, checks that the slot sequence
+ *        equals the frame it wants, uses the frame in place, and checks the slot sequence again. If it
+ *        changed, the frame was overwritten while it was used and must be discarded
+ *      - a reader claims a consumer entry by swapping its pid in for 0, and stores the sequence of every
+ *        frame it finishes in readSequence. The writer counts in numOverwritten each frame that is
+ *        overwritten before the reader finished it, and frees the entries of readers that have exited
+ *      - state is set to 0 when the ring is closed or replaced, readers then map the new ring by name
+ *      - readers map the ring read/write to claim a consumer entry, so on POSIX they must run as the IOC
+ *        user or in its group (the object is created with mode EVT_SHARED_MODE)
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTSHAREDRING_H
+#define EVTSHAREDRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#include <epicsTime.h>
+
+#include "evtFrameCopy.h"
+#include "evtMappedFile.h"
+
+// "EVTS" when read as little endian bytes
+#define EVT_SHM_MAGIC           0x53545645
+#define EVT_SHM_VERSION         1
+#define EVT_SHM_MAX_CONSUMERS   16
+#define EVT_SHM_MAX_DIMS        4
+#define EVT_SHM_MIN_SLOTS       2
+#define EVT_SHM_MAX_SLOTS       256
+
+// the ring is shared with other processes, so its atomics must not rely on a lock in this process
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory ring requires lock free 64 bit atomics");
+
+
+typedef struct EVTShmConsumer {
+    // process id of the reader, 0 for a free entry
+    std::atomic<uint64_t> pid;
+    // sequence of the last frame the reader finished
+    std::atomic<uint64_t> readSequence;
+    // frames overwritten before the reader finished them, written by the driver
+    std::atomic<uint64_t> numOverwritten;
+    uint64_t reserved[5];
+} EVTShmConsumer;
+
+
+typedef struct EVTShmHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    // 1 while the ring is written, 0 once it is closed or replaced
+    std::atomic<uint32_t> state;
+    uint32_t numSlots;
+    uint64_t slotSize;
+    uint64_t dataOffset;
+    uint64_t producerPid;
+    // sequence of the last frame written, 0 before the first frame
+    std::atomic<uint64_t> writeSequence;
+    uint64_t slotDataOffset;
+    uint64_t reserved[1];
+    EVTShmConsumer consumers[EVT_SHM_MAX_CONSUMERS];
+} EVTShmHeader;
+
+
+typedef struct EVTShmSlotHeader {
+    // sequence of the frame in the slot, 0 while it is written
+    std::atomic<uint64_t> sequence;
+    int32_t uniqueId;
+    // NDDataType_t and NDColorMode_t of the frame
+    uint32_t dataType;
+    uint32_t colorMode;
+    uint32_t ndims;
+    uint64_t dims[EVT_SHM_MAX_DIMS];
+    uint64_t dataSize;
+    // raw camera timestamp in nanoseconds
+    uint64_t cameraTimeStamp;
+    // epics timestamp of the frame
+    uint32_t secPastEpoch;
+    uint32_t nsec;
+    uint64_t reserved[6];
+} EVTShmSlotHeader;
+
+static_assert(sizeof(EVTShmHeader) == 1088 && sizeof(EVTShmSlotHeader) == 128, "shared memory ring layout changed");
+
+
+// Statistics of the ring as seen by the driver
+typedef struct EVTShmStats {
+    uint64_t sequence;
+    int numConsumers;
+    // frames the furthest behind reader has yet to finish
+    uint64_t maxLag;
+    uint64_t numOverwritten;
+} EVTShmStats;
+
+
+// Frame held in place by a reader
+typedef struct EVTShmFrameView {
+    uint64_t sequence;
+    const EVTShmSlotHeader* pSlot;
+    const void* pData;
+} EVTShmFrameView;
+
+
+class EVTSharedRing {
+
+    public:
+
+        EVTSharedRing();
+        ~EVTSharedRing();
+
+        // creates the ring, replacing any ring with the same name, slots hold frames up to maxFrameBytes
+        bool open(const char* name, int numSlots, size_t maxFrameBytes, std::string& error);
+        void close();
+        bool isOpen() const;
+        size_t getMaxFrameBytes() const;
+
+        // copies a frame into the next slot, returns false if the ring is closed or the frame does not fit
+        bool write(int uniqueId, int dataType, int colorMode, int ndims, const size_t* dims,
+                   const void* pData, size_t dataSize, uint64_t cameraTimeStamp, const epicsTimeStamp& timeStamp,
+                   const EVTFrameCopy& frameCopy);
+
+        void getStats(EVTShmStats* pStats) const;
+
+    private:
+
+        EVTMappedFile mapping;
+        EVTShmHeader* pHeader;
+        size_t maxFrameBytes;
+        uint64_t sequence;
+        uint64_t numOverwritten;
+
+        EVTShmSlotHeader* getSlot(uint64_t sequence) const;
+
+        EVTSharedRing(const EVTSharedRing&);
+        EVTSharedRing& operator=(const EVTSharedRing&);
+};
+
+
+// Reader side of the protocol, used by C++ consumers and to test the ring
+class EVTSharedRingReader {
+
+    public:
+
+        EVTSharedRingReader();
+        ~EVTSharedRingReader();
+
+        // maps the ring and claims a consumer entry, reading starts with the next frame written
+        bool open(const char* name, std::string& error);
+        void close();
+
+        // waits for the next frame and returns it in place. Frames already overwritten are skipped and counted
+        bool next(EVTShmFrameView* pView, double timeout);
+        // marks a frame finished, returns false if it was overwritten while it was used
+        bool done(const EVTShmFrameView& view);
+
+        bool isClosed() const;
+        uint64_t getNumSkipped() const;
+
+    private:
+
+        EVTMappedFile mapping;
+        EVTShmHeader* pHeader;
+        EVTShmConsumer* pConsumer;
+        uint64_t lastSequence;
+        uint64_t numSkipped;
+
+        EVTSharedRingReader(const EVTSharedRingReader&);
+        EVTSharedRingReader& operator=(const EVTSharedRingReader&);
+};
+
+
+// Reads and prints frames from a ring, used to test the ring on the IOC host
+int evtSharedRingRead(const char* name, int numFrames, double timeout);
+
+
+#endif
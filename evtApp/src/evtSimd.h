@@ -0,0 +1,73 @@
+/**
+ * Header file with the SIMD definitions shared by the ADEmergentVision processing kernels
+ * 
+ * All kernels are written against SSE2, which is part of the x86_64 baseline on both gcc and MSVC,
+ * so no additional compiler flags are needed. Every kernel also has a scalar path which is used
+ * for the remainder of a row, and on architectures where SSE2 is not available.
+ * 
+ * Created On: October-18-2026
+ * 
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ * 
+ */
+
+// header guard
+#ifndef EVTSIMD_H
+#define EVTSIMD_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EVT_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <stdint.h>
+
+
+#ifdef EVT_SIMD_SSE2
+
+/**
+ * Splits 16 interleaved 8 bit RGB pixels into one register per channel. Each round interleaves the low
+ * and high halves of the registers, and after log2(16) rounds the channels are separated.
+ */
+static inline void evtLoadDeinterleave3(const uint8_t* p, __m128i* pR, __m128i* pG, __m128i* pB){
+    __m128i a = _mm_loadu_si128((const __m128i*) p);
+    __m128i b = _mm_loadu_si128((const __m128i*) (p + 16));
+    __m128i c = _mm_loadu_si128((const __m128i*) (p + 32));
+    for(int round = 0; round < 4; round++){
+        __m128i a1 = _mm_unpacklo_epi8(a, _mm_unpackhi_epi64(b, b));
+        __m128i b1 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(a, a), c);
+        __m128i c1 = _mm_unpacklo_epi8(b, _mm_unpackhi_epi64(c, c));
+        a = a1;
+        b = b1;
+        c = c1;
+    }
+    *pR = a;
+    *pG = b;
+    *pB = c;
+}
+
+
+/**
+ * Splits 8 interleaved 16 bit RGB pixels into one register per channel, in log2(8) rounds
+ */
+static inline void evtLoadDeinterleave3(const uint16_t* p, __m128i* pR, __m128i* pG, __m128i* pB){
+    __m128i a = _mm_loadu_si128((const __m128i*) p);
+    __m128i b = _mm_loadu_si128((const __m128i*) (p + 8));
+    __m128i c = _mm_loadu_si128((const __m128i*) (p + 16));
+    for(int round = 0; round < 3; round++){
+        __m128i a1 = _mm_unpacklo_epi16(a, _mm_unpackhi_epi64(b, b));
+        __m128i b1 = _mm_unpacklo_epi16(_mm_unpackhi_epi64(a, a), c);
+        __m128i c1 = _mm_unpacklo_epi16(b, _mm_unpackhi_epi64(c, c));
+        a = a1;
+        b = b1;
+        c = c1;
+    }
+    *pR = a;
+    *pG = b;
+    *pB = c;
+}
+
+#endif
+
+
+#endif
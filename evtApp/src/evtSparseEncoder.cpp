@@ -0,0 +1,176 @@
+/**
+ * Source file for the ADEmergentVision sparse frame encoder
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <string.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "evtSimd.h"
+#include "evtSparseEncoder.h"
+
+using namespace std;
+
+
+static inline int evtCountTrailingZeros(uint32_t mask){
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int) index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+
+EVTSparseEncoder::EVTSparseEncoder()
+    : size(0), numPixels(0), runLengthOffset(0), runLast(0), runLength(0), runOpen(false) {}
+
+
+/**
+ * Returns a pointer to numBytes bytes at the end of the stream, growing the buffer if needed
+ */
+inline uint8_t* EVTSparseEncoder::reserve(size_t numBytes){
+    if(this->size + numBytes > this->buffer.size()){
+        size_t capacity = this->buffer.size() * 2;
+        if(capacity < this->size + numBytes) capacity = this->size + numBytes + 4096;
+        this->buffer.resize(capacity);
+    }
+    uint8_t* p = &this->buffer[this->size];
+    this->size += numBytes;
+    return p;
+}
+
+
+inline void EVTSparseEncoder::closeRun(){
+    if(!this->runOpen) return;
+    memcpy(&this->buffer[this->runLengthOffset], &this->runLength, sizeof(uint16_t));
+    this->runOpen = false;
+}
+
+
+/**
+ * Appends a single pixel to the stream, extending the open run if the pixel follows it
+ */
+template <typename T>
+inline void EVTSparseEncoder::addPixel(size_t index, T value, EVTSparseFormat format){
+    this->numPixels++;
+    if(format == EVT_SPARSE_PAIRS){
+        uint32_t index32 = (uint32_t) index;
+        uint8_t* p = reserve(sizeof(uint32_t) + sizeof(T));
+        memcpy(p, &index32, sizeof(uint32_t));
+        memcpy(p + sizeof(uint32_t), &value, sizeof(T));
+        return;
+    }
+    if(!this->runOpen || index != this->runLast + 1 || this->runLength == 0xFFFF){
+        closeRun();
+        uint32_t index32 = (uint32_t) index;
+        uint8_t* p = reserve(sizeof(uint32_t) + sizeof(uint16_t));
+        memcpy(p, &index32, sizeof(uint32_t));
+        this->runLengthOffset = this->size - sizeof(uint16_t);
+        this->runLength = 0;
+        this->runOpen = true;
+    }
+    memcpy(reserve(sizeof(T)), &value, sizeof(T));
+    this->runLength++;
+    this->runLast = index;
+}
+
+
+/**
+ * Finds the pixels at or above the threshold with SSE2 compares, and a move mask per 16 bytes,
+ * so blocks without signal cost a load, a compare and a test.
+ */
+template <typename T>
+size_t EVTSparseEncoder::encodeFrame(const T* pData, size_t sizeX, size_t sizeY, unsigned int threshold, EVTSparseFormat format){
+    const unsigned int maxValue = (sizeof(T) == 1) ? 0xFF : 0xFFFF;
+    if(threshold < 1) threshold = 1;
+    this->size = 0;
+    this->numPixels = 0;
+    this->runOpen = false;
+    if(threshold > maxValue) return 0;
+
+#ifdef EVT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i thrv = (sizeof(T) == 1) ? _mm_set1_epi8((char) threshold) : _mm_set1_epi16((short) threshold);
+    // pixels per 16 byte block, and move mask bits per pixel
+    const size_t blockPixels = 16 / sizeof(T);
+    const int bitsPerPixel = (int) sizeof(T);
+#endif
+    for(size_t y = 0; y < sizeY; y++){
+        const T* row = pData + y * sizeX;
+        size_t rowStart = y * sizeX;
+        size_t x = 0;
+#ifdef EVT_SIMD_SSE2
+        for(; x + blockPixels <= sizeX; x += blockPixels){
+            __m128i v = _mm_loadu_si128((const __m128i*) (row + x));
+            // threshold - v saturates to zero where v >= threshold
+            __m128i below = (sizeof(T) == 1) ? _mm_subs_epu8(thrv, v) : _mm_subs_epu16(thrv, v);
+            __m128i keep = (sizeof(T) == 1) ? _mm_cmpeq_epi8(below, zero) : _mm_cmpeq_epi16(below, zero);
+            uint32_t mask = (uint32_t) _mm_movemask_epi8(keep);
+            while(mask != 0){
+                int bit = evtCountTrailingZeros(mask);
+                size_t px = x + bit / bitsPerPixel;
+                addPixel(rowStart + px, row[px], format);
+                mask &= ~(((1u << bitsPerPixel) - 1) << bit);
+            }
+        }
+#endif
+        for(; x < sizeX; x++){
+            if(row[x] >= threshold) addPixel(rowStart + x, row[x], format);
+        }
+        closeRun();
+    }
+    return this->size;
+}
+
+
+/**
+ * Encodes an 8 bit frame
+ *
+ * @params[in]: pData       -> pointer to image data, rows are contiguous
+ * @params[in]: sizeX       -> image width
+ * @params[in]: sizeY       -> image height
+ * @params[in]: threshold   -> smallest value of an encoded pixel
+ * @params[in]: format      -> pairs or runs
+ * @return: size of the encoded stream in bytes
+ */
+size_t EVTSparseEncoder::encode(const uint8_t* pData, size_t sizeX, size_t sizeY, unsigned int threshold, EVTSparseFormat format){
+    return encodeFrame(pData, sizeX, sizeY, threshold, format);
+}
+
+
+/**
+ * Encodes a 16 bit frame
+ *
+ * @params[in]: pData       -> pointer to image data, rows are contiguous
+ * @params[in]: sizeX       -> image width
+ * @params[in]: sizeY       -> image height
+ * @params[in]: threshold   -> smallest value of an encoded pixel
+ * @params[in]: format      -> pairs or runs
+ * @return: size of the encoded stream in bytes
+ */
+size_t EVTSparseEncoder::encode(const uint16_t* pData, size_t sizeX, size_t sizeY, unsigned int threshold, EVTSparseFormat format){
+    return encodeFrame(pData, sizeX, sizeY, threshold, format);
+}
+
+
+const uint8_t* EVTSparseEncoder::getData() const {
+    return this->size > 0 ? &this->buffer[0] : NULL;
+}
+
+
+size_t EVTSparseEncoder::getSize() const {
+    return this->size;
+}
+
+
+size_t EVTSparseEncoder::getNumPixels() const {
+    return this->numPixels;
+}
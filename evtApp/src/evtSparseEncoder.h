@@ -0,0 +1,71 @@
+/**
+ * Header file for the ADEmergentVision sparse frame encoder
+ *
+ * Thresholds a mono frame in an SSE2 pass, skipping 16 byte blocks with no signal, and encodes the
+ * pixels at or above the threshold into a compact little endian byte stream, either as
+ * (index, value) pairs, or as runs of consecutive pixels within a row.
+ *
+ * Stream layouts, where value is 1 byte for 8 bit frames and 2 bytes for 16 bit frames:
+ *      EVT_SPARSE_PAIRS:   { uint32 index, value }                         per pixel
+ *      EVT_SPARSE_RUNS:    { uint32 start index, uint16 length, value[length] }   per run
+ * Indexes are y * sizeX + x, and runs never cross the end of a row.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTSPARSEENCODER_H
+#define EVTSPARSEENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Codec names written to the Codec attribute of sparse NDArrays
+#define EVT_SPARSE_PAIRS_CODEC  "EVTSparsePairs"
+#define EVT_SPARSE_RUNS_CODEC   "EVTSparseRuns"
+
+
+typedef enum {
+    EVT_SPARSE_PAIRS    = 0,
+    EVT_SPARSE_RUNS     = 1
+} EVTSparseFormat;
+
+
+class EVTSparseEncoder {
+
+    public:
+
+        EVTSparseEncoder();
+
+        // encodes all pixels >= threshold (at least 1), returns the size of the stream in bytes
+        size_t encode(const uint8_t* pData, size_t sizeX, size_t sizeY, unsigned int threshold, EVTSparseFormat format);
+        size_t encode(const uint16_t* pData, size_t sizeX, size_t sizeY, unsigned int threshold, EVTSparseFormat format);
+
+        const uint8_t* getData() const;
+        size_t getSize() const;
+        size_t getNumPixels() const;
+
+    private:
+
+        std::vector<uint8_t> buffer;
+        size_t size;
+        size_t numPixels;
+
+        // offset of the length field of the open run, and the index of its last pixel
+        size_t runLengthOffset;
+        size_t runLast;
+        uint16_t runLength;
+        bool runOpen;
+
+        inline uint8_t* reserve(size_t numBytes);
+        template <typename T> inline void addPixel(size_t index, T value, EVTSparseFormat format);
+        inline void closeRun();
+        template <typename T> size_t encodeFrame(const T* pData, size_t sizeX, size_t sizeY, unsigned int threshold, EVTSparseFormat format);
+};
+
+
+#endif
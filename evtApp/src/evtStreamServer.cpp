@@ -0,0 +1,570 @@
+/**
+ * Source file for the ADEmergentVision TCP raw frame stream server
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <errno.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/uio.h>
+#endif
+
+#ifdef __linux__
+#include <poll.h>
+#include <linux/errqueue.h>
+// older C library headers do not define the zero copy flags, which the kernel has had since 4.14
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#include "evtByteOrder.h"
+#include "evtStreamServer.h"
+
+using namespace std;
+
+
+static void evtShutdownSocket(SOCKET sock){
+#ifdef _WIN32
+    shutdown(sock, SD_BOTH);
+#else
+    shutdown(sock, SHUT_RDWR);
+#endif
+}
+
+
+// waits for a socket to become readable, returns false on timeout
+static bool evtWaitReadable(SOCKET sock, int timeoutMs){
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(sock, &readSet);
+    struct timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    return select((int) sock + 1, &readSet, NULL, NULL, &tv) > 0;
+}
+
+
+static void evtSetSocketTimeout(SOCKET sock, int option, double timeout){
+#ifdef _WIN32
+    DWORD timeoutMs = (DWORD) (timeout * 1000);
+    setsockopt(sock, SOL_SOCKET, option, (char*) &timeoutMs, sizeof(timeoutMs));
+#else
+    struct timeval tv;
+    tv.tv_sec = (long) timeout;
+    tv.tv_usec = (long) ((timeout - tv.tv_sec) * 1000000);
+    setsockopt(sock, SOL_SOCKET, option, (char*) &tv, sizeof(tv));
+#endif
+}
+
+
+EVTStreamServer::EVTStreamFrame::EVTStreamFrame(NDArray* pArray) : pArray(pArray) {
+    pArray->reserve();
+}
+
+
+EVTStreamServer::EVTStreamFrame::~EVTStreamFrame(){
+    this->pArray->release();
+}
+
+
+EVTStreamServer::EVTStreamServer()
+    : listenSock(INVALID_SOCKET), running(false), queueDepth(4), zeroCopy(true), sequence(0) {
+    memset(&this->closedStats, 0, sizeof(this->closedStats));
+}
+
+
+EVTStreamServer::~EVTStreamServer(){
+    stop();
+}
+
+
+/**
+ * Starts listening for subscribers. A running server is stopped first, disconnecting its subscribers.
+ *
+ * @params[in]:  port       -> TCP port to listen on
+ * @params[in]:  queueDepth -> frames held for each subscriber before frames are dropped for it
+ * @params[in]:  zeroCopy   -> send with MSG_ZEROCOPY where the system supports it
+ * @params[out]: error      -> description of the failure
+ * @return: true if the server is listening
+ */
+bool EVTStreamServer::start(int port, int queueDepth, bool zeroCopy, string& error){
+    stop();
+    if(port <= 0 || port > 65535){
+        error = "Invalid port";
+        return false;
+    }
+    this->listenSock = epicsSocketCreate(AF_INET, SOCK_STREAM, 0);
+    if(this->listenSock == INVALID_SOCKET){
+        error = "Could not create socket";
+        return false;
+    }
+    epicsSocketEnableAddressReuseDuringTimeWaitState(this->listenSock);
+
+    osiSockAddr local;
+    memset(&local, 0, sizeof(local));
+    local.ia.sin_family = AF_INET;
+    local.ia.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.ia.sin_port = htons((unsigned short) port);
+    if(::bind(this->listenSock, &local.sa, sizeof(local.ia)) != 0 || listen(this->listenSock, EVT_STREAM_MAX_CLIENTS) != 0){
+        char message[128];
+        epicsSocketConvertErrnoToString(message, sizeof(message));
+        error = string("Could not listen on port ") + to_string(port) + ": " + message;
+        epicsSocketDestroy(this->listenSock);
+        this->listenSock = INVALID_SOCKET;
+        return false;
+    }
+
+    this->queueDepth = queueDepth > 0 ? queueDepth : 1;
+    this->zeroCopy = zeroCopy;
+    this->sequence = 0;
+    memset(&this->closedStats, 0, sizeof(this->closedStats));
+    this->running = true;
+    this->acceptor = thread(&EVTStreamServer::acceptLoop, this);
+    return true;
+}
+
+
+void EVTStreamServer::stop(){
+    if(!this->running && this->listenSock == INVALID_SOCKET) return;
+    this->running = false;
+    if(this->acceptor.joinable()) this->acceptor.join();
+    if(this->listenSock != INVALID_SOCKET) epicsSocketDestroy(this->listenSock);
+    this->listenSock = INVALID_SOCKET;
+    reapClients(true);
+}
+
+
+bool EVTStreamServer::isRunning() const {
+    return this->running;
+}
+
+
+/**
+ * Accepts subscribers and removes the ones that have disconnected. The listening socket is polled,
+ * so the loop sees a stop request within a fraction of a second.
+ */
+void EVTStreamServer::acceptLoop(){
+    while(this->running){
+        reapClients(false);
+        if(!evtWaitReadable(this->listenSock, 200)) continue;
+        osiSockAddr remote;
+        osiSocklen_t remoteSize = sizeof(remote);
+        SOCKET sock = ::accept(this->listenSock, &remote.sa, &remoteSize);
+        if(sock == INVALID_SOCKET) continue;
+
+        shared_ptr<EVTStreamClient> client(new EVTStreamClient());
+        client->sock = sock;
+        char address[64];
+        sockAddrToDottedIP(&remote.sa, address, sizeof(address));
+        client->address = address;
+        client->stopping = false;
+        client->finished = false;
+        client->failed = false;
+        client->nextId = 0;
+        client->numSent = 0;
+        client->numDropped = 0;
+        client->numCopied = 0;
+
+        int noDelay = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char*) &noDelay, sizeof(noDelay));
+        evtSetSocketTimeout(sock, SO_SNDTIMEO, EVT_STREAM_SEND_TIMEOUT);
+        client->zeroCopy = false;
+#ifdef __linux__
+        int enable = 1;
+        if(this->zeroCopy) client->zeroCopy = setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+#endif
+
+        lock_guard<mutex> lock(this->clientMutex);
+        if(this->clients.size() >= EVT_STREAM_MAX_CLIENTS){
+            epicsSocketDestroy(sock);
+            continue;
+        }
+        client->sender = thread(&EVTStreamServer::senderLoop, this, client);
+        this->clients.push_back(client);
+    }
+}
+
+
+/**
+ * Sends the queued frames of one subscriber until it disconnects or the server stops, then waits briefly
+ * for the kernel to finish with any zero copy sends. Sends still pending keep their NDArrays until the
+ * socket is destroyed in reapClients.
+ */
+void EVTStreamServer::senderLoop(shared_ptr<EVTStreamClient> client){
+    while(true){
+        shared_ptr<EVTStreamFrame> frame;
+        {
+            unique_lock<mutex> lock(client->mutex);
+            client->frameReady.wait(lock, [&client]{ return client->stopping || !client->queue.empty(); });
+            if(client->stopping) break;
+            frame = client->queue.front();
+            client->queue.pop_front();
+        }
+        if(!sendFrame(*client, frame)){
+            lock_guard<mutex> lock(client->mutex);
+            client->failed = !client->stopping;
+            break;
+        }
+        client->numSent++;
+    }
+    evtShutdownSocket(client->sock);
+    reapCompletions(*client, 0, 1000);
+    {
+        lock_guard<mutex> lock(client->mutex);
+        client->queue.clear();
+    }
+    client->finished = true;
+}
+
+
+/**
+ * Sends the header and data of a frame in one gathered call, continuing after partial sends. With zero
+ * copy every call that sends data is given the next completion id, and the frame is held until the kernel
+ * reports that id complete. A subscriber that is copied rather than zero copied, such as one on loopback,
+ * is moved to normal sends, as zero copy only adds cost in that case.
+ *
+ * @return: false if the subscriber disconnected or did not take the data within the send timeout
+ */
+bool EVTStreamServer::sendFrame(EVTStreamClient& client, const shared_ptr<EVTStreamFrame>& frame){
+    size_t dataSize = (size_t) evtLittleEndian64(frame->header.dataSize);
+#ifdef _WIN32
+    WSABUF buffers[2];
+    buffers[0].buf = (char*) &frame->header;
+    buffers[0].len = sizeof(EVTStreamHeader);
+    buffers[1].buf = (char*) frame->pArray->pData;
+    buffers[1].len = (ULONG) dataSize;
+    WSABUF* pBuffers = buffers;
+    DWORD numBuffers = 2;
+    while(numBuffers > 0){
+        DWORD sent = 0;
+        if(WSASend(client.sock, pBuffers, numBuffers, &sent, 0, NULL, NULL) != 0) return false;
+        while(numBuffers > 0 && sent >= pBuffers[0].len){
+            sent -= pBuffers[0].len;
+            pBuffers++;
+            numBuffers--;
+        }
+        if(numBuffers > 0){
+            pBuffers[0].buf += sent;
+            pBuffers[0].len -= sent;
+        }
+    }
+    return true;
+#else
+    struct iovec iov[2];
+    iov[0].iov_base = &frame->header;
+    iov[0].iov_len = sizeof(EVTStreamHeader);
+    iov[1].iov_base = frame->pArray->pData;
+    iov[1].iov_len = dataSize;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    while(msg.msg_iovlen > 0){
+        int flags = MSG_NOSIGNAL;
+#ifdef __linux__
+        if(client.zeroCopy) flags |= MSG_ZEROCOPY;
+#endif
+        ssize_t sent = sendmsg(client.sock, &msg, flags);
+        if(sent < 0){
+            if(errno == EINTR) continue;
+#ifdef __linux__
+            // out of locked memory for zero copy, the data is sent with a normal copy instead
+            if(errno == ENOBUFS && client.zeroCopy){
+                client.zeroCopy = false;
+                continue;
+            }
+#endif
+            return false;
+        }
+#ifdef __linux__
+        if(client.zeroCopy && sent > 0){
+            EVTStreamPending pending;
+            pending.id = client.nextId++;
+            pending.frame = frame;
+            client.pending.push_back(pending);
+        }
+#endif
+        size_t remaining = (size_t) sent;
+        while(msg.msg_iovlen > 0 && remaining >= msg.msg_iov[0].iov_len){
+            remaining -= msg.msg_iov[0].iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if(msg.msg_iovlen > 0){
+            msg.msg_iov[0].iov_base = (char*) msg.msg_iov[0].iov_base + remaining;
+            msg.msg_iov[0].iov_len -= remaining;
+        }
+    }
+    reapCompletions(client, EVT_STREAM_MAX_PENDING, EVT_STREAM_SEND_TIMEOUT * 1000);
+    return client.pending.size() <= EVT_STREAM_MAX_PENDING;
+#endif
+}
+
+
+/**
+ * Reads the zero copy completions the kernel has queued on the error queue of a subscriber socket, and
+ * drops the frames held for the completed sends. Each completion covers an inclusive range of send ids.
+ *
+ * @params[in]: client      -> subscriber
+ * @params[in]: maxPending  -> waits for completions while more sends than this are held
+ * @params[in]: timeoutMs   -> longest time to wait for each completion
+ * @return: void
+ */
+void EVTStreamServer::reapCompletions(EVTStreamClient& client, size_t maxPending, int timeoutMs){
+#ifdef __linux__
+    while(!client.pending.empty()){
+        char control[128];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if(recvmsg(client.sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0){
+            if(errno == EINTR) continue;
+            if(client.pending.size() <= maxPending) return;
+            // completions are signalled as an error condition on the socket
+            struct pollfd pfd;
+            pfd.fd = client.sock;
+            pfd.events = 0;
+            pfd.revents = 0;
+            if(poll(&pfd, 1, timeoutMs) <= 0) return;
+            continue;
+        }
+        for(struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)){
+            if(!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                 (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))) continue;
+            struct sock_extended_err* err = (struct sock_extended_err*) CMSG_DATA(cmsg);
+            if(err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+            uint32_t first = err->ee_info, last = err->ee_data;
+            if(err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED){
+                client.numCopied += last - first + 1;
+                client.zeroCopy = false;
+            }
+            for(deque<EVTStreamPending>::iterator it = client.pending.begin(); it != client.pending.end();){
+                if(it->id - first <= last - first) it = client.pending.erase(it);
+                else ++it;
+            }
+        }
+    }
+#endif
+}
+
+
+/**
+ * Removes subscribers from the list, and adds their counts to the totals of closed subscribers.
+ *
+ * @params[in]: all -> disconnects every subscriber, otherwise only the ones whose sender has finished
+ * @return: void
+ */
+void EVTStreamServer::reapClients(bool all){
+    vector<shared_ptr<EVTStreamClient> > removed;
+    {
+        lock_guard<mutex> lock(this->clientMutex);
+        for(size_t i = 0; i < this->clients.size();){
+            if(all || this->clients[i]->finished){
+                removed.push_back(this->clients[i]);
+                this->clients.erase(this->clients.begin() + i);
+            }
+            else i++;
+        }
+    }
+    for(size_t i = 0; i < removed.size(); i++){
+        EVTStreamClient& client = *removed[i];
+        {
+            lock_guard<mutex> lock(client.mutex);
+            client.stopping = true;
+        }
+        client.frameReady.notify_all();
+        // unblocks a send in progress
+        evtShutdownSocket(client.sock);
+        client.sender.join();
+        // a zero linger discards unsent data, so the kernel no longer reads the pending NDArrays once closed
+        struct linger noLinger;
+        noLinger.l_onoff = 1;
+        noLinger.l_linger = 0;
+        setsockopt(client.sock, SOL_SOCKET, SO_LINGER, (char*) &noLinger, sizeof(noLinger));
+        epicsSocketDestroy(client.sock);
+        client.pending.clear();
+
+        lock_guard<mutex> lock(this->clientMutex);
+        this->closedStats.numSent += client.numSent;
+        this->closedStats.numDropped += client.numDropped;
+        this->closedStats.numCopied += client.numCopied;
+        if(client.failed) this->closedStats.numErrors++;
+    }
+}
+
+
+/**
+ * Queues a frame for every subscriber with room in its queue, and counts it as dropped for the others.
+ * Called from the image thread, it never waits on a subscriber.
+ *
+ * @params[in]: pArray          -> frame to send, reserved while it is queued or being sent
+ * @params[in]: cameraTimeStamp -> raw camera timestamp in nanoseconds
+ * @return: void
+ */
+void EVTStreamServer::publish(NDArray* pArray, uint64_t cameraTimeStamp){
+    if(!this->running) return;
+    uint64_t sequence = ++this->sequence;
+    lock_guard<mutex> lock(this->clientMutex);
+    if(this->clients.empty()) return;
+
+    NDArrayInfo info;
+    pArray->getInfo(&info);
+    shared_ptr<EVTStreamFrame> frame(new EVTStreamFrame(pArray));
+    EVTStreamHeader& header = frame->header;
+    memset(&header, 0, sizeof(header));
+    uint32_t ndims = (uint32_t) (pArray->ndims < EVT_STREAM_MAX_DIMS ? pArray->ndims : EVT_STREAM_MAX_DIMS);
+    header.magic = evtLittleEndian32(EVT_STREAM_MAGIC);
+    header.version = evtLittleEndian16(EVT_STREAM_VERSION);
+    header.headerSize = evtLittleEndian16((uint16_t) sizeof(EVTStreamHeader));
+    header.sequence = evtLittleEndian64(sequence);
+    header.uniqueId = (int32_t) evtLittleEndian32((uint32_t) pArray->uniqueId);
+    header.dataType = evtLittleEndian32((uint32_t) pArray->dataType);
+    header.colorMode = evtLittleEndian32((uint32_t) info.colorMode);
+    header.ndims = evtLittleEndian32(ndims);
+    for(uint32_t i = 0; i < ndims; i++) header.dims[i] = evtLittleEndian64(pArray->dims[i].size);
+    header.dataSize = evtLittleEndian64(info.totalBytes);
+    header.cameraTimeStamp = evtLittleEndian64(cameraTimeStamp);
+    header.secPastEpoch = evtLittleEndian32(pArray->epicsTS.secPastEpoch);
+    header.nsec = evtLittleEndian32(pArray->epicsTS.nsec);
+
+    for(size_t i = 0; i < this->clients.size(); i++){
+        EVTStreamClient& client = *this->clients[i];
+        {
+            lock_guard<mutex> clientLock(client.mutex);
+            if(client.stopping || client.finished) continue;
+            if((int) client.queue.size() >= this->queueDepth){
+                client.numDropped++;
+                continue;
+            }
+            client.queue.push_back(frame);
+        }
+        client.frameReady.notify_one();
+    }
+}
+
+
+void EVTStreamServer::getStats(EVTStreamStats* pStats){
+    lock_guard<mutex> lock(this->clientMutex);
+    *pStats = this->closedStats;
+    pStats->numClients = 0;
+    for(size_t i = 0; i < this->clients.size(); i++){
+        EVTStreamClient& client = *this->clients[i];
+        if(!client.finished) pStats->numClients++;
+        pStats->numSent += client.numSent;
+        pStats->numDropped += client.numDropped;
+        pStats->numCopied += client.numCopied;
+    }
+}
+
+
+static bool evtReceiveAll(SOCKET sock, char* pBuffer, size_t size){
+    while(size > 0){
+        int received = recv(sock, pBuffer, (int) (size > 0x40000000 ? 0x40000000 : size), 0);
+        if(received <= 0) return false;
+        pBuffer += received;
+        size -= (size_t) received;
+    }
+    return true;
+}
+
+
+/**
+ * Connects to a stream server and prints the header of each frame received, the age of each frame computed
+ * from its timestamp, and the sequence gaps caused by frames dropped for this subscriber. Intended for
+ * verifying the server on loopback.
+ *
+ * @params[in]: address     -> host name or IP address of the server
+ * @params[in]: port        -> TCP port of the server
+ * @params[in]: numFrames   -> number of frames to receive before returning
+ * @params[in]: timeout     -> seconds to wait for each frame
+ * @return: number of frames received
+ */
+int evtStreamListen(const char* address, int port, int numFrames, double timeout){
+    osiSockAddr server;
+    if(address == NULL || aToIPAddr(address, (unsigned short) port, &server.ia) != 0){
+        printf("Could not resolve %s\n", address == NULL ? "" : address);
+        return 0;
+    }
+    SOCKET sock = epicsSocketCreate(AF_INET, SOCK_STREAM, 0);
+    if(sock == INVALID_SOCKET){
+        printf("Could not create socket\n");
+        return 0;
+    }
+    if(::connect(sock, &server.sa, sizeof(server.ia)) != 0){
+        printf("Could not connect to %s:%d\n", address, port);
+        epicsSocketDestroy(sock);
+        return 0;
+    }
+    evtSetSocketTimeout(sock, SO_RCVTIMEO, timeout);
+
+    vector<char> data;
+    uint64_t lastSequence = 0, numMissed = 0, numBytes = 0;
+    int received = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while(received < numFrames){
+        EVTStreamHeader header;
+        if(!evtReceiveAll(sock, (char*) &header, sizeof(header))){
+            printf("No frame received\n");
+            break;
+        }
+        if(evtLittleEndian32(header.magic) != EVT_STREAM_MAGIC || evtLittleEndian16(header.headerSize) != sizeof(EVTStreamHeader)){
+            printf("Invalid frame header\n");
+            break;
+        }
+        header.sequence = evtLittleEndian64(header.sequence);
+        header.uniqueId = (int32_t) evtLittleEndian32((uint32_t) header.uniqueId);
+        header.ndims = evtLittleEndian32(header.ndims);
+        for(uint32_t d = 0; d < EVT_STREAM_MAX_DIMS; d++) header.dims[d] = evtLittleEndian64(header.dims[d]);
+        header.dataSize = evtLittleEndian64(header.dataSize);
+        header.secPastEpoch = evtLittleEndian32(header.secPastEpoch);
+        header.nsec = evtLittleEndian32(header.nsec);
+        data.resize((size_t) header.dataSize);
+        if(header.dataSize > 0 && !evtReceiveAll(sock, &data[0], (size_t) header.dataSize)){
+            printf("Frame data incomplete\n");
+            break;
+        }
+        epicsTimeStamp now, frameTime;
+        epicsTimeGetCurrent(&now);
+        frameTime.secPastEpoch = header.secPastEpoch;
+        frameTime.nsec = header.nsec;
+        if(lastSequence != 0 && header.sequence > lastSequence + 1) numMissed += header.sequence - lastSequence - 1;
+        lastSequence = header.sequence;
+        numBytes += header.dataSize;
+        printf("seq %llu, id %d, dims", (unsigned long long) header.sequence, header.uniqueId);
+        for(uint32_t d = 0; d < header.ndims && d < EVT_STREAM_MAX_DIMS; d++) printf(" %llu", (unsigned long long) header.dims[d]);
+        printf(", %llu bytes, age %.1f us\n", (unsigned long long) header.dataSize, epicsTimeDiffInSeconds(&now, &frameTime) * 1e6);
+        received++;
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("%d frames received, %llu missed, %.1f MB/s\n", received, (unsigned long long) numMissed,
+           elapsed > 0 ? numBytes / elapsed / 1e6 : 0.0);
+    epicsSocketDestroy(sock);
+    return received;
+}
@@ -0,0 +1,169 @@
+/**
+ * Header file for the ADEmergentVision TCP raw frame stream server
+ *
+ * Streams raw frames to any number of TCP subscribers. Each frame is sent as a fixed header followed by
+ * the frame data, gathered in one sendmsg call straight from the NDArray, which is held until the kernel
+ * is done with it. On Linux the data is sent with MSG_ZEROCOPY, so it is not copied into the socket buffer.
+ * Every subscriber has its own sender thread and a bounded queue. A frame that arrives while a queue is
+ * full is dropped for that subscriber only, and counted, so a slow subscriber never delays the image thread
+ * or the other subscribers. Subscribers detect dropped frames from gaps in the sequence.
+ *
+ * Stream layout:
+ *      EVTStreamHeader             (88 bytes, every field little endian)
+ *      frame data                  (dataSize bytes, sent as is, in the byte order of the IOC host)
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTSTREAMSERVER_H
+#define EVTSTREAMSERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <epicsTime.h>
+#include <osiSock.h>
+
+#include "NDArray.h"
+
+// "EVTN" when read as little endian bytes
+#define EVT_STREAM_MAGIC        0x4E545645
+#define EVT_STREAM_VERSION      1
+#define EVT_STREAM_MAX_DIMS     4
+#define EVT_STREAM_MAX_CLIENTS  16
+// zero copy sends the kernel may still be reading from, per subscriber
+#define EVT_STREAM_MAX_PENDING  64
+// a subscriber that does not take data for this long is disconnected
+#define EVT_STREAM_SEND_TIMEOUT 5
+
+
+#pragma pack(push, 1)
+typedef struct EVTStreamHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    // incremented for every frame, whether or not it is sent to a given subscriber
+    uint64_t sequence;
+    int32_t uniqueId;
+    // NDDataType_t and NDColorMode_t of the frame
+    uint32_t dataType;
+    uint32_t colorMode;
+    uint32_t ndims;
+    uint64_t dims[EVT_STREAM_MAX_DIMS];
+    uint64_t dataSize;
+    // raw camera timestamp in nanoseconds
+    uint64_t cameraTimeStamp;
+    // epics timestamp of the frame
+    uint32_t secPastEpoch;
+    uint32_t nsec;
+} EVTStreamHeader;
+#pragma pack(pop)
+
+static_assert(sizeof(EVTStreamHeader) == 88, "stream header layout changed");
+
+
+// Totals over all subscribers since the server was started
+typedef struct EVTStreamStats {
+    int numClients;
+    uint64_t numSent;
+    uint64_t numDropped;
+    // zero copy sends the kernel had to copy, always the case on loopback
+    uint64_t numCopied;
+    // subscribers disconnected because a send failed or timed out
+    uint64_t numErrors;
+} EVTStreamStats;
+
+
+class EVTStreamServer {
+
+    public:
+
+        EVTStreamServer();
+        ~EVTStreamServer();
+
+        // listens on the given port on all interfaces, queueDepth is the number of frames held per subscriber
+        bool start(int port, int queueDepth, bool zeroCopy, std::string& error);
+        void stop();
+        bool isRunning() const;
+
+        // queues a frame for every subscriber, the NDArray is reserved until all sends have completed.
+        // May be called without the lock of the caller that starts and stops the server.
+        void publish(NDArray* pArray, uint64_t cameraTimeStamp);
+
+        void getStats(EVTStreamStats* pStats);
+
+    private:
+
+        // A frame queued for one or more subscribers, releases the NDArray when the last reference is dropped
+        class EVTStreamFrame {
+            public:
+                EVTStreamFrame(NDArray* pArray);
+                ~EVTStreamFrame();
+                EVTStreamHeader header;
+                NDArray* pArray;
+        };
+
+        typedef struct EVTStreamPending {
+            uint32_t id;
+            std::shared_ptr<EVTStreamFrame> frame;
+        } EVTStreamPending;
+
+        typedef struct EVTStreamClient {
+            SOCKET sock;
+            std::string address;
+            std::thread sender;
+            std::mutex mutex;
+            std::condition_variable frameReady;
+            std::deque<std::shared_ptr<EVTStreamFrame> > queue;
+            bool stopping;
+            std::atomic<bool> finished;
+            bool zeroCopy;
+            // sends waiting for the kernel to report their completion, and the id of the next send
+            std::deque<EVTStreamPending> pending;
+            uint32_t nextId;
+            std::atomic<uint64_t> numSent;
+            std::atomic<uint64_t> numDropped;
+            std::atomic<uint64_t> numCopied;
+            bool failed;
+        } EVTStreamClient;
+
+        SOCKET listenSock;
+        std::thread acceptor;
+        std::atomic<bool> running;
+        std::atomic<int> queueDepth;
+        bool zeroCopy;
+        std::atomic<uint64_t> sequence;
+
+        std::mutex clientMutex;
+        std::vector<std::shared_ptr<EVTStreamClient> > clients;
+        // counts of subscribers that have disconnected
+        EVTStreamStats closedStats;
+
+        void acceptLoop();
+        void senderLoop(std::shared_ptr<EVTStreamClient> client);
+        bool sendFrame(EVTStreamClient& client, const std::shared_ptr<EVTStreamFrame>& frame);
+        void reapCompletions(EVTStreamClient& client, size_t maxPending, int timeoutMs);
+        void reapClients(bool all);
+
+        EVTStreamServer(const EVTStreamServer&);
+        EVTStreamServer& operator=(const EVTStreamServer&);
+};
+
+
+// Connects to a stream server and prints the frames received, used to test the server on loopback
+int evtStreamListen(const char* address, int port, int numFrames, double timeout);
+
+
+#endif
@@ -0,0 +1,192 @@
+/**
+ * Source file for the ADEmergentVision per pixel temporal statistics accumulator
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include "evtSimd.h"
+#include "evtTemporalStats.h"
+
+using namespace std;
+
+
+#ifdef EVT_SIMD_SSE2
+
+/**
+ * Welford update of 4 pixels: mean += (x - mean) / n, m2 += (x - mean_old) * (x - mean_new)
+ */
+static inline void evtWelfordStep(__m128i pixels, float* pMean, float* pM2, __m128 invN){
+    __m128 x = _mm_cvtepi32_ps(pixels);
+    __m128 mean = _mm_loadu_ps(pMean);
+    __m128 delta = _mm_sub_ps(x, mean);
+    mean = _mm_add_ps(mean, _mm_mul_ps(delta, invN));
+    _mm_storeu_ps(pMean, mean);
+    _mm_storeu_ps(pM2, _mm_add_ps(_mm_loadu_ps(pM2), _mm_mul_ps(delta, _mm_sub_ps(x, mean))));
+}
+
+
+static inline size_t evtWelfordVector(const uint8_t* pData, float* pMean, float* pM2, size_t numPixels, __m128 invN){
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for(; i + 16 <= numPixels; i += 16){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pData + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        evtWelfordStep(_mm_unpacklo_epi16(lo, zero), pMean + i,      pM2 + i,      invN);
+        evtWelfordStep(_mm_unpackhi_epi16(lo, zero), pMean + i + 4,  pM2 + i + 4,  invN);
+        evtWelfordStep(_mm_unpacklo_epi16(hi, zero), pMean + i + 8,  pM2 + i + 8,  invN);
+        evtWelfordStep(_mm_unpackhi_epi16(hi, zero), pMean + i + 12, pM2 + i + 12, invN);
+    }
+    return i;
+}
+
+
+static inline size_t evtWelfordVector(const uint16_t* pData, float* pMean, float* pM2, size_t numPixels, __m128 invN){
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for(; i + 8 <= numPixels; i += 8){
+        __m128i v = _mm_loadu_si128((const __m128i*) (pData + i));
+        evtWelfordStep(_mm_unpacklo_epi16(v, zero), pMean + i,     pM2 + i,     invN);
+        evtWelfordStep(_mm_unpackhi_epi16(v, zero), pMean + i + 4, pM2 + i + 4, invN);
+    }
+    return i;
+}
+
+#endif
+
+
+EVTTemporalStats::EVTTemporalStats()
+    : sizeX(0), sizeY(0), numFrames(0), numAccumulated(0), running(false), complete(false),
+      meanLevel(0), meanVariance(0) {}
+
+
+/**
+ * Starts a new accumulation
+ *
+ * @params[in]: numFrames   -> number of frames to accumulate, at least 2
+ * @return: void
+ */
+void EVTTemporalStats::start(int numFrames){
+    this->numFrames = numFrames < 2 ? 2 : numFrames;
+    this->numAccumulated = 0;
+    this->running = true;
+    this->complete = false;
+}
+
+
+void EVTTemporalStats::cancel(){
+    this->running = false;
+}
+
+
+bool EVTTemporalStats::isRunning() const {
+    return this->running;
+}
+
+
+int EVTTemporalStats::getNumAccumulated() const {
+    return this->numAccumulated;
+}
+
+
+template <typename T>
+bool EVTTemporalStats::accumulateFrame(const T* pData, size_t sizeX, size_t sizeY){
+    if(!this->running) return false;
+    size_t numPixels = sizeX * sizeY;
+    if(this->numAccumulated == 0 || sizeX != this->sizeX || sizeY != this->sizeY){
+        this->sizeX = sizeX;
+        this->sizeY = sizeY;
+        this->numAccumulated = 0;
+        this->mean.assign(numPixels, 0.0f);
+        this->m2.assign(numPixels, 0.0f);
+    }
+    if(numPixels == 0) return false;
+
+    this->numAccumulated++;
+    float invN = 1.0f / this->numAccumulated;
+    float* pMean = &this->mean[0];
+    float* pM2 = &this->m2[0];
+    size_t i = 0;
+#ifdef EVT_SIMD_SSE2
+    i = evtWelfordVector(pData, pMean, pM2, numPixels, _mm_set1_ps(invN));
+#endif
+    for(; i < numPixels; i++){
+        float x = (float) pData[i];
+        float delta = x - pMean[i];
+        pMean[i] += delta * invN;
+        pM2[i] += delta * (x - pMean[i]);
+    }
+
+    if(this->numAccumulated < this->numFrames) return false;
+    finish();
+    return true;
+}
+
+
+/**
+ * Turns the sum of squared differences into the variance, and computes the spatial averages
+ */
+void EVTTemporalStats::finish(){
+    float scale = 1.0f / (this->numAccumulated - 1);
+    double sumMean = 0, sumVariance = 0;
+    for(size_t i = 0; i < this->m2.size(); i++){
+        this->m2[i] *= scale;
+        sumMean += this->mean[i];
+        sumVariance += this->m2[i];
+    }
+    this->meanLevel = sumMean / this->mean.size();
+    this->meanVariance = sumVariance / this->m2.size();
+    this->running = false;
+    this->complete = true;
+}
+
+
+/**
+ * Adds a frame to the accumulation
+ *
+ * @params[in]: pData   -> pointer to image data
+ * @params[in]: sizeX   -> image width
+ * @params[in]: sizeY   -> image height
+ * @return: true if this frame completed the accumulation
+ */
+bool EVTTemporalStats::accumulate(const uint8_t* pData, size_t sizeX, size_t sizeY){
+    return accumulateFrame(pData, sizeX, sizeY);
+}
+
+
+bool EVTTemporalStats::accumulate(const uint16_t* pData, size_t sizeX, size_t sizeY){
+    return accumulateFrame(pData, sizeX, sizeY);
+}
+
+
+const float* EVTTemporalStats::getMean() const {
+    return this->complete ? &this->mean[0] : NULL;
+}
+
+
+const float* EVTTemporalStats::getVariance() const {
+    return this->complete ? &this->m2[0] : NULL;
+}
+
+
+size_t EVTTemporalStats::getSizeX() const {
+    return this->sizeX;
+}
+
+
+size_t EVTTemporalStats::getSizeY() const {
+    return this->sizeY;
+}
+
+
+double EVTTemporalStats::getMeanLevel() const {
+    return this->meanLevel;
+}
+
+
+double EVTTemporalStats::getMeanVariance() const {
+    return this->meanVariance;
+}
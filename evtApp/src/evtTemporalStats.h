@@ -0,0 +1,70 @@
+/**
+ * Header file for the ADEmergentVision per pixel temporal statistics accumulator
+ *
+ * Accumulates the per pixel mean and variance of a series of mono 8/16 bit frames with Welford's
+ * streaming update, 4 pixels at a time in SSE2 float arithmetic, so no frames have to be kept.
+ * Used for photon transfer characterization, where the spatial averages of the mean and variance maps
+ * of a dark series give the read noise, and those of an illuminated series the conversion gain.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTTEMPORALSTATS_H
+#define EVTTEMPORALSTATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+
+class EVTTemporalStats {
+
+    public:
+
+        EVTTemporalStats();
+
+        // the next numFrames frames passed to accumulate are added to new maps
+        void start(int numFrames);
+        void cancel();
+        bool isRunning() const;
+        int getNumAccumulated() const;
+
+        // returns true once the requested number of frames has been accumulated, a frame of a
+        // different size restarts the accumulation
+        bool accumulate(const uint8_t* pData, size_t sizeX, size_t sizeY);
+        bool accumulate(const uint16_t* pData, size_t sizeX, size_t sizeY);
+
+        // maps of the last completed accumulation, valid until the next start, variance is the
+        // unbiased sample variance
+        const float* getMean() const;
+        const float* getVariance() const;
+        size_t getSizeX() const;
+        size_t getSizeY() const;
+
+        // spatial averages of the mean and variance maps
+        double getMeanLevel() const;
+        double getMeanVariance() const;
+
+    private:
+
+        std::vector<float> mean;
+        std::vector<float> m2;
+        size_t sizeX;
+        size_t sizeY;
+        int numFrames;
+        int numAccumulated;
+        bool running;
+        bool complete;
+        double meanLevel;
+        double meanVariance;
+
+        template <typename T> bool accumulateFrame(const T* pData, size_t sizeX, size_t sizeY);
+        void finish();
+};
+
+
+#endif
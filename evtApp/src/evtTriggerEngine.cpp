@@ -0,0 +1,106 @@
+/**
+ * Source file for the ADEmergentVision content based trigger engine
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+#include "evtTriggerEngine.h"
+
+
+EVTTriggerEngine::EVTTriggerEngine()
+    : condition(EVT_TRIGGER_ABOVE), threshold(0), preFrames(0), postFrames(0), lastValue(0), hasLastValue(false),
+      remainingFrames(0), windowOpen(false), triggerId(0), frameNumber(-1), triggerFrameNumber(0) {}
+
+
+/**
+ * Sets the trigger condition and window length
+ *
+ * @params[in]: condition   -> comparison of the metric with the threshold
+ * @params[in]: threshold   -> threshold value
+ * @params[in]: preFrames   -> frames recorded before the trigger frame
+ * @params[in]: postFrames  -> frames recorded after the trigger frame
+ * @return: void
+ */
+void EVTTriggerEngine::configure(EVTTriggerCondition condition, double threshold, int preFrames, int postFrames){
+    if(preFrames < 0) preFrames = 0;
+    if(preFrames > EVT_TRIGGER_MAX_PRE_FRAMES) preFrames = EVT_TRIGGER_MAX_PRE_FRAMES;
+    this->condition = condition;
+    this->threshold = threshold;
+    this->preFrames = preFrames;
+    this->postFrames = postFrames < 0 ? 0 : postFrames;
+}
+
+
+void EVTTriggerEngine::reset(){
+    this->windowOpen = false;
+    this->remainingFrames = 0;
+    this->hasLastValue = false;
+}
+
+
+/**
+ * Evaluates the condition for a frame
+ *
+ * @params[in]: value   -> metric value of the frame
+ * @params[in]: force   -> trigger on this frame regardless of the value
+ * @return: whether the frame opened a window, is in an open window, or neither
+ */
+EVTTriggerState EVTTriggerEngine::evaluate(double value, bool force){
+    bool met;
+    switch(this->condition){
+        case EVT_TRIGGER_BELOW:
+            met = value < this->threshold;
+            break;
+        case EVT_TRIGGER_RISING:
+            met = this->hasLastValue && this->lastValue <= this->threshold && value > this->threshold;
+            break;
+        case EVT_TRIGGER_FALLING:
+            met = this->hasLastValue && this->lastValue >= this->threshold && value < this->threshold;
+            break;
+        default:
+            met = value > this->threshold;
+            break;
+    }
+    this->lastValue = value;
+    this->hasLastValue = true;
+    this->frameNumber++;
+
+    if(met || force){
+        this->remainingFrames = this->postFrames;
+        if(this->windowOpen) return EVT_TRIGGER_RECORDING;
+        this->windowOpen = true;
+        this->triggerId++;
+        this->triggerFrameNumber = this->frameNumber;
+        return EVT_TRIGGER_STARTED;
+    }
+    if(!this->windowOpen) return EVT_TRIGGER_IDLE;
+    if(this->remainingFrames == 0){
+        this->windowOpen = false;
+        return EVT_TRIGGER_IDLE;
+    }
+    this->remainingFrames--;
+    return EVT_TRIGGER_RECORDING;
+}
+
+
+int EVTTriggerEngine::getPreFrames() const {
+    return this->preFrames;
+}
+
+
+int EVTTriggerEngine::getTriggerId() const {
+    return this->triggerId;
+}
+
+
+int64_t EVTTriggerEngine::getFrameNumber() const {
+    return this->frameNumber;
+}
+
+
+int64_t EVTTriggerEngine::getTriggerFrameNumber() const {
+    return this->triggerFrameNumber;
+}
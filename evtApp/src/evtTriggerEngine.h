@@ -0,0 +1,76 @@
+/**
+ * Header file for the ADEmergentVision content based trigger engine
+ *
+ * Evaluates a condition on a per frame scalar metric, and opens a recording window when it is met.
+ * A window holds the preFrames frames before the trigger frame, the trigger frame, and the postFrames
+ * frames after it. A trigger while a window is open extends it by postFrames frames, keeping its ID.
+ * The engine only keeps the state, the driver buffers and publishes the frames.
+ *
+ * Created On: October-18-2026
+ *
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ *
+ */
+
+// header guard
+#ifndef EVTTRIGGERENGINE_H
+#define EVTTRIGGERENGINE_H
+
+#include <stdint.h>
+
+// Largest number of frames buffered before a trigger
+#define EVT_TRIGGER_MAX_PRE_FRAMES 1000
+
+
+typedef enum {
+    EVT_TRIGGER_ABOVE   = 0,
+    EVT_TRIGGER_BELOW   = 1,
+    EVT_TRIGGER_RISING  = 2,
+    EVT_TRIGGER_FALLING = 3
+} EVTTriggerCondition;
+
+
+typedef enum {
+    EVT_TRIGGER_IDLE        = 0,    // no window open, frames are kept as pre trigger frames
+    EVT_TRIGGER_STARTED     = 1,    // this frame opened a window
+    EVT_TRIGGER_RECORDING   = 2     // this frame is in an open window
+} EVTTriggerState;
+
+
+class EVTTriggerEngine {
+
+    public:
+
+        EVTTriggerEngine();
+
+        void configure(EVTTriggerCondition condition, double threshold, int preFrames, int postFrames);
+        // closes any open window, the trigger ID keeps counting
+        void reset();
+
+        // evaluates the condition for the next frame, force triggers regardless of the value
+        EVTTriggerState evaluate(double value, bool force);
+
+        int getPreFrames() const;
+        int getTriggerId() const;
+        // frame number of the last evaluated frame, and of the frame that opened the last window
+        int64_t getFrameNumber() const;
+        int64_t getTriggerFrameNumber() const;
+
+    private:
+
+        EVTTriggerCondition condition;
+        double threshold;
+        int preFrames;
+        int postFrames;
+
+        double lastValue;
+        bool hasLastValue;
+        int remainingFrames;
+        bool windowOpen;
+        int triggerId;
+        int64_t frameNumber;
+        int64_t triggerFrameNumber;
+};
+
+
+#endif
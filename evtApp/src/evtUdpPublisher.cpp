@@ -0,0 +1,239 @@
+/**
+ * Source file for the ADEmergentVision UDP feedback publisher
+ * 
+ * Created On: October-18-2026
+ * 
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ * 
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <fcntl.h>
+#endif
+
+#include "evtByteOrder.h"
+#include "evtUdpPublisher.h"
+
+using namespace std;
+
+
+static bool isMulticastAddress(const struct sockaddr_in* addr){
+    return (ntohl(addr->sin_addr.s_addr) & 0xF0000000) == 0xE0000000;
+}
+
+
+EVTUdpPublisher::EVTUdpPublisher()
+    : sock(INVALID_SOCKET), sequence(0), numSent(0), numErrors(0) {
+    memset(&this->destination, 0, sizeof(this->destination));
+}
+
+
+EVTUdpPublisher::~EVTUdpPublisher(){
+    close();
+}
+
+
+/**
+ * Opens the socket used for sending datagrams. Any previously opened socket is closed first.
+ * 
+ * @params[in]:  address    -> destination host name or IP address
+ * @params[in]:  port       -> destination UDP port
+ * @params[in]:  ttl        -> multicast time to live
+ * @params[out]: error      -> description of the failure
+ * @return: true if the socket was opened
+ */
+bool EVTUdpPublisher::open(const char* address, int port, int ttl, string& error){
+    close();
+    if(port <= 0 || port > 65535){
+        error = "Invalid port";
+        return false;
+    }
+    if(aToIPAddr(address, (unsigned short) port, &this->destination.ia) != 0){
+        error = string("Could not resolve ") + address;
+        return false;
+    }
+
+    this->sock = epicsSocketCreate(AF_INET, SOCK_DGRAM, 0);
+    if(this->sock == INVALID_SOCKET){
+        error = "Could not create socket";
+        return false;
+    }
+
+    if(isMulticastAddress(&this->destination.ia)){
+        unsigned char mcastTtl = (unsigned char) (ttl > 0 ? ttl : 1);
+        // loopback is kept on so that local receivers, and the loopback test, see the datagrams
+        unsigned char mcastLoop = 1;
+        setsockopt(this->sock, IPPROTO_IP, IP_MULTICAST_TTL, (char*) &mcastTtl, sizeof(mcastTtl));
+        setsockopt(this->sock, IPPROTO_IP, IP_MULTICAST_LOOP, (char*) &mcastLoop, sizeof(mcastLoop));
+    }
+
+    // sends come from the image thread, a datagram that does not fit in the send buffer is counted as an error
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(this->sock, FIONBIO, &nonBlocking);
+#else
+    fcntl(this->sock, F_SETFL, fcntl(this->sock, F_GETFL) | O_NONBLOCK);
+#endif
+
+    this->sequence = 0;
+    this->numSent = 0;
+    this->numErrors = 0;
+    return true;
+}
+
+
+void EVTUdpPublisher::close(){
+    if(this->sock != INVALID_SOCKET){
+        epicsSocketDestroy(this->sock);
+        this->sock = INVALID_SOCKET;
+    }
+}
+
+
+bool EVTUdpPublisher::isOpen() const {
+    return this->sock != INVALID_SOCKET;
+}
+
+
+/**
+ * Builds and sends a single feedback datagram. The socket does not block, so a full send buffer drops
+ * the datagram rather than holding up the caller.
+ * 
+ * @params[in]: uniqueId        -> NDArray unique id of the frame
+ * @params[in]: cameraTimeStamp -> raw camera timestamp of the frame
+ * @params[in]: timeStamp       -> epics timestamp of the frame
+ * @params[in]: values          -> selected metric values
+ * @params[in]: numValues       -> number of values
+ * @return: true if the datagram was sent
+ */
+bool EVTUdpPublisher::send(int uniqueId, uint64_t cameraTimeStamp, const epicsTimeStamp& timeStamp, const double* values, size_t numValues){
+    if(this->sock == INVALID_SOCKET) return false;
+
+    size_t size = sizeof(EVTFeedbackHeader) + numValues * sizeof(double);
+    this->buffer.resize(size);
+    EVTFeedbackHeader* header = (EVTFeedbackHeader*) &this->buffer[0];
+    header->magic = evtLittleEndian32(EVT_FEEDBACK_MAGIC);
+    header->version = evtLittleEndian16(EVT_FEEDBACK_VERSION);
+    header->numValues = evtLittleEndian16((uint16_t) numValues);
+    header->sequence = evtLittleEndian32(this->sequence++);
+    header->uniqueId = (int32_t) evtLittleEndian32((uint32_t) uniqueId);
+    header->cameraTimeStamp = evtLittleEndian64(cameraTimeStamp);
+    header->secPastEpoch = evtLittleEndian32(timeStamp.secPastEpoch);
+    header->nsec = evtLittleEndian32(timeStamp.nsec);
+    for(size_t i = 0; i < numValues; i++){
+        double value = evtLittleEndianDouble(values[i]);
+        memcpy(&this->buffer[sizeof(EVTFeedbackHeader) + i * sizeof(double)], &value, sizeof(double));
+    }
+
+    int sent = sendto(this->sock, &this->buffer[0], (int) size, 0, &this->destination.sa, sizeof(this->destination.ia));
+    if(sent != (int) size){
+        this->numErrors++;
+        return false;
+    }
+    this->numSent++;
+    return true;
+}
+
+
+size_t EVTUdpPublisher::getNumSent() const {
+    return this->numSent;
+}
+
+
+size_t EVTUdpPublisher::getNumErrors() const {
+    return this->numErrors;
+}
+
+
+/**
+ * Listens for feedback datagrams and prints their contents along with the age of each datagram,
+ * computed from the frame timestamp. Intended for verifying the publisher on loopback.
+ * 
+ * @params[in]: address     -> multicast group to join, or empty/NULL for unicast
+ * @params[in]: port        -> UDP port to listen on
+ * @params[in]: numPackets  -> number of datagrams to receive before returning
+ * @params[in]: timeout     -> seconds to wait for each datagram
+ * @return: number of datagrams received
+ */
+int evtFeedbackListen(const char* address, int port, int numPackets, double timeout){
+    SOCKET sock = epicsSocketCreate(AF_INET, SOCK_DGRAM, 0);
+    if(sock == INVALID_SOCKET){
+        printf("Could not create socket\n");
+        return 0;
+    }
+    epicsSocketEnableAddressReuseDuringTimeWaitState(sock);
+
+    osiSockAddr local;
+    memset(&local, 0, sizeof(local));
+    local.ia.sin_family = AF_INET;
+    local.ia.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.ia.sin_port = htons((unsigned short) port);
+    if(bind(sock, &local.sa, sizeof(local.ia)) != 0){
+        printf("Could not bind to port %d\n", port);
+        epicsSocketDestroy(sock);
+        return 0;
+    }
+
+    if(address != NULL && strlen(address) > 0){
+        osiSockAddr group;
+        if(aToIPAddr(address, (unsigned short) port, &group.ia) == 0 && isMulticastAddress(&group.ia)){
+            struct ip_mreq request;
+            request.imr_multiaddr = group.ia.sin_addr;
+            request.imr_interface.s_addr = htonl(INADDR_ANY);
+            setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char*) &request, sizeof(request));
+        }
+    }
+
+#ifdef _WIN32
+    DWORD timeoutMs = (DWORD) (timeout * 1000);
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*) &timeoutMs, sizeof(timeoutMs));
+#else
+    struct timeval tv;
+    tv.tv_sec = (long) timeout;
+    tv.tv_usec = (long) ((timeout - tv.tv_sec) * 1000000);
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*) &tv, sizeof(tv));
+#endif
+
+    char buffer[sizeof(EVTFeedbackHeader) + 64 * sizeof(double)];
+    int received = 0;
+    while(received < numPackets){
+        int size = recv(sock, buffer, sizeof(buffer), 0);
+        if(size < (int) sizeof(EVTFeedbackHeader)){
+            printf("No datagram received\n");
+            break;
+        }
+        epicsTimeStamp now;
+        epicsTimeGetCurrent(&now);
+        EVTFeedbackHeader header;
+        memcpy(&header, buffer, sizeof(header));
+        if(evtLittleEndian32(header.magic) != EVT_FEEDBACK_MAGIC) continue;
+        header.numValues = evtLittleEndian16(header.numValues);
+        header.sequence = evtLittleEndian32(header.sequence);
+        header.uniqueId = (int32_t) evtLittleEndian32((uint32_t) header.uniqueId);
+        header.cameraTimeStamp = evtLittleEndian64(header.cameraTimeStamp);
+        header.secPastEpoch = evtLittleEndian32(header.secPastEpoch);
+        header.nsec = evtLittleEndian32(header.nsec);
+
+        epicsTimeStamp frameTime;
+        frameTime.secPastEpoch = header.secPastEpoch;
+        frameTime.nsec = header.nsec;
+        printf("seq %u, id %d, camera ts %llu, age %.1f us:", header.sequence, header.uniqueId,
+               (unsigned long long) header.cameraTimeStamp, epicsTimeDiffInSeconds(&now, &frameTime) * 1e6);
+        size_t numValues = (size - sizeof(EVTFeedbackHeader)) / sizeof(double);
+        if(numValues > header.numValues) numValues = header.numValues;
+        for(size_t i = 0; i < numValues; i++){
+            double value;
+            memcpy(&value, buffer + sizeof(EVTFeedbackHeader) + i * sizeof(double), sizeof(double));
+            printf(" %g", evtLittleEndianDouble(value));
+        }
+        printf("\n");
+        received++;
+    }
+    epicsSocketDestroy(sock);
+    return received;
+}
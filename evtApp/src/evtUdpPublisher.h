@@ -0,0 +1,84 @@
+/**
+ * Header file for the ADEmergentVision UDP feedback publisher
+ * 
+ * Sends one compact datagram per frame with the frame id, timestamps and a configured list of scalar
+ * metrics to a unicast or multicast endpoint. Datagrams are sent directly from the image thread, with the
+ * driver lock held, on a non blocking socket, so a send never waits on the network.
+ * 
+ * Datagram layout, every field converted to little endian when the datagram is built:
+ *      EVTFeedbackHeader           (32 bytes)
+ *      double values[numValues]    (8 bytes each)
+ * 
+ * Created On: October-18-2026
+ * 
+ * Copyright (c) : 2026 Brookhaven National Laboratory
+ * 
+ */
+
+// header guard
+#ifndef EVTUDPPUBLISHER_H
+#define EVTUDPPUBLISHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <epicsTime.h>
+#include <osiSock.h>
+
+// "EVTF" when read as little endian bytes
+#define EVT_FEEDBACK_MAGIC      0x46545645
+#define EVT_FEEDBACK_VERSION    1
+
+
+#pragma pack(push, 1)
+typedef struct EVTFeedbackHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t numValues;
+    // incremented for every datagram, used by receivers to detect loss
+    uint32_t sequence;
+    int32_t uniqueId;
+    // raw camera timestamp in nanoseconds
+    uint64_t cameraTimeStamp;
+    // epics timestamp of the frame
+    uint32_t secPastEpoch;
+    uint32_t nsec;
+} EVTFeedbackHeader;
+#pragma pack(pop)
+
+
+class EVTUdpPublisher {
+
+    public:
+
+        EVTUdpPublisher();
+        ~EVTUdpPublisher();
+
+        // address may be unicast or multicast, ttl is only used for multicast
+        bool open(const char* address, int port, int ttl, std::string& error);
+        void close();
+        bool isOpen() const;
+
+        bool send(int uniqueId, uint64_t cameraTimeStamp, const epicsTimeStamp& timeStamp, const double* values, size_t numValues);
+
+        size_t getNumSent() const;
+        size_t getNumErrors() const;
+
+    private:
+
+        SOCKET sock;
+        osiSockAddr destination;
+        uint32_t sequence;
+        size_t numSent;
+        size_t numErrors;
+        std::vector<char> buffer;
+};
+
+
+// Receives and prints feedback datagrams, used to test the publisher on loopback
+int evtFeedbackListen(const char* address, int port, int numPackets, double timeout);
+
+
+#endif
@@ -32,6 +32,10 @@ epicsEnvSet("EPICS_CA_MAX_ARRAY_BYTES", 20000000)
 #epicsThreadSleep(15)
 
 
+# Workers shared by the per frame processing of all cameras, 0 threads for one per core of the CPU set
+# EVTExecutorConfig(int numThreads, const char* cpuSet)
+#EVTExecutorConfig(4, "0-3")
+
 # ADEmergentVisionConfig(const char* portName, char* serialNumber, int maxBuffers, size_t maxMemory, int priority, int stackSize)
 ADEmergentVisionConfig("$(PORT)", "370018", 0, 0, 0, 0)
 